@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+#
+#   generate-default-app-options.py
+#   ScrollToZoom
+#
+#   Created by alpha on 2026/10/17.
+#   Copyright © 2026 alphaArgon.
+#
+#   Compiles ScrollToZoom/STZDefaultAppOptions.list into a perfect hash table in
+#   ScrollToZoom/STZDefaultAppOptions.h, so that looking up the recommended options of an app
+#   needs neither allocation nor CoreFoundation at run time.
+#
+#   The hash is the displacement kind: a bundle ID is hashed once to pick a bucket, and the seed
+#   stored for the bucket rehashes it to a slot no other bundle ID takes.
+#
+#   Entries ending with `*` are prefix rules. They don’t go into the hash table but into a plain
+#   array, which is compiled into an `STZPrefixTrie` at run time.
+#
+#   Usage:
+#       generate-default-app-options.py             Regenerates the header.
+#       generate-default-app-options.py --check     Fails if the header is out of date, or if any
+#                                                   listed bundle ID isn’t found in its table.
+
+import os
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'ScrollToZoom')
+LIST_PATH = os.path.join(ROOT, 'STZDefaultAppOptions.list')
+HEADER_PATH = os.path.join(ROOT, 'STZDefaultAppOptions.h')
+
+MAX_SEED = 0xFFFF
+
+
+def fnv1a(data, seed):
+    #   Must match `STZDefaultAppOptionsHash` below.
+    h = (2166136261 ^ (seed * 0x9E3779B1)) & 0xFFFFFFFF
+    for byte in data:
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def power_of_two_at_least(n):
+    p = 1
+    while p < n:
+        p *= 2
+    return p
+
+
+def read_list(path):
+    entries = []
+    seen = set()
+    with open(path, encoding='utf-8') as f:
+        for number, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+
+            fields = line.split(None, 1)
+            if len(fields) != 2:
+                sys.exit(f'{path}:{number}: expected a bundle ID and options')
+
+            bundle_id, options = fields[0], ''.join(fields[1].split())
+            data = bundle_id.encode('utf-8')
+            if data in seen:
+                sys.exit(f'{path}:{number}: duplicate bundle ID {bundle_id}')
+            if len(data) > 255:
+                sys.exit(f'{path}:{number}: bundle ID longer than 255 bytes')
+            if b'*' in data[:-1]:
+                sys.exit(f'{path}:{number}: `*` is only allowed at the end')
+
+            seen.add(data)
+            entries.append((data, options.replace('|', ' | ')))
+    return entries
+
+
+def build_table(entries):
+    slot_count = power_of_two_at_least(max(2 * len(entries), 1))
+    bucket_count = power_of_two_at_least(max(len(entries) // 2, 1))
+
+    buckets = [[] for _ in range(bucket_count)]
+    for entry in entries:
+        buckets[fnv1a(entry[0], 0) & (bucket_count - 1)].append(entry)
+
+    seeds = [0] * bucket_count
+    slots = [None] * slot_count
+
+    #   Place the largest buckets first while the table is still sparse.
+    for b in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            continue
+        for seed in range(1, MAX_SEED + 1):
+            taken = [fnv1a(data, seed) & (slot_count - 1) for data, _ in buckets[b]]
+            if len(set(taken)) == len(taken) and all(slots[s] is None for s in taken):
+                break
+        else:
+            sys.exit('no perfect hash found; the list is too large for 16-bit seeds')
+
+        seeds[b] = seed
+        for s, entry in zip(taken, buckets[b]):
+            slots[s] = entry
+
+    return seeds, slots
+
+
+def look_up(seeds, slots, data):
+    seed = seeds[fnv1a(data, 0) & (len(seeds) - 1)]
+    slot = slots[fnv1a(data, seed) & (len(slots) - 1)]
+    return slot[1] if slot and slot[0] == data else None
+
+
+def c_string(data):
+    return '"' + data.decode('utf-8').replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def render(entries, prefix_rules, seeds, slots):
+    lines = [
+        '/*',
+        ' *  STZDefaultAppOptions.h',
+        ' *  ScrollToZoom',
+        ' *',
+        ' *  Generated by Scripts/generate-default-app-options.py from STZDefaultAppOptions.list.',
+        ' *  Do not edit.',
+        ' */',
+        '',
+        '#pragma once',
+        '#include "STZSettings.h"',
+        '',
+        '',
+        f'#define kSTZDefaultAppOptionsCount {len(entries)}',
+        f'#define kSTZDefaultAppPrefixRuleCount {len(prefix_rules)}',
+        '',
+        f'static uint16_t const STZDefaultAppOptionsSeeds[{len(seeds)}] = {{',
+    ]
+
+    for i in range(0, len(seeds), 8):
+        lines.append('    ' + ', '.join(f'{seed:5}' for seed in seeds[i:i + 8]) + ',')
+
+    lines += [
+        '};',
+        '',
+        'static struct {',
+        '    char const     *bundleID;',
+        '    uint8_t         length;',
+        '    STZAppOptions   options;',
+        f'}} const STZDefaultAppOptionsSlots[{len(slots)}] = {{',
+    ]
+
+    for i, slot in enumerate(slots):
+        if slot:
+            lines.append(f'    [{i}] = {{{c_string(slot[0])}, {len(slot[0])}, {slot[1]}}},')
+
+    lines += [
+        '};',
+        '',
+        '/// Rules ending with `*`, which is counted in the length.',
+        'static struct {',
+        '    char const     *rule;',
+        '    uint8_t         length;',
+        '    STZAppOptions   options;',
+        f'}} const STZDefaultAppPrefixRules[{max(len(prefix_rules), 1)}] = {{',
+    ]
+
+    for data, options in prefix_rules:
+        lines.append(f'    {{{c_string(data)}, {len(data)}, {options}}},')
+
+    lines += [
+        '};',
+        '',
+        '',
+        'static inline uint32_t STZDefaultAppOptionsHash(char const *bytes, size_t length, uint32_t seed) {',
+        '    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B1u);',
+        '    for (size_t i = 0; i < length; ++i) {',
+        '        hash = (hash ^ (uint8_t)bytes[i]) * 16777619u;',
+        '    }',
+        '    return hash;',
+        '}',
+        '',
+        '',
+        '/// Looks up exact entries only. Returns false if the bundle ID is not listed.',
+        'static inline bool STZGetDefaultAppOptions(char const *bundleID, size_t length, STZAppOptions *outOptions) {',
+        f'    uint32_t bucket = STZDefaultAppOptionsHash(bundleID, length, 0) & {len(seeds) - 1};',
+        '    uint32_t seed = STZDefaultAppOptionsSeeds[bucket];',
+        f'    uint32_t i = STZDefaultAppOptionsHash(bundleID, length, seed) & {len(slots) - 1};',
+        '',
+        '    if (!STZDefaultAppOptionsSlots[i].bundleID) {return false;}',
+        '    if (STZDefaultAppOptionsSlots[i].length != length) {return false;}',
+        '    if (memcmp(STZDefaultAppOptionsSlots[i].bundleID, bundleID, length) != 0) {return false;}',
+        '    *outOptions = STZDefaultAppOptionsSlots[i].options;',
+        '    return true;',
+        '}',
+        '',
+    ]
+
+    return '\n'.join(lines)
+
+
+def main():
+    check = sys.argv[1:] == ['--check']
+    if sys.argv[1:] and not check:
+        sys.exit(f'usage: {sys.argv[0]} [--check]')
+
+    entries = read_list(LIST_PATH)
+    prefix_rules = sorted(e for e in entries if e[0].endswith(b'*'))
+    entries = [e for e in entries if not e[0].endswith(b'*')]
+    seeds, slots = build_table(entries)
+
+    for data, options in entries:
+        if look_up(seeds, slots, data) != options:
+            sys.exit(f'{data.decode()} is not found in the generated table')
+
+    output = render(entries, prefix_rules, seeds, slots)
+
+    if check:
+        try:
+            with open(HEADER_PATH, encoding='utf-8') as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != output:
+            sys.exit('STZDefaultAppOptions.h is out of date; run this script without --check')
+        print(f'STZDefaultAppOptions.h matches {len(entries)} entries and '
+              f'{len(prefix_rules)} prefix rules in the list')
+        return
+
+    with open(HEADER_PATH, 'w', encoding='utf-8') as f:
+        f.write(output)
+
+
+if __name__ == '__main__':
+    main()
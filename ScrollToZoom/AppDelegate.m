@@ -77,6 +77,9 @@ void STZDidStopWorkingDueToEventTapTimeout(void) {
         }
     }
 
+    STZStartTrackingDisplays();
+    STZStartTrackingProcesses();
+
     if (!STZSetWorkingModes(STZGetPreferredModes())) {
         [STZWindow orderFrontSharedWindowWithAdvancedSettings:NO];
     }
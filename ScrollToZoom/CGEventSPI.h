@@ -7,8 +7,10 @@
  */
 
 #pragma once
-#include <CoreGraphics/CGEvent.h>
+#include "STZBackend.h"
+#if !STZ_HEADLESS
 #include <IOKit/hid/IOHIDLib.h>
+#endif
 
 CF_IMPLICIT_BRIDGING_ENABLED
 CF_ASSUME_NONNULL_BEGIN
@@ -66,8 +68,10 @@ typedef CF_ENUM(uint32_t, CGHIDEventType) {
 };
 
 
+#if !STZ_HEADLESS
 typedef struct CF_BRIDGED_TYPE(id) __IOHIDEvent *IOHIDEventRef;
 IOHIDEventRef __nullable CGEventCopyIOHIDEvent(CGEventRef);
+#endif
 
 
 typedef CF_ENUM(uint32_t, IOHIDEventType) {
@@ -82,6 +86,7 @@ typedef CF_ENUM(uint32_t, IOHIDEventType) {
     kIOHIDEventTypeForce = 32,
 };
 
+#if !STZ_HEADLESS
 IOHIDEventType IOHIDEventGetType(IOHIDEventRef);
 
 
@@ -111,6 +116,12 @@ static inline uint64_t CGEventGetRegistryID(CGEventRef event) {
     return senderID;
 }
 
+#else
+static inline uint64_t CGEventGetRegistryID(CGEventRef event) {
+    return CGEventGetIntegerValueField(event, kCGEventRegistryID);
+}
+#endif
+
 
 CF_ASSUME_NONNULL_END
 CF_IMPLICIT_BRIDGING_DISABLED
@@ -0,0 +1,250 @@
+/*
+ *  STZAppEngine.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZAppEngine.h"
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+#if __APPLE__
+#define MODIFICATION_TIME(st) ((st).st_mtimespec)
+#else
+#define MODIFICATION_TIME(st) ((st).st_mtim)
+#endif
+
+
+static bool hasSuffix(char const *string, char const *suffix) {
+    size_t length = strlen(string);
+    size_t suffixLength = strlen(suffix);
+    return length >= suffixLength && memcmp(string + length - suffixLength, suffix, suffixLength) == 0;
+}
+
+
+static bool fileExists(char const *path) {
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+
+STZAppEngine STZDetectAppEngine(char const *bundlePath) {
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s/Contents/Frameworks", bundlePath) >= (int)sizeof(path)) {
+        return kSTZAppEngineNative;
+    }
+
+    DIR *dir = opendir(path);
+    if (!dir) {return kSTZAppEngineNative;}
+
+    STZAppEngine engine = kSTZAppEngineNative;
+    struct dirent *entry;
+
+    while ((entry = readdir(dir))) {
+        char const *name = entry->d_name;
+        if (!hasSuffix(name, ".framework")) {continue;}
+
+        if (strcmp(name, "Electron Framework.framework") == 0) {
+            engine = kSTZAppEngineElectron;
+            break;
+        }
+
+        if (strcmp(name, "Chromium Framework.framework") == 0) {
+            engine = kSTZAppEngineChromium;
+            continue;
+        }
+
+        //  Branded browsers rename the framework, but it still carries Chromium’s resource packs.
+        //  `Resources` is a symbolic link to the current version.
+        char marker[PATH_MAX];
+        int length = snprintf(marker, sizeof(marker), "%s/%s/Resources/chrome_100_percent.pak", path, name);
+        if (length < (int)sizeof(marker) && fileExists(marker)) {
+            engine = kSTZAppEngineChromium;
+        }
+    }
+
+    closedir(dir);
+    return engine;
+}
+
+
+//  MARK: - Cache
+
+
+//  The file is plain text with a header line, then one entry per line:
+//
+//      <engine> <seconds> <nanoseconds> <bundle path>
+//
+//  Paths containing a newline can’t be written and are only cached in memory.
+
+static char const kCacheHeader[] = "STZAppEngineCache 1\n";
+
+
+typedef struct {
+    char           *bundlePath;
+    int64_t         seconds;
+    int64_t         nanoseconds;
+    STZAppEngine    engine;
+} CacheEntry;
+
+
+struct _STZAppEngineCache {
+    char           *filePath;
+    CacheEntry     *entries;
+    size_t          count;
+    size_t          capacity;
+    bool            dirty;
+};
+
+
+static CacheEntry *findEntry(STZAppEngineCacheRef cache, char const *bundlePath) {
+    //  A user runs at most a few hundred apps; a linear scan off the event path is fine.
+    for (size_t i = 0; i < cache->count; ++i) {
+        if (strcmp(cache->entries[i].bundlePath, bundlePath) == 0) {
+            return &cache->entries[i];
+        }
+    }
+    return NULL;
+}
+
+
+static CacheEntry *addEntry(STZAppEngineCacheRef cache, char const *bundlePath) {
+    if (cache->count == cache->capacity) {
+        cache->capacity = cache->capacity ? cache->capacity * 2 : 32;
+        cache->entries = realloc(cache->entries, sizeof(CacheEntry) * cache->capacity);
+    }
+
+    CacheEntry *entry = &cache->entries[cache->count++];
+    entry->bundlePath = strdup(bundlePath);
+    return entry;
+}
+
+
+static void loadEntries(STZAppEngineCacheRef cache) {
+    FILE *file = fopen(cache->filePath, "r");
+    if (!file) {return;}
+
+    char line[PATH_MAX + 64];
+    if (!fgets(line, sizeof(line), file) || strcmp(line, kCacheHeader) != 0) {
+        fclose(file);
+        return;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        size_t length = strlen(line);
+        if (length == 0 || line[length - 1] != '\n') {break;}  //  Truncated.
+        line[length - 1] = '\0';
+
+        unsigned engine;
+        long long seconds, nanoseconds;
+        int pathOffset;
+        if (sscanf(line, "%u %lld %lld %n", &engine, &seconds, &nanoseconds, &pathOffset) != 3) {continue;}
+        if (engine > kSTZAppEngineElectron || line[pathOffset] == '\0') {continue;}
+
+        char const *bundlePath = line + pathOffset;
+        CacheEntry *entry = findEntry(cache, bundlePath) ?: addEntry(cache, bundlePath);
+        entry->seconds = seconds;
+        entry->nanoseconds = nanoseconds;
+        entry->engine = engine;
+    }
+
+    fclose(file);
+}
+
+
+STZAppEngineCacheRef STZAppEngineCacheCreate(char const *filePath) {
+    STZAppEngineCacheRef cache = malloc(sizeof(struct _STZAppEngineCache));
+    cache->filePath = strdup(filePath);
+    cache->entries = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+    cache->dirty = false;
+    loadEntries(cache);
+    return cache;
+}
+
+
+void STZAppEngineCacheRelease(STZAppEngineCacheRef cache) {
+    for (size_t i = 0; i < cache->count; ++i) {
+        free(cache->entries[i].bundlePath);
+    }
+    free(cache->entries);
+    free(cache->filePath);
+    free(cache);
+}
+
+
+/// Updates rewrite `Info.plist`, but not necessarily anything near the top of the bundle.
+static bool getModificationTime(char const *bundlePath, int64_t *outSeconds, int64_t *outNanoseconds) {
+    char path[PATH_MAX];
+    struct stat st;
+
+    int length = snprintf(path, sizeof(path), "%s/Contents/Info.plist", bundlePath);
+    if (length >= (int)sizeof(path) || stat(path, &st) != 0) {
+        if (stat(bundlePath, &st) != 0) {return false;}
+    }
+
+    *outSeconds = MODIFICATION_TIME(st).tv_sec;
+    *outNanoseconds = MODIFICATION_TIME(st).tv_nsec;
+    return true;
+}
+
+
+STZAppEngine STZAppEngineCacheGetEngine(STZAppEngineCacheRef cache, char const *bundlePath) {
+    int64_t seconds, nanoseconds;
+    if (!getModificationTime(bundlePath, &seconds, &nanoseconds)) {
+        return kSTZAppEngineNative;
+    }
+
+    CacheEntry *entry = findEntry(cache, bundlePath);
+    if (entry && entry->seconds == seconds && entry->nanoseconds == nanoseconds) {
+        return entry->engine;
+    }
+
+    if (!entry) {
+        entry = addEntry(cache, bundlePath);
+    }
+
+    entry->seconds = seconds;
+    entry->nanoseconds = nanoseconds;
+    entry->engine = STZDetectAppEngine(bundlePath);
+    cache->dirty = true;
+    return entry->engine;
+}
+
+
+bool STZAppEngineCacheSave(STZAppEngineCacheRef cache) {
+    if (!cache->dirty) {return true;}
+
+    char tempPath[PATH_MAX];
+    if (snprintf(tempPath, sizeof(tempPath), "%s.%d", cache->filePath, (int)getpid()) >= (int)sizeof(tempPath)) {
+        return false;
+    }
+
+    FILE *file = fopen(tempPath, "w");
+    if (!file) {return false;}
+
+    bool ok = fputs(kCacheHeader, file) >= 0;
+    for (size_t i = 0; ok && i < cache->count; ++i) {
+        CacheEntry const *entry = &cache->entries[i];
+        if (strchr(entry->bundlePath, '\n')) {continue;}
+        ok = fprintf(file, "%u %lld %lld %s\n", (unsigned)entry->engine,
+                     (long long)entry->seconds, (long long)entry->nanoseconds, entry->bundlePath) >= 0;
+    }
+
+    //  Replace the old file only once the new one is complete.
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tempPath, cache->filePath) != 0) {
+        unlink(tempPath);
+        return false;
+    }
+
+    cache->dirty = false;
+    return true;
+}
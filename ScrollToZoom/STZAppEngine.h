@@ -0,0 +1,52 @@
+/*
+ *  STZAppEngine.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Chromium-based apps embed the engine as a framework: browsers ship `Chromium Framework` or a
+//  renamed copy such as `Google Chrome Framework`, and Electron apps ship `Electron Framework`.
+//  Detection looks only at the bundle on disk, so it needs no running process and works on any
+//  POSIX system.
+
+typedef CLOSED_ENUM(uint8_t) {
+    kSTZAppEngineNative     = 0,
+    kSTZAppEngineChromium   = 1,
+    kSTZAppEngineElectron   = 2,
+} STZAppEngine;
+
+/// Scans `Contents/Frameworks` of the bundle. Returns `kSTZAppEngineNative` if no marker is found
+/// or the bundle can’t be read. This touches the file system; never call it on the event path.
+STZAppEngine STZDetectAppEngine(char const *bundlePath);
+
+
+//  MARK: - Cache
+
+
+//  Remembers detection results keyed by bundle path, so that each bundle is scanned once per
+//  modification. The cache isn’t thread-safe; use it from one queue.
+
+typedef struct _STZAppEngineCache *STZAppEngineCacheRef;
+
+/// Loads entries from the file if it exists and is readable; otherwise starts empty.
+STZAppEngineCacheRef STZAppEngineCacheCreate(char const *filePath);
+void STZAppEngineCacheRelease(STZAppEngineCacheRef);
+
+/// Returns the cached engine if the bundle hasn’t been modified since it was scanned; otherwise
+/// scans it again and records the result.
+STZAppEngine STZAppEngineCacheGetEngine(STZAppEngineCacheRef, char const *bundlePath);
+
+/// Writes the entries atomically. Does nothing if none has changed since the cache was loaded or
+/// last saved. Returns false if the file can’t be written.
+bool STZAppEngineCacheSave(STZAppEngineCacheRef);
+
+
+CF_ASSUME_NONNULL_END
@@ -0,0 +1,135 @@
+/*
+ *  STZAppRegistry.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZAppRegistry.h"
+
+
+typedef struct {
+    char const     *bundleID;
+    uint32_t        length;
+    uint32_t        hash;
+    bool            isSystem;
+} AppEntry;
+
+
+//  Entry 0 stands for `kSTZNoAppID` so that entries are indexed by app ID directly.
+static AppEntry *entries = NULL;
+static uint32_t entryCount = 1;
+static uint32_t entryCapacity = 0;
+
+//  Open addressing with linear probing; slots hold app IDs, 0 for empty ones.
+static STZAppID *slots = NULL;
+static uint32_t slotMask = 0;
+
+
+static uint32_t hashBytes(char const *bytes, size_t length) {
+    //  FNV-1a. Bundle IDs share long prefixes, which a byte-wise hash copes with fine.
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (uint8_t)bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+
+static void rebuildSlots(uint32_t capacity) {
+    free(slots);
+    slots = calloc(capacity, sizeof(STZAppID));
+    slotMask = capacity - 1;
+
+    for (STZAppID appID = 1; appID < entryCount; ++appID) {
+        uint32_t h = entries[appID].hash & slotMask;
+        while (slots[h] != kSTZNoAppID) {
+            h = (h + 1) & slotMask;
+        }
+        slots[h] = appID;
+    }
+}
+
+
+/// Returns the slot of the bundle ID, or the empty slot where it would be inserted.
+static uint32_t findSlot(char const *bundleID, size_t length, uint32_t hash) {
+    uint32_t h = hash & slotMask;
+    STZAppID appID;
+    while ((appID = slots[h]) != kSTZNoAppID) {
+        AppEntry const *entry = &entries[appID];
+        if (entry->hash == hash && entry->length == length && memcmp(entry->bundleID, bundleID, length) == 0) {
+            break;
+        }
+        h = (h + 1) & slotMask;
+    }
+    return h;
+}
+
+
+STZAppID STZAppRegistryLookup(char const *bundleID, size_t length) {
+    if (!slots) {return kSTZNoAppID;}
+    return slots[findSlot(bundleID, length, hashBytes(bundleID, length))];
+}
+
+
+STZAppID STZAppRegistryIntern(char const *bundleID, size_t length) {
+    if (!slots) {
+        rebuildSlots(64);
+    }
+
+    uint32_t hash = hashBytes(bundleID, length);
+    uint32_t h = findSlot(bundleID, length, hash);
+    if (slots[h] != kSTZNoAppID) {return slots[h];}
+
+    if (entryCount == entryCapacity || entryCapacity == 0) {
+        entryCapacity = entryCapacity ? entryCapacity * 2 : 64;
+        entries = realloc(entries, sizeof(AppEntry) * entryCapacity);
+        entries[0] = (AppEntry){NULL, 0, 0, false};
+    }
+
+    char *copy = malloc(length + 1);
+    memcpy(copy, bundleID, length);
+    copy[length] = '\0';
+
+    static char const systemPrefix[] = "com.apple.";
+    size_t prefixLength = sizeof(systemPrefix) - 1;
+
+    STZAppID appID = entryCount++;
+    entries[appID] = (AppEntry){
+        .bundleID = copy,
+        .length = (uint32_t)length,
+        .hash = hash,
+        .isSystem = length >= prefixLength && memcmp(copy, systemPrefix, prefixLength) == 0,
+    };
+
+    //  Keep the load factor at most 1/2.
+    if (entryCount * 2 > slotMask + 1) {
+        rebuildSlots((slotMask + 1) * 2);
+    } else {
+        slots[h] = appID;
+    }
+
+    return appID;
+}
+
+
+char const *STZAppRegistryGetBundleIdentifier(STZAppID appID, size_t *outLength) {
+    if (appID == kSTZNoAppID || appID >= entryCount) {
+        if (outLength) {*outLength = 0;}
+        return NULL;
+    }
+
+    if (outLength) {*outLength = entries[appID].length;}
+    return entries[appID].bundleID;
+}
+
+
+STZAppID STZAppRegistryGetLastAppID(void) {
+    return entryCount - 1;
+}
+
+
+bool STZAppRegistryIsSystemApp(STZAppID appID) {
+    return appID != kSTZNoAppID && appID < entryCount && entries[appID].isSystem;
+}
@@ -0,0 +1,41 @@
+/*
+ *  STZAppRegistry.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Bundle identifiers are interned into small app IDs, so that per-app data can be kept in
+//  arrays indexed by the ID instead of being looked up by string. IDs start from 1 and are never
+//  reused. The registry is not thread-safe; intern and look up on the main thread only.
+
+typedef uint32_t STZAppID;
+
+/// Stands for processes without a bundle identifier.
+#define kSTZNoAppID ((STZAppID)0)
+
+
+/// The bundle ID is UTF-8 and needn’t be NUL-terminated.
+STZAppID STZAppRegistryIntern(char const *bundleID, size_t length);
+
+/// Returns `kSTZNoAppID` if the bundle ID has not been interned.
+STZAppID STZAppRegistryLookup(char const *bundleID, size_t length);
+
+/// The string is NUL-terminated and lives as long as the process.
+char const *__nullable STZAppRegistryGetBundleIdentifier(STZAppID appID, size_t *__nullable outLength);
+
+/// IDs in use are 1 through the returned value.
+STZAppID STZAppRegistryGetLastAppID(void);
+
+/// Whether the bundle ID starts with `com.apple.`.
+bool STZAppRegistryIsSystemApp(STZAppID appID);
+
+
+CF_ASSUME_NONNULL_END
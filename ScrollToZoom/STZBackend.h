@@ -0,0 +1,27 @@
+/*
+ *  STZBackend.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+
+//  The portable core (STZCommon.c and STZStateManager.c) only touches the platform through the
+//  event field accessors, event creation, the clock, logging and posting. On macOS these are
+//  CoreGraphics and the console panel. Defining `STZ_HEADLESS` swaps in the in-memory backend,
+//  which provides the same names on any C11 platform, so the core can be compiled and driven
+//  without a window server. CMakeLists.txt at the top of the repository builds the portable
+//  sources this way as `libstzcore`, along with the tests.
+
+#if STZ_HEADLESS
+#include "STZMemoryBackend.h"
+#else
+#include <CoreGraphics/CGEvent.h>
+#include <time.h>
+
+static inline CGEventTimestamp CGEventTimestampNow(void) {
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW_APPROX);
+}
+#endif
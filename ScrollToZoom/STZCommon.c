@@ -7,6 +7,7 @@
  */
 
 #include "STZCommon.h"
+#include "STZSettings.h"
 #include "CGEventSPI.h"
 
 
@@ -20,6 +21,7 @@ STZFlags STZFlagsValidate(uint32_t dirtyFlags) {
 }
 
 
+#if !STZ_HEADLESS
 CFStringRef STZFlagsCopyDescription(uint32_t anyFlags) {
     if (anyFlags & kSTZMouseButtonsMask) {
         if (anyFlags == kSTZMouseButtonMiddle) {
@@ -62,6 +64,7 @@ CFStringRef STZFlagsCopyDescription(uint32_t anyFlags) {
 
     return CFStringCreateWithCharacters(kCFAllocatorDefault, characters, characterCount);
 }
+#endif
 
 
 //  MARK: -
@@ -75,41 +78,335 @@ static inline int div_ceil(int a, int b) {
 }
 
 
+//  While all entries fit in `inlinePayload`, the cache is in the small mode: there’s no index and
+//  lookups scan the few inline entries. Further entries live in slabs of `kSlabEntryCount` entries.
+//  Slabs are never moved, so the address of a value is stable until the value is removed; a slab
+//  is released once all its entries have expired. `index` is an open-addressed table of entry
+//  indices with linear probing; its capacity is a power of two and at least twice the entry count.
+//
+//  Lifetime is tracked by a coarse timer wheel instead of comparing timestamps on every access.
+//  Time is counted in ticks of `valueLifetime / (kWheelSlotCount - 1)`. An accessed entry is
+//  stamped with the current tick and linked into the wheel slot of that tick. When the wheel
+//  advances to a slot, all entries in it are at least `kWheelSlotCount` ticks old and disposed.
+//
+//  Accesses move the wheel to the current time before stamping, or an entry accessed after a
+//  long gap would be stamped with a stale tick and disposed by the next advance. Within a tick
+//  that costs one comparison.
+
+#define kIndexEmpty     (-1)
+#define kIndexRemoved   (-2)
+#define kWheelSlotCount 8
+#define kSlabEntryCount 8
+
+
+typedef struct {
+    int                 liveCount;
+    int                 reserved;
+    uint8_t             entries[];
+} _STZCacheSlab;
+
+
 struct _STZCache {
-    int                 count;
-    int                 recentIndex;
-    CGEventTimestamp    valueLifetime;
+    int                 count;  ///< Inline entries and entries of all slabs, including released ones.
+    int                 inlineCount;
+    int                 liveCount;
+    int                 recentIndex;  ///< -1 means none.
+    int                 freeIndex;  ///< Head of the free entry list; -1 means none.
+    int                 indexMask;
+    int                 removedCount;
+    int32_t            *index;  ///< NULL in the small mode.
+    int                 slabCount;
+    _STZCacheSlab     **slabs;  ///< A released slab is NULL.
+    uint32_t            nextGeneration;
+    uint32_t            tick;
+    CGEventTimestamp    tickDuration;
+    CGEventTimestamp    nextTickTime;  ///< When the wheel has to advance again.
+    int32_t             wheel[kWheelSlotCount];
     int                 valueSize;
     int                 entrySize;
-    void               *entries;
     void (*valueDisposeCallback)(void *valueAddr);
     uint8_t             inlinePayload[80];
 };
 
 
 typedef struct {
-    uint64_t            key;
-    CGEventTimestamp    accessedAt;  ///< 0 means not used.
+    uint64_t            key;  ///< The next free entry index if not used.
+    uint32_t            tick;  ///< 0 means not used.
+    uint32_t            generation;  ///< Identifies the value for handles; 0 means not used.
+    int32_t             wheelNext;
+    int32_t             wheelPrev;
 } _STZCacheEntryStub;
 
 
-_STZCacheEntryStub *STZCacheGetEntryAtIndex(STZCacheRef cache, int i) {
-    return (_STZCacheEntryStub *)(cache->entries + cache->entrySize * i);
+/// Returns NULL if the entry belongs to a released slab.
+static _STZCacheEntryStub *STZCacheGetEntryAtIndex(STZCacheRef cache, int i) {
+    if (i < cache->inlineCount) {
+        return (_STZCacheEntryStub *)(cache->inlinePayload + cache->entrySize * i);
+    }
+
+    i -= cache->inlineCount;
+    _STZCacheSlab *slab = cache->slabs[i / kSlabEntryCount];
+    if (!slab) {return NULL;}
+    return (_STZCacheEntryStub *)(slab->entries + cache->entrySize * (i % kSlabEntryCount));
+}
+
+
+static _STZCacheSlab *STZCacheGetSlabOfIndex(STZCacheRef cache, int i) {
+    if (i < cache->inlineCount) {return NULL;}
+    return cache->slabs[(i - cache->inlineCount) / kSlabEntryCount];
+}
+
+
+static int STZCacheGetIndexOfValue(STZCacheRef cache, void const *valueAddr) {
+    uintptr_t entry = (uintptr_t)valueAddr - sizeof(_STZCacheEntryStub);
+
+    uintptr_t base = (uintptr_t)cache->inlinePayload;
+    if (entry >= base && entry < base + cache->entrySize * cache->inlineCount) {
+        return (int)(entry - base) / cache->entrySize;
+    }
+
+    for (int s = 0; s < cache->slabCount; ++s) {
+        if (!cache->slabs[s]) {continue;}
+        base = (uintptr_t)cache->slabs[s]->entries;
+        if (entry >= base && entry < base + cache->entrySize * kSlabEntryCount) {
+            return cache->inlineCount + s * kSlabEntryCount + (int)(entry - base) / cache->entrySize;
+        }
+    }
+
+    return -1;
+}
+
+
+static inline uint32_t hashKey(uint64_t key) {
+    //  Registry IDs are sequential and share high bits; Fibonacci hashing spreads them.
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+
+static void pushFreeEntry(STZCacheRef cache, int i) {
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    entry->tick = 0;
+    entry->generation = 0;
+    entry->key = (uint64_t)(int64_t)cache->freeIndex;
+    cache->freeIndex = i;
+}
+
+
+static int popFreeEntry(STZCacheRef cache) {
+    int i = cache->freeIndex;
+    if (i == -1) {return -1;}
+
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    cache->freeIndex = (int)(int64_t)entry->key;
+
+    entry->generation = cache->nextGeneration;
+    cache->nextGeneration = cache->nextGeneration + 1 ?: 1;
+
+    _STZCacheSlab *slab = STZCacheGetSlabOfIndex(cache, i);
+    if (slab) {
+        slab->liveCount += 1;
+    }
+    return i;
+}
+
+
+static void rebuildIndex(STZCacheRef cache) {
+    int capacity = 8;
+    while (capacity < cache->count * 2) {
+        capacity *= 2;
+    }
+
+    if (cache->indexMask + 1 != capacity) {
+        free(cache->index);
+        cache->index = malloc(sizeof(int32_t) * capacity);
+        cache->indexMask = capacity - 1;
+    }
+
+    for (int h = 0; h < capacity; ++h) {
+        cache->index[h] = kIndexEmpty;
+    }
+
+    for (int i = 0; i < cache->count; ++i) {
+        _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+        if (!entry || entry->tick == 0) {continue;}
+
+        int h = hashKey(entry->key) & cache->indexMask;
+        while (cache->index[h] != kIndexEmpty) {
+            h = (h + 1) & cache->indexMask;
+        }
+        cache->index[h] = i;
+    }
+
+    cache->removedCount = 0;
+}
+
+
+/// Returns the index slot of the key, or -1 if not found.
+static int findIndexSlot(STZCacheRef cache, uint64_t key) {
+    int h = hashKey(key) & cache->indexMask;
+    int32_t i;
+    while ((i = cache->index[h]) != kIndexEmpty) {
+        if (i != kIndexRemoved && STZCacheGetEntryAtIndex(cache, i)->key == key) {
+            return h;
+        }
+        h = (h + 1) & cache->indexMask;
+    }
+    return -1;
+}
+
+
+static void linkWheelEntry(STZCacheRef cache, int i) {
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    int32_t *head = &cache->wheel[entry->tick % kWheelSlotCount];
+    entry->wheelPrev = -1;
+    entry->wheelNext = *head;
+    if (*head != -1) {
+        STZCacheGetEntryAtIndex(cache, *head)->wheelPrev = i;
+    }
+    *head = i;
+}
+
+
+static void unlinkWheelEntry(STZCacheRef cache, int i) {
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    if (entry->wheelPrev != -1) {
+        STZCacheGetEntryAtIndex(cache, entry->wheelPrev)->wheelNext = entry->wheelNext;
+    } else {
+        cache->wheel[entry->tick % kWheelSlotCount] = entry->wheelNext;
+    }
+    if (entry->wheelNext != -1) {
+        STZCacheGetEntryAtIndex(cache, entry->wheelNext)->wheelPrev = entry->wheelPrev;
+    }
+}
+
+
+static void touchEntry(STZCacheRef cache, int i) {
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    if (entry->tick == cache->tick) {return;}
+    unlinkWheelEntry(cache, i);
+    entry->tick = cache->tick;
+    linkWheelEntry(cache, i);
+}
+
+
+static void removeEntry(STZCacheRef cache, int i) {
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    unlinkWheelEntry(cache, i);
+
+    if (cache->index) {
+        int h = findIndexSlot(cache, entry->key);
+        assert(h != -1 && cache->index[h] == i);
+        cache->index[h] = kIndexRemoved;
+        cache->removedCount += 1;
+    }
+
+    if (cache->recentIndex == i) {
+        cache->recentIndex = -1;
+    }
+
+    _STZCacheSlab *slab = STZCacheGetSlabOfIndex(cache, i);
+    if (slab) {
+        slab->liveCount -= 1;
+    }
+
+    cache->liveCount -= 1;
+    cache->valueDisposeCallback(&entry[1]);
+    pushFreeEntry(cache, i);
+}
+
+
+static void addSlab(STZCacheRef cache) {
+    int s = 0;
+    while (s < cache->slabCount && cache->slabs[s] != NULL) {
+        s += 1;
+    }
+
+    if (s == cache->slabCount) {
+        cache->slabCount += 1;
+        cache->slabs = realloc(cache->slabs, sizeof(*cache->slabs) * cache->slabCount);
+        cache->count = cache->inlineCount + cache->slabCount * kSlabEntryCount;
+    }
+
+    _STZCacheSlab *slab = malloc(sizeof(_STZCacheSlab) + cache->entrySize * kSlabEntryCount);
+    slab->liveCount = 0;
+    cache->slabs[s] = slab;
+
+    //  Push in reverse so that lower indices are reused first.
+    int first = cache->inlineCount + s * kSlabEntryCount;
+    for (int i = first + kSlabEntryCount - 1; i >= first; --i) {
+        pushFreeEntry(cache, i);
+    }
+
+    if (cache->index == NULL || cache->count * 2 > cache->indexMask + 1) {
+        rebuildIndex(cache);
+    }
+}
+
+
+static void releaseEmptySlabs(STZCacheRef cache) {
+    bool released = false;
+    for (int s = 0; s < cache->slabCount; ++s) {
+        if (cache->slabs[s] && cache->slabs[s]->liveCount == 0) {
+            free(cache->slabs[s]);
+            cache->slabs[s] = NULL;
+            released = true;
+        }
+    }
+
+    if (!released) {return;}
+
+    while (cache->slabCount > 0 && cache->slabs[cache->slabCount - 1] == NULL) {
+        cache->slabCount -= 1;
+    }
+    cache->count = cache->inlineCount + cache->slabCount * kSlabEntryCount;
+
+    //  Entries of released slabs must leave the free list.
+    cache->freeIndex = -1;
+    for (int i = cache->count - 1; i >= 0; --i) {
+        _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+        if (!entry || entry->tick != 0) {continue;}
+        entry->key = (uint64_t)(int64_t)cache->freeIndex;
+        cache->freeIndex = i;
+    }
+
+    if (cache->slabCount == 0) {
+        free(cache->slabs);
+        free(cache->index);
+        cache->slabs = NULL;
+        cache->index = NULL;
+        cache->indexMask = -1;
+        cache->removedCount = 0;
+    } else {
+        rebuildIndex(cache);
+    }
 }
 
 
 STZCacheRef STZCacheCreate(size_t valueSize, CGEventTimestamp valueLifetime, void (*valueDisposeCallback)(void *valueAddr)) {
     STZCacheRef cache = malloc(sizeof(*cache));
-    cache->recentIndex = 0;
-    cache->valueLifetime = valueLifetime;
+    cache->liveCount = 0;
+    cache->recentIndex = -1;
+    cache->freeIndex = -1;
+    cache->indexMask = -1;
+    cache->removedCount = 0;
+    cache->index = NULL;
+    cache->slabCount = 0;
+    cache->slabs = NULL;
+    cache->nextGeneration = 1;
+    cache->tickDuration = valueLifetime / (kWheelSlotCount - 1) ?: 1;
+    cache->tick = (uint32_t)(CGEventTimestampNow() / cache->tickDuration) + 1;
+    cache->nextTickTime = (CGEventTimestamp)cache->tick * cache->tickDuration;
+    for (int s = 0; s < kWheelSlotCount; ++s) {
+        cache->wheel[s] = -1;
+    }
     cache->valueSize = (int)valueSize;
     cache->entrySize = (1 + div_ceil((int)valueSize, sizeof(_STZCacheEntryStub))) * sizeof(_STZCacheEntryStub);
-    cache->entries = cache->inlinePayload;
     cache->valueDisposeCallback = valueDisposeCallback ?: noop;
 
-    cache->count = sizeof(cache->inlinePayload) / cache->entrySize;
-    for (int i = 0; i < cache->count; ++i) {
-        STZCacheGetEntryAtIndex(cache, i)->accessedAt = 0;
+    cache->inlineCount = sizeof(cache->inlinePayload) / cache->entrySize;
+    cache->count = cache->inlineCount;
+    for (int i = cache->count - 1; i >= 0; --i) {
+        pushFreeEntry(cache, i);
     }
 
     return cache;
@@ -119,43 +416,77 @@ STZCacheRef STZCacheCreate(size_t valueSize, CGEventTimestamp valueLifetime, voi
 void STZCacheRelease(STZCacheRef cache) {
     for (int i = 0; i < cache->count; ++i) {
         _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
-        if (entry->accessedAt != 0) {
+        if (entry && entry->tick != 0) {
             cache->valueDisposeCallback(&entry[1]);
         }
     }
-    if (cache->entries != cache->inlinePayload) {
-        free(cache->entries);
+    for (int s = 0; s < cache->slabCount; ++s) {
+        free(cache->slabs[s]);
     }
+    free(cache->slabs);
+    free(cache->index);
     free(cache);
 }
 
 
-void *STZCacheGetValueForKey(STZCacheRef cache, uint64_t key, bool *outCreatedIfAbsent) {
-    CGEventTimestamp now = CGEventTimestampNow();
+static void advanceWheel(STZCacheRef cache, CGEventTimestamp now) {
+    if (now < cache->nextTickTime) {return;}
+
+    uint32_t target = (uint32_t)(now / cache->tickDuration) + 1;
+    if ((int32_t)(target - cache->tick) <= 0) {return;}
+
+    //  Every slot has been passed if the wheel advances a full round; expire all of them once.
+    uint32_t steps = target - cache->tick;
+    if (steps > kWheelSlotCount) {
+        steps = kWheelSlotCount;
+    }
+
+    bool removed = false;
+    for (uint32_t s = 1; s <= steps; ++s) {
+        int32_t i = cache->wheel[(target - steps + s) % kWheelSlotCount];
+        while (i != -1) {
+            int32_t next = STZCacheGetEntryAtIndex(cache, i)->wheelNext;
+            removeEntry(cache, i);
+            removed = true;
+            i = next;
+        }
+    }
 
-    int spareIndex = -1;
+    cache->tick = target;
+    cache->nextTickTime = (CGEventTimestamp)target * cache->tickDuration;
+
+    if (removed) {
+        releaseEmptySlabs(cache);
+    }
+}
+
+
+static int findEntry(STZCacheRef cache, uint64_t key) {
+    if (cache->index) {
+        int h = findIndexSlot(cache, key);
+        return h == -1 ? -1 : cache->index[h];
+    }
 
-    for (int h = 0; h < cache->count; ++h) {
-        int i = (cache->recentIndex + h) % cache->count;
+    for (int i = 0; i < cache->count; ++i) {
         _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+        if (entry->tick != 0 && entry->key == key) {return i;}
+    }
+    return -1;
+}
 
-        if (entry->accessedAt == 0) {
-            spareIndex = i;
 
-        } else if ((now - entry->accessedAt) >= cache->valueLifetime) {
-            if (spareIndex == -1) {
-                spareIndex = i;
-            }
+static void *STZCacheGetValueForKey(STZCacheRef cache, uint64_t key, bool *outCreatedIfAbsent) {
+    advanceWheel(cache, CGEventTimestampNow());
 
-        } else if (entry->key == key) {
-            entry->accessedAt = now;
-            cache->recentIndex = i;
+    int found = findEntry(cache, key);
+    if (found != -1) {
+        touchEntry(cache, found);
+        cache->recentIndex = found;
 
-            if (outCreatedIfAbsent) {
-                *outCreatedIfAbsent = false;
-            }
-            return &entry[1];
+        if (outCreatedIfAbsent) {
+            *outCreatedIfAbsent = false;
         }
+        return &STZCacheGetEntryAtIndex(cache, found)[1];
     }
 
     if (!outCreatedIfAbsent) {
@@ -164,44 +495,43 @@ void *STZCacheGetValueForKey(STZCacheRef cache, uint64_t key, bool *outCreatedIf
 
     *outCreatedIfAbsent = true;
 
-    if (spareIndex == -1) {
-        int newCount = (double)cache->count * 1.5 + 1;
+    if (cache->freeIndex == -1) {
+        addSlab(cache);
+    }
 
-        if (cache->entries == cache->inlinePayload) {
-            cache->entries = malloc(newCount * cache->entrySize);
-            memcpy(cache->entries, cache->inlinePayload, sizeof(cache->inlinePayload));
+    int i = popFreeEntry(cache);
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    entry->key = key;
+    entry->tick = cache->tick;
+    linkWheelEntry(cache, i);
+    cache->liveCount += 1;
+    cache->recentIndex = i;
+
+    if (cache->index) {
+        //  Keep the load factor, including removed slots, under 3/4 so that probes terminate early.
+        if ((cache->liveCount + cache->removedCount) * 4 > (cache->indexMask + 1) * 3) {
+            rebuildIndex(cache);
         } else {
-            cache->entries = realloc(cache->entries, newCount * cache->entrySize);
-        }
-
-        for (int i = cache->count; i < newCount; ++i) {
-            STZCacheGetEntryAtIndex(cache, i)->accessedAt = 0;
+            int h = hashKey(key) & cache->indexMask;
+            while (cache->index[h] >= 0) {
+                h = (h + 1) & cache->indexMask;
+            }
+            if (cache->index[h] == kIndexRemoved) {
+                cache->removedCount -= 1;
+            }
+            cache->index[h] = i;
         }
-
-        spareIndex = cache->count;
-        cache->count = newCount;
     }
 
-    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, spareIndex);
-    if (entry->accessedAt != 0) {
-        cache->valueDisposeCallback(&entry[1]);
-    }
-
-    entry->key = key;
-    entry->accessedAt = now;
-    cache->recentIndex = spareIndex;
     return &entry[1];
 }
 
 
 void *__nullable STZCacheGetRecentValue(STZCacheRef cache, uint64_t *__nullable outKey) {
-    if (cache->count == 0) {return NULL;}
+    if (cache->recentIndex == -1) {return NULL;}
 
     _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, cache->recentIndex);
-    if (entry->accessedAt == 0) {return NULL;}
-
-    CGEventTimestamp now = CGEventTimestampNow();
-    if ((now - entry->accessedAt) >= cache->valueLifetime) {return NULL;}
+    assert(entry->tick != 0);
 
     if (outKey != NULL) {
         *outKey = entry->key;
@@ -226,24 +556,82 @@ void *STZCacheSetValue(STZCacheRef cache, uint64_t key, void const *valueAddr) {
 }
 
 
+STZCacheHandle STZCacheGetHandle(STZCacheRef cache, void const *valueAddr) {
+    int i = STZCacheGetIndexOfValue(cache, valueAddr);
+    assert(i != -1);
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    return ((uint64_t)entry->generation << 32) | (uint32_t)(i + 1);
+}
+
+
+void *__nullable STZCacheGetValueForHandle(STZCacheRef cache, STZCacheHandle handle) {
+    advanceWheel(cache, CGEventTimestampNow());
+
+    int i = (int)(uint32_t)handle - 1;
+    if (i < 0 || i >= cache->count) {return NULL;}
+
+    _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
+    if (!entry || entry->generation == 0 || entry->generation != (uint32_t)(handle >> 32)) {return NULL;}
+
+    touchEntry(cache, i);
+    cache->recentIndex = i;
+    return &entry[1];
+}
+
+
+bool STZCacheRemoveValue(STZCacheRef cache, uint64_t key) {
+    int i = findEntry(cache, key);
+    if (i == -1) {return false;}
+
+    removeEntry(cache, i);
+    releaseEmptySlabs(cache);
+    return true;
+}
+
+
 void STZCacheRemoveAll(STZCacheRef cache) {
     for (int i = 0; i < cache->count; ++i) {
         _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
-        if (entry->accessedAt != 0) {
-            entry->accessedAt = 0;
+        if (entry && entry->tick != 0) {
+            entry->tick = 0;
             cache->valueDisposeCallback(&entry[1]);
         }
     }
+
+    for (int s = 0; s < kWheelSlotCount; ++s) {
+        cache->wheel[s] = -1;
+    }
+    for (int s = 0; s < cache->slabCount; ++s) {
+        if (cache->slabs[s]) {
+            cache->slabs[s]->liveCount = 0;
+        }
+    }
+
+    cache->liveCount = 0;
+    cache->recentIndex = -1;
+    releaseEmptySlabs(cache);
+
+    cache->freeIndex = -1;
+    for (int i = cache->count - 1; i >= 0; --i) {
+        pushFreeEntry(cache, i);
+    }
 }
 
 
-void STZCacheEnumerateValues(STZCacheRef cache, void (*valueEnumerateCallback)(void *valueAddr, void *context), void *context) {
-    CGEventTimestamp now = CGEventTimestampNow();
+CGEventTimestamp STZCacheGetExpiryInterval(STZCacheRef cache) {
+    return cache->tickDuration;
+}
+
+
+void STZCacheExpireValues(STZCacheRef cache, CGEventTimestamp now) {
+    advanceWheel(cache, now);
+}
 
+
+void STZCacheEnumerateValues(STZCacheRef cache, void (*valueEnumerateCallback)(void *valueAddr, void *context), void *context) {
     for (int i = 0; i < cache->count; ++i) {
         _STZCacheEntryStub *entry = STZCacheGetEntryAtIndex(cache, i);
-        if (entry->accessedAt == 0) {continue;}
-        if ((now - entry->accessedAt) >= cache->valueLifetime) {continue;}
+        if (!entry || entry->tick == 0) {continue;}
         valueEnumerateCallback(&entry[1], context);
     }
 }
@@ -277,14 +665,75 @@ static char const *commaMomentumPhaseName(CGMomentumScrollPhase phase) {
 }
 
 
+#if !STZ_HEADLESS
+//  Displays of unknown refresh rates, including some built-in panels, are taken as 60 Hz.
+static CGEventTimestamp const kFallbackFrameInterval = NSEC_PER_SEC / 60;
+
+#define kMaxDisplays 16
+
+static struct {
+    CGRect              bounds;
+    CGEventTimestamp    frameInterval;
+} displays[kMaxDisplays];
+
+static uint32_t displayCount = 0;
+
+
+static void loadDisplays(void) {
+    //  The main display comes first.
+    CGDirectDisplayID displayIDs[kMaxDisplays];
+    if (CGGetActiveDisplayList(kMaxDisplays, displayIDs, &displayCount) != kCGErrorSuccess) {
+        displayCount = 0;
+    }
+
+    for (uint32_t i = 0; i < displayCount; ++i) {
+        CGDisplayModeRef mode = CGDisplayCopyDisplayMode(displayIDs[i]);
+        double refreshRate = mode ? CGDisplayModeGetRefreshRate(mode) : 0;
+        if (mode) {CGDisplayModeRelease(mode);}
+
+        displays[i].bounds = CGDisplayBounds(displayIDs[i]);
+        displays[i].frameInterval = refreshRate > 0 ? (CGEventTimestamp)(NSEC_PER_SEC / refreshRate) : kFallbackFrameInterval;
+    }
+}
+
+
+//  Called on the main thread, as are the event taps, so the table is never read half-written.
+static void displayReconfigurationCallback(CGDirectDisplayID display, CGDisplayChangeSummaryFlags flags, void *userInfo) {
+    if (flags & kCGDisplayBeginConfigurationFlag) {return;}
+    loadDisplays();
+}
+
+
+void STZStartTrackingDisplays(void) {
+    static bool observing = false;
+    if (observing) {return;}
+    observing = true;
+
+    CGDisplayRegisterReconfigurationCallback(displayReconfigurationCallback, NULL);
+    loadDisplays();
+}
+
+
+CGEventTimestamp STZGetDisplayFrameIntervalAtPoint(CGPoint point) {
+    for (uint32_t i = 0; i < displayCount; ++i) {
+        if (CGRectContainsPoint(displays[i].bounds, point)) {
+            return displays[i].frameInterval;
+        }
+    }
+    return displayCount ? displays[0].frameInterval : kFallbackFrameInterval;
+}
+#endif
+
+
 void STZUnknownEnumCase(char const *type, int64_t value) {
     if (!STZIsLoggingEnabled()) {return;}
-    STZDebugLog("Unknown enum %s case %lld", type, value);
+    STZDebugLog("Unknown enum %s case %lld", type, (long long)value);
 }
 
 
+#if !STZ_HEADLESS
 void STZDebugLogEvent(char const *prefix, CGEventRef event) {
-    if (!STZIsLoggingEnabled()) {return;}
+    if (!STZIsLoggingEnabled() || !STZGetSettingsSnapshot()->logsScrollEvents) {return;}
 
     uint64_t senderID = CGEventGetRegistryID(event);
     CFStringRef flagDesc = STZFlagsCopyDescription(CGEventGetFlags(event) & kSTZPrintableModifiersMask);
@@ -359,3 +808,36 @@ void STZDebugLogEvent(char const *prefix, CGEventRef event) {
 
     CFRelease(spaceFlagDesc);
 }
+
+#else
+//  Without CoreFoundation strings, flags are logged in hexadecimal.
+void STZDebugLogEvent(char const *prefix, CGEventRef event) {
+    if (!STZIsLoggingEnabled() || !STZGetSettingsSnapshot()->logsScrollEvents) {return;}
+
+    unsigned long long senderID = CGEventGetRegistryID(event);
+    unsigned long long flags = CGEventGetFlags(event) & kSTZPrintableModifiersMask;
+    CGGesturePhase phase;
+
+    switch (CGEventGetType(event)) {
+    case kCGEventScrollWheel:
+        phase = (uint32_t)CGEventGetIntegerValueField(event, kCGScrollWheelEventScrollPhase);
+        CGMomentumScrollPhase mPhase = (uint32_t)CGEventGetIntegerValueField(event, kCGScrollWheelEventMomentumPhase);
+        STZDebugLog("%s scroll wheel [%llx] with %llx%s, by %lld or %0.1f px",
+                    prefix, senderID, flags, mPhase ? commaMomentumPhaseName(mPhase) : commaPhaseName(phase),
+                    (long long)CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1),
+                    CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1));
+        break;
+
+    case kCGEventGesture:
+        phase = (CGGesturePhase)CGEventGetIntegerValueField(event, kCGGestureEventPhase);
+        STZDebugLog("%s zoom gesture [%llx] with %llx%s, scaled to %0.02f%%",
+                    prefix, senderID, flags, commaPhaseName(phase),
+                    (1 + CGEventGetDoubleValueField(event, kCGGestureEventZoomValue)) * 100);
+        break;
+
+    default:
+        STZDebugLog("%s event %u [%llx] with %llx", prefix, (unsigned)CGEventGetType(event), senderID, flags);
+        break;
+    }
+}
+#endif
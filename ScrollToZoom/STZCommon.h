@@ -7,19 +7,19 @@
  */
 
 #pragma once
-#include <CoreGraphics/CGEvent.h>
+#include "STZBackend.h"
 
 CF_IMPLICIT_BRIDGING_ENABLED
 CF_ASSUME_NONNULL_BEGIN
 
 
+#if __clang__
 #define CLOSED_ENUM(ScalarType) enum __attribute__((enum_extensibility(closed))): ScalarType
 #define OPTION_FLAGS(ScalarType) enum __attribute__((flag_enum,enum_extensibility(open))): ScalarType
-
-
-static inline CGEventTimestamp CGEventTimestampNow(void) {
-    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW_APPROX);
-}
+#else
+#define CLOSED_ENUM(ScalarType) enum
+#define OPTION_FLAGS(ScalarType) enum
+#endif
 
 
 typedef OPTION_FLAGS(uint32_t) {
@@ -44,7 +44,9 @@ typedef OPTION_FLAGS(uint32_t) {
 
 
 STZFlags STZFlagsValidate(uint32_t dirtyFlags);
+#if !STZ_HEADLESS
 CFStringRef STZFlagsCopyDescription(uint32_t anyFlags);
+#endif
 
 
 typedef struct _STZCache *STZCacheRef;
@@ -52,16 +54,44 @@ typedef struct _STZCache *STZCacheRef;
 STZCacheRef STZCacheCreate(size_t valueSize, CGEventTimestamp valueLifetime, void (*__nullable valueDisposeCallback)(void *valueAddr));
 void STZCacheRelease(STZCacheRef);
 
-/// Returns the address of the value. The value is valid until a mutation happens to the cache.
+/// Returns the address of the value. Values are never moved; the address is valid until the value
+/// expires or the cache is emptied.
 void *__nullable STZCacheGetValue(STZCacheRef, uint64_t key);
 void *STZCacheSetValue(STZCacheRef, uint64_t key, void const *valueAddr);
 
 void *__nullable STZCacheGetRecentValue(STZCacheRef, uint64_t *__nullable outKey);
 
+/// A handle identifies a value across its lifetime. Resolving the handle of a value that has been
+/// removed returns NULL, even if its storage has been reused by another value.
+typedef uint64_t STZCacheHandle;
+
+STZCacheHandle STZCacheGetHandle(STZCacheRef, void const *valueAddr);
+void *__nullable STZCacheGetValueForHandle(STZCacheRef, STZCacheHandle);
+
+/// Disposes the value immediately. Returns false if there is no value for the key.
+bool STZCacheRemoveValue(STZCacheRef, uint64_t key);
 void STZCacheRemoveAll(STZCacheRef);
+
+/// Disposes values that have not been accessed for `valueLifetime`. Accesses by key or handle
+/// also expire values first, so a value then lives for at least its lifetime and at most one
+/// `STZCacheGetExpiryInterval` longer. Call this periodically so that values are disposed even
+/// when the cache isn’t accessed.
+void STZCacheExpireValues(STZCacheRef, CGEventTimestamp now);
+CGEventTimestamp STZCacheGetExpiryInterval(STZCacheRef);
+
 void STZCacheEnumerateValues(STZCacheRef, void (*valueEnumerateCallback)(void *valueAddr, void *__nullable context), void *__nullable context);
 
 
+/// Reads the displays into a table now and again whenever they are reconfigured. Must be called
+/// on the main thread, before the event taps are created.
+void STZStartTrackingDisplays(void);
+
+/// The refresh interval of the display containing the point, or of the main display if none
+/// does. Only looks up the table, so this is cheap enough for event taps; before displays are
+/// tracked, all are taken as 60 Hz.
+CGEventTimestamp STZGetDisplayFrameIntervalAtPoint(CGPoint point);
+
+
 bool STZIsLoggingEnabled(void);
 void STZDebugLog(char const *message, ...) CF_FORMAT_FUNCTION(1, 2);
 
@@ -20,6 +20,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)addLog:(NSString *)message;
 - (void)clearLogs:(nullable id)sender;
 - (void)toggleLoggingPaused:(nullable id)sender;
+- (void)toggleTraceRecording:(nullable id)sender;
 - (BOOL)isLoggingPaused;
 
 @end
@@ -8,6 +8,7 @@
 
 #import "STZConsolePanel.h"
 #import "STZControls.h"
+#import "STZTrace.h"
 #import "GeneratedAssetSymbols.h"
 
 
@@ -16,6 +17,7 @@
 NSString *const STZPanelTitleToolbarItemIdentifier = @"STZPanelTitleToolbarItem";
 NSString *const STZToggleLoggingToolbarItemIdentifier = @"STZToggleLoggingToolbarItem";
 NSString *const STZClearLogsToolbarItemIdentifier = @"STZClearLogsToolbarItem";
+NSString *const STZRecordTraceToolbarItemIdentifier = @"STZRecordTraceToolbarItem";
 
 
 BOOL STZConsoleSharedPanelExists = NO;
@@ -153,6 +155,7 @@ void STZDebugLog(char const *message, ...) {
     return @[STZPanelTitleToolbarItemIdentifier,
              STZToggleLoggingToolbarItemIdentifier,
              STZClearLogsToolbarItemIdentifier,
+             STZRecordTraceToolbarItemIdentifier,
              NSToolbarFlexibleSpaceItemIdentifier];
 }
 
@@ -161,7 +164,8 @@ void STZDebugLog(char const *message, ...) {
              STZPanelTitleToolbarItemIdentifier,
              NSToolbarFlexibleSpaceItemIdentifier,
              STZToggleLoggingToolbarItemIdentifier,
-             STZClearLogsToolbarItemIdentifier];
+             STZClearLogsToolbarItemIdentifier,
+             STZRecordTraceToolbarItemIdentifier];
 }
 
 - (NSToolbarItem *)toolbar:(NSToolbar *)toolbar itemForItemIdentifier:(NSToolbarItemIdentifier)itemIdentifier willBeInsertedIntoToolbar:(BOOL)flag {
@@ -203,6 +207,20 @@ void STZDebugLog(char const *message, ...) {
         return item;
     }
 
+    if ([itemIdentifier isEqualToString:STZRecordTraceToolbarItemIdentifier]) {
+        NSButton *button = [[NSButton alloc] init];
+        [button setBezelStyle:NSTexturedRoundedBezelStyle];
+        [button setTarget:self];
+        [button setAction:@selector(toggleTraceRecording:)];
+        [button setButtonType:NSButtonTypeToggle];
+        [self updateRecordButtonImage:button];
+        [button sizeToFit];
+
+        NSToolbarItem *item = [[NSToolbarItem alloc] initWithItemIdentifier:itemIdentifier];
+        [item setView:button];
+        return item;
+    }
+
     return nil;
 }
 
@@ -211,6 +229,12 @@ void STZDebugLog(char const *message, ...) {
     [button setImage:[NSImage imageNamed:_loggingEnabled ? ACImageNameStopLogging : ACImageNameStartLogging]];
 }
 
+- (void)updateRecordButtonImage:(NSButton *)button {
+    BOOL recording = STZTraceIsRecording();
+    [button setState:recording];
+    [button setImage:[NSImage imageNamed:recording ? NSImageNameTouchBarRecordStopTemplate : NSImageNameTouchBarRecordStartTemplate]];
+}
+
 - (void)addLog:(NSString *)message {
     if (!_loggingEnabled) {return;}
 
@@ -271,6 +295,28 @@ void STZDebugLog(char const *message, ...) {
     }
 }
 
+- (void)toggleTraceRecording:(id)sender {
+    NSButton *button = (NSButton *)sender;
+
+    if (STZTraceIsRecording()) {
+        STZTraceStopRecording();
+        [self updateRecordButtonImage:button];
+        return;
+    }
+
+    NSDateFormatter *formatter = [[NSDateFormatter alloc] init];
+    [formatter setDateFormat:@"yyyy-MM-dd HH.mm.ss"];
+
+    NSSavePanel *savePanel = [NSSavePanel savePanel];
+    [savePanel setNameFieldStringValue:[NSString stringWithFormat:@"ScrollToZoom %@.stztrace", [formatter stringFromDate:[NSDate date]]]];
+    [savePanel beginSheetModalForWindow:self completionHandler:^(NSModalResponse result) {
+        if (result == NSModalResponseOK) {
+            STZTraceStartRecording([[[savePanel URL] path] fileSystemRepresentation]);
+        }
+        [self updateRecordButtonImage:button];
+    }];
+}
+
 - (BOOL)isLoggingPaused {
     return !_loggingEnabled;
 }
@@ -0,0 +1,65 @@
+/*
+ *  STZDefaultAppOptions.h
+ *  ScrollToZoom
+ *
+ *  Generated by Scripts/generate-default-app-options.py from STZDefaultAppOptions.list.
+ *  Do not edit.
+ */
+
+#pragma once
+#include "STZSettings.h"
+
+
+#define kSTZDefaultAppOptionsCount 2
+#define kSTZDefaultAppPrefixRuleCount 7
+
+static uint16_t const STZDefaultAppOptionsSeeds[1] = {
+        1,
+};
+
+static struct {
+    char const     *bundleID;
+    uint8_t         length;
+    STZAppOptions   options;
+} const STZDefaultAppOptionsSlots[4] = {
+    [0] = {"ai.perplexity.comet", 19, kSTZFixesZoomForChromiumApp},
+    [3] = {"org.mozilla.firefox", 19, kSTZFlagsExcludedForApp},
+};
+
+/// Rules ending with `*`, which is counted in the length.
+static struct {
+    char const     *rule;
+    uint8_t         length;
+    STZAppOptions   options;
+} const STZDefaultAppPrefixRules[7] = {
+    {"com.brave.Browser*", 18, kSTZFixesZoomForChromiumApp},
+    {"com.google.Chrome*", 18, kSTZFixesZoomForChromiumApp},
+    {"com.microsoft.edgemac*", 22, kSTZFixesZoomForChromiumApp},
+    {"com.operasoftware.Opera*", 24, kSTZFixesZoomForChromiumApp},
+    {"com.vivaldi.Vivaldi*", 20, kSTZFixesZoomForChromiumApp},
+    {"company.thebrowser.*", 20, kSTZFixesZoomForChromiumApp},
+    {"org.chromium.*", 14, kSTZFixesZoomForChromiumApp},
+};
+
+
+static inline uint32_t STZDefaultAppOptionsHash(char const *bytes, size_t length, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B1u);
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (uint8_t)bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+
+/// Looks up exact entries only. Returns false if the bundle ID is not listed.
+static inline bool STZGetDefaultAppOptions(char const *bundleID, size_t length, STZAppOptions *outOptions) {
+    uint32_t bucket = STZDefaultAppOptionsHash(bundleID, length, 0) & 0;
+    uint32_t seed = STZDefaultAppOptionsSeeds[bucket];
+    uint32_t i = STZDefaultAppOptionsHash(bundleID, length, seed) & 3;
+
+    if (!STZDefaultAppOptionsSlots[i].bundleID) {return false;}
+    if (STZDefaultAppOptionsSlots[i].length != length) {return false;}
+    if (memcmp(STZDefaultAppOptionsSlots[i].bundleID, bundleID, length) != 0) {return false;}
+    *outOptions = STZDefaultAppOptionsSlots[i].options;
+    return true;
+}
@@ -0,0 +1,137 @@
+/*
+ *  STZDeviceRegistry.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZDeviceRegistry.h"
+#include <IOKit/IOKitLib.h>
+
+
+#define MAX_OBSERVERS 4
+
+typedef struct {
+    STZDeviceCallback   callback;
+    void               *refcon;
+} Observer;
+
+static Observer observers[MAX_OBSERVERS];
+static int observerCount = 0;
+
+
+//  Scroll events are sent by HID event services, while Magic Mouse taps are keyed by the
+//  multitouch device. A device may match both classes; observers should tolerate duplicates.
+static char const *const serviceClasses[] = {"IOHIDEventService", "AppleMultitouchDevice"};
+#define SERVICE_CLASS_COUNT (sizeof(serviceClasses) / sizeof(*serviceClasses))
+
+static IONotificationPortRef notificationPort = NULL;
+static io_iterator_t iterators[SERVICE_CLASS_COUNT * 2];
+
+
+static void drainIterator(io_iterator_t iterator, bool attached, bool broadcasts) {
+    io_object_t item;
+    while ((item = IOIteratorNext(iterator))) {
+        uint64_t registryID = 0;
+        IORegistryEntryGetRegistryEntryID(item, &registryID);
+        IOObjectRelease(item);
+
+        if (!broadcasts || registryID == 0) {continue;}
+        for (int i = 0; i < observerCount; ++i) {
+            observers[i].callback(registryID, attached, observers[i].refcon);
+        }
+    }
+}
+
+
+static void anyDeviceAttached(void *refcon, io_iterator_t iterator) {
+    drainIterator(iterator, true, true);
+}
+
+
+static void anyDeviceDetached(void *refcon, io_iterator_t iterator) {
+    drainIterator(iterator, false, true);
+}
+
+
+static void stopListening(void) {
+    if (!notificationPort) {return;}
+
+    CFRunLoopSourceRef source = IONotificationPortGetRunLoopSource(notificationPort);
+    CFRunLoopRemoveSource(CFRunLoopGetMain(), source, kCFRunLoopCommonModes);
+
+    for (size_t i = 0; i < SERVICE_CLASS_COUNT * 2; ++i) {
+        if (iterators[i]) {
+            IOObjectRelease(iterators[i]);
+            iterators[i] = 0;
+        }
+    }
+
+    IONotificationPortDestroy(notificationPort);
+    notificationPort = NULL;
+}
+
+
+static bool startListening(void) {
+    if (notificationPort) {return true;}
+
+    if (__builtin_available(macOS 12.0, *)) {
+        notificationPort = IONotificationPortCreate(kIOMainPortDefault);
+    } else {
+        notificationPort = IONotificationPortCreate(kIOMasterPortDefault);
+    }
+    if (!notificationPort) {return false;}
+
+    for (size_t i = 0; i < SERVICE_CLASS_COUNT; ++i) {
+        io_iterator_t *attachedIterator = &iterators[i * 2];
+        io_iterator_t *detachedIterator = &iterators[i * 2 + 1];
+
+        if (IOServiceAddMatchingNotification(notificationPort, kIOFirstMatchNotification,
+                                             IOServiceMatching(serviceClasses[i]) /* consumed */,
+                                             anyDeviceAttached, NULL, attachedIterator) != KERN_SUCCESS
+         || IOServiceAddMatchingNotification(notificationPort, kIOTerminatedNotification,
+                                             IOServiceMatching(serviceClasses[i]) /* consumed */,
+                                             anyDeviceDetached, NULL, detachedIterator) != KERN_SUCCESS) {
+            stopListening();
+            return false;
+        }
+
+        //  Iterators must be drained to arm the notifications. Devices already present are not news.
+        drainIterator(*attachedIterator, true, false);
+        drainIterator(*detachedIterator, false, false);
+    }
+
+    CFRunLoopSourceRef source = IONotificationPortGetRunLoopSource(notificationPort);
+    CFRunLoopAddSource(CFRunLoopGetMain(), source, kCFRunLoopCommonModes);
+    return true;
+}
+
+
+bool STZDeviceRegistryAddObserver(STZDeviceCallback callback, void *refcon) {
+    for (int i = 0; i < observerCount; ++i) {
+        if (observers[i].callback == callback && observers[i].refcon == refcon) {return true;}
+    }
+
+    if (observerCount == MAX_OBSERVERS) {return false;}
+    if (!startListening()) {return false;}
+
+    observers[observerCount] = (Observer){callback, refcon};
+    observerCount += 1;
+    return true;
+}
+
+
+void STZDeviceRegistryRemoveObserver(STZDeviceCallback callback, void *refcon) {
+    for (int i = 0; i < observerCount; ++i) {
+        if (observers[i].callback == callback && observers[i].refcon == refcon) {
+            observerCount -= 1;
+            observers[i] = observers[observerCount];
+            break;
+        }
+    }
+
+    if (observerCount == 0) {
+        stopListening();
+    }
+}
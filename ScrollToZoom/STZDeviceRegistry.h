@@ -0,0 +1,25 @@
+/*
+ *  STZDeviceRegistry.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+/// Called on the main thread when an input device is attached or detached. The registry ID is
+/// the same as `CGEventGetRegistryID` of events sent by the device.
+typedef void (*STZDeviceCallback)(uint64_t registryID, bool attached, void *__nullable refcon);
+
+/// The registry listens to the I/O Registry only while there are observers. Devices present when
+/// the first observer is added are not reported.
+bool STZDeviceRegistryAddObserver(STZDeviceCallback callback, void *__nullable refcon);
+void STZDeviceRegistryRemoveObserver(STZDeviceCallback callback, void *__nullable refcon);
+
+
+CF_ASSUME_NONNULL_END
@@ -0,0 +1,144 @@
+/*
+ *  STZEpoch.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZEpoch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+
+//  Each reading thread owns a record in a list that only grows. A record is given back when its
+//  thread exits and reused by the next thread that reads; there are only a few such threads.
+
+typedef struct Reader {
+    _Atomic(uint64_t)   epoch;  ///< 0 while the thread holds nothing.
+    _Atomic(bool)       inUse;
+    struct Reader      *next;
+} Reader;
+
+static _Atomic(Reader *) readers = NULL;
+static _Atomic(uint64_t) globalEpoch = 1;
+
+static _Thread_local Reader *threadReader = NULL;
+static _Thread_local int threadReadingDepth = 0;
+
+static pthread_once_t readerKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t readerKey;
+
+
+static void giveBackReader(void *reader) {
+    atomic_store_explicit(&((Reader *)reader)->epoch, 0, memory_order_release);
+    atomic_store_explicit(&((Reader *)reader)->inUse, false, memory_order_release);
+}
+
+
+static void createReaderKey(void) {
+    pthread_key_create(&readerKey, giveBackReader);
+}
+
+
+static Reader *getThreadReader(void) {
+    if (threadReader) {return threadReader;}
+
+    Reader *reader = atomic_load_explicit(&readers, memory_order_acquire);
+    for (; reader; reader = reader->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&reader->inUse, &expected, true)) {break;}
+    }
+
+    if (!reader) {
+        reader = malloc(sizeof(Reader));
+        atomic_init(&reader->epoch, 0);
+        atomic_init(&reader->inUse, true);
+        reader->next = atomic_load_explicit(&readers, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&readers, &reader->next, reader,
+                                                      memory_order_release, memory_order_relaxed)) {}
+    }
+
+    pthread_once(&readerKeyOnce, createReaderKey);
+    pthread_setspecific(readerKey, reader);
+    threadReader = reader;
+    return reader;
+}
+
+
+void STZEpochBeginReading(void) {
+    threadReadingDepth += 1;
+}
+
+
+void STZEpochEndReading(void) {
+    assert(threadReadingDepth > 0);
+    threadReadingDepth -= 1;
+    if (threadReadingDepth == 0 && threadReader) {
+        atomic_store_explicit(&threadReader->epoch, 0, memory_order_release);
+    }
+}
+
+
+void STZEpochPin(void) {
+    Reader *reader = getThreadReader();
+    if (atomic_load_explicit(&reader->epoch, memory_order_relaxed)) {return;}
+
+    //  The writer replaces an object before it advances the epoch, then looks for pinned readers.
+    //  Either it sees this pin, or the loads after the fence see the replacement.
+    atomic_store_explicit(&reader->epoch, atomic_load(&globalEpoch), memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+
+//  MARK: - Retiring
+
+
+typedef struct {
+    void       *object;
+    void      (*release)(void *);
+    uint64_t    epoch;
+} Retired;
+
+static Retired *retired = NULL;
+static size_t retiredCount = 0;
+static size_t retiredCapacity = 0;
+
+
+void STZEpochRetire(void *object, void (*release)(void *)) {
+    if (retiredCount == retiredCapacity) {
+        retiredCapacity = retiredCapacity ? retiredCapacity * 2 : 8;
+        retired = realloc(retired, sizeof(Retired) * retiredCapacity);
+    }
+
+    atomic_thread_fence(memory_order_seq_cst);
+    retired[retiredCount++] = (Retired){object, release, atomic_fetch_add(&globalEpoch, 1)};
+    STZEpochReclaim();
+}
+
+
+size_t STZEpochReclaim(void) {
+    if (!retiredCount) {return 0;}
+
+    atomic_thread_fence(memory_order_seq_cst);
+    uint64_t oldestPinned = UINT64_MAX;
+    for (Reader *reader = atomic_load_explicit(&readers, memory_order_acquire); reader; reader = reader->next) {
+        uint64_t epoch = atomic_load_explicit(&reader->epoch, memory_order_acquire);
+        if (epoch && epoch < oldestPinned) {
+            oldestPinned = epoch;
+        }
+    }
+
+    //  A reader pinned at the epoch an object was retired in, or earlier, may have loaded it.
+    size_t kept = 0;
+    for (size_t i = 0; i < retiredCount; ++i) {
+        if (retired[i].epoch < oldestPinned) {
+            retired[i].release(retired[i].object);
+        } else {
+            retired[kept++] = retired[i];
+        }
+    }
+
+    retiredCount = kept;
+    return kept;
+}
@@ -0,0 +1,42 @@
+/*
+ *  STZEpoch.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Epoch-based reclamation of objects that readers on any thread load from an atomic pointer,
+//  such as the settings snapshot, and that a single writer replaces.
+//
+//  A reader pins the current epoch before loading, and stays pinned until it leaves its outermost
+//  reading stretch; a retired object is tagged with the epoch it was replaced in, and freed once
+//  every pinned reader has pinned a later epoch. Readers never wait and never free; the writer
+//  frees what it can whenever it retires another object.
+
+/// Brackets a stretch in which the thread may hold objects it loads, such as an event tap
+/// callback. Stretches may nest.
+void STZEpochBeginReading(void);
+void STZEpochEndReading(void);
+
+/// Must be called before loading an object, and is cheap if the thread is already pinned.
+/// Outside of any stretch, the thread stays pinned until it next leaves one; a thread that
+/// never does holds back every object retired from then on.
+void STZEpochPin(void);
+
+/// Calls `release` with the object once no reader may hold it, either now or in a later call.
+/// The object must no longer be reachable by new loads. Calls must be serialized.
+void STZEpochRetire(void *object, void (*release)(void *object));
+
+/// Releases what no reader may hold any more, and returns the number of objects still waiting.
+/// Must be serialized with `STZEpochRetire`.
+size_t STZEpochReclaim(void);
+
+
+CF_ASSUME_NONNULL_END
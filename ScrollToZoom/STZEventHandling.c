@@ -12,6 +12,11 @@
 #include "STZMagicZoom.h"
 #include "STZStateManager.h"
 #include "STZProcessManager.h"
+#include "STZDeviceRegistry.h"
+#include "STZEpoch.h"
+#include "STZTrace.h"
+#include "STZTapList.h"
+#include "STZWheelTaps.h"
 
 
 // The order of event taps reported by `CGGetEventTapList` is not documented.
@@ -21,80 +26,86 @@
 static bool newEventTapsPrependsToList = false;
 
 
-static bool isForeignEventTapIrrelevantToWheel(CGEventTapInformation const *info) {
-    if (!(info->eventsOfInterest & (1 << kCGEventScrollWheel))) {return true;}
-    if (info->options & kCGEventTapOptionListenOnly) {return true;}
-    return false;
-}
+static uint32_t copyEventTapList(STZTapInfo *infos, uint32_t capacity, void *refcon) {
+    static CGEventTapInformation *buffer = NULL;
+    static uint32_t bufferCapacity = 0;
+    if (bufferCapacity < capacity) {
+        buffer = realloc(buffer, sizeof(CGEventTapInformation) * capacity);
+        bufferCapacity = capacity;
+    }
 
+    uint32_t count = 0;
+    if (CGGetEventTapList(capacity, buffer, &count) != kCGErrorSuccess) {return 0;}
 
-static bool isSystemProcess(pid_t pid) {
-    CFStringRef bundleID = STZGetBundleIdentifierForProcessID(pid);
-    return !bundleID || CFStringHasPrefix(bundleID, CFSTR("com.apple."));
+    for (uint32_t i = 0; i < count; ++i) {
+        infos[i] = (STZTapInfo){
+            .tapID = buffer[i].eventTapID,
+            .tapPoint = buffer[i].tapPoint,
+            .tappingProcess = buffer[i].tappingProcess,
+            .listensOnly = (buffer[i].options & kCGEventTapOptionListenOnly) != 0,
+            .tapsScrollWheel = (buffer[i].eventsOfInterest & (1 << kCGEventScrollWheel)) != 0,
+        };
+    }
+
+    //  A full buffer may have cut the list short; only then ask for the total.
+    if (count == capacity) {
+        uint32_t total = count;
+        CGGetEventTapList(0, NULL, &total);
+        return total > count ? total : count;
+    }
+    return count;
 }
 
 
-static bool isWheelUnderDictatorship(void) {
-    uint32_t count;
-    CGGetEventTapList(0, NULL, &count);
+static STZTapProcessKind classifyTappingProcess(int32_t pid, void *refcon) {
+    //  A process without a bundle identifier is a system one, as before lookups were
+    //  asynchronous; one still being looked up is asked again by the next refresh.
+    STZAppID appID = STZGetAppIDForProcessID(pid);
+    if (appID == kSTZNoAppID) {
+        return STZIsResolvingProcessID(pid) ? kSTZTapProcessUnresolved : kSTZTapProcessSystem;
+    }
+    return STZAppRegistryIsSystemApp(appID) ? kSTZTapProcessSystem : kSTZTapProcessForeign;
+}
 
-    CGEventTapInformation *infos = malloc(sizeof(CGEventTapInformation) * count);
-    CGGetEventTapList(count, infos, &count);
 
-    if (STZIsLoggingEnabled()) {
-        for (uint32_t i = 0; i < count; ++i) {
-            if (isForeignEventTapIrrelevantToWheel(&infos[i])) {continue;}
+static STZTapListRef eventTapList = NULL;
 
-            char const *locName = "";
-            switch (infos[i].tapPoint) {
-            case kCGHIDEventTap: locName = "HID"; break;
-            case kCGSessionEventTap: locName = "session"; break;
-            case kCGAnnotatedSessionEventTap: locName = "annotated session"; break;
-            default: locName = "unknown"; break;
-            }
-            CFStringRef bundleID = STZGetBundleIdentifierForProcessID(infos[i].tappingProcess);
-            STZDebugLog("\ttap [%u] from %@ at %s", infos[i].eventTapID, bundleID, locName);
-        }
+static STZTapListRef refreshEventTapList(void) {
+    if (!eventTapList) {
+        eventTapList = STZTapListCreate(getpid(), copyEventTapList, classifyTappingProcess, NULL);
     }
 
-    pid_t selfPID = getpid();
+    if (!STZTapListRefresh(eventTapList) || !STZIsLoggingEnabled()) {return eventTapList;}
 
+    uint32_t count;
+    STZTapInfo const *infos = STZTapListGetInfos(eventTapList, &count);
     for (uint32_t i = 0; i < count; ++i) {
-        if (isForeignEventTapIrrelevantToWheel(&infos[i])) {continue;}
-
-        if (newEventTapsPrependsToList) {
-            if (infos[i].tappingProcess == selfPID) {
-                free(infos);
-                return true;
-            } else if (!isSystemProcess(infos[i].tappingProcess)) {
-                free(infos);
-                return false;
-            }
-
-        } else {
-            if (infos[i].tappingProcess != selfPID && !isSystemProcess(infos[i].tappingProcess)) {
-                free(infos);
-                return false;
-            }
+        if (!infos[i].tapsScrollWheel || infos[i].listensOnly) {continue;}
+
+        char const *locName = "";
+        switch (infos[i].tapPoint) {
+        case kCGHIDEventTap: locName = "HID"; break;
+        case kCGSessionEventTap: locName = "session"; break;
+        case kCGAnnotatedSessionEventTap: locName = "annotated session"; break;
+        default: locName = "unknown"; break;
         }
+        char const *bundleID = STZAppRegistryGetBundleIdentifier(STZGetAppIDForProcessID(infos[i].tappingProcess), NULL);
+        STZDebugLog("\ttap [%u] from %s at %s", infos[i].tapID, bundleID ?: "(null)", locName);
     }
+    return eventTapList;
+}
 
-    free(infos);
-    return false;
+
+static bool isWheelUnderDictatorship(void) {
+    return STZTapListIsWheelUnderDictatorship(refreshEventTapList(), newEventTapsPrependsToList);
 }
 
 
 static void checkNewSoftWheelTapPrepended(void) {
-    newEventTapsPrependsToList = false;
-
     uint32_t count;
-    CGGetEventTapList(0, NULL, &count);
-    if (count <= 1) {return;}
+    STZTapInfo const *infos = STZTapListGetInfos(refreshEventTapList(), &count);
 
-    CGEventTapInformation *infos = malloc(sizeof(CGEventTapInformation) * count);
-    CGGetEventTapList(count, infos, &count);
-
-    if (infos[0].tappingProcess == getpid()) {
+    if (count > 1 && infos[0].tappingProcess == getpid()) {
         newEventTapsPrependsToList = infos[0].tapPoint != kCGHIDEventTap;
     } else {
         newEventTapsPrependsToList = false;
@@ -105,8 +116,6 @@ static void checkNewSoftWheelTapPrepended(void) {
     } else {
         STZDebugLog("\tcannot determine where new event taps are inserted into the system list");
     }
-    free(infos);
-    return;
 }
 
 
@@ -129,11 +138,14 @@ static void releaseEventTap(STZEventTap *tap) {
 }
 
 
-static bool createEventTap(STZEventTap *tap, CGEventTapCallBack callback, CGEventMask events, CGEventTapOptions options, CGEventTapLocation location) {
+static CGEventRef timedTapCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon);
+
+
+static bool createEventTap(STZEventTap *tap, STZTapCallback callback, CGEventMask events, CGEventTapOptions options, CGEventTapLocation location) {
     assert(!tap->port && !tap->source);
     tap->port = CGEventTapCreate(location,
                                  location == kCGHIDEventTap ? kCGHeadInsertEventTap : kCGTailAppendEventTap,
-                                 options, events, callback, NULL);
+                                 options, events, timedTapCallback, (void *)(uintptr_t)callback);
     if (!tap->port) {return false;}
 
     tap->source = CFMachPortCreateRunLoopSource(kCFAllocatorDefault, tap->port, 0);
@@ -148,20 +160,8 @@ static CGEventRef hardWheelTapCallback(CGEventTapProxy proxy, CGEventType type,
 static CGEventRef passiveSoftWheelTapCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon);
 static CGEventRef mutableSoftWheelTapCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon);
 static void periodicUpdateCallback(CFRunLoopTimerRef timer, void *refcon);
-
-
-typedef struct {
-    STZStateRef     state;
-    STZAppOptions   appOptions;
-    uint64_t        hardScrollDir;
-    bool            magicZoomPending;
-} WheelContext;
-
-static void wheelContextDispose(void *context) {
-    STZStateRelease(((WheelContext *)context)->state);
-}
-
-static STZCacheRef wheelContexts = NULL;
+static void expiryTimerCallback(CFRunLoopTimerRef timer, void *refcon);
+static void anyDeviceAttachedOrDetached(uint64_t registryID, bool attached, void *refcon);
 
 
 static STZEventTap flagsTap = {NULL, NULL};
@@ -174,36 +174,152 @@ static STZEventTap mutableSoftWheelTap = {NULL, NULL};
 static bool stabWantsDictatorship = false;
 static bool continuesTriggeredZoom = false;
 static bool magicZooms = false;
-static bool wheelTapsMutable = false;
-static bool triggerFlagsDown = false;
+static STZWheelTapsRef wheelTaps = NULL;
 static CFRunLoopTimerRef periodicTimer = NULL;
+static CFAbsoluteTime const kFarFutureFireDate = 1e10;
+static CFTimeInterval const kTapListSettleInterval = 0.25;
+static CFRunLoopTimerRef expiryTimer = NULL;
 
 
 static bool needsReinsertTaps = false;
+static CFRunLoopTimerRef tapListSettleTimer = NULL;
+
+//  The system disables a tap whose callback keeps an event waiting for about a second. Past
+//  this budget, work that can wait runs after the callback returns instead.
+static CGEventTimestamp const kTapCallbackBudget = NSEC_PER_SEC / 4;
+static STZWatchdogRef tapWatchdog = NULL;
+static CFRunLoopSourceRef deferredWorkSource = NULL;
+
+static void runDeferredWork(void *info) {
+    STZWatchdogRunDeferredWork(tapWatchdog);
+}
+
+static void deferWork(STZDeferredWork work, void *info, void *object) {
+    if (STZWatchdogDefer(tapWatchdog, work, info, object)) {
+        CFRunLoopSourceSignal(deferredWorkSource);
+        CFRunLoopWakeUp(CFRunLoopGetMain());
+    }
+}
+
+/// Always false outside tap callbacks.
+static bool shouldDeferOptionalWork(void) {
+    return STZWatchdogShouldDefer(tapWatchdog, CGEventTimestampNow());
+}
+
+static void logDeferredMessage(void *message, void *object) {
+    STZDebugLog("%s", (char const *)message);
+}
+
+static void logDeferredEvent(void *prefix, void *event) {
+    STZDebugLogEvent(prefix, event);
+    CFRelease(event);
+}
+
+/// Once a callback starts deferring, its later logs must be deferred too to stay in order.
+static void logMessage(char const *message) {
+    if (!STZIsLoggingEnabled()) {return;}
+    if (shouldDeferOptionalWork()) {
+        deferWork(logDeferredMessage, (void *)message, NULL);
+    } else {
+        STZDebugLog("%s", message);
+    }
+}
+
+/// The event is copied if the log is deferred, since the callback goes on to change it.
+static void logEvent(char const *prefix, CGEventRef event) {
+    if (!STZIsLoggingEnabled() || !STZGetSettingsSnapshot()->logsScrollEvents) {return;}
+    if (shouldDeferOptionalWork()) {
+        deferWork(logDeferredEvent, (void *)prefix, CGEventCreateCopy(event));
+    } else {
+        STZDebugLogEvent(prefix, event);
+    }
+}
+
+static void eventTapListDidSettle(CFRunLoopTimerRef timer, void *refcon) {
+    //  Taps are only reinserted when the user starts to zoom, so that two apps wanting to come
+    //  first don’t take turns forever. Read the list now so that the check then finds it known.
+    if (passiveHardWheelTap.port == NULL || !needsReinsertTaps) {return;}
+    STZDebugLog("Event tap list changed");
+    refreshEventTapList();
+}
+
 static void anyEventTapAddedOrRemoved(CFNotificationCenterRef center, void *observer,
                                       CFNotificationName name, const void *object,
                                       CFDictionaryRef userInfo) {
-    STZDebugLog("Foreign event tap added or removed");
     needsReinsertTaps = true;
+
+    //  An app usually creates several taps in a row; read the list once they have settled.
+    if (!tapListSettleTimer) {
+        tapListSettleTimer = CFRunLoopTimerCreate(kCFAllocatorDefault, kFarFutureFireDate, kFarFutureFireDate, 0, 0, eventTapListDidSettle, NULL);
+        CFRunLoopAddTimer(CFRunLoopGetMain(), tapListSettleTimer, kCFRunLoopCommonModes);
+    }
+    CFRunLoopTimerSetNextFireDate(tapListSettleTimer, CFAbsoluteTimeGetCurrent() + kTapListSettleInterval);
 }
 
-static WheelContext *wheelContextWithFallback(uint64_t registryID) {
-    WheelContext *context;
-    if (registryID != 0) {
-        context = STZCacheGetValue(wheelContexts, registryID);
-    } else {
-        context = STZCacheGetRecentValue(wheelContexts, &registryID);
+//  The proxy of the tap callback in progress, for posting events where the tap is.
+static CGEventTapProxy currentTapProxy = NULL;
+
+static void emitWheelEvent(STZWheelEmission emission, STZWheelDelivery delivery, CGEventRef event,
+                           uint64_t registryID, void *refcon) {
+    static char const *const prefixes[] = {
+        [kSTZWheelUpdated] = "\tupdated to",
+        [kSTZWheelDiscarded] = NULL,
+        [kSTZWheelPrepended] = "\tpreempted by",
+        [kSTZWheelAppended] = "\tfollowed by",
+        [kSTZWheelReplacing] = "\treplaced by",
+        [kSTZWheelPeriodic] = "\tperiodic",
+        [kSTZWheelReverting] = "\tfollowed by",
+        [kSTZWheelCommandKey] = NULL,
+    };
+
+    if (emission == kSTZWheelDiscarded) {
+        logMessage("\tdiscarded");
+    } else if (prefixes[emission]) {
+        logEvent(prefixes[emission], event);
     }
 
-    if (context != NULL) {return context;}
+    switch (delivery) {
+    case kSTZWheelNotPosted:
+        break;
+    case kSTZWheelPostedAtTap:
+        assert(currentTapProxy);
+        CGEventTapPostEvent(currentTapProxy, event);
+        break;
+    case kSTZWheelPostedToSession:
+        CGEventPost(kCGSessionEventTap, event);
+        break;
+    }
+}
 
-    WheelContext ctx_ = {
-        .state = STZStateCreate(),
-        .appOptions = 0,
-        .hardScrollDir = 0,
-        .magicZoomPending = false,
-    };
-    return STZCacheSetValue(wheelContexts, registryID, &ctx_);
+static void setWheelTapsMutable(bool tapsMutable, void *refcon) {
+    CGEventTapEnable(mutableSoftWheelTap.port, tapsMutable);
+    if (passiveSoftWheelTap.port) {
+        CGEventTapEnable(passiveSoftWheelTap.port, !tapsMutable);
+    }
+    if (passiveHardWheelTap.port) {
+        CGEventTapEnable(mutableHardWheelTap.port, tapsMutable);
+        CGEventTapEnable(passiveHardWheelTap.port, !tapsMutable);
+    }
+    if (tapsMutable) {
+        logMessage("\tswitched to mutating scroll wheel taps");
+    }
+}
+
+static void movePeriodicTimer(CGEventTimestamp deadline, CGEventTimestamp now, void *refcon) {
+    if (!periodicTimer) {return;}
+
+    //  Deadlines are on the clock of events; the run loop only takes absolute time, which may
+    //  jump. Convert at the last moment so that only the delay is subject to the jump.
+    CFAbsoluteTime fireDate = kFarFutureFireDate;
+    if (deadline != 0) {
+        CGEventTimestamp delay = deadline > now ? deadline - now : 0;
+        fireDate = CFAbsoluteTimeGetCurrent() + (double)delay / NSEC_PER_SEC;
+    }
+    CFRunLoopTimerSetNextFireDate(periodicTimer, fireDate);
+}
+
+static STZAppOptions getAppOptionsForProcess(STZSettingsSnapshot const *settings, int32_t pid, void *refcon) {
+    return STZSettingsSnapshotGetAppOptions(settings, STZGetAppIDForProcessID(pid));
 }
 
 
@@ -232,6 +348,24 @@ STZModes STZGetWorkingModes(void) {
 bool STZSetWorkingModes(STZModes modes) {
     continuesTriggeredZoom = (modes & kSTZRevertsToScrollImmediately) == 0;
 
+    if (!tapWatchdog) {
+        //  Kept for the whole run so that timings add up across working mode changes.
+        tapWatchdog = STZWatchdogCreate(kTapCallbackBudget, kSTZTapCallbackCount);
+        CFRunLoopSourceContext context = {.perform = runDeferredWork};
+        deferredWorkSource = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &context);
+        CFRunLoopAddSource(CFRunLoopGetMain(), deferredWorkSource, kCFRunLoopCommonModes);
+    }
+
+    if (!wheelTaps) {
+        STZWheelTapsHooks hooks = {
+            .emit = emitWheelEvent,
+            .setTapsMutable = setWheelTapsMutable,
+            .moveTimer = movePeriodicTimer,
+            .getAppOptions = getAppOptionsForProcess,
+        };
+        wheelTaps = STZWheelTapsCreate(&hooks, NULL);
+    }
+
     if (!(modes & kSTZPracticalModesMask)) {goto RESET;}
     if (!AXIsProcessTrusted()) {goto RESET;}
 
@@ -254,12 +388,12 @@ bool STZSetWorkingModes(STZModes modes) {
                                                tapAddedOrRemovedObserver,
                                                CFSTR(kCGNotifyEventTapAdded), NULL);
         } else {
-            if (!createEventTap(&passiveHardWheelTap, hardWheelTapCallback,
+            if (!createEventTap(&passiveHardWheelTap, kSTZHardWheelTapCallback,
                                 1 << kCGEventScrollWheel,
                                 kCGEventTapOptionListenOnly, kCGHIDEventTap)) {
                 goto RESET;
             }
-            if (!createEventTap(&mutableHardWheelTap, hardWheelTapCallback,
+            if (!createEventTap(&mutableHardWheelTap, kSTZHardWheelTapCallback,
                                 1 << kCGEventScrollWheel,
                                 kCGEventTapOptionDefault, kCGHIDEventTap)) {
                 goto RESET;
@@ -275,9 +409,9 @@ bool STZSetWorkingModes(STZModes modes) {
     if (!flagsTap.port != !(modes & kSTZTriggerFlagsEnabled)) {
         if (flagsTap.port) {
             releaseEventTap(&flagsTap);
-            triggerFlagsDown = false;
+            STZWheelTapsForgetTriggerFlags(wheelTaps);
         } else {
-            if (!createEventTap(&flagsTap, flagsTapCallback,
+            if (!createEventTap(&flagsTap, kSTZFlagsTapCallback,
                                 (1 << kCGEventFlagsChanged) | (1 << kCGEventOtherMouseDown) | (1 << kCGEventOtherMouseUp),
                                 kCGEventTapOptionListenOnly, kCGHIDEventTap)) {
                 goto RESET;
@@ -292,7 +426,7 @@ bool STZSetWorkingModes(STZModes modes) {
         if (passiveSoftWheelTap.port) {
             releaseEventTap(&passiveSoftWheelTap);
         } else {
-            if (!createEventTap(&passiveSoftWheelTap, passiveSoftWheelTapCallback,
+            if (!createEventTap(&passiveSoftWheelTap, kSTZPassiveSoftWheelTapCallback,
                                 1 << kCGEventScrollWheel,
                                 kCGEventTapOptionListenOnly, softTapLocation)) {
                 goto RESET;
@@ -305,7 +439,7 @@ bool STZSetWorkingModes(STZModes modes) {
         if (mutableSoftWheelTap.port) {
             releaseEventTap(&mutableSoftWheelTap);
         } else {
-            if (!createEventTap(&mutableSoftWheelTap, mutableSoftWheelTapCallback,
+            if (!createEventTap(&mutableSoftWheelTap, kSTZMutableSoftWheelTapCallback,
                                 1 << kCGEventScrollWheel,
                                 kCGEventTapOptionDefault, softTapLocation)) {
                 goto RESET;
@@ -329,8 +463,9 @@ bool STZSetWorkingModes(STZModes modes) {
         }
     }
 
+    bool wheelTapsMutable = STZWheelTapsAreMutable(wheelTaps);
     if (!mutableSoftWheelTap.port) {
-        wheelTapsMutable = false;
+        STZWheelTapsReset(wheelTaps);
 
     } else {
         CGEventTapEnable(mutableSoftWheelTap.port, wheelTapsMutable);
@@ -349,10 +484,30 @@ bool STZSetWorkingModes(STZModes modes) {
         CGEventTapEnable(passiveHardWheelTap.port, !wheelTapsMutable);
     }
 
-    if (!wheelContexts) {
-        wheelContexts = STZCacheCreate(sizeof(WheelContext), 300 * NSEC_PER_SEC, wheelContextDispose);
+    STZWheelModes wheelModes = continuesTriggeredZoom ? kSTZWheelContinuesTriggeredZoom : 0;
+    if (passiveHardWheelTap.port) {
+        wheelModes |= kSTZWheelUnderDictatorship;
+    }
+    STZWheelTapsSetModes(wheelTaps, wheelModes);
+
+    if (!periodicTimer) {
+        //  Created once and moved as deadlines change. A timer that doesn’t repeat is invalidated
+        //  after it fires; this one repeats far enough apart that it never fires on its own.
+        periodicTimer = CFRunLoopTimerCreate(kCFAllocatorDefault, kFarFutureFireDate, kFarFutureFireDate, 0, 0, periodicUpdateCallback, NULL);
+        CFRunLoopAddTimer(CFRunLoopGetMain(), periodicTimer, kCFRunLoopCommonModes);
     }
 
+    if (!expiryTimer) {
+        //  Lookups only expire contexts while events come; advance the wheel so that idle ones are released.
+        CFTimeInterval interval = (double)STZWheelTapsGetExpiryInterval(wheelTaps) / NSEC_PER_SEC;
+        expiryTimer = CFRunLoopTimerCreate(kCFAllocatorDefault, CFAbsoluteTimeGetCurrent() + interval, interval, 0, 0, expiryTimerCallback, NULL);
+        CFRunLoopTimerSetTolerance(expiryTimer, interval / 8);
+        CFRunLoopAddTimer(CFRunLoopGetMain(), expiryTimer, kCFRunLoopCommonModes);
+    }
+
+    //  Expiry is only a fallback; contexts of detached devices are released right away.
+    STZDeviceRegistryAddObserver(anyDeviceAttachedOrDetached, NULL);
+
     stabWantsDictatorship = false;
     needsReinsertTaps = false;
 
@@ -373,7 +528,6 @@ RESET:
     stabWantsDictatorship = !!(modes & kSTZWantsDictatorship);
 
     releaseEventTap(&flagsTap);
-    triggerFlagsDown = false;
 
     releaseEventTap(&passiveSoftWheelTap);
     releaseEventTap(&mutableSoftWheelTap);
@@ -384,10 +538,8 @@ RESET:
         STZMagicZoomObserveActivation(NULL, NULL);
     }
 
-    wheelTapsMutable = false;
-    if (wheelContexts) {
-        STZCacheRemoveAll(wheelContexts);
-    }
+    STZWheelTapsReset(wheelTaps);
+    STZWheelTapsSetModes(wheelTaps, continuesTriggeredZoom ? kSTZWheelContinuesTriggeredZoom : 0);
 
     if (periodicTimer) {
         CFRunLoopTimerInvalidate(periodicTimer);
@@ -395,6 +547,14 @@ RESET:
         periodicTimer = NULL;
     }
 
+    STZDeviceRegistryRemoveObserver(anyDeviceAttachedOrDetached, NULL);
+
+    if (expiryTimer) {
+        CFRunLoopTimerInvalidate(expiryTimer);
+        CFRelease(expiryTimer);
+        expiryTimer = NULL;
+    }
+
     CFNotificationCenterPostNotification(CFNotificationCenterGetLocalCenter(),
                                          kSTZWorkingModesDidChangeNotification,
                                          NULL, NULL, true);
@@ -402,8 +562,46 @@ RESET:
 }
 
 
+static void logTapCallbackTimings(void) {
+    static char const *const names[kSTZTapCallbackCount] = {
+        [kSTZFlagsTapCallback] = "flags",
+        [kSTZHardWheelTapCallback] = "hard wheel",
+        [kSTZPassiveSoftWheelTapCallback] = "passive soft wheel",
+        [kSTZMutableSoftWheelTapCallback] = "mutable soft wheel",
+    };
+
+    for (STZTapCallback callback = 0; callback < kSTZTapCallbackCount; ++callback) {
+        STZWatchdogHistogram histogram = STZGetTapCallbackTimings(callback);
+        if (!histogram.callbacks) {continue;}
+
+        STZWatchdogHistogram delays = STZGetTapQueueDelays(callback);
+        STZDebugLog("\t%s tap: %llu callbacks, %llu over budget, p50 %.2f ms, p99 %.2f ms, max %.2f ms; "
+                    "queued p99 %.2f ms, max %.2f ms",
+                    names[callback], (unsigned long long)histogram.callbacks, (unsigned long long)histogram.overBudget,
+                    (double)STZWatchdogHistogramGetPercentile(&histogram, 0.5) * 1000 / NSEC_PER_SEC,
+                    (double)STZWatchdogHistogramGetPercentile(&histogram, 0.99) * 1000 / NSEC_PER_SEC,
+                    (double)histogram.maxDuration * 1000 / NSEC_PER_SEC,
+                    (double)STZWatchdogHistogramGetPercentile(&delays, 0.99) * 1000 / NSEC_PER_SEC,
+                    (double)delays.maxDuration * 1000 / NSEC_PER_SEC);
+    }
+}
+
+
+STZWatchdogHistogram STZGetTapCallbackTimings(STZTapCallback callback) {
+    if (!tapWatchdog) {return (STZWatchdogHistogram){0};}
+    return STZWatchdogGetHistogram(tapWatchdog, callback);
+}
+
+
+STZWatchdogHistogram STZGetTapQueueDelays(STZTapCallback callback) {
+    if (!tapWatchdog) {return (STZWatchdogHistogram){0};}
+    return STZWatchdogGetQueueDelayHistogram(tapWatchdog, callback);
+}
+
+
 static void eventTapTimeout(void) {
     STZDebugLog("Event tap disabled due to timeout");
+    logTapCallbackTimings();
     STZSetWorkingModes(0);
     STZDidStopWorkingDueToEventTapTimeout();
 }
@@ -434,169 +632,54 @@ static void reinsertTapsIfNeeded(void) {
 }
 
 
-static void clearTriggerFlagsForEvent(CGEventRef event) {
-    CGEventFlags mask = ~(STZGetTriggerFlags() & kSTZModifiersMask);
-    CGEventSetFlags(event, CGEventGetFlags(event) & mask);
-}
-
-
-static void beginWheelTapMutations(void) {
-    if (wheelTapsMutable) {return;}
-    CGEventTapEnable(mutableSoftWheelTap.port, true);
-    if (passiveSoftWheelTap.port) {
-        CGEventTapEnable(passiveSoftWheelTap.port, false);
-    }
-    if (passiveHardWheelTap.port) {
-        CGEventTapEnable(mutableHardWheelTap.port, true);
-        CGEventTapEnable(passiveHardWheelTap.port, false);
-    }
-    wheelTapsMutable = true;
-    STZDebugLog("\tswitched to mutating scroll wheel taps");
-}
-
-
-typedef OPTION_FLAGS(uint64_t) {
-    //  The following two flags are exclusive
-    kStateSessionIsMagicZoom        = 1 << 0,
-    kStateSessionIsTriggeredZoom    = 1 << 1,
-} StateSessionData;
-
-
-typedef OPTION_FLAGS(uint8_t) {
-    kTryToEndWheelTapMutations  = 1 << 0,
-    kRescheduleTimer            = 1 << 1,
-    kEmitPeriodicEvents         = 1 << 2,
-    kDiscardTriggerFlags        = 1 << 3,
-} WheelContextActions;
-
-
-typedef struct {
-    WheelContextActions     const actions;
-    CGEventTimestamp        const now;
-    CGEventRef              const event;
-    bool                    canEndMutations;
-    CGEventTimestamp        eventUpdatePeriod;
-} WheelContextDoEnv;
-
-
-static void wheelContextDo(void *addr, void *refcon) {
-    WheelContext *context = addr;
-    WheelContextDoEnv *env = refcon;
-    if (env->actions & kEmitPeriodicEvents) {
-        CGEventRef event = STZStatePeriodicallyUpdate(context->state, env->now);
-        if (event != NULL) {
-            if (context->appOptions & kSTZFlagsExcludedForApp) {
-                clearTriggerFlagsForEvent(event);
-            }
-            STZDebugLogEvent("\tperiodic", event);
-            CGEventPost(kCGSessionEventTap, event);
-            CFRelease(event);
-        }
-    }
-
-    if (env->actions & kDiscardTriggerFlags) {
-        StateSessionData data;
-        if (STZStateGetSessionData(context->state, &data) && !(data & kStateSessionIsMagicZoom)) {
-            CGEventRef event = STZStateRevertToScrollByEvent(context->state, env->event);
-            if (event != NULL) {
-                STZDebugLogEvent("\tfollowed by", event);
-                CGEventPost(kCGSessionEventTap, event);
-                CFRelease(event);
-            }
-        }
-    }
+static void magicZoomActivationCallback(uint64_t registryID, bool active, void *refcon) {
+    STZTraceRecordMagicZoom(CGEventTimestampNow(), registryID, active);
 
-    if (env->actions & kTryToEndWheelTapMutations) {
-        StateSessionData data;
-        if (context->magicZoomPending
-         || (STZStateGetSessionData(context->state, &data) && (data & kStateSessionIsMagicZoom))
-         || !STZStateCanStopTransformingEvents(context->state)) {
-            env->canEndMutations = false;
-        }
+    if (active) {
+        STZDebugLog("Magic zoom finger down for [%llx]", registryID);
+    } else {
+        STZDebugLog("Magic zoom finger up for [%llx]", registryID);
     }
+    STZEpochBeginReading();
+    STZWheelTapsSetMagicZoomPending(wheelTaps, registryID, active);
+    STZEpochEndReading();
 
-    if (env->actions & kRescheduleTimer) {
-        CGEventTimestamp updatePeriod = STZStateGetNextUpdatePeriod(context->state, env->now);
-        if (updatePeriod != 0) {
-            if (env->eventUpdatePeriod == 0 || env->eventUpdatePeriod > updatePeriod) {
-                env->eventUpdatePeriod = updatePeriod;
-            }
-        }
-    }
+    reinsertTapsIfNeeded();
 }
 
 
-static void forEachStateDo(WheelContextActions actions, CGEventRef event) {
-    assert(!(actions & kDiscardTriggerFlags) || event);
-
-    if (!wheelTapsMutable || triggerFlagsDown) {
-        actions = actions & ~kTryToEndWheelTapMutations;
-    }
-
-    WheelContextDoEnv env = {
-        .actions = actions,
-        .now = CGEventTimestampNow(),
-        .event = event,
-        .canEndMutations = (actions & kTryToEndWheelTapMutations) != 0,
-        .eventUpdatePeriod = 0,
+static CGEventRef timedTapCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon) {
+    static CGEventTapCallBack const callbacks[kSTZTapCallbackCount] = {
+        [kSTZFlagsTapCallback] = flagsTapCallback,
+        [kSTZHardWheelTapCallback] = hardWheelTapCallback,
+        [kSTZPassiveSoftWheelTapCallback] = passiveSoftWheelTapCallback,
+        [kSTZMutableSoftWheelTapCallback] = mutableSoftWheelTapCallback,
     };
 
-    STZCacheEnumerateValues(wheelContexts, wheelContextDo, &env);
-
-    if (env.canEndMutations) {
-        CGEventTapEnable(mutableSoftWheelTap.port, false);
-        if (passiveSoftWheelTap.port) {
-            CGEventTapEnable(passiveSoftWheelTap.port, true);
-        }
-        if (passiveHardWheelTap.port) {
-            CGEventTapEnable(mutableHardWheelTap.port, false);
-            CGEventTapEnable(passiveHardWheelTap.port, true);
-        }
-        wheelTapsMutable = false;
-        STZDebugLog("\tswitched to passive scroll wheel taps");
+    STZTapCallback callback = (STZTapCallback)(uintptr_t)refcon;
+    if (type == kCGEventTapDisabledByTimeout || type == kCGEventTapDisabledByUserInput) {
+        return callbacks[callback](proxy, type, event, NULL);
     }
 
-    if (actions & kRescheduleTimer) {
-        if (env.eventUpdatePeriod == 0) {
-            if (periodicTimer != NULL) {
-                CFRunLoopTimerInvalidate(periodicTimer);
-                CFRelease(periodicTimer);
-                periodicTimer = NULL;
-            }
-
-        } else {
-            CFAbsoluteTime fireDate = CFAbsoluteTimeGetCurrent() + (double)env.eventUpdatePeriod / NSEC_PER_SEC;
-
-            if (periodicTimer != NULL) {
-                if (CFRunLoopTimerGetNextFireDate(periodicTimer) < fireDate - (1.0 / 240)) {return;}
-                CFRunLoopTimerInvalidate(periodicTimer);
-                CFRelease(periodicTimer);
-            }
-
-            periodicTimer = CFRunLoopTimerCreate(kCFAllocatorDefault, fireDate, 0, 0, 0, periodicUpdateCallback, NULL);
-            CFRunLoopAddTimer(CFRunLoopGetMain(), periodicTimer, kCFRunLoopCommonModes);
-        }
-    }
+    //  Settings snapshots read by the callback stay valid until it returns.
+    STZEpochBeginReading();
+    STZWatchdogBeginCallback(tapWatchdog, callback, CGEventGetTimestamp(event), CGEventTimestampNow());
+    currentTapProxy = proxy;
+    CGEventRef result = callbacks[callback](proxy, type, event, NULL);
+    currentTapProxy = NULL;
+    STZWatchdogEndCallback(tapWatchdog, CGEventTimestampNow());
+    STZEpochEndReading();
+    return result;
 }
 
 
-static void magicZoomActivationCallback(uint64_t registryID, bool active, void *refcon) {
-    WheelContext *context = wheelContextWithFallback(registryID);
-    context->magicZoomPending = active;
-
-    if (active) {
-        STZDebugLog("Magic zoom finger down for [%llx]", registryID);
-        beginWheelTapMutations();
-    } else {
-        STZDebugLog("Magic zoom finger up for [%llx]", registryID);
-        forEachStateDo(kTryToEndWheelTapMutations, NULL);
-    }
-
+static void reinsertTapsLater(void *info, void *object) {
     reinsertTapsIfNeeded();
 }
 
 
 static CGEventRef flagsTapCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon) {
+    STZFlags triggerFlags = STZGetSettingsSnapshot()->triggerFlags;
     bool flagsDown;
 
     switch (type) {
@@ -604,40 +687,39 @@ static CGEventRef flagsTapCallback(CGEventTapProxy proxy, CGEventType type, CGEv
     case kCGEventTapDisabledByUserInput:    return NULL;
 
     case kCGEventFlagsChanged:
-        if (!(STZGetTriggerFlags() & kSTZModifiersMask)) {return event;}
-        flagsDown = (CGEventGetFlags(event) & kSTZModifiersMask) == STZGetTriggerFlags();
+        if (!(triggerFlags & kSTZModifiersMask)) {return event;}
+        flagsDown = (CGEventGetFlags(event) & kSTZModifiersMask) == triggerFlags;
         break;
 
     case kCGEventOtherMouseDown:
-        if (!(STZGetTriggerFlags() & kSTZMouseButtonsMask)) {return event;}
-        if (CGEventGetIntegerValueField(event, kCGMouseEventButtonNumber) != STZGetTriggerFlags()) {return event;}
+        if (!(triggerFlags & kSTZMouseButtonsMask)) {return event;}
+        if (CGEventGetIntegerValueField(event, kCGMouseEventButtonNumber) != triggerFlags) {return event;}
         flagsDown = true;
         break;
 
     case kCGEventOtherMouseUp:
-        if (!(STZGetTriggerFlags() & kSTZMouseButtonsMask)) {return event;}
-        if (CGEventGetIntegerValueField(event, kCGMouseEventButtonNumber) != STZGetTriggerFlags()) {return event;}
+        if (!(triggerFlags & kSTZMouseButtonsMask)) {return event;}
+        if (CGEventGetIntegerValueField(event, kCGMouseEventButtonNumber) != triggerFlags) {return event;}
         flagsDown = false;
         break;
 
     default: assert(false); break;
     }
 
-    STZDebugLogEvent("Hard", event);
+    logEvent("Hard", event);
+    STZTraceRecordTrigger(CGEventGetTimestamp(event), CGEventGetFlags(event), flagsDown);
 
-    if (triggerFlagsDown != flagsDown) {
-        triggerFlagsDown = flagsDown;
+    if (STZWheelTapsAreTriggerFlagsDown(wheelTaps) != flagsDown) {
+        STZWheelTapsSetTriggerFlagsDown(wheelTaps, flagsDown, event);
 
         if (flagsDown) {
-            beginWheelTapMutations();
-            reinsertTapsIfNeeded();
-
-        } else {
-            WheelContextActions actions = kTryToEndWheelTapMutations;
-            if (!continuesTriggeredZoom) {
-                actions |= kDiscardTriggerFlags;
+            //  Reading the tap list is a round trip to the window server, and reinserting the
+            //  taps takes several. Either only has to be done before the next scroll event.
+            if (shouldDeferOptionalWork()) {
+                deferWork(reinsertTapsLater, NULL, NULL);
+            } else {
+                reinsertTapsIfNeeded();
             }
-            forEachStateDo(actions, event);
         }
     }
 
@@ -645,17 +727,6 @@ static CGEventRef flagsTapCallback(CGEventTapProxy proxy, CGEventType type, CGEv
 }
 
 
-static void emitCommandBasedZoomKeyEventPair(CGEventRef ref) {
-    CGEventRef pair[2];
-    if (STZCreateCommandBasedZoomKeyEventPair(ref, pair)) {
-        for (int i = 0; i < 2; ++i) {
-            CGEventPost(kCGSessionEventTap, pair[i]);
-            CFRelease(pair[i]);
-        }
-    }
-}
-
-
 static CGEventRef hardWheelTapCallback(CGEventTapProxy proxy, CGEventType type, CGEventRef event, void *refcon) {
     switch (type) {
     case kCGEventTapDisabledByTimeout:      eventTapTimeout(); CF_FALLTHROUGH;
@@ -663,60 +734,29 @@ static CGEventRef hardWheelTapCallback(CGEventTapProxy proxy, CGEventType type,
     default: assert(type == kCGEventScrollWheel); break;
     }
 
-    if (wheelTapsMutable) {
-        STZDebugLogEvent("Mutable hard", event);
+    if (STZWheelTapsAreMutable(wheelTaps)) {
+        logEvent("Mutable hard", event);
     } else {
-        STZDebugLogEvent("Passive hard", event);
-    }
-
-    //  Stashing when not mutable is a no-op, but we can store the fallback scroll direction.
-    //  When using Mos, etc., a hard event may be followed by a sequence of periodic soft events.
-    //  If the user presses the trigger flags during that sequence, the zoom direction may
-    //  be out-of-date without this fallback value.
-    WheelContext *context = wheelContextWithFallback(CGEventGetRegistryID(event));
-    context->hardScrollDir = STZStashScrollDirectionIntoEvent(event);
-
-    //  For example with Mos, the event sequence may look like this:
-    //
-    //    trigger down -> hard scroll [1] -> soft scroll × n [1] ->
-    //    trigger up -> soft scroll × n [1] ->
-    //    hard scroll [2] -> soft scroll × n [2]
-    //
-    //  All these scroll events are discrete; Mos doesn’t simulate scroll gestures.
-    //  When `hard scroll [2]` arrives and the session has not yet timed out, terminate it.
-
-    uint64_t data;
-    if (continuesTriggeredZoom && !triggerFlagsDown
-     && STZStateGetSessionData(context->state, &data) && (data & kStateSessionIsTriggeredZoom)
-     && STZIsScrollEventDiscrete(event)) {
-        CGEventRef revertEvent = STZStateRevertToScrollByEvent(context->state, event);
-        if (revertEvent != NULL) {
-            STZDebugLogEvent("\tfollowed by", revertEvent);
-            CGEventPost(kCGSessionEventTap, revertEvent);
-            CFRelease(revertEvent);
-
-            //  The subsequent mutation ending may invalidate the current mutation,
-            //  so we manually emit the modified event.
-            if (wheelTapsMutable) {
-                CGEventTapPostEvent(proxy, event);
-            }
-            forEachStateDo(kTryToEndWheelTapMutations, NULL);
-            return NULL;
-        }
+        logEvent("Passive hard", event);
     }
 
-    if (wheelTapsMutable && triggerFlagsDown && STZIsScrollEventDiscrete(event)) {
-        pid_t pid = (int32_t)CGEventGetIntegerValueField(event, kCGEventTargetUnixProcessID);
-        CFStringRef bundleID = STZGetBundleIdentifierForProcessID(pid);
-        STZAppOptions appOptions = STZGetAppOptionsForBundleIdentifier(bundleID);
+    return STZWheelTapsHardScrollEvent(wheelTaps, event);
+}
+
 
-        if (!(appOptions & kSTZDisabledForApp) && (appOptions & kSTZUsesCommandBasedZoom)) {
-            emitCommandBasedZoomKeyEventPair(event);
-            return NULL;
-        }
+//  Soft taps see scroll events the same way whether or not the hard taps are inserted, so
+//  that’s where traces are recorded.
+static void traceScrollEvent(CGEventRef event) {
+    if (!STZTraceIsRecording()) {return;}
+
+    pid_t pid = (int32_t)CGEventGetIntegerValueField(event, kCGEventTargetUnixProcessID);
+    if (!STZTraceKnowsProcess(pid)) {
+        STZTraceRecordProcess(pid, STZAppRegistryGetBundleIdentifier(STZGetAppIDForProcessID(pid), NULL));
     }
 
-    return event;
+    STZScrollRecord record;
+    STZScrollRecordRead(&record, event);
+    STZTraceRecordScroll(&record);
 }
 
 
@@ -727,10 +767,9 @@ static CGEventRef passiveSoftWheelTapCallback(CGEventTapProxy proxy, CGEventType
     default: assert(type == kCGEventScrollWheel); break;
     }
 
-    STZDebugLogEvent("Passive soft", event);
-
-    WheelContext *context = wheelContextWithFallback(CGEventGetRegistryID(event));
-    STZStateReadScrollEvent(context->state, event);
+    logEvent("Passive soft", event);
+    traceScrollEvent(event);
+    STZWheelTapsPassiveScrollEvent(wheelTaps, event);
     return event;
 }
 
@@ -742,142 +781,30 @@ static CGEventRef mutableSoftWheelTapCallback(CGEventTapProxy proxy, CGEventType
     default: assert(type == kCGEventScrollWheel); break;
     }
 
-    STZDebugLogEvent("Mutable soft", event);
-
-    WheelContext *context = wheelContextWithFallback(CGEventGetRegistryID(event));
-    context->magicZoomPending = false;
-
-    StateSessionData data = 0;
-    STZGestureType gesture = kSTZScroll;
-    bool inSession = STZStateGetSessionData(context->state, &data);
-    bool underDictatorship = passiveHardWheelTap.port != NULL;
-
-    //  Magic Zoom is currently not affected by any per-app option.
-    //  Though we have no idea why Chromium set a zoom threshold, Magic Zoom behaves like
-    //  touchpad zoom, so we don’t fix Chromium zoom stall for it.
-
-    if (inSession && (data & kStateSessionIsMagicZoom)) {
-        gesture = kSTZZoom;
-        context->appOptions = 0;
-
-    } else if (STZShouldBeginMagicZoom(CGEventGetRegistryID(event))) {
-        data = kStateSessionIsMagicZoom;
-        gesture = kSTZZoom;
-        context->appOptions = 0;
-
-    } else if (continuesTriggeredZoom && inSession && (data & kStateSessionIsTriggeredZoom)
-            && (STZScrollEventMayFallIntoMomentum(event) || (underDictatorship && STZIsScrollEventDiscrete(event)))) {
-        //  What if the event is a `kContinuousScrollEnded`?
-        //  It doesn’t matter because the session will soon time out or enter a momentum state.
-        gesture = kSTZZoom;
-
-    } else if (triggerFlagsDown && (!continuesTriggeredZoom || !STZScrollEventMayFallIntoMomentum(event))) {
-        //  With `continuesTriggeredZoom`, momentum scrolls in zoom session are handled in the
-        //  previous, and we don’t transform momentum scrolls eagerly.
+    logEvent("Mutable soft", event);
+    traceScrollEvent(event);
+    return STZWheelTapsMutableScrollEvent(wheelTaps, event);
+}
 
-        //  Scroll events in the same session are always posted to the same process,
-        //  so we need to check the app options only once per session.
-        if (!STZStateIsZooming(context->state)) {
-            pid_t pid = (int32_t)CGEventGetIntegerValueField(event, kCGEventTargetUnixProcessID);
-            CFStringRef bundleID = STZGetBundleIdentifierForProcessID(pid);
-            context->appOptions = STZGetAppOptionsForBundleIdentifier(bundleID);
-        }
 
-        if (!(context->appOptions & kSTZDisabledForApp)) {
-            if (!underDictatorship && STZIsScrollEventDiscrete(event) && (context->appOptions & kSTZUsesCommandBasedZoom)) {
-                STZStashScrollDirectionIntoEvent(event);
-                emitCommandBasedZoomKeyEventPair(event);
-                return NULL;
-            }
-
-            gesture = kSTZZoom;
-            if (continuesTriggeredZoom) {
-                data = kStateSessionIsTriggeredZoom;
-            }
-        }
-    }
+static void periodicUpdateCallback(CFRunLoopTimerRef timer, void *refcon) {
+    assert(periodicTimer == timer);
+    STZEpochBeginReading();
+    STZWheelTapsTimerDidFire(wheelTaps);
+    STZEpochEndReading();
+}
 
-    if (gesture != kSTZZoom) {
-        //  For example, a event sequence may look like this:
-        //
-        //    trigger down -> continuous scroll × n [1] ->      zoom
-        //    trigger up -> continuous scroll × n [1] ->        revert to scrolls
-        //    momentum scroll × n [1]
-        //
-        //   If the data is kept after reverting to scrolls, the momentum scrolls might
-        //   be misrecognized as a triggered zoom.
-        data = 0;
-    }
-
-    uint64_t fallbackScrollDir = underDictatorship ? context->hardScrollDir : 0;
-
-    STZEventPlacement auxPlacement;
-    CGEventRef auxEvent = STZStateTransformScrollEvent(context->state, event, gesture,
-                                                       (context->appOptions & kSTZFixesZoomForChromiumApp) != 0,
-                                                       fallbackScrollDir, &data, &auxPlacement);
-    if (underDictatorship) {
-        STZReadScrollDeltaFromEvent(event, 0, true);
-    }
-
-    CGEventRef returnValue;
-#define RETURNS(x) returnValue = x; break
-    if (auxEvent == NULL) {
-        switch (auxPlacement) {
-        case kSTZReplaceEvent:
-            STZDebugLog("\tdiscarded");
-            RETURNS(NULL);
-        case kSTZAppendEvent:
-        case kSTZPrependEvent:
-            STZDebugLogEvent("\tupdated to", event);
-            RETURNS(event);
-        }
 
-    } else {
-        if (context->appOptions & kSTZFlagsExcludedForApp) {
-            clearTriggerFlagsForEvent(auxEvent);
-        }
-        switch (auxPlacement) {
-        case kSTZReplaceEvent:
-            STZDebugLogEvent("\treplaced by", auxEvent);
-            if (underDictatorship) {
-                CGEventPost(kCGSessionEventTap, auxEvent);
-            } else {
-                CGEventTapPostEvent(proxy, auxEvent);
-            }
-            CFRelease(auxEvent);
-            RETURNS(NULL);
-        case kSTZAppendEvent:
-            STZDebugLogEvent("\tupdated to", event);
-            STZDebugLogEvent("\tfollowed by", auxEvent);
-            CGEventTapPostEvent(proxy, event);
-            if (underDictatorship) {
-                CGEventPost(kCGSessionEventTap, auxEvent);
-            } else {
-                CGEventTapPostEvent(proxy, auxEvent);
-            }
-            CFRelease(auxEvent);
-            RETURNS(NULL);
-        case kSTZPrependEvent:
-            STZDebugLogEvent("\tpreempted by", auxEvent);
-            STZDebugLogEvent("\tupdated to", event);
-            if (underDictatorship) {
-                CGEventPost(kCGSessionEventTap, auxEvent);
-            } else {
-                CGEventTapPostEvent(proxy, auxEvent);
-            }
-            CFRelease(auxEvent);
-            RETURNS(event);
-        }
-    }
-#undef RETURNS
-    forEachStateDo(kTryToEndWheelTapMutations | kRescheduleTimer, NULL);
-    return returnValue;
+static void expiryTimerCallback(CFRunLoopTimerRef timer, void *refcon) {
+    STZEpochBeginReading();
+    STZWheelTapsExpireContexts(wheelTaps);
+    STZEpochEndReading();
 }
 
 
-static void periodicUpdateCallback(CFRunLoopTimerRef timer, void *refcon) {
-    assert(periodicTimer == timer);
-    CFRelease(periodicTimer);
-    periodicTimer = NULL;
-    forEachStateDo(kTryToEndWheelTapMutations | kRescheduleTimer | kEmitPeriodicEvents, NULL);
+static void anyDeviceAttachedOrDetached(uint64_t registryID, bool attached, void *refcon) {
+    if (attached) {return;}
+    if (STZWheelTapsRemoveDevice(wheelTaps, registryID)) {
+        STZDebugLog("Released context of detached device [%llx]", registryID);
+    }
 }
@@ -8,6 +8,7 @@
 
 #pragma once
 #include "STZSettings.h"
+#include "STZWatchdog.h"
 
 
 STZModes STZGetWorkingModes(void);
@@ -15,3 +16,19 @@ bool STZSetWorkingModes(STZModes);
 
 
 extern CFStringRef const kSTZWorkingModesDidChangeNotification;
+
+
+typedef CLOSED_ENUM(uint8_t) {
+    kSTZFlagsTapCallback,
+    kSTZHardWheelTapCallback,
+    kSTZPassiveSoftWheelTapCallback,
+    kSTZMutableSoftWheelTapCallback,
+} STZTapCallback;
+
+#define kSTZTapCallbackCount 4
+
+/// How long the callback has taken since the app launched. All zero before any tap is created.
+STZWatchdogHistogram STZGetTapCallbackTimings(STZTapCallback);
+
+/// How long events seem to have waited before the callback was entered, by their timestamps.
+STZWatchdogHistogram STZGetTapQueueDelays(STZTapCallback);
@@ -9,8 +9,10 @@
 #include "STZMagicZoom.h"
 #include "MTSupportSPI.h"
 #include "STZCommon.h"
+#include "STZDeviceRegistry.h"
+#include "STZTapSlots.h"
+#include "STZTrace.h"
 #include <IOKit/hid/IOHIDLib.h>
-#include <os/lock.h>
 
 
 typedef union {
@@ -25,22 +27,24 @@ typedef union {
 
 #define MAX_TOUCHES 10
 
+//  The recognition result of each Magic Mouse is published through its slot in STZTapSlots.c.
+//  What the frame callback keeps between frames lives beside it, at the same index, and is only
+//  touched between `STZTapSlotBeginWriting` and `STZTapSlotEndWriting`.
+
 typedef struct {
     TouchStatus         touches[MAX_TOUCHES];
     uint8_t             goodTouchCount;
-    bool                recognized;
     uint8_t             tappedNTimes;
     MTPoint             tapLocation;
-    CGEventTimestamp    tapTimestamp;
 } TapContext;
 
-
-static STZCacheRef tapContexts = NULL;
-static os_unfair_lock tapContextLock = OS_UNFAIR_LOCK_INIT;
+static TapContext tapContexts[kSTZTapSlotCount];
 
 
 static void anyMouseAdded(void *refcon, io_iterator_t iterator);
 static void anyMouseRemoved(void *refcon, io_iterator_t iterator);
+static void anyDeviceAttachedOrDetached(uint64_t registryID, bool attached, void *refcon);
+static void removeMouse(uint64_t registryID);
 static void removeAllMice(void);
 
 static int magicMouseTouched(MTDeviceRef, MTTouch const *, CFIndex touchCount, CFTimeInterval timestamp, MTFrameID, void *refcon);
@@ -69,13 +73,7 @@ bool STZSetListeningMagicMice(bool listen) {
         IONotificationPortDestroy(mouseNotificationPort);
         mouseNotificationPort = NULL;
         removeAllMice();
-
-        os_unfair_lock_lock(&tapContextLock);
-        if (tapContexts) {
-            STZCacheRemoveAll(tapContexts);
-        }
-        os_unfair_lock_unlock(&tapContextLock);
-
+        STZDeviceRegistryRemoveObserver(anyDeviceAttachedOrDetached, NULL);
         return true;
     }
 
@@ -122,6 +120,10 @@ bool STZSetListeningMagicMice(bool listen) {
     anyMouseRemoved(NULL, removedIterator);
     CFRunLoopSourceRef source = IONotificationPortGetRunLoopSource(mouseNotificationPort);
     CFRunLoopAddSource(CFRunLoopGetMain(), source, kCFRunLoopCommonModes);
+
+    //  Without the registry, a detached mouse only leaves its tap slot behind until the slot is
+    //  taken over; it is not worth failing for.
+    STZDeviceRegistryAddObserver(anyDeviceAttachedOrDetached, NULL);
     return true;
 }
 
@@ -176,24 +178,47 @@ static void anyMouseAdded(void *refcon, io_iterator_t iterator) {
 static void anyMouseRemoved(void *refcon, io_iterator_t iterator) {
     io_object_t item;
     while ((item = IOIteratorNext(iterator))) {
-        if (addedMice) {
-            uint64_t registryID = 0;
-            IORegistryEntryGetRegistryEntryID(item, &registryID);
-
-            MTDeviceRef device = (void *)CFDictionaryGetValue(addedMice, uint64Key(registryID));
-            if (device) {
-                MTDeviceStop(device);
-                CFDictionaryRemoveValue(addedMice, uint64Key(registryID));
-            }
-        }
-
+        uint64_t registryID = 0;
+        IORegistryEntryGetRegistryEntryID(item, &registryID);
+        removeMouse(registryID);
         IOObjectRelease(item);
     }
 }
 
 
+//  Both this and `anyMouseRemoved` may come first for the same device.
+static void anyDeviceAttachedOrDetached(uint64_t registryID, bool attached, void *refcon) {
+    if (!attached) {
+        removeMouse(registryID);
+    }
+}
+
+
+static void removeMouse(uint64_t registryID) {
+    if (addedMice) {
+        MTDeviceRef device = (void *)CFDictionaryGetValue(addedMice, uint64Key(registryID));
+        if (device) {
+            MTDeviceStop(device);
+            CFDictionaryRemoveValue(addedMice, uint64Key(registryID));
+        }
+    }
+
+    STZTapSlotRelease(registryID);
+}
+
+
+/// Slots are released only after the device is stopped, so that no frame callback is writing
+/// to one when it is given to another device.
 static void stopDevice(void const *key, void const *value, void *context) {
     MTDeviceStop((void *)value);
+
+#if __LP64__
+    uint64_t registryID = (uint64_t)key;
+#else
+    uint64_t registryID = 0;
+    CFNumberGetValue(key, kCFNumberSInt64Type, &registryID);
+#endif
+    STZTapSlotRelease(registryID);
 }
 
 static void removeAllMice(void) {
@@ -232,32 +257,51 @@ static float vectorLengthSquare(MTPoint vector) {
 }
 
 
+static void traceTouches(uint64_t registryID, MTTouch const *touches, CFIndex touchCount) {
+    STZTraceTouch traceTouches[STZ_TRACE_MAX_TOUCHES];
+    int count = touchCount < STZ_TRACE_MAX_TOUCHES ? (int)touchCount : STZ_TRACE_MAX_TOUCHES;
+
+    for (int i = 0; i < count; ++i) {
+        traceTouches[i] = (STZTraceTouch){
+            .fingerID = (uint8_t)touches[i].fingerID,
+            .phase = (uint8_t)touches[i].phase,
+            .location = {touches[i].location.x, touches[i].location.y},
+            .velocity = {touches[i].velocity.x, touches[i].velocity.y},
+            .zTotal = touches[i].zTotal,
+            .zDensity = touches[i].zDensity,
+        };
+    }
+
+    STZTraceRecordTouches(CGEventTimestampNow(), registryID, traceTouches, count);
+}
+
+
 //  This function might be called from other threads.
 static int magicMouseTouched(MTDeviceRef device, MTTouch const *touches, CFIndex touchCount, CFTimeInterval frameTime, MTFrameID frame, void *refcon) {
     uint64_t registryID = 0;
     MTDeviceGetRegistryID(device, &registryID);
 
+    if (STZTraceIsRecording()) {
+        traceTouches(registryID, touches, touchCount);
+    }
+
     bool notify = false;
     CGEventTimestamp now = CGEventTimestampNow();
-    os_unfair_lock_lock(&tapContextLock);
 
-    if (!tapContexts) {
-        tapContexts = STZCacheCreate(sizeof(TapContext), 300 * NSEC_PER_SEC, NULL);
-    }
+    bool claimed;
+    int slot = STZTapSlotBeginWriting(registryID, now, &claimed);
+    if (slot < 0) {return 0;}
 
-    TapContext *context = STZCacheGetValue(tapContexts, registryID);
-    if (!context) {
-        TapContext newValue = {
-            .touches = {{0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}},
-            .goodTouchCount = 0,
-            .recognized = false,
-            .tappedNTimes = 0,
-            .tapLocation = {0, 0},
-            .tapTimestamp = 0,
-        };
-        context = STZCacheSetValue(tapContexts, registryID, &newValue);
+    TapContext *context = &tapContexts[slot];
+    if (claimed) {
+        *context = (TapContext){0};
     }
 
+    STZTapState published = STZTapSlotGetState(slot);
+    bool wasRecognized = published.recognized;
+    CGEventTimestamp tapTimestamp = published.tapTimestamp;
+    CGEventTimestamp oldTapTimestamp = tapTimestamp;
+
     uint8_t goodTouchCount = 0;
     uint8_t lastTouchIndex = 0;
 
@@ -300,12 +344,12 @@ static int magicMouseTouched(MTDeviceRef device, MTTouch const *touches, CFIndex
         bool singleTap = goodTouchCount == 1 && context->goodTouchCount == 0;
         if (!singleTap) {
             if (goodTouchCount != 0) {
-                context->tapTimestamp = 0;
+                tapTimestamp = 0;
                 context->tappedNTimes = 0;
             }
 
         } else {
-            CGEventTimestamp delta = now - context->tapTimestamp;
+            CGEventTimestamp delta = now - tapTimestamp;
             if (delta > (0.25 * NSEC_PER_SEC)
              || pointDistanceSquare(touches[lastTouchIndex].location, context->tapLocation) > SQUARE(0.25)) {
                 context->tapLocation = touches[lastTouchIndex].location;
@@ -314,7 +358,7 @@ static int magicMouseTouched(MTDeviceRef device, MTTouch const *touches, CFIndex
 
             //  Magic Mouse sends touches per ~0.011s. Taps too frequent could be mistouch.
             if (delta > (0.05 * NSEC_PER_SEC)) {
-                context->tapTimestamp = now;
+                tapTimestamp = now;
                 context->tappedNTimes += 1;
                 if (context->tappedNTimes == 3) {
                     context->tappedNTimes = 1;
@@ -325,8 +369,11 @@ static int magicMouseTouched(MTDeviceRef device, MTTouch const *touches, CFIndex
         context->goodTouchCount = goodTouchCount;
 
         bool recognized = goodTouchCount && context->tappedNTimes == 2;
-        notify = recognized != context->recognized;
-        context->recognized = recognized;
+        notify = recognized != wasRecognized;
+
+        if (notify || tapTimestamp != oldTapTimestamp) {
+            STZTapSlotPublish(slot, (STZTapState){recognized, tapTimestamp});
+        }
 
     } else {
         //  If a finger moved during the touch, reset the tap count.
@@ -337,14 +384,12 @@ static int magicMouseTouched(MTDeviceRef device, MTTouch const *touches, CFIndex
         }
     }
 
-    os_unfair_lock_unlock(&tapContextLock);
+    STZTapSlotEndWriting(slot);
 
     if (notify) {
         dispatch_async(dispatch_get_main_queue(), ^{
-            os_unfair_lock_lock(&tapContextLock);
-            TapContext *context_ = STZCacheGetValue(tapContexts, registryID);
-            bool recognized = context_ ? context_->recognized : false;
-            os_unfair_lock_unlock(&tapContextLock);
+            STZTapState state;
+            bool recognized = STZTapSlotRead(registryID, &state) && state.recognized;
 
             if (activationCallback) {
                 activationCallback(registryID, recognized, activationCallbackRefcon);
@@ -354,20 +399,3 @@ static int magicMouseTouched(MTDeviceRef device, MTTouch const *touches, CFIndex
 
     return 0;
 }
-
-
-bool STZShouldBeginMagicZoom(uint64_t registryID) {
-    const CGEventTimestamp timeout = 0.5 * NSEC_PER_SEC;
-
-    bool active = false;
-    os_unfair_lock_lock(&tapContextLock);
-
-    TapContext *context = tapContexts ? STZCacheGetValue(tapContexts, registryID) : NULL;
-    if (context && context->recognized) {
-        CGEventTimestamp now = CGEventTimestampNow();
-        active = (now - context->tapTimestamp) < timeout;
-    }
-
-    os_unfair_lock_unlock(&tapContextLock);
-    return active;
-}
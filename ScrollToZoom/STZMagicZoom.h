@@ -18,7 +18,5 @@ bool STZSetListeningMagicMice(bool listen);
 typedef void (*STZMagicZoomCallback)(uint64_t registryID, bool active, void *refcon);
 void STZMagicZoomObserveActivation(STZMagicZoomCallback __nullable callback, void *__nullable refcon);
 
-bool STZShouldBeginMagicZoom(uint64_t registryID);
-
 
 CF_ASSUME_NONNULL_END
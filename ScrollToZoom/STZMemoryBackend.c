@@ -0,0 +1,254 @@
+/*
+ *  STZMemoryBackend.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#if STZ_HEADLESS
+
+#include "STZCommon.h"
+#include "STZSettings.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+
+//  Covers every field in CGEventSPI.h.
+#define FIELD_COUNT 160
+
+struct __CGEvent {
+    int                 refCount;
+    CGEventType         type;
+    CGEventFlags        flags;
+    CGPoint             location;
+    CGEventTimestamp    timestamp;
+    int64_t             integers[FIELD_COUNT];
+    double              doubles[FIELD_COUNT];
+};
+
+
+static size_t createdEventCount = 0;
+static size_t fieldAccessCount = 0;
+
+
+CFTypeRef CFRetain(CFTypeRef object) {
+    ((struct __CGEvent *)object)->refCount += 1;
+    return object;
+}
+
+
+void CFRelease(CFTypeRef object) {
+    struct __CGEvent *event = (struct __CGEvent *)object;
+    assert(event->refCount > 0);
+    event->refCount -= 1;
+    if (event->refCount == 0) {
+        free(event);
+    }
+}
+
+
+CFIndex CFGetRetainCount(CFTypeRef object) {
+    return ((struct __CGEvent *)object)->refCount;
+}
+
+
+CGEventRef CGEventCreate(CGEventSourceRef source) {
+    CGEventRef event = calloc(1, sizeof(struct __CGEvent));
+    event->refCount = 1;
+    createdEventCount += 1;
+    event->timestamp = CGEventTimestampNow();
+    return event;
+}
+
+
+CGEventRef CGEventCreateCopy(CGEventRef event) {
+    CGEventRef copy = malloc(sizeof(struct __CGEvent));
+    memcpy(copy, event, sizeof(struct __CGEvent));
+    copy->refCount = 1;
+    createdEventCount += 1;
+    return copy;
+}
+
+
+CGEventSourceRef CGEventCreateSourceFromEvent(CGEventRef event) {
+    return NULL;
+}
+
+
+CGEventType CGEventGetType(CGEventRef event) {return event->type;}
+void CGEventSetType(CGEventRef event, CGEventType type) {event->type = type;}
+CGEventFlags CGEventGetFlags(CGEventRef event) {return event->flags;}
+void CGEventSetFlags(CGEventRef event, CGEventFlags flags) {event->flags = flags;}
+CGPoint CGEventGetLocation(CGEventRef event) {fieldAccessCount += 1; return event->location;}
+void CGEventSetLocation(CGEventRef event, CGPoint location) {fieldAccessCount += 1; event->location = location;}
+CGEventTimestamp CGEventGetTimestamp(CGEventRef event) {fieldAccessCount += 1; return event->timestamp;}
+void CGEventSetTimestamp(CGEventRef event, CGEventTimestamp timestamp) {fieldAccessCount += 1; event->timestamp = timestamp;}
+
+
+int64_t CGEventGetIntegerValueField(CGEventRef event, CGEventField field) {
+    assert(field < FIELD_COUNT);
+    fieldAccessCount += 1;
+    return event->integers[field];
+}
+
+
+void CGEventSetIntegerValueField(CGEventRef event, CGEventField field, int64_t value) {
+    assert(field < FIELD_COUNT);
+    fieldAccessCount += 1;
+    event->integers[field] = value;
+    event->doubles[field] = (double)value;
+}
+
+
+double CGEventGetDoubleValueField(CGEventRef event, CGEventField field) {
+    assert(field < FIELD_COUNT);
+    fieldAccessCount += 1;
+    return event->doubles[field];
+}
+
+
+void CGEventSetDoubleValueField(CGEventRef event, CGEventField field, double value) {
+    assert(field < FIELD_COUNT);
+    fieldAccessCount += 1;
+    event->doubles[field] = value;
+    event->integers[field] = (int64_t)value;
+}
+
+
+//  MARK: -
+
+
+static CGEventTimestamp now = 0;
+static STZMemoryBackendPostCallback postCallback = NULL;
+static void *postCallbackRefcon = NULL;
+static bool loggingEnabled = false;
+static CGEventTimestamp displayFrameInterval = NSEC_PER_SEC / 60;
+
+
+CGEventTimestamp CGEventTimestampNow(void) {
+    return now;
+}
+
+
+void STZMemoryBackendSetNow(CGEventTimestamp newNow) {
+    now = newNow;
+}
+
+
+size_t STZMemoryBackendGetCreatedEventCount(void) {
+    return createdEventCount;
+}
+
+
+size_t STZMemoryBackendGetFieldAccessCount(void) {
+    return fieldAccessCount;
+}
+
+
+void STZMemoryBackendSetDisplayFrameInterval(CGEventTimestamp interval) {
+    displayFrameInterval = interval;
+}
+
+
+CGEventTimestamp STZGetDisplayFrameIntervalAtPoint(CGPoint point) {
+    return displayFrameInterval;
+}
+
+
+void STZMemoryBackendSetPostCallback(STZMemoryBackendPostCallback callback, void *refcon) {
+    postCallback = callback;
+    postCallbackRefcon = refcon;
+}
+
+
+void CGEventPost(CGEventTapLocation location, CGEventRef event) {
+    if (postCallback) {
+        postCallback(location, event, postCallbackRefcon);
+    }
+}
+
+
+void STZMemoryBackendSetLoggingEnabled(bool enabled) {
+    loggingEnabled = enabled;
+}
+
+
+bool STZIsLoggingEnabled(void) {
+    return loggingEnabled;
+}
+
+
+void STZDebugLog(char const *message, ...) {
+    if (!loggingEnabled) {return;}
+
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+
+//  MARK: - Settings
+
+//  Defaults are the same as STZSettings.m. Headless runs are single-threaded, so setters update
+//  the one snapshot in place; every app has the default options.
+
+static STZAppOptions const noAppOptions[1] = {0};
+
+static STZSettingsSnapshot snapshot = {
+    .version = 1,
+    .preferredModes = kSTZMagicZoomEnabled | kSTZTriggerFlagsEnabled | kSTZWantsDictatorship,
+    .triggerFlags = kSTZModifierOption,
+    .magnificationScalar = 0.0025,
+    .momentumZoomAttenuation = 0.8,
+    .momentumZoomMinValue = 0.001,
+    .zoomCoalescingWindow = 0,
+    .frameInterval = 0,
+    .mutableTapsLingerTime = NSEC_PER_SEC / 5,
+    .maxTapSwitchesPerSecond = 8,
+    .logsScrollEvents = true,
+    .appOptions = noAppOptions,
+    .lastAppID = 0,
+};
+
+
+static double clamp(double value, double min, double max) {
+    return value < min ? min : value > max ? max : value;
+}
+
+
+STZSettingsSnapshot const *STZGetSettingsSnapshot(void) {
+    return &snapshot;
+}
+
+
+STZModes STZGetPreferredModes(void) {return snapshot.preferredModes;}
+void STZSetPreferredModes(STZModes modes) {snapshot.preferredModes = modes; snapshot.version += 1;}
+double STZGetMagnificationScalar(void) {return snapshot.magnificationScalar;}
+void STZSetMagnificationScalar(double value) {snapshot.magnificationScalar = clamp(value, -1, 1); snapshot.version += 1;}
+double STZGetMomentumZoomAttenuation(void) {return snapshot.momentumZoomAttenuation;}
+void STZSetMomentumZoomAttenuation(double value) {snapshot.momentumZoomAttenuation = clamp(value, 0, 1); snapshot.version += 1;}
+double STZGetMomentumZoomMinValue(void) {return snapshot.momentumZoomMinValue;}
+void STZSetMomentumZoomMinValue(double value) {snapshot.momentumZoomMinValue = clamp(value, 0, 1); snapshot.version += 1;}
+double STZGetZoomCoalescingWindow(void) {return (double)snapshot.zoomCoalescingWindow / NSEC_PER_SEC;}
+void STZSetZoomCoalescingWindow(double value) {snapshot.zoomCoalescingWindow = (CGEventTimestamp)(clamp(value, 0, 0.1) * NSEC_PER_SEC); snapshot.version += 1;}
+
+static double targetFrameRate = 0;
+double STZGetTargetFrameRate(void) {return targetFrameRate;}
+void STZSetTargetFrameRate(double value) {
+    targetFrameRate = value > 0 ? clamp(value, 24, 480) : 0;
+    snapshot.frameInterval = targetFrameRate > 0 ? (CGEventTimestamp)(NSEC_PER_SEC / targetFrameRate) : 0;
+    snapshot.version += 1;
+}
+
+double STZGetMutableTapsLingerTime(void) {return (double)snapshot.mutableTapsLingerTime / NSEC_PER_SEC;}
+void STZSetMutableTapsLingerTime(double value) {snapshot.mutableTapsLingerTime = (CGEventTimestamp)(clamp(value, 0, 1) * NSEC_PER_SEC); snapshot.version += 1;}
+int STZGetMaxTapSwitchesPerSecond(void) {return (int)snapshot.maxTapSwitchesPerSecond;}
+void STZSetMaxTapSwitchesPerSecond(int value) {snapshot.maxTapSwitchesPerSecond = value > 0 ? (uint32_t)clamp(value, 2, 64) : 0; snapshot.version += 1;}
+bool STZGetLogsScrollEvents(void) {return snapshot.logsScrollEvents;}
+void STZSetLogsScrollEvents(bool value) {snapshot.logsScrollEvents = value; snapshot.version += 1;}
+
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ *  STZMemoryBackend.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  A stand-in for the subset of CoreFoundation and CoreGraphics used by the portable core. Only
+//  include this through STZBackend.h with `STZ_HEADLESS` defined. Field numbers and enum values
+//  match the SDK so that recorded events keep their meaning.
+
+
+#define CF_IMPLICIT_BRIDGING_ENABLED
+#define CF_IMPLICIT_BRIDGING_DISABLED
+#define CF_ASSUME_NONNULL_BEGIN
+#define CF_ASSUME_NONNULL_END
+#define CF_RETURNS_RETAINED
+#define CF_BRIDGED_TYPE(T)
+#define CF_FORMAT_FUNCTION(F, A) __attribute__((format(printf, F, A)))
+#define CF_FALLTHROUGH __attribute__((fallthrough))
+
+#if __clang__
+#define CF_ENUM(ScalarType, Name) enum __attribute__((enum_extensibility(open))) Name : ScalarType Name; enum Name : ScalarType
+#define __nullable _Nullable
+#else
+#define CF_ENUM(ScalarType, Name) ScalarType Name; enum Name
+#define __nullable
+#define _Nonnull
+#endif
+
+//  glibc has its own function-like `__nonnull`, so portable headers spell it `_Nonnull`.
+
+#ifndef NSEC_PER_SEC
+#define NSEC_PER_SEC 1000000000ull
+#endif
+
+#define NX_ALPHASHIFTMASK   0x00010000
+#define NX_SHIFTMASK        0x00020000
+#define NX_CONTROLMASK      0x00040000
+#define NX_ALTERNATEMASK    0x00080000
+#define NX_COMMANDMASK      0x00100000
+#define NX_SECONDARYFNMASK  0x00800000
+
+
+typedef long CFIndex;
+typedef void const *CFTypeRef;
+typedef struct __CFString const *CFStringRef;
+typedef struct __CFDictionary const *CFDictionaryRef;
+
+/// Only events are reference counted by this backend.
+CFTypeRef CFRetain(CFTypeRef);
+void CFRelease(CFTypeRef);
+CFIndex CFGetRetainCount(CFTypeRef);
+
+
+typedef struct {double x, y;} CGPoint;
+
+typedef struct __CGEvent *CGEventRef;
+typedef struct __CGEventSource *CGEventSourceRef;
+typedef uint64_t CGEventTimestamp;
+
+typedef CF_ENUM(uint64_t, CGEventFlags) {
+    kCGEventFlagMaskAlphaShift  = NX_ALPHASHIFTMASK,
+    kCGEventFlagMaskShift       = NX_SHIFTMASK,
+    kCGEventFlagMaskControl     = NX_CONTROLMASK,
+    kCGEventFlagMaskAlternate   = NX_ALTERNATEMASK,
+    kCGEventFlagMaskCommand     = NX_COMMANDMASK,
+    kCGEventFlagMaskSecondaryFn = NX_SECONDARYFNMASK,
+};
+
+typedef CF_ENUM(uint32_t, CGEventType) {
+    kCGEventNull                = 0,
+    kCGEventKeyDown             = 10,
+    kCGEventKeyUp               = 11,
+    kCGEventFlagsChanged        = 12,
+    kCGEventScrollWheel         = 22,
+    kCGEventOtherMouseDown      = 25,
+    kCGEventOtherMouseUp        = 26,
+};
+
+typedef CF_ENUM(uint32_t, CGEventField) {
+    kCGMouseEventButtonNumber               = 3,
+    kCGKeyboardEventKeycode                 = 9,
+    kCGKeyboardEventKeyboardType            = 10,
+    kCGEventTargetUnixProcessID             = 40,
+    kCGEventSourceUserData                  = 42,
+    kCGEventSourceStateID                   = 45,
+    kCGScrollWheelEventFixedPtDeltaAxis1    = 93,
+    kCGScrollWheelEventFixedPtDeltaAxis2    = 94,
+    kCGScrollWheelEventFixedPtDeltaAxis3    = 95,
+    kCGScrollWheelEventPointDeltaAxis1      = 96,
+    kCGScrollWheelEventPointDeltaAxis2      = 97,
+    kCGScrollWheelEventScrollPhase          = 99,
+    kCGScrollWheelEventMomentumPhase        = 123,
+};
+
+typedef CF_ENUM(uint32_t, CGScrollPhase) {
+    kCGScrollPhaseBegan         = 1,
+    kCGScrollPhaseChanged       = 2,
+    kCGScrollPhaseEnded         = 4,
+    kCGScrollPhaseCancelled     = 8,
+    kCGScrollPhaseMayBegin      = 128,
+};
+
+typedef CF_ENUM(uint32_t, CGMomentumScrollPhase) {
+    kCGMomentumScrollPhaseNone      = 0,
+    kCGMomentumScrollPhaseBegin     = 1,
+    kCGMomentumScrollPhaseContinue  = 2,
+    kCGMomentumScrollPhaseEnd       = 3,
+};
+
+typedef CF_ENUM(uint32_t, CGGesturePhase) {
+    kCGGesturePhaseNone         = 0,
+    kCGGesturePhaseBegan        = 1,
+    kCGGesturePhaseChanged      = 2,
+    kCGGesturePhaseEnded        = 4,
+    kCGGesturePhaseCancelled    = 8,
+    kCGGesturePhaseMayBegin     = 128,
+};
+
+typedef CF_ENUM(uint32_t, CGEventTapLocation) {
+    kCGHIDEventTap = 0,
+    kCGSessionEventTap,
+    kCGAnnotatedSessionEventTap,
+};
+
+
+/// Fields are stored both as integers and as doubles; setting either updates the other.
+CGEventRef CGEventCreate(CGEventSourceRef __nullable source);
+CGEventRef CGEventCreateCopy(CGEventRef);
+CGEventSourceRef __nullable CGEventCreateSourceFromEvent(CGEventRef);
+
+CGEventType CGEventGetType(CGEventRef);
+void CGEventSetType(CGEventRef, CGEventType);
+CGEventFlags CGEventGetFlags(CGEventRef);
+void CGEventSetFlags(CGEventRef, CGEventFlags);
+CGPoint CGEventGetLocation(CGEventRef);
+void CGEventSetLocation(CGEventRef, CGPoint);
+CGEventTimestamp CGEventGetTimestamp(CGEventRef);
+void CGEventSetTimestamp(CGEventRef, CGEventTimestamp);
+
+int64_t CGEventGetIntegerValueField(CGEventRef, CGEventField);
+void CGEventSetIntegerValueField(CGEventRef, CGEventField, int64_t);
+double CGEventGetDoubleValueField(CGEventRef, CGEventField);
+void CGEventSetDoubleValueField(CGEventRef, CGEventField, double);
+
+/// Hands the event to the post callback, which doesn’t take ownership.
+void CGEventPost(CGEventTapLocation, CGEventRef);
+
+
+/// The clock doesn’t advance by itself; `CGEventCreate` also stamps events with it.
+CGEventTimestamp CGEventTimestampNow(void);
+void STZMemoryBackendSetNow(CGEventTimestamp now);
+
+/// The number of events created so far, including copies.
+size_t STZMemoryBackendGetCreatedEventCount(void);
+
+/// The number of times fields, the location or the timestamp of any event have been read or
+/// written so far. Each is a call into the window server’s event on macOS.
+size_t STZMemoryBackendGetFieldAccessCount(void);
+
+/// Every point is on one display, whose refresh interval defaults to 60 Hz.
+void STZMemoryBackendSetDisplayFrameInterval(CGEventTimestamp interval);
+
+typedef void (*STZMemoryBackendPostCallback)(CGEventTapLocation location, CGEventRef event, void *__nullable refcon);
+void STZMemoryBackendSetPostCallback(STZMemoryBackendPostCallback __nullable callback, void *__nullable refcon);
+
+/// Log messages are formatted with `vfprintf` and written to `stderr` when enabled.
+void STZMemoryBackendSetLoggingEnabled(bool enabled);
@@ -0,0 +1,137 @@
+/*
+ *  STZPrefixTrie.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZPrefixTrie.h"
+
+
+typedef OPTION_FLAGS(uint8_t) {
+    kExactRule      = 1 << 0,
+    kPrefixRule     = 1 << 1,
+} RuleKinds;
+
+
+//  Children are kept as a sibling list sorted by byte. Bundle IDs use few distinct bytes, so a
+//  scan is as fast as anything fancier.
+typedef struct {
+    uint32_t        firstChild;  ///< 0 means none; the root is never a child.
+    uint32_t        nextSibling;
+    uint32_t        exactValue;
+    uint32_t        prefixValue;
+    uint8_t         byte;
+    RuleKinds       rules;
+} Node;
+
+static uint32_t const kNotFound = UINT32_MAX;
+
+
+struct _STZPrefixTrie {
+    Node           *nodes;
+    uint32_t        count;
+    uint32_t        capacity;
+};
+
+
+STZPrefixTrieRef STZPrefixTrieCreate(void) {
+    STZPrefixTrieRef trie = malloc(sizeof(struct _STZPrefixTrie));
+    trie->capacity = 32;
+    trie->count = 1;
+    trie->nodes = malloc(sizeof(Node) * trie->capacity);
+    trie->nodes[0] = (Node){0};
+    return trie;
+}
+
+
+void STZPrefixTrieRelease(STZPrefixTrieRef trie) {
+    free(trie->nodes);
+    free(trie);
+}
+
+
+static uint32_t findChild(STZPrefixTrieRef trie, uint32_t parent, uint8_t byte) {
+    uint32_t i = trie->nodes[parent].firstChild;
+    while (i != 0 && trie->nodes[i].byte < byte) {
+        i = trie->nodes[i].nextSibling;
+    }
+    return i != 0 && trie->nodes[i].byte == byte ? i : kNotFound;
+}
+
+
+static uint32_t addChild(STZPrefixTrieRef trie, uint32_t parent, uint8_t byte) {
+    uint32_t *link = &trie->nodes[parent].firstChild;
+    while (*link != 0 && trie->nodes[*link].byte < byte) {
+        link = &trie->nodes[*link].nextSibling;
+    }
+    if (*link != 0 && trie->nodes[*link].byte == byte) {return *link;}
+
+    if (trie->count == trie->capacity) {
+        //  `link` points into the array, so keep its offset across the reallocation.
+        size_t offset = (char *)link - (char *)trie->nodes;
+        trie->capacity *= 2;
+        trie->nodes = realloc(trie->nodes, sizeof(Node) * trie->capacity);
+        link = (uint32_t *)((char *)trie->nodes + offset);
+    }
+
+    uint32_t i = trie->count++;
+    trie->nodes[i] = (Node){
+        .firstChild = 0,
+        .nextSibling = *link,
+        .byte = byte,
+        .rules = 0,
+    };
+    *link = i;
+    return i;
+}
+
+
+static bool isPrefixRule(char const *rule, size_t length) {
+    return length > 0 && rule[length - 1] == '*';
+}
+
+
+void STZPrefixTrieAddRule(STZPrefixTrieRef trie, char const *rule, size_t length, uint32_t value) {
+    bool prefix = isPrefixRule(rule, length);
+    if (prefix) {length -= 1;}
+
+    uint32_t node = 0;
+    for (size_t i = 0; i < length; ++i) {
+        node = addChild(trie, node, (uint8_t)rule[i]);
+    }
+
+    if (prefix) {
+        trie->nodes[node].rules |= kPrefixRule;
+        trie->nodes[node].prefixValue = value;
+    } else {
+        trie->nodes[node].rules |= kExactRule;
+        trie->nodes[node].exactValue = value;
+    }
+}
+
+
+bool STZPrefixTrieMatch(STZPrefixTrieRef trie, char const *string, size_t length, uint32_t *outValue) {
+    bool found = false;
+    uint32_t node = 0;
+    size_t i = 0;
+
+    while (true) {
+        Node const *n = &trie->nodes[node];
+        if (i == length && (n->rules & kExactRule)) {
+            *outValue = n->exactValue;
+            return true;
+        }
+        if (n->rules & kPrefixRule) {
+            *outValue = n->prefixValue;
+            found = true;
+        }
+
+        if (i == length) {break;}
+        node = findChild(trie, node, (uint8_t)string[i++]);
+        if (node == kNotFound) {break;}
+    }
+
+    return found;
+}
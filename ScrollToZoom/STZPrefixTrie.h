@@ -0,0 +1,33 @@
+/*
+ *  STZPrefixTrie.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  A byte trie of rules, each carrying a 32-bit value. A rule ending with `*` is a prefix rule
+//  that matches every string starting with the rest of it, including that string itself; `*`
+//  elsewhere has no special meaning. Other rules match exactly. Matching takes time linear in
+//  the length of the string, however many rules there are.
+
+typedef struct _STZPrefixTrie *STZPrefixTrieRef;
+
+STZPrefixTrieRef STZPrefixTrieCreate(void);
+void STZPrefixTrieRelease(STZPrefixTrieRef);
+
+/// Adding a rule again replaces its value. Rules are UTF-8 and needn’t be NUL-terminated.
+void STZPrefixTrieAddRule(STZPrefixTrieRef, char const *rule, size_t length, uint32_t value);
+
+/// An exact rule wins over prefix rules; otherwise the longest matching prefix rule wins.
+/// Returns false if no rule matches.
+bool STZPrefixTrieMatch(STZPrefixTrieRef, char const *string, size_t length, uint32_t *outValue);
+
+
+CF_ASSUME_NONNULL_END
@@ -8,13 +8,26 @@
 
 #pragma once
 #include <CoreFoundation/CoreFoundation.h>
+#include "STZAppRegistry.h"
 
 CF_IMPLICIT_BRIDGING_ENABLED
 CF_ASSUME_NONNULL_BEGIN
 
 
+/// Records the running applications and starts observing launches and terminations. Call it on
+/// the main thread at launch; otherwise the first lookup does it on the event path.
+void STZStartTrackingProcesses(void);
+
 uint64_t STZRunningApplicationsSnapshotVersion(void);
-CFStringRef __nullable STZGetBundleIdentifierForProcessID(pid_t pid);
+
+/// Never blocks, so it’s safe to call in event taps. Returns `kSTZNoAppID` if the process has no
+/// bundle identifier, and also for an app whose launch hasn’t been observed yet, in which case it
+/// is looked up once the main run loop is free again.
+STZAppID STZGetAppIDForProcessID(pid_t pid);
+
+/// Whether the process is being looked up after `STZGetAppIDForProcessID` answered `kSTZNoAppID`
+/// for it, so that it may still turn out to be an app. Main thread only.
+bool STZIsResolvingProcessID(pid_t pid);
 CFURLRef __nullable STZGetInstalledURLForBundleIdentifier(CFStringRef);
 
 
@@ -7,28 +7,35 @@
  */
 
 #import "STZProcessManager.h"
+#import "STZSettings.h"
+#import "STZAppEngine.h"
+#import "STZProcessTable.h"
 #import <Foundation/Foundation.h>
 #import <AppKit/NSRunningApplication.h>
 
 
-#define CACHE_CAPACITY 32
-
-
 __attribute__((objc_direct_members))
 @interface STZBundleIdentifierManager : NSObject
 
 + (STZBundleIdentifierManager *)sharedManager;
 - (uint64_t)runningApplicationsSnapshotVersion;
-- (NSString *__nullable)bundleIdentifierForProcessID:(pid_t)pid;
+- (STZAppID)appIDForProcessID:(pid_t)pid;
+- (BOOL)isResolvingProcessID:(pid_t)pid;
 
 @end
 
 
 @implementation STZBundleIdentifierManager {
-    //  `pid_t` on macOS is an integer and an NSNumber can be a tagged pointer, which is efficient.
-    NSCache        *_caches;
+    //  Filled from the running applications up front and kept in step with their changes, so
+    //  that event taps never wait for AppKit to look up a process.
+    STZProcessTableRef _processes;
     NSWorkspace    *_workspace;
+    NSMutableIndexSet *_resolvingPIDs;
     uint64_t        _snapshotVersion;
+
+    //  Bundles are scanned on this queue, which alone touches the cache.
+    dispatch_queue_t _detectionQueue;
+    STZAppEngineCacheRef _engineCache;
 }
 
 static void *STZRunningApplicationsKVO = &STZRunningApplicationsKVO;
@@ -37,17 +44,23 @@ static void *STZRunningApplicationsKVO = &STZRunningApplicationsKVO;
     [_workspace removeObserver:self
                     forKeyPath:@"runningApplications"
                        context:STZRunningApplicationsKVO];
+    STZProcessTableRelease(_processes);
+    if (_engineCache) {
+        STZAppEngineCacheRelease(_engineCache);
+    }
 }
 
 - (instancetype)init {
     self = [super init];
-    _caches = [[NSCache alloc] init];
-    [_caches setCountLimit:CACHE_CAPACITY];
+    _processes = STZProcessTableCreate();
+    _resolvingPIDs = [[NSMutableIndexSet alloc] init];
+    _detectionQueue = dispatch_queue_create("STZAppEngineDetection", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
 
+    //  The initial notification covers apps already running.
     _workspace = [NSWorkspace sharedWorkspace];
     [_workspace addObserver:self
                 forKeyPath:@"runningApplications"
-                   options:NSKeyValueObservingOptionOld
+                   options:NSKeyValueObservingOptionOld | NSKeyValueObservingOptionNew | NSKeyValueObservingOptionInitial
                    context:STZRunningApplicationsKVO];
 
     return self;
@@ -71,32 +84,114 @@ static void *STZRunningApplicationsKVO = &STZRunningApplicationsKVO;
 
     _snapshotVersion += 1;
 
-    if (![[change valueForKey:NSKeyValueChangeKindKey] isEqualToNumber:@(NSKeyValueChangeRemoval)]) {
+    NSKeyValueChange kind = [[change valueForKey:NSKeyValueChangeKindKey] unsignedIntegerValue];
+    if (kind == NSKeyValueChangeInsertion || kind == NSKeyValueChangeSetting) {
+        NSArray<NSRunningApplication *> *apps = [change valueForKey:NSKeyValueChangeNewKey];
+
+        //  The initial pass interns every running app; publish the settings once for all.
+        STZSettingsBeginBatch();
+        for (NSRunningApplication *app in apps) {
+            [self recordApplication:app];
+        }
+        STZSettingsEndBatch();
+        [self detectEnginesOfApplications:apps];
+        return;
+    }
+
+    if (kind != NSKeyValueChangeRemoval) {
         return;
     }
 
     for (NSRunningApplication *app in [change valueForKey:NSKeyValueChangeOldKey]) {
-        NSNumber *key = @([app processIdentifier]);
-        [_caches removeObjectForKey:key];
+        STZProcessTableRemove(_processes, [app processIdentifier]);
     }
 }
 
-- (uint64_t)runningApplicationsSnapshotVersion {
-    return _snapshotVersion;
+- (void)recordApplication:(NSRunningApplication *)app {
+    pid_t pid = [app processIdentifier];
+    if (pid <= 0) {return;}
+
+    NSString *bundleID = [app bundleIdentifier];
+    STZAppID appID = bundleID ? STZGetAppIDForBundleIdentifier((__bridge void *)bundleID) : kSTZNoAppID;
+    STZProcessTableSetAppID(_processes, pid, appID, _snapshotVersion);
+}
+
+- (void)detectEnginesOfApplications:(NSArray<NSRunningApplication *> *)apps {
+    NSMutableArray<NSString *> *bundleIDs = [NSMutableArray array];
+    NSMutableArray<NSString *> *bundlePaths = [NSMutableArray array];
+
+    for (NSRunningApplication *app in apps) {
+        NSString *bundleID = [app bundleIdentifier];
+        NSString *bundlePath = [[app bundleURL] path];
+        if (!bundleID || !bundlePath) {continue;}
+        [bundleIDs addObject:bundleID];
+        [bundlePaths addObject:bundlePath];
+    }
+
+    if (![bundleIDs count]) {return;}
+
+    dispatch_async(_detectionQueue, ^{
+        if (!self->_engineCache) {
+            self->_engineCache = STZAppEngineCacheCreate([[self engineCachePath] fileSystemRepresentation]);
+        }
+
+        NSMutableArray<NSNumber *> *engines = [NSMutableArray array];
+        for (NSString *bundlePath in bundlePaths) {
+            [engines addObject:@(STZAppEngineCacheGetEngine(self->_engineCache, [bundlePath fileSystemRepresentation]))];
+        }
+        STZAppEngineCacheSave(self->_engineCache);
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            STZSettingsBeginBatch();
+            for (NSUInteger i = 0; i < [bundleIDs count]; ++i) {
+                STZAppEngine engine = [engines[i] unsignedCharValue];
+                STZAppOptions options = engine != kSTZAppEngineNative ? kSTZFixesZoomForChromiumApp : 0;
+                STZSetDetectedAppOptionsForBundleIdentifier((__bridge void *)bundleIDs[i], options);
+            }
+            STZSettingsEndBatch();
+        });
+    });
 }
 
-- (NSString *)bundleIdentifierForProcessID:(pid_t)pid {
-    NSNumber *key = @(pid);
+- (NSString *)engineCachePath {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSURL *cachesURL = [[fileManager URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+    NSURL *directoryURL = [cachesURL URLByAppendingPathComponent:[[NSBundle mainBundle] bundleIdentifier] isDirectory:YES];
+    [fileManager createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+    return [[directoryURL URLByAppendingPathComponent:@"AppEngines.cache"] path];
+}
 
-    NSString *bundleID = [_caches objectForKey:key];
-    if (bundleID) {return bundleID;}
+- (uint64_t)runningApplicationsSnapshotVersion {
+    return _snapshotVersion;
+}
 
-    NSRunningApplication *app = [NSRunningApplication runningApplicationWithProcessIdentifier:pid];
-    bundleID = [app bundleIdentifier];
-    if (!bundleID) {return nil;}
+- (STZAppID)appIDForProcessID:(pid_t)pid {
+    if (pid <= 0) {return kSTZNoAppID;}
+
+    STZAppID appID;
+    if (STZProcessTableGetAppID(_processes, pid, _snapshotVersion, &appID)) {return appID;}
+
+    //  Either the process isn’t an app, or its launch hasn’t been observed yet. Answer no app for
+    //  now, which also holds back repeated lookups until the snapshot changes, and ask AppKit
+    //  after the current callback returns.
+    uint64_t version = _snapshotVersion;
+    STZProcessTableSetAppID(_processes, pid, kSTZNoAppID, version);
+    [_resolvingPIDs addIndex:(NSUInteger)pid];
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self->_resolvingPIDs removeIndex:(NSUInteger)pid];
+        if (self->_snapshotVersion != version) {return;}  //  Observed meanwhile.
+        NSRunningApplication *app = [NSRunningApplication runningApplicationWithProcessIdentifier:pid];
+        if (app) {
+            [self recordApplication:app];
+        }
+    });
+
+    return kSTZNoAppID;
+}
 
-    [_caches setObject:bundleID forKey:key];
-    return bundleID;
+- (BOOL)isResolvingProcessID:(pid_t)pid {
+    return pid > 0 && [_resolvingPIDs containsIndex:(NSUInteger)pid];
 }
 
 @end
@@ -107,8 +202,18 @@ uint64_t STZRunningApplicationsSnapshotVersion(void) {
 }
 
 
-CFStringRef STZGetBundleIdentifierForProcessID(pid_t pid) {
-    return (__bridge void *)[[STZBundleIdentifierManager sharedManager] bundleIdentifierForProcessID:pid];
+void STZStartTrackingProcesses(void) {
+    [STZBundleIdentifierManager sharedManager];
+}
+
+
+STZAppID STZGetAppIDForProcessID(pid_t pid) {
+    return [[STZBundleIdentifierManager sharedManager] appIDForProcessID:pid];
+}
+
+
+bool STZIsResolvingProcessID(pid_t pid) {
+    return [[STZBundleIdentifierManager sharedManager] isResolvingProcessID:pid];
 }
 
 
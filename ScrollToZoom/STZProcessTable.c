@@ -0,0 +1,143 @@
+/*
+ *  STZProcessTable.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZProcessTable.h"
+
+
+typedef struct {
+    int32_t         pid;  ///< 0 for empty slots; PIDs of real processes are positive.
+    STZAppID        appID;
+    uint64_t        version;
+} Slot;
+
+
+struct _STZProcessTable {
+    Slot           *slots;
+    uint32_t        mask;
+    uint32_t        count;
+};
+
+
+static uint32_t const kInitialCapacity = 256;
+
+
+static uint32_t hashPID(int32_t pid) {
+    //  PIDs are mostly sequential and would otherwise fill runs of adjacent slots. Multiplying by
+    //  an odd constant is still a bijection on the low bits, so distinct PIDs below the capacity
+    //  never share a home slot.
+    return (uint32_t)pid * 2654435769u;
+}
+
+
+static uint32_t homeOf(STZProcessTableRef table, int32_t pid) {
+    return hashPID(pid) & table->mask;
+}
+
+
+STZProcessTableRef STZProcessTableCreate(void) {
+    STZProcessTableRef table = malloc(sizeof(struct _STZProcessTable));
+    table->slots = calloc(kInitialCapacity, sizeof(Slot));
+    table->mask = kInitialCapacity - 1;
+    table->count = 0;
+    return table;
+}
+
+
+void STZProcessTableRelease(STZProcessTableRef table) {
+    free(table->slots);
+    free(table);
+}
+
+
+static Slot *findSlot(STZProcessTableRef table, int32_t pid) {
+    uint32_t i = homeOf(table, pid);
+    while (table->slots[i].pid != 0) {
+        if (table->slots[i].pid == pid) {return &table->slots[i];}
+        i = (i + 1) & table->mask;
+    }
+    return &table->slots[i];
+}
+
+
+static void grow(STZProcessTableRef table) {
+    Slot *oldSlots = table->slots;
+    uint32_t oldCapacity = table->mask + 1;
+
+    table->slots = calloc(oldCapacity * 2, sizeof(Slot));
+    table->mask = oldCapacity * 2 - 1;
+
+    for (uint32_t i = 0; i < oldCapacity; ++i) {
+        if (oldSlots[i].pid != 0) {
+            *findSlot(table, oldSlots[i].pid) = oldSlots[i];
+        }
+    }
+
+    free(oldSlots);
+}
+
+
+bool STZProcessTableGetAppID(STZProcessTableRef table, int32_t pid, uint64_t version, STZAppID *outAppID) {
+    if (pid <= 0) {return false;}
+
+    Slot const *slot = findSlot(table, pid);
+    if (slot->pid == 0) {return false;}
+    if (slot->appID == kSTZNoAppID && slot->version != version) {return false;}
+
+    *outAppID = slot->appID;
+    return true;
+}
+
+
+void STZProcessTableSetAppID(STZProcessTableRef table, int32_t pid, STZAppID appID, uint64_t version) {
+    assert(pid > 0);
+
+    Slot *slot = findSlot(table, pid);
+    if (slot->pid == 0) {
+        //  Keep the load factor at most one half so that probe sequences stay short.
+        if ((table->count + 1) * 2 > table->mask + 1) {
+            grow(table);
+            slot = findSlot(table, pid);
+        }
+        table->count += 1;
+    }
+
+    *slot = (Slot){pid, appID, version};
+}
+
+
+void STZProcessTableRemove(STZProcessTableRef table, int32_t pid) {
+    if (pid <= 0) {return;}
+
+    Slot *slot = findSlot(table, pid);
+    if (slot->pid == 0) {return;}
+    table->count -= 1;
+
+    //  Shift later members of the probe sequence back instead of leaving a tombstone, so that
+    //  processes coming and going never degrade lookups.
+    uint32_t hole = (uint32_t)(slot - table->slots);
+    uint32_t i = hole;
+
+    while (true) {
+        i = (i + 1) & table->mask;
+        if (table->slots[i].pid == 0) {break;}
+
+        uint32_t home = homeOf(table, table->slots[i].pid);
+        bool movable = hole <= i ? (home <= hole || home > i) : (home <= hole && home > i);
+        if (movable) {
+            table->slots[hole] = table->slots[i];
+            hole = i;
+        }
+    }
+
+    table->slots[hole] = (Slot){0};
+}
+
+
+uint32_t STZProcessTableGetCount(STZProcessTableRef table) {
+    return table->count;
+}
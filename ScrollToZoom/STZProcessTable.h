@@ -0,0 +1,39 @@
+/*
+ *  STZProcessTable.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZAppRegistry.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Maps process IDs to app IDs with open addressing, so that a lookup is a few probes without
+//  allocation, locking or calls into AppKit.
+//
+//  Every entry is stamped with the version of the running applications snapshot it was written
+//  at. An entry with an app ID stays valid until the process is removed; an entry recording that
+//  a process has no app ID is only valid at its own version, since the process may have been
+//  registered as an app since.
+
+typedef struct _STZProcessTable *STZProcessTableRef;
+
+STZProcessTableRef STZProcessTableCreate(void);
+void STZProcessTableRelease(STZProcessTableRef);
+
+/// Returns false if there is no valid entry at `version`, in which case the caller should
+/// resolve the process off the event path and set the result.
+bool STZProcessTableGetAppID(STZProcessTableRef, int32_t pid, uint64_t version, STZAppID *outAppID);
+
+/// `pid` must be positive. `appID` may be `kSTZNoAppID`.
+void STZProcessTableSetAppID(STZProcessTableRef, int32_t pid, STZAppID appID, uint64_t version);
+void STZProcessTableRemove(STZProcessTableRef, int32_t pid);
+
+uint32_t STZProcessTableGetCount(STZProcessTableRef);
+
+
+CF_ASSUME_NONNULL_END
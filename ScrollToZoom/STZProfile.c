@@ -0,0 +1,95 @@
+/*
+ *  STZProfile.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZProfile.h"
+#include <math.h>
+
+
+static STZProfileSettings const profileSettings[] = {
+    [kSTZProfileBalanced] = {
+        .wantsDictatorship = true,
+        .mutableTapsLingerTime = 0.2,
+        .maxTapSwitchesPerSecond = 8,
+        .zoomCoalescingWindow = 0,
+        .targetFrameRate = 0,
+        .logsScrollEvents = true,
+    },
+
+    //  Other taps may see events first, so none of our taps wait for them. Taps switch back to
+    //  passive soon, and zoom changes are neither held back nor paced below the display.
+    [kSTZProfileLowLatency] = {
+        .wantsDictatorship = false,
+        .mutableTapsLingerTime = 0.05,
+        .maxTapSwitchesPerSecond = 16,
+        .zoomCoalescingWindow = 0,
+        .targetFrameRate = 0,
+        .logsScrollEvents = false,
+    },
+
+    //  Zoom changes are merged to at most one per 60 Hz frame, since each makes the app lay out.
+    //  Merged changes go out with the next scroll event rather than on a timer, so this costs up
+    //  to a frame of latency, and a timer wakeup every other frame or so while zooming to notice
+    //  the input stopping, far fewer than the events saved. Taps are reconfigured rarely.
+    [kSTZProfileLowPower] = {
+        .wantsDictatorship = false,
+        .mutableTapsLingerTime = 0.5,
+        .maxTapSwitchesPerSecond = 4,
+        .zoomCoalescingWindow = 1.0 / 60,
+        .targetFrameRate = 60,
+        .logsScrollEvents = false,
+    },
+};
+
+
+STZProfileSettings STZGetProfileSettings(STZProfile profile) {
+    assert(profile > kSTZProfileCustom && profile <= kSTZProfileLowPower);
+    return profileSettings[profile];
+}
+
+
+/// Settings are stored after clamping and conversion, so compare with some slack.
+static bool isClose(double a, double b) {
+    return fabs(a - b) < 1e-6;
+}
+
+
+STZProfile STZGetCurrentProfile(void) {
+    bool wantsDictatorship = (STZGetPreferredModes() & kSTZWantsDictatorship) != 0;
+
+    for (STZProfile profile = kSTZProfileBalanced; profile <= kSTZProfileLowPower; ++profile) {
+        STZProfileSettings const *settings = &profileSettings[profile];
+        if (settings->wantsDictatorship == wantsDictatorship
+         && isClose(settings->mutableTapsLingerTime, STZGetMutableTapsLingerTime())
+         && settings->maxTapSwitchesPerSecond == STZGetMaxTapSwitchesPerSecond()
+         && isClose(settings->zoomCoalescingWindow, STZGetZoomCoalescingWindow())
+         && isClose(settings->targetFrameRate, STZGetTargetFrameRate())
+         && settings->logsScrollEvents == STZGetLogsScrollEvents()) {
+            return profile;
+        }
+    }
+
+    return kSTZProfileCustom;
+}
+
+
+void STZApplyProfile(STZProfile profile) {
+    if (profile == kSTZProfileCustom) {return;}
+    STZProfileSettings const *settings = &profileSettings[profile];
+
+    STZModes modes = STZGetPreferredModes() & ~kSTZWantsDictatorship;
+    if (settings->wantsDictatorship) {
+        modes |= kSTZWantsDictatorship;
+    }
+
+    STZSetPreferredModes(modes);
+    STZSetMutableTapsLingerTime(settings->mutableTapsLingerTime);
+    STZSetMaxTapSwitchesPerSecond(settings->maxTapSwitchesPerSecond);
+    STZSetZoomCoalescingWindow(settings->zoomCoalescingWindow);
+    STZSetTargetFrameRate(settings->targetFrameRate);
+    STZSetLogsScrollEvents(settings->logsScrollEvents);
+}
@@ -0,0 +1,47 @@
+/*
+ *  STZProfile.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZSettings.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Profiles set the settings that trade latency against power together, so that users don’t
+//  have to tune them one by one. A profile is not stored; the current one is whichever matches
+//  the settings, and changing any of them by hand makes it custom.
+
+
+typedef CLOSED_ENUM(uint8_t) {
+    kSTZProfileCustom,
+    kSTZProfileBalanced,    ///< The defaults.
+    kSTZProfileLowLatency,
+    kSTZProfileLowPower,
+} STZProfile;
+
+typedef struct {
+    bool                wantsDictatorship;          ///< See `kSTZWantsDictatorship`.
+    double              mutableTapsLingerTime;
+    int                 maxTapSwitchesPerSecond;
+    double              zoomCoalescingWindow;
+    double              targetFrameRate;
+    bool                logsScrollEvents;
+} STZProfileSettings;
+
+/// `profile` must not be `kSTZProfileCustom`.
+STZProfileSettings STZGetProfileSettings(STZProfile profile);
+
+STZProfile STZGetCurrentProfile(void);
+
+/// Sets the settings of the profile, and `kSTZWantsDictatorship` of the preferred modes. The
+/// caller should then set the working modes to the preferred ones. Does nothing for
+/// `kSTZProfileCustom`.
+void STZApplyProfile(STZProfile profile);
+
+
+CF_ASSUME_NONNULL_END
@@ -0,0 +1,351 @@
+/*
+ *  STZReplay.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#if STZ_HEADLESS
+
+#include "STZReplay.h"
+#include "CGEventSPI.h"
+#include "STZWheelTaps.h"
+#include "STZTapSlots.h"
+#include <math.h>
+#include <string.h>
+
+
+//  Latencies are counted in buckets of 0.1 ms for percentiles; longer ones than the coalescing
+//  window allows fall in the last bucket.
+#define kLatencyBucketCount 1024
+static CGEventTimestamp const kLatencyBucketWidth = NSEC_PER_SEC / 10000;
+
+
+struct _STZReplay {
+    STZReplayOptions    options;
+    STZReplayCallback   callback;
+    void               *refcon;
+    STZWheelTapsRef     taps;
+    CGEventTimestamp    startTime;
+    CGEventTimestamp    now;
+    CGEventTimestamp    nextUpdateTime;
+
+    //  Set while the hard taps handle an event; the event they pass on goes to the soft taps.
+    bool                inHardStage;
+    CGEventRef          passedToSoftStage;
+
+    //  Devices whose magic zoom recognition was published into the tap slots, which are global.
+    uint64_t            magicMice[kSTZTapSlotCount];
+    uint32_t            magicMouseCount;
+
+    //  When the oldest scroll of each device not yet reflected was discarded.
+    STZCacheRef         heldSince;
+
+    uint64_t            sessionPosts;
+    uint64_t            zoomEvents;
+    uint64_t            zoomChanges;
+    CGEventTimestamp    firstZoomTime;
+    CGEventTimestamp    lastZoomTime;
+    CGEventTimestamp    totalLatency;
+    CGEventTimestamp    maxLatency;
+    uint32_t            latencyCounts[kLatencyBucketCount];
+};
+
+
+static void recordStatistics(STZReplayRef replay, STZReplayEmission emission, CGEventRef event, uint64_t registryID) {
+    CGEventTimestamp *heldSince = STZCacheGetValue(replay->heldSince, registryID);
+
+    if (emission == kSTZReplayDiscarding) {
+        if (heldSince == NULL && STZWheelTapsIsZooming(replay->taps, registryID)) {
+            STZCacheSetValue(replay->heldSince, registryID, &replay->now);
+        }
+        return;
+    }
+
+    if (CGEventGetType(event) != kCGEventGesture) {return;}
+
+    if (replay->zoomEvents == 0) {
+        replay->firstZoomTime = replay->now;
+    }
+    replay->zoomEvents += 1;
+    replay->lastZoomTime = replay->now;
+
+    if (CGEventGetIntegerValueField(event, kCGGestureEventPhase) == kCGGesturePhaseChanged) {
+        CGEventTimestamp latency = heldSince ? replay->now - *heldSince : 0;
+        replay->zoomChanges += 1;
+        replay->totalLatency += latency;
+        if (replay->maxLatency < latency) {
+            replay->maxLatency = latency;
+        }
+
+        CGEventTimestamp bucket = latency / kLatencyBucketWidth;
+        replay->latencyCounts[bucket < kLatencyBucketCount ? bucket : kLatencyBucketCount - 1] += 1;
+    }
+
+    if (heldSince != NULL) {
+        STZCacheRemoveValue(replay->heldSince, registryID);
+    }
+}
+
+
+//  MARK: - Hooks of the wheel taps
+
+
+static void emitWheelEvent(STZWheelEmission emission, STZWheelDelivery delivery, CGEventRef event,
+                           uint64_t registryID, void *refcon) {
+    STZReplayRef replay = refcon;
+
+    //  The hard taps post the event they handled at their location when they have to return
+    //  NULL; either way it reaches the soft taps, which report it.
+    if (replay->inHardStage && emission == kSTZWheelUpdated) {
+        assert(replay->passedToSoftStage == NULL);
+        replay->passedToSoftStage = (CGEventRef)CFRetain(event);
+        return;
+    }
+
+    if (delivery == kSTZWheelPostedToSession) {
+        replay->sessionPosts += 1;
+    }
+
+    recordStatistics(replay, (STZReplayEmission)emission, event, registryID);
+    replay->callback(replay->now, (STZReplayEmission)emission, event, replay->refcon);
+}
+
+static void setWheelTapsMutable(bool tapsMutable, void *refcon) {
+    //  The switches are counted by the tap policy.
+}
+
+static void movePeriodicTimer(CGEventTimestamp deadline, CGEventTimestamp now, void *refcon) {
+    STZReplayRef replay = refcon;
+    replay->nextUpdateTime = deadline;
+}
+
+static STZAppOptions getAppOptionsForProcess(STZSettingsSnapshot const *settings, int32_t pid, void *refcon) {
+    STZReplayRef replay = refcon;
+    return (replay->options & kSTZReplayFixesChromiumZoomStall) ? kSTZFixesZoomForChromiumApp : 0;
+}
+
+
+STZReplayRef STZReplayCreate(STZReplayOptions options, STZReplayCallback callback, void *refcon) {
+    static STZWheelTapsHooks const hooks = {
+        .emit = emitWheelEvent,
+        .setTapsMutable = setWheelTapsMutable,
+        .moveTimer = movePeriodicTimer,
+        .getAppOptions = getAppOptionsForProcess,
+    };
+
+    STZReplayRef replay = malloc(sizeof(*replay));
+    replay->options = options;
+    replay->callback = callback;
+    replay->refcon = refcon;
+    replay->now = CGEventTimestampNow();
+    replay->startTime = replay->now;
+    replay->nextUpdateTime = 0;
+    replay->inHardStage = false;
+    replay->passedToSoftStage = NULL;
+    replay->magicMouseCount = 0;
+    replay->heldSince = STZCacheCreate(sizeof(CGEventTimestamp), 300 * NSEC_PER_SEC, NULL);
+    replay->sessionPosts = 0;
+    replay->zoomEvents = 0;
+    replay->zoomChanges = 0;
+    replay->firstZoomTime = 0;
+    replay->lastZoomTime = 0;
+    replay->totalLatency = 0;
+    replay->maxLatency = 0;
+    memset(replay->latencyCounts, 0, sizeof(replay->latencyCounts));
+
+    replay->taps = STZWheelTapsCreate(&hooks, replay);
+
+    STZWheelModes modes = 0;
+    if (options & kSTZReplayContinuesTriggeredZoom) {
+        modes |= kSTZWheelContinuesTriggeredZoom;
+    }
+    if (options & kSTZReplayWantsDictatorship) {
+        modes |= kSTZWheelUnderDictatorship;
+    }
+    STZWheelTapsSetModes(replay->taps, modes);
+    return replay;
+}
+
+
+void STZReplayRelease(STZReplayRef replay) {
+    for (uint32_t i = 0; i < replay->magicMouseCount; ++i) {
+        STZTapSlotRelease(replay->magicMice[i]);
+    }
+    STZWheelTapsRelease(replay->taps);
+    STZCacheRelease(replay->heldSince);
+    free(replay);
+}
+
+
+CGEventTimestamp STZReplayGetNextUpdateTime(STZReplayRef replay) {
+    return replay->nextUpdateTime;
+}
+
+
+/// Rounded down to the bucket width.
+static double latencyPercentile(STZReplayRef replay, double fraction) {
+    uint64_t rank = (uint64_t)ceil(replay->zoomChanges * fraction);
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < kLatencyBucketCount; ++i) {
+        count += replay->latencyCounts[i];
+        if (count >= rank) {
+            return (double)(i * kLatencyBucketWidth) / NSEC_PER_SEC;
+        }
+    }
+    return (double)replay->maxLatency / NSEC_PER_SEC;
+}
+
+
+STZReplayStatistics STZReplayGetStatistics(STZReplayRef replay) {
+    STZSchedulerStatistics scheduling = STZWheelTapsGetSchedulerStatistics(replay->taps);
+    STZTapPolicyStatistics tapping = STZWheelTapsGetPolicyStatistics(replay->taps, replay->now);
+    STZReplayStatistics statistics = {
+        .timerArms = scheduling.timerArms,
+        .timerMoves = scheduling.timerMoves,
+        .timerFirings = scheduling.firings,
+        .tapSwitches = tapping.switches,
+        .mutableTime = (double)tapping.mutableTime / NSEC_PER_SEC,
+        .sessionPosts = replay->sessionPosts,
+        .zoomEvents = replay->zoomEvents,
+        .zoomChanges = replay->zoomChanges,
+        .timerFiringsPerMinute = 0,
+        .zoomEventsPerSecond = 0,
+        .meanLatency = 0,
+        .p50Latency = 0,
+        .p99Latency = 0,
+        .maxLatency = (double)replay->maxLatency / NSEC_PER_SEC,
+    };
+
+    CGEventTimestamp duration = replay->now - replay->startTime;
+    if (duration > 0) {
+        statistics.timerFiringsPerMinute = (double)scheduling.firings * 60 * NSEC_PER_SEC / duration;
+    }
+
+    CGEventTimestamp span = replay->lastZoomTime - replay->firstZoomTime;
+    if (span > 0) {
+        statistics.zoomEventsPerSecond = (double)replay->zoomEvents * NSEC_PER_SEC / span;
+    }
+    if (replay->zoomChanges > 0) {
+        statistics.meanLatency = (double)replay->totalLatency / replay->zoomChanges / NSEC_PER_SEC;
+        statistics.p50Latency = latencyPercentile(replay, 0.5);
+        statistics.p99Latency = latencyPercentile(replay, 0.99);
+    }
+    return statistics;
+}
+
+
+//  MARK: - Input
+
+
+static void setNow(STZReplayRef replay, CGEventTimestamp now) {
+    replay->now = now;
+    STZMemoryBackendSetNow(now);
+}
+
+
+void STZReplayAdvanceTo(STZReplayRef replay, CGEventTimestamp time) {
+    if (time < replay->now) {
+        time = replay->now;
+    }
+
+    while (replay->nextUpdateTime != 0 && replay->nextUpdateTime <= time) {
+        setNow(replay, replay->nextUpdateTime);
+        replay->nextUpdateTime = 0;
+        STZWheelTapsTimerDidFire(replay->taps);
+    }
+
+    setNow(replay, time);
+}
+
+
+void STZReplaySetTriggerFlagsDown(STZReplayRef replay, bool down, CGEventTimestamp time) {
+    STZReplayAdvanceTo(replay, time);
+
+    CGEventRef event = CGEventCreate(NULL);
+    CGEventSetType(event, kCGEventFlagsChanged);
+    CGEventSetTimestamp(event, replay->now);
+    STZWheelTapsSetTriggerFlagsDown(replay->taps, down, event);
+    CFRelease(event);
+}
+
+
+void STZReplaySetMagicZoomActive(STZReplayRef replay, uint64_t registryID, bool active, CGEventTimestamp time) {
+    STZReplayAdvanceTo(replay, time);
+
+    //  The recognizer publishes into the tap slots before it calls back, as in STZMagicZoom.c.
+    bool claimed;
+    int slot = STZTapSlotBeginWriting(registryID, replay->now, &claimed);
+    if (slot >= 0) {
+        STZTapSlotPublish(slot, (STZTapState){active, replay->now});
+        STZTapSlotEndWriting(slot);
+
+        if (claimed && replay->magicMouseCount < kSTZTapSlotCount) {
+            replay->magicMice[replay->magicMouseCount++] = registryID;
+        }
+    }
+
+    STZWheelTapsSetMagicZoomPending(replay->taps, registryID, active);
+}
+
+
+void STZReplayScrollEvent(STZReplayRef replay, CGEventRef event) {
+    STZReplayAdvanceTo(replay, CGEventGetTimestamp(event));
+
+    //  Under dictatorship, an event passes the hard taps at the HID location first, then the soft
+    //  taps at the annotated session location. What the hard taps post goes to the session.
+    CGEventRef softEvent = event;
+    if (replay->options & kSTZReplayWantsDictatorship) {
+        replay->inHardStage = true;
+        CGEventRef passed = STZWheelTapsHardScrollEvent(replay->taps, event);
+        replay->inHardStage = false;
+
+        if (passed == NULL) {
+            softEvent = replay->passedToSoftStage;
+            if (softEvent == NULL) {return;}
+        }
+    }
+
+    if (!STZWheelTapsAreMutable(replay->taps)) {
+        STZWheelTapsPassiveScrollEvent(replay->taps, softEvent);
+        replay->callback(replay->now, kSTZReplayUpdated, softEvent, replay->refcon);
+    } else {
+        STZWheelTapsMutableScrollEvent(replay->taps, softEvent);
+    }
+
+    if (replay->passedToSoftStage != NULL) {
+        CFRelease(replay->passedToSoftStage);
+        replay->passedToSoftStage = NULL;
+    }
+}
+
+
+void STZReplayTrace(STZReplayRef replay, STZTraceReaderRef reader) {
+    STZTraceItem item;
+    while (STZTraceReaderNext(reader, &item)) {
+        switch (item.kind) {
+        case kSTZTraceScroll: {
+            CGEventRef event = STZTraceCreateScrollEvent(&item);
+            STZReplayScrollEvent(replay, event);
+            CFRelease(event);
+            break;
+        }
+
+        case kSTZTraceTrigger:
+            STZReplaySetTriggerFlagsDown(replay, item.trigger.down, item.timestamp);
+            break;
+
+        case kSTZTraceMagicZoom:
+            STZReplaySetMagicZoomActive(replay, item.registryID, item.magicZoomActive, item.timestamp);
+            break;
+
+        default:
+            STZReplayAdvanceTo(replay, item.timestamp);
+            break;
+        }
+    }
+}
+
+
+#endif
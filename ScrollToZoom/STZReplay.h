@@ -0,0 +1,99 @@
+/*
+ *  STZReplay.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZTrace.h"
+
+CF_IMPLICIT_BRIDGING_ENABLED
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Feeds recorded or synthetic input to the same wheel tap logic as STZEventHandling.c, by way of
+//  STZWheelTaps.c, but against the backend clock instead of the run loop. Taps switch between
+//  passive and mutable as they do in the app, so scroll events seen while they are passive are
+//  passed through unchanged. Only available with `STZ_HEADLESS`, where time only passes when the
+//  replay advances it, so a long session replays as fast as the state machine runs and produces
+//  the same output every time.
+
+
+/// Same values as `STZWheelEmission`.
+typedef CLOSED_ENUM(uint8_t) {
+    kSTZReplayUpdated,      ///< The input event, after the state machine updated it.
+    kSTZReplayDiscarding,   ///< The input event is discarded; the event passed is the input.
+    kSTZReplayPrepended,    ///< Posted before the input event.
+    kSTZReplayAppended,     ///< Posted after the input event.
+    kSTZReplayReplacing,    ///< Posted instead of the input event.
+    kSTZReplayPeriodic,     ///< Posted by the periodic update.
+    kSTZReplayReverting,    ///< Posted when a triggered zoom reverts to scrolling.
+    kSTZReplayCommandKey,   ///< Posted for an app that zooms by key commands.
+} STZReplayEmission;
+
+typedef void (*STZReplayCallback)(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *__nullable refcon);
+
+
+typedef OPTION_FLAGS(uint8_t) {
+    kSTZReplayContinuesTriggeredZoom    = 1 << 0,
+    kSTZReplayFixesChromiumZoomStall    = 1 << 1,
+
+    /// Scroll events pass the hard taps before the soft ones, and zoom events made by the soft
+    /// taps are posted to the session, as with `kSTZWantsDictatorship`.
+    kSTZReplayWantsDictatorship         = 1 << 2,
+} STZReplayOptions;
+
+
+typedef struct _STZReplay *STZReplayRef;
+
+STZReplayRef STZReplayCreate(STZReplayOptions options, STZReplayCallback callback, void *__nullable refcon);
+void STZReplayRelease(STZReplayRef);
+
+/// Runs the periodic updates that are due until `time`, then sets the clock to `time`. Time
+/// never goes backwards; earlier values are treated as the current time.
+void STZReplayAdvanceTo(STZReplayRef, CGEventTimestamp time);
+
+/// Advances to the timestamp of the scroll event, then transforms it. The event is not retained.
+void STZReplayScrollEvent(STZReplayRef, CGEventRef event);
+void STZReplaySetTriggerFlagsDown(STZReplayRef, bool down, CGEventTimestamp time);
+
+/// Stands in for Magic Mouse touches, whose recognizer is not part of the portable core.
+void STZReplaySetMagicZoomActive(STZReplayRef, uint64_t registryID, bool active, CGEventTimestamp time);
+
+/// Returns 0 if no periodic update is scheduled.
+CGEventTimestamp STZReplayGetNextUpdateTime(STZReplayRef);
+
+/// Feeds the remaining records of the trace, decoding them one at a time. Touch frames are
+/// skipped; the recorded magic zoom activations are replayed instead.
+void STZReplayTrace(STZReplayRef, STZTraceReaderRef reader);
+
+
+/// Counts zoom gesture events posted and timer activity since the replay was created, for
+/// comparing settings such as `STZSetZoomCoalescingWindow` on the same input.
+///
+/// The latency of a zoom change is how long the oldest scroll event folded into it has been
+/// held back by the state machine; a change posted for its own scroll event has none.
+typedef struct {
+    uint64_t            timerArms;              ///< Times the periodic update timer was armed.
+    uint64_t            timerMoves;             ///< Times it was moved while armed.
+    uint64_t            timerFirings;
+    double              timerFiringsPerMinute;  ///< Over the time replayed, i.e. wakeups of the app.
+    uint64_t            tapSwitches;            ///< Times the taps switched to mutable or back.
+    double              mutableTime;            ///< In seconds, while the taps were mutable.
+    uint64_t            sessionPosts;           ///< Posted to the session anew, passing its taps again.
+    uint64_t            zoomEvents;
+    uint64_t            zoomChanges;
+    double              zoomEventsPerSecond;    ///< Over the span from the first to the last one.
+    double              meanLatency;            ///< In seconds, over zoom changes.
+    double              p50Latency;             ///< In seconds, to 0.1 ms.
+    double              p99Latency;             ///< In seconds, to 0.1 ms.
+    double              maxLatency;             ///< In seconds.
+} STZReplayStatistics;
+
+STZReplayStatistics STZReplayGetStatistics(STZReplayRef);
+
+
+CF_ASSUME_NONNULL_END
+CF_IMPLICIT_BRIDGING_DISABLED
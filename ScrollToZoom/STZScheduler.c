@@ -0,0 +1,190 @@
+/*
+ *  STZScheduler.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZScheduler.h"
+
+
+struct _STZScheduler {
+    STZSchedulerEntry **heap;
+    uint32_t            count;
+    uint32_t            capacity;
+
+    CGEventTimestamp    timerDeadline;  ///< 0 if the timer is stopped.
+    uint64_t            timerArms;
+    uint64_t            timerMoves;
+    uint64_t            firings;
+    uint64_t            earlyFirings;
+    CGEventTimestamp    totalJitter;
+    CGEventTimestamp    maxJitter;
+};
+
+
+STZSchedulerRef STZSchedulerCreate(void) {
+    STZSchedulerRef scheduler = malloc(sizeof(struct _STZScheduler));
+    scheduler->heap = NULL;
+    scheduler->count = 0;
+    scheduler->capacity = 0;
+    scheduler->timerDeadline = 0;
+    scheduler->timerArms = 0;
+    scheduler->timerMoves = 0;
+    scheduler->firings = 0;
+    scheduler->earlyFirings = 0;
+    scheduler->totalJitter = 0;
+    scheduler->maxJitter = 0;
+    return scheduler;
+}
+
+
+void STZSchedulerRelease(STZSchedulerRef scheduler) {
+    for (uint32_t i = 0; i < scheduler->count; ++i) {
+        scheduler->heap[i]->deadline = 0;
+    }
+    free(scheduler->heap);
+    free(scheduler);
+}
+
+
+static void place(STZSchedulerRef scheduler, STZSchedulerEntry *entry, uint32_t index) {
+    scheduler->heap[index] = entry;
+    entry->index = index;
+}
+
+
+static void siftUp(STZSchedulerRef scheduler, uint32_t index) {
+    STZSchedulerEntry *entry = scheduler->heap[index];
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (scheduler->heap[parent]->deadline <= entry->deadline) {break;}
+        place(scheduler, scheduler->heap[parent], index);
+        index = parent;
+    }
+    place(scheduler, entry, index);
+}
+
+
+static void siftDown(STZSchedulerRef scheduler, uint32_t index) {
+    STZSchedulerEntry *entry = scheduler->heap[index];
+    while (true) {
+        uint32_t child = index * 2 + 1;
+        if (child >= scheduler->count) {break;}
+        if (child + 1 < scheduler->count && scheduler->heap[child + 1]->deadline < scheduler->heap[child]->deadline) {
+            child += 1;
+        }
+        if (entry->deadline <= scheduler->heap[child]->deadline) {break;}
+        place(scheduler, scheduler->heap[child], index);
+        index = child;
+    }
+    place(scheduler, entry, index);
+}
+
+
+void STZSchedulerSetDeadline(STZSchedulerRef scheduler, STZSchedulerEntry *entry, CGEventTimestamp deadline) {
+    if (entry->deadline == deadline) {return;}
+
+    if (entry->deadline == 0) {
+        if (scheduler->count == scheduler->capacity) {
+            scheduler->capacity = scheduler->capacity ? scheduler->capacity * 2 : 8;
+            scheduler->heap = realloc(scheduler->heap, sizeof(STZSchedulerEntry *) * scheduler->capacity);
+        }
+        entry->deadline = deadline;
+        place(scheduler, entry, scheduler->count++);
+        siftUp(scheduler, entry->index);
+        return;
+    }
+
+    uint32_t index = entry->index;
+    assert(index < scheduler->count && scheduler->heap[index] == entry);
+
+    if (deadline == 0) {
+        entry->deadline = 0;
+        scheduler->count -= 1;
+        if (index == scheduler->count) {return;}
+
+        //  Fill the hole with the last entry, which may belong either above or below it.
+        STZSchedulerEntry *last = scheduler->heap[scheduler->count];
+        place(scheduler, last, index);
+        siftUp(scheduler, index);
+        siftDown(scheduler, last->index);
+        return;
+    }
+
+    bool earlier = deadline < entry->deadline;
+    entry->deadline = deadline;
+    if (earlier) {
+        siftUp(scheduler, index);
+    } else {
+        siftDown(scheduler, index);
+    }
+}
+
+
+CGEventTimestamp STZSchedulerGetEarliestDeadline(STZSchedulerRef scheduler) {
+    return scheduler->count ? scheduler->heap[0]->deadline : 0;
+}
+
+
+bool STZSchedulerUpdateTimer(STZSchedulerRef scheduler, CGEventTimestamp *outDeadline) {
+    CGEventTimestamp deadline = STZSchedulerGetEarliestDeadline(scheduler);
+    if (deadline == 0) {return false;}
+
+    if (scheduler->timerDeadline == 0) {
+        scheduler->timerArms += 1;
+    } else if (deadline < scheduler->timerDeadline) {
+        scheduler->timerMoves += 1;
+    } else {
+        //  A later deadline is left to the firing that is already armed.
+        return false;
+    }
+
+    scheduler->timerDeadline = deadline;
+    *outDeadline = deadline;
+    return true;
+}
+
+
+void STZSchedulerForgetTimer(STZSchedulerRef scheduler) {
+    scheduler->timerDeadline = 0;
+}
+
+
+CGEventTimestamp STZSchedulerTimerDidFire(STZSchedulerRef scheduler, CGEventTimestamp now) {
+    CGEventTimestamp armed = scheduler->timerDeadline;
+    if (armed == 0) {return 0;}
+
+    //  The timer is spent either way; the next update arms it again if anything is left.
+    scheduler->timerDeadline = 0;
+    scheduler->firings += 1;
+
+    //  Deadlines that moved later since the timer was armed make it fire before any is due.
+    CGEventTimestamp earliest = STZSchedulerGetEarliestDeadline(scheduler);
+    CGEventTimestamp due = earliest > armed ? earliest : armed;
+    if (earliest == 0 || now < due) {
+        scheduler->earlyFirings += 1;
+        return 0;
+    }
+
+    CGEventTimestamp jitter = now - due;
+    scheduler->totalJitter += jitter;
+    if (scheduler->maxJitter < jitter) {
+        scheduler->maxJitter = jitter;
+    }
+    return jitter;
+}
+
+
+STZSchedulerStatistics STZSchedulerGetStatistics(STZSchedulerRef scheduler) {
+    uint64_t onTime = scheduler->firings - scheduler->earlyFirings;
+    return (STZSchedulerStatistics){
+        .timerArms = scheduler->timerArms,
+        .timerMoves = scheduler->timerMoves,
+        .firings = scheduler->firings,
+        .earlyFirings = scheduler->earlyFirings,
+        .meanJitter = onTime ? scheduler->totalJitter / onTime : 0,
+        .maxJitter = scheduler->maxJitter,
+    };
+}
@@ -0,0 +1,68 @@
+/*
+ *  STZScheduler.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Keeps the deadlines of many clients in a min-heap so that a single timer can serve all of
+//  them. Deadlines are `CGEventTimestamp`s, the same monotonic clock events are stamped with;
+//  only the owner of the timer converts the earliest one to the clock of its run loop.
+//
+//  The scheduler doesn’t own a timer. After changing deadlines, the owner asks whether its timer
+//  has to be armed or moved earlier, and only then touches it. A deadline that moves later, as
+//  one pushed back by every click of a scroll wheel does, leaves the timer alone; it fires early
+//  once and is armed again for the real deadline, instead of being moved on every change.
+
+
+/// Embedded in the client, which must not move while scheduled. Zero-initialize it.
+typedef struct {
+    CGEventTimestamp    deadline;  ///< 0 if not scheduled.
+    uint32_t            index;
+} STZSchedulerEntry;
+
+
+typedef struct _STZScheduler *STZSchedulerRef;
+
+STZSchedulerRef STZSchedulerCreate(void);
+void STZSchedulerRelease(STZSchedulerRef);
+
+/// Schedules, moves or, with a `deadline` of 0, cancels the entry.
+void STZSchedulerSetDeadline(STZSchedulerRef, STZSchedulerEntry *entry, CGEventTimestamp deadline);
+
+/// Returns 0 if nothing is scheduled.
+CGEventTimestamp STZSchedulerGetEarliestDeadline(STZSchedulerRef);
+
+/// Returns true if the timer should be armed or moved to `*outDeadline`: when it is not armed
+/// and something is scheduled, or the earliest deadline is now earlier than the armed one. The
+/// timer is never stopped; once nothing is scheduled, it fires early for the last time.
+bool STZSchedulerUpdateTimer(STZSchedulerRef, CGEventTimestamp *outDeadline);
+
+/// Takes the timer as not armed, e.g. after the owner invalidated it.
+void STZSchedulerForgetTimer(STZSchedulerRef);
+
+/// Called when the timer fires; records and returns how late it is, or 0 if it is early, i.e.
+/// no deadline is due yet. The next `STZSchedulerUpdateTimer` arms it again.
+CGEventTimestamp STZSchedulerTimerDidFire(STZSchedulerRef, CGEventTimestamp now);
+
+
+typedef struct {
+    uint64_t            timerArms;      ///< After the timer fired or before it ever did.
+    uint64_t            timerMoves;     ///< Of an armed timer, to an earlier deadline.
+    uint64_t            firings;
+    uint64_t            earlyFirings;
+    CGEventTimestamp    meanJitter;     ///< In nanoseconds, over firings that are not early.
+    CGEventTimestamp    maxJitter;
+} STZSchedulerStatistics;
+
+STZSchedulerStatistics STZSchedulerGetStatistics(STZSchedulerRef);
+
+
+CF_ASSUME_NONNULL_END
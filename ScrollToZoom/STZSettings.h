@@ -7,7 +7,7 @@
  */
 
 #pragma once
-#include "STZCommon.h"
+#include "STZAppRegistry.h"
 
 CF_IMPLICIT_BRIDGING_ENABLED
 CF_ASSUME_NONNULL_BEGIN
@@ -71,6 +71,38 @@ void STZSetMomentumZoomAttenuation(double);
 double STZGetMomentumZoomMinValue(void);
 void STZSetMomentumZoomMinValue(double);
 
+/// The window in seconds within which changes of a zoom gesture converted from continuous or
+/// momentum scrolls are merged into one event. High-rate devices and scroll smoothing tools emit
+/// several scrolls per display frame, and each zoom event makes the app lay out again.
+///
+/// The first change in a window is emitted at once and the rest with the first scroll event after
+/// the window, so zooming lags by about this much. Only if the input stops are they emitted by a
+/// timer, one more window later. Began and ended events are never held back, and an ended event
+/// carries what was. Set it to `0` to emit one zoom event per scroll event.
+double STZGetZoomCoalescingWindow(void);
+void STZSetZoomCoalescingWindow(double);
+
+/// The frame rate in Hz that delayed zoom events are paced to, e.g. after a discrete scroll or
+/// for the Chromium zoom fix. Set it to `0` to follow the refresh rate of the display where each
+/// zoom gesture begins.
+double STZGetTargetFrameRate(void);
+void STZSetTargetFrameRate(double);
+
+/// How long in seconds scroll wheel taps stay mutable after zooming no longer needs them, so
+/// that a jittery trigger key or short flicks don’t reconfigure the taps each time.
+double STZGetMutableTapsLingerTime(void);
+void STZSetMutableTapsLingerTime(double);
+
+/// The most times per second scroll wheel taps may switch between passive and mutable; beyond
+/// that, they stay mutable a little longer. Set it to `0` for no limit.
+int STZGetMaxTapSwitchesPerSecond(void);
+void STZSetMaxTapSwitchesPerSecond(int);
+
+/// Whether events passing the taps are logged one by one while logging is enabled. Formatting
+/// them takes time in the event taps; state changes are logged either way.
+bool STZGetLogsScrollEvents(void);
+void STZSetLogsScrollEvents(bool);
+
 
 typedef OPTION_FLAGS(uint32_t) {
     kSTZDisabledForApp          = 1 << 0,
@@ -85,11 +117,15 @@ typedef OPTION_FLAGS(uint32_t) {
     kSTZFixesZoomForChromiumApp = 1 << 3,
 } STZAppOptions;
 
+/// A bundle identifier ending with `*` is a prefix rule, which applies to every app whose bundle
+/// identifier starts with the rest of it and has no exact rule. Among prefix rules, the longest
+/// matching one wins. Rules set by the user win over recommended ones.
 STZAppOptions STZGetAppOptionsForBundleIdentifier(CFStringRef __nullable bundleID);
 void STZSetAppOptionsForBundleIdentifier(CFStringRef bundleID, STZAppOptions);
 
-/// Posted to the local center when `STZSetAppOptionsForBundleIdentifier` is called.
-/// The user info has a key `bundleIdentifier`, indicating options for what have changed.
+/// Posted to the local center when `STZSetAppOptionsForBundleIdentifier` is called, or when
+/// detection changes the recommended options of an app. The user info has a key
+/// `bundleIdentifier`, indicating options for what have changed.
 extern CFStringRef const kSTZAppOptionsDidChangeNotification;
 
 /// Returns all tap options keyed by the bundle identifier. The value is a raw pointer whose bit
@@ -98,6 +134,57 @@ CFDictionaryRef STZCopyOptionsForAllApps(void);
 
 STZAppOptions STZGetRecommendedAppOptionsForBundleIdentifier(CFStringRef bundleID);
 
+/// Options recommended after inspecting the app bundle, which apply only if no default rule
+/// covers the app. Used to fix zooming for Chromium-based apps we don’t list.
+void STZSetDetectedAppOptionsForBundleIdentifier(CFStringRef bundleID, STZAppOptions);
+
+
+//  MARK: - Snapshot
+
+/// The settings read by the event path, copied into an immutable snapshot. A new snapshot is
+/// published whenever a setter runs, so readers on any thread see a consistent set of values
+/// with plain loads.
+///
+/// A superseded snapshot is freed once no reader may hold it (see STZEpoch.h). Callbacks that
+/// read it run within `STZEpochBeginReading` and `STZEpochEndReading`, and must not keep it
+/// past the end.
+typedef struct {
+    /// Increases with every published snapshot.
+    uint64_t            version;
+
+    STZModes            preferredModes;
+    STZFlags            triggerFlags;
+    double              magnificationScalar;
+    double              momentumZoomAttenuation;
+    double              momentumZoomMinValue;
+    CGEventTimestamp    zoomCoalescingWindow;  ///< In nanoseconds.
+    CGEventTimestamp    frameInterval;         ///< In nanoseconds; 0 to follow the display.
+    CGEventTimestamp    mutableTapsLingerTime; ///< In nanoseconds.
+    uint32_t            maxTapSwitchesPerSecond;
+    bool                logsScrollEvents;
+
+    /// Options of every app interned when the snapshot was published, indexed by app ID.
+    STZAppOptions const *__nullable appOptions;
+    STZAppID            lastAppID;
+} STZSettingsSnapshot;
+
+/// Loads the user defaults on the first call, which should be made on the main thread.
+STZSettingsSnapshot const *STZGetSettingsSnapshot(void);
+
+/// Returns 0 for `kSTZNoAppID` and for apps interned after the snapshot was published.
+static inline STZAppOptions STZSettingsSnapshotGetAppOptions(STZSettingsSnapshot const *snapshot, STZAppID appID) {
+    return appID <= snapshot->lastAppID ? snapshot->appOptions[appID] : 0;
+}
+
+/// Interns the bundle ID. Snapshots published afterwards include options for the app, and one
+/// is published right away if the app is new, unless within a batch.
+STZAppID STZGetAppIDForBundleIdentifier(CFStringRef bundleID);
+
+/// Defers publishing snapshots until the outermost batch ends, so that interning or detecting
+/// many apps at once publishes one. Batches may nest; main thread only.
+void STZSettingsBeginBatch(void);
+void STZSettingsEndBatch(void);
+
 
 CF_ASSUME_NONNULL_END
 CF_IMPLICIT_BRIDGING_DISABLED
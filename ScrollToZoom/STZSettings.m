@@ -7,8 +7,12 @@
  */
 
 #import "STZSettings.h"
+#import "STZDefaultAppOptions.h"
+#import "STZEpoch.h"
+#import "STZPrefixTrie.h"
 #import "STZProcessManager.h"
 #import <Foundation/Foundation.h>
+#import <stdatomic.h>
 
 
 STZModes const kSTZModesAll = kSTZMagicZoomEnabled | kSTZTriggerFlagsEnabled | kSTZWantsDictatorship | kSTZRevertsToScrollImmediately;
@@ -19,6 +23,11 @@ STZFlags STZTriggerFlags = kSTZModifierOption;
 double STZMagnificationScalar = 0.0025;
 double STZMomentumZoomAttenuation = 0.8;
 double STZScrollMomentumZoomMinValue = 0.001;
+double STZZoomCoalescingWindow = 0;
+double STZTargetFrameRate = 0;
+double STZMutableTapsLingerTime = 0.2;
+int STZMaxTapSwitchesPerSecond = 8;
+bool STZLogsScrollEvents = true;
 CFMutableDictionaryRef STZOptionsForApps = NULL;
 CFMutableDictionaryRef STZOptionsObjsForApps = NULL;
 
@@ -28,6 +37,11 @@ static NSString *const STZTriggerFlagsKey = @"STZScrollToZoomFlags";
 static NSString *const STZMagnificationScalarKey = @"STZScrollToZoomMagnifier";
 static NSString *const STZMomentumZoomAttenuationKey = @"STZScrollMomentumToZoomAttenuation";
 static NSString *const STZScrollMomentumZoomMinValueKey = @"STZScrollMinMomentumMagnification";
+static NSString *const STZZoomCoalescingWindowKey = @"STZZoomCoalescingWindow";
+static NSString *const STZTargetFrameRateKey = @"STZTargetFrameRate";
+static NSString *const STZMutableTapsLingerTimeKey = @"STZMutableTapsLingerTime";
+static NSString *const STZMaxTapSwitchesPerSecondKey = @"STZMaxTapSwitchesPerSecond";
+static NSString *const STZLogsScrollEventsKey = @"STZLogsScrollEvents";
 static NSString *const STZOptionsForAppsKey = @"STZEventTapOptionsForApps";
 
 static NSString *const STZLegacyDisablesMagicZoomKey = @"STZDisableDotDashDragToZoom";
@@ -40,36 +54,12 @@ enum {
 };
 
 
-CFDictionaryRef STZDefaultOptionsForApps = NULL;
-
-static struct {
-    CFStringRef     bundleID;
-    STZAppOptions   options;
-} STZDefaultAppOptionsList[] = {
-    {CFSTR("org.mozilla.firefox"), kSTZFlagsExcludedForApp},
-
-    //  There’re plenty of Chromium-based apps; we can’t list all of them.
-    //  Most Electron apps don’t support zooming.
-    {CFSTR("org.chromium.Chromium"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("org.chromium.Thorium"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.google.Chrome"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.google.Chrome.beta"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.google.Chrome.canary"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.operasoftware.Opera"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.microsoft.edgemac"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.microsoft.edgemac.Beta"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.microsoft.edgemac.Canary"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.microsoft.edgemac.Dev"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.operasoftware.OperaNext"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.operasoftware.OperaDeveloper"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.operasoftware.OperaGX"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.vivaldi.Vivaldi"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.vivaldi.Vivaldi.snapshot"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("company.thebrowser.Browser"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("company.thebrowser.dia"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("com.brave.Browser"), kSTZFixesZoomForChromiumApp},
-    {CFSTR("ai.perplexity.comet"), kSTZFixesZoomForChromiumApp},
-};
+/// Bundle IDs are at most 255 bytes. Returns NULL if the string can’t be converted.
+static char const *getBundleIDBytes(CFStringRef bundleID, char buffer[static 256]) {
+    char const *bytes = CFStringGetCStringPtr(bundleID, kCFStringEncodingUTF8);
+    if (bytes) {return bytes;}
+    return CFStringGetCString(bundleID, buffer, 256, kCFStringEncodingUTF8) ? buffer : NULL;
+}
 
 
 static double clamp(double x, double lo, double hi) {
@@ -79,6 +69,22 @@ static double clamp(double x, double lo, double hi) {
 }
 
 
+/// Zero or negative means following the display.
+static double clampFrameRate(double rate) {
+    return rate > 0 ? clamp(rate, 24, 480) : 0;
+}
+
+
+/// Zero or negative means no limit. A limit of one would keep taps mutable for a second.
+static int clampSwitchLimit(int limit) {
+    return limit > 0 ? (int)clamp(limit, 2, 64) : 0;
+}
+
+
+static void publishSnapshot(void);
+static void rebuildUserRules(void);
+static void resolveOptionsForAllApps(void);
+
 static void _loadUserDefaultsIfNeeded(void) {
     static bool loaded = false;
     if (loaded) {return;}
@@ -113,15 +119,29 @@ static void _loadUserDefaultsIfNeeded(void) {
         STZScrollMomentumZoomMinValue = clamp([minMomentum doubleValue], 0, 1);
     }
 
-    if (!STZDefaultOptionsForApps) {
-        size_t count = sizeof(STZDefaultAppOptionsList) / sizeof(*STZDefaultAppOptionsList);
-        CFMutableDictionaryRef dict = CFDictionaryCreateMutable(kCFAllocatorDefault, count, &kCFTypeDictionaryKeyCallBacks, NULL);
-        for (size_t i = 0; i < count; ++i) {
-            CFStringRef bundleID = STZDefaultAppOptionsList[i].bundleID;
-            STZAppOptions options = STZDefaultAppOptionsList[i].options;
-            CFDictionarySetValue(dict, bundleID, (void *)(uintptr_t)options);
-        }
-        STZDefaultOptionsForApps = dict;
+    NSNumber *coalescingWindow = [userDefaults objectForKey:STZZoomCoalescingWindowKey];
+    if (coalescingWindow && [coalescingWindow isKindOfClass:[NSNumber self]]) {
+        STZZoomCoalescingWindow = clamp([coalescingWindow doubleValue], 0, 0.1);
+    }
+
+    NSNumber *frameRate = [userDefaults objectForKey:STZTargetFrameRateKey];
+    if (frameRate && [frameRate isKindOfClass:[NSNumber self]]) {
+        STZTargetFrameRate = clampFrameRate([frameRate doubleValue]);
+    }
+
+    NSNumber *lingerTime = [userDefaults objectForKey:STZMutableTapsLingerTimeKey];
+    if (lingerTime && [lingerTime isKindOfClass:[NSNumber self]]) {
+        STZMutableTapsLingerTime = clamp([lingerTime doubleValue], 0, 1);
+    }
+
+    NSNumber *switchLimit = [userDefaults objectForKey:STZMaxTapSwitchesPerSecondKey];
+    if (switchLimit && [switchLimit isKindOfClass:[NSNumber self]]) {
+        STZMaxTapSwitchesPerSecond = clampSwitchLimit([switchLimit intValue]);
+    }
+
+    NSNumber *logsScrollEvents = [userDefaults objectForKey:STZLogsScrollEventsKey];
+    if (logsScrollEvents && [logsScrollEvents isKindOfClass:[NSNumber self]]) {
+        STZLogsScrollEvents = [logsScrollEvents boolValue];
     }
 
     if (STZOptionsForApps) {
@@ -140,7 +160,7 @@ static void _loadUserDefaultsIfNeeded(void) {
             if (![number isKindOfClass:[NSNumber self]]) {continue;}
 
             NSInteger value = [number integerValue];
-            uintptr_t defaultValue = (uintptr_t)CFDictionaryGetValue(STZDefaultOptionsForApps, (__bridge void *)key);
+            uintptr_t defaultValue = STZGetRecommendedAppOptionsForBundleIdentifier((__bridge void *)key);
 
             if (version < kSTZAppOptionsVersionWithChromiumZoomFixes && (defaultValue & kSTZFixesZoomForChromiumApp)) {
                 value |= kSTZFixesZoomForChromiumApp;
@@ -154,6 +174,9 @@ static void _loadUserDefaultsIfNeeded(void) {
     }
 
     loaded = true;
+    rebuildUserRules();
+    resolveOptionsForAllApps();
+    publishSnapshot();
 }
 
 
@@ -163,7 +186,9 @@ STZModes STZGetPreferredModes(void) {
 }
 
 void STZSetPreferredModes(STZModes modes) {
+    _loadUserDefaultsIfNeeded();
     STZPreferredModes = modes & kSTZModesAll;
+    publishSnapshot();
     [[NSUserDefaults standardUserDefaults] setInteger:STZPreferredModes
                                                forKey:STZModesKey];
 }
@@ -175,7 +200,9 @@ STZFlags STZGetTriggerFlags(void) {
 }
 
 void STZSetTriggerFlags(STZFlags flags) {
+    _loadUserDefaultsIfNeeded();
     STZTriggerFlags = STZFlagsValidate(flags);
+    publishSnapshot();
     [[NSUserDefaults standardUserDefaults] setInteger:STZTriggerFlags
                                                forKey:STZTriggerFlagsKey];
 }
@@ -187,7 +214,9 @@ double STZGetMagnificationScalar(void) {
 }
 
 void STZSetMagnificationScalar(double magnifier) {
+    _loadUserDefaultsIfNeeded();
     STZMagnificationScalar = clamp(magnifier, -1, 1);
+    publishSnapshot();
     [[NSUserDefaults standardUserDefaults] setDouble:STZMagnificationScalar
                                               forKey:STZMagnificationScalarKey];
 }
@@ -199,7 +228,9 @@ double STZGetMomentumZoomAttenuation(void) {
 }
 
 void STZSetMomentumZoomAttenuation(double attenuation) {
+    _loadUserDefaultsIfNeeded();
     STZMomentumZoomAttenuation = clamp(attenuation, 0, 1);
+    publishSnapshot();
     [[NSUserDefaults standardUserDefaults] setDouble:STZMomentumZoomAttenuation
                                               forKey:STZMomentumZoomAttenuationKey];
 }
@@ -211,21 +242,98 @@ double STZGetMomentumZoomMinValue(void) {
 }
 
 void STZSetMomentumZoomMinValue(double minMagnification) {
+    _loadUserDefaultsIfNeeded();
     STZScrollMomentumZoomMinValue = clamp(minMagnification, 0, 1);
+    publishSnapshot();
     [[NSUserDefaults standardUserDefaults] setDouble:STZScrollMomentumZoomMinValue
                                               forKey:STZScrollMomentumZoomMinValueKey];
 }
 
 
+double STZGetZoomCoalescingWindow(void) {
+    _loadUserDefaultsIfNeeded();
+    return STZZoomCoalescingWindow;
+}
+
+void STZSetZoomCoalescingWindow(double window) {
+    _loadUserDefaultsIfNeeded();
+    STZZoomCoalescingWindow = clamp(window, 0, 0.1);
+    publishSnapshot();
+    [[NSUserDefaults standardUserDefaults] setDouble:STZZoomCoalescingWindow
+                                              forKey:STZZoomCoalescingWindowKey];
+}
+
+
+double STZGetTargetFrameRate(void) {
+    _loadUserDefaultsIfNeeded();
+    return STZTargetFrameRate;
+}
+
+void STZSetTargetFrameRate(double rate) {
+    _loadUserDefaultsIfNeeded();
+    STZTargetFrameRate = clampFrameRate(rate);
+    publishSnapshot();
+    [[NSUserDefaults standardUserDefaults] setDouble:STZTargetFrameRate
+                                              forKey:STZTargetFrameRateKey];
+}
+
+
+double STZGetMutableTapsLingerTime(void) {
+    _loadUserDefaultsIfNeeded();
+    return STZMutableTapsLingerTime;
+}
+
+void STZSetMutableTapsLingerTime(double time) {
+    _loadUserDefaultsIfNeeded();
+    STZMutableTapsLingerTime = clamp(time, 0, 1);
+    publishSnapshot();
+    [[NSUserDefaults standardUserDefaults] setDouble:STZMutableTapsLingerTime
+                                              forKey:STZMutableTapsLingerTimeKey];
+}
+
+
+int STZGetMaxTapSwitchesPerSecond(void) {
+    _loadUserDefaultsIfNeeded();
+    return STZMaxTapSwitchesPerSecond;
+}
+
+void STZSetMaxTapSwitchesPerSecond(int limit) {
+    _loadUserDefaultsIfNeeded();
+    STZMaxTapSwitchesPerSecond = clampSwitchLimit(limit);
+    publishSnapshot();
+    [[NSUserDefaults standardUserDefaults] setInteger:STZMaxTapSwitchesPerSecond
+                                               forKey:STZMaxTapSwitchesPerSecondKey];
+}
+
+
+bool STZGetLogsScrollEvents(void) {
+    _loadUserDefaultsIfNeeded();
+    return STZLogsScrollEvents;
+}
+
+void STZSetLogsScrollEvents(bool logs) {
+    _loadUserDefaultsIfNeeded();
+    STZLogsScrollEvents = logs;
+    publishSnapshot();
+    [[NSUserDefaults standardUserDefaults] setBool:STZLogsScrollEvents
+                                            forKey:STZLogsScrollEventsKey];
+}
+
+
+static STZAppOptions resolveOptions(char const *bytes, size_t length);
+
 STZAppOptions STZGetAppOptionsForBundleIdentifier(CFStringRef bundleID) {
     if (!bundleID) {return 0;}
     _loadUserDefaultsIfNeeded();
 
     void const *value;
-    if (!CFDictionaryGetValueIfPresent(STZOptionsForApps, bundleID, &value)) {
-        value = CFDictionaryGetValue(STZDefaultOptionsForApps, bundleID);
+    if (CFDictionaryGetValueIfPresent(STZOptionsForApps, bundleID, &value)) {
+        return (STZAppOptions)(uintptr_t)value;
     }
-    return (STZAppOptions)(uintptr_t)value;
+
+    char buffer[256];
+    char const *bytes = getBundleIDBytes(bundleID, buffer);
+    return bytes ? resolveOptions(bytes, strlen(bytes)) : 0;
 }
 
 void STZSetAppOptionsForBundleIdentifier(CFStringRef bundleID, STZAppOptions options) {
@@ -235,7 +343,7 @@ void STZSetAppOptionsForBundleIdentifier(CFStringRef bundleID, STZAppOptions opt
     if (CFDictionaryGetValueIfPresent(STZOptionsForApps, bundleID, &value)
      && (options == (uintptr_t)value)) {return;}
 
-    if (options == (uintptr_t)CFDictionaryGetValue(STZDefaultOptionsForApps, bundleID)) {
+    if (options == STZGetRecommendedAppOptionsForBundleIdentifier(bundleID)) {
         CFDictionaryRemoveValue(STZOptionsForApps, bundleID);
         CFDictionaryRemoveValue(STZOptionsObjsForApps, bundleID);
 
@@ -246,6 +354,12 @@ void STZSetAppOptionsForBundleIdentifier(CFStringRef bundleID, STZAppOptions opt
         CFRelease(number);
     }
 
+    //  A prefix rule may change any number of apps, so resolve them all again. There are only
+    //  as many as have been running since launch.
+    rebuildUserRules();
+    resolveOptionsForAllApps();
+    publishSnapshot();
+
     [[NSUserDefaults standardUserDefaults] setObject:(__bridge id)STZOptionsObjsForApps
                                               forKey:STZOptionsForAppsKey];
     [[NSUserDefaults standardUserDefaults] setInteger:kSTZAppOptionsVersionLatest
@@ -266,6 +380,245 @@ CFDictionaryRef STZCopyOptionsForAllApps(void) {
 }
 
 
+static STZAppOptions getRecommendedOptions(char const *bytes, size_t length);
+
 STZAppOptions STZGetRecommendedAppOptionsForBundleIdentifier(CFStringRef bundleID) {
-    return (STZAppOptions)(uintptr_t)CFDictionaryGetValue(STZDefaultOptionsForApps, bundleID);
+    char buffer[256];
+    char const *bytes = getBundleIDBytes(bundleID, buffer);
+    return bytes ? getRecommendedOptions(bytes, strlen(bytes)) : 0;
+}
+
+
+//  MARK: - Rules
+
+
+//  Keys of `STZOptionsForApps` ending with `*` are prefix rules, e.g. `com.microsoft.edgemac*`
+//  for every channel of Edge. An app’s options come from the first of:
+//
+//  1.  the user’s exact rule, or the longest of the user’s prefix rules matching it;
+//  2.  the default exact entry;
+//  3.  the longest default prefix rule matching it;
+//  4.  what detection found in the app bundle.
+//
+//  Options are resolved once per interned app and cached in `appOptionsByID`, so the event path
+//  never matches rules itself.
+
+static STZPrefixTrieRef userRules = NULL;
+static STZPrefixTrieRef defaultPrefixRules = NULL;
+
+//  Keyed by app ID; the value is the options. Apps with nothing detected have no entry.
+static CFMutableDictionaryRef detectedOptions = NULL;
+
+
+static void addUserRule(void const *key, void const *value, void *context) {
+    char buffer[256];
+    char const *bytes = getBundleIDBytes(key, buffer);
+    if (!bytes) {return;}
+    STZPrefixTrieAddRule(userRules, bytes, strlen(bytes), (STZAppOptions)(uintptr_t)value);
+}
+
+
+static void rebuildUserRules(void) {
+    if (userRules) {
+        STZPrefixTrieRelease(userRules);
+    }
+    userRules = STZPrefixTrieCreate();
+    CFDictionaryApplyFunction(STZOptionsForApps, addUserRule, NULL);
+}
+
+
+static STZPrefixTrieRef getDefaultPrefixRules(void) {
+    if (!defaultPrefixRules) {
+        defaultPrefixRules = STZPrefixTrieCreate();
+        for (size_t i = 0; i < kSTZDefaultAppPrefixRuleCount; ++i) {
+            STZPrefixTrieAddRule(defaultPrefixRules,
+                                 STZDefaultAppPrefixRules[i].rule,
+                                 STZDefaultAppPrefixRules[i].length,
+                                 STZDefaultAppPrefixRules[i].options);
+        }
+    }
+    return defaultPrefixRules;
+}
+
+
+/// Takes either a bundle ID or a rule. A prefix rule is recommended what the default prefix rules
+/// give the rest of it, since the exact entries it covers keep their own options anyway.
+static STZAppOptions getRecommendedOptions(char const *bytes, size_t length) {
+    uint32_t options;
+    bool isRule = length > 0 && bytes[length - 1] == '*';
+    if (isRule) {
+        length -= 1;
+    } else if (STZGetDefaultAppOptions(bytes, length, &options)) {
+        return options;
+    }
+
+    if (STZPrefixTrieMatch(getDefaultPrefixRules(), bytes, length, &options)) {return options;}
+    if (isRule || !detectedOptions) {return 0;}
+
+    STZAppID appID = STZAppRegistryLookup(bytes, length);
+    if (appID == kSTZNoAppID) {return 0;}
+    return (STZAppOptions)(uintptr_t)CFDictionaryGetValue(detectedOptions, (void *)(uintptr_t)appID);
+}
+
+
+static STZAppOptions resolveOptions(char const *bytes, size_t length) {
+    uint32_t options;
+    if (userRules && STZPrefixTrieMatch(userRules, bytes, length, &options)) {return options;}
+    return getRecommendedOptions(bytes, length);
+}
+
+
+//  MARK: - Snapshot
+
+
+static _Atomic(STZSettingsSnapshot const *) currentSnapshot = NULL;
+
+//  Publishing is deferred while positive; see `STZSettingsBeginBatch`.
+static int batchDepth = 0;
+static bool needsPublish = false;
+
+//  Options resolved for every interned app; entry 0 is for `kSTZNoAppID`.
+static STZAppOptions *appOptionsByID = NULL;
+static STZAppID appOptionsLastID = 0;
+static STZAppID appOptionsCapacity = 0;
+
+
+static void setOptionsForAppID(STZAppID appID, STZAppOptions options) {
+    if (appID >= appOptionsCapacity) {
+        STZAppID capacity = appOptionsCapacity ? appOptionsCapacity : 64;
+        while (capacity <= appID) {
+            capacity *= 2;
+        }
+        appOptionsByID = realloc(appOptionsByID, sizeof(STZAppOptions) * capacity);
+        memset(appOptionsByID + appOptionsCapacity, 0, sizeof(STZAppOptions) * (capacity - appOptionsCapacity));
+        appOptionsCapacity = capacity;
+    }
+
+    appOptionsByID[appID] = options;
+    if (appID > appOptionsLastID) {
+        appOptionsLastID = appID;
+    }
+}
+
+
+static void resolveOptionsForAllApps(void) {
+    STZAppID lastAppID = STZAppRegistryGetLastAppID();
+    for (STZAppID appID = 1; appID <= lastAppID; ++appID) {
+        size_t length;
+        char const *bytes = STZAppRegistryGetBundleIdentifier(appID, &length);
+        setOptionsForAppID(appID, bytes ? resolveOptions(bytes, length) : 0);
+    }
+}
+
+
+static void publishSnapshot(void) {
+    static uint64_t version = 0;
+
+    if (batchDepth > 0) {
+        needsPublish = true;
+        return;
+    }
+
+    //  The options are stored right after the snapshot so that both go in one allocation.
+    size_t optionsSize = sizeof(STZAppOptions) * (appOptionsLastID + 1);
+    STZSettingsSnapshot *snapshot = malloc(sizeof(STZSettingsSnapshot) + optionsSize);
+    STZAppOptions *appOptions = (STZAppOptions *)(snapshot + 1);
+
+    if (appOptionsByID) {
+        memcpy(appOptions, appOptionsByID, optionsSize);
+    } else {
+        appOptions[0] = 0;
+    }
+
+    snapshot->version = ++version;
+    snapshot->preferredModes = STZPreferredModes;
+    snapshot->triggerFlags = STZTriggerFlags;
+    snapshot->magnificationScalar = STZMagnificationScalar;
+    snapshot->momentumZoomAttenuation = STZMomentumZoomAttenuation;
+    snapshot->momentumZoomMinValue = STZScrollMomentumZoomMinValue;
+    snapshot->zoomCoalescingWindow = (CGEventTimestamp)(STZZoomCoalescingWindow * NSEC_PER_SEC);
+    snapshot->frameInterval = STZTargetFrameRate > 0 ? (CGEventTimestamp)(NSEC_PER_SEC / STZTargetFrameRate) : 0;
+    snapshot->mutableTapsLingerTime = (CGEventTimestamp)(STZMutableTapsLingerTime * NSEC_PER_SEC);
+    snapshot->maxTapSwitchesPerSecond = STZMaxTapSwitchesPerSecond;
+    snapshot->logsScrollEvents = STZLogsScrollEvents;
+    snapshot->appOptions = appOptions;
+    snapshot->lastAppID = appOptionsLastID;
+
+    STZSettingsSnapshot const *old = atomic_exchange_explicit(&currentSnapshot, snapshot, memory_order_acq_rel);
+    if (!old) {return;}
+
+    //  Readers may still hold the old snapshot; it’s freed once every one pinned since has left.
+    STZEpochRetire((void *)old, free);
+}
+
+
+STZSettingsSnapshot const *STZGetSettingsSnapshot(void) {
+    STZEpochPin();
+    STZSettingsSnapshot const *snapshot = atomic_load_explicit(&currentSnapshot, memory_order_acquire);
+    if (snapshot) {return snapshot;}
+
+    _loadUserDefaultsIfNeeded();
+    return atomic_load_explicit(&currentSnapshot, memory_order_acquire);
+}
+
+
+void STZSettingsBeginBatch(void) {
+    batchDepth += 1;
+}
+
+
+void STZSettingsEndBatch(void) {
+    assert(batchDepth > 0);
+    batchDepth -= 1;
+    if (batchDepth == 0 && needsPublish) {
+        needsPublish = false;
+        publishSnapshot();
+    }
+}
+
+
+void STZSetDetectedAppOptionsForBundleIdentifier(CFStringRef bundleID, STZAppOptions options) {
+    STZAppID appID = STZGetAppIDForBundleIdentifier(bundleID);
+    if (appID == kSTZNoAppID) {return;}
+
+    if (!detectedOptions) {
+        detectedOptions = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+    }
+
+    void *key = (void *)(uintptr_t)appID;
+    if ((STZAppOptions)(uintptr_t)CFDictionaryGetValue(detectedOptions, key) == options) {return;}
+
+    if (options) {
+        CFDictionarySetValue(detectedOptions, key, (void *)(uintptr_t)options);
+    } else {
+        CFDictionaryRemoveValue(detectedOptions, key);
+    }
+
+    size_t length;
+    char const *bytes = STZAppRegistryGetBundleIdentifier(appID, &length);
+    setOptionsForAppID(appID, resolveOptions(bytes, length));
+    publishSnapshot();
+
+    CFDictionaryRef userInfo = (__bridge void *)@{@"bundleIdentifier": (__bridge id)bundleID};
+    CFNotificationCenterPostNotification(CFNotificationCenterGetLocalCenter(),
+                                         kSTZAppOptionsDidChangeNotification,
+                                         NULL, userInfo, true);
+}
+
+
+STZAppID STZGetAppIDForBundleIdentifier(CFStringRef bundleID) {
+    _loadUserDefaultsIfNeeded();
+
+    char buffer[256];
+    char const *bytes = getBundleIDBytes(bundleID, buffer);
+    if (!bytes) {return kSTZNoAppID;}
+
+    size_t length = strlen(bytes);
+    STZAppID lastAppID = STZAppRegistryGetLastAppID();
+    STZAppID appID = STZAppRegistryIntern(bytes, length);
+    if (appID > lastAppID) {
+        setOptionsForAppID(appID, resolveOptions(bytes, length));
+        publishSnapshot();
+    }
+    return appID;
 }
@@ -7,8 +7,8 @@
  */
 
 #include "STZStateManager.h"
-#include "STZSettings.h"
 #include "CGEventSPI.h"
+#include <pthread.h>
 
 
 typedef struct {
@@ -49,67 +49,109 @@ static const CGEventTimestamp kCGEventDistantFuture = UINT64_MAX;
 //  actually used, the payloads below are very small and should not have a significant impact.
 //  Currently, no code on GitHub utilizes this field.
 static int32_t const kSignumField      = kCGScrollWheelEventFixedPtDeltaAxis3;
-static int64_t const kPositiveSignum   = 5722;
-static int64_t const kNegativeSignum   = 5721;
-static int64_t const kZeroSignum       = 5720;
+
+//  An enum rather than constants so that they are usable as case labels in standard C.
+enum {
+    kPositiveSignum     = 5722,
+    kNegativeSignum     = 5721,
+    kZeroSignum         = 5720,
+};
+
+
+enum {
+    kScrollPhaseDirty   = 1 << 0,
+    kStashDirty         = 1 << 1,
+};
 
 
-static bool isScrollFlipped(CGEventRef event) {
-    return CGEventGetIntegerValueField(event, kCGScrollEventIsDirectionInverted) != 0;
+void STZScrollRecordRead(STZScrollRecord *record, CGEventRef event) {
+    assert(CGEventGetType(event) == kCGEventScrollWheel);
+
+    record->event = event;
+    record->registryID = CGEventGetRegistryID(event);
+    record->timestamp = CGEventGetTimestamp(event);
+    record->location = CGEventGetLocation(event);
+    record->scrollPhase = (CGScrollPhase)CGEventGetIntegerValueField(event, kCGScrollWheelEventScrollPhase);
+    record->momentumPhase = (CGMomentumScrollPhase)CGEventGetIntegerValueField(event, kCGScrollWheelEventMomentumPhase);
+    record->pointDelta[0] = CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1);
+    record->pointDelta[1] = CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis2);
+    record->fixedPtDelta[0] = CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1);
+    record->fixedPtDelta[1] = CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis2);
+    record->stash = CGEventGetIntegerValueField(event, kSignumField);
+    record->isDirectionInverted = CGEventGetIntegerValueField(event, kCGScrollEventIsDirectionInverted) != 0;
+    record->dirtyFields = 0;
 }
 
 
-static double primaryScrollDelta(CGEventRef event) {
-    double data = CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1);
+void STZScrollRecordWriteBack(STZScrollRecord *record) {
+    if (record->dirtyFields & kScrollPhaseDirty) {
+        CGEventSetIntegerValueField(record->event, kCGScrollWheelEventScrollPhase, record->scrollPhase);
+        CGEventSetIntegerValueField(record->event, kCGScrollWheelEventMomentumPhase, record->momentumPhase);
+    }
+    if (record->dirtyFields & kStashDirty) {
+        CGEventSetIntegerValueField(record->event, kSignumField, record->stash);
+    }
+    record->dirtyFields = 0;
+}
+
+
+static void setStash(STZScrollRecord *record, int64_t stash) {
+    if (record->stash == stash) {return;}
+    record->stash = stash;
+    record->dirtyFields |= kStashDirty;
+}
+
+
+static double primaryScrollDelta(STZScrollRecord const *record) {
+    double data = record->pointDelta[0];
     if (data == 0) {
-        data = CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1);
+        data = record->fixedPtDelta[0];
     }
     return data;
 }
 
 
-uint64_t STZStashScrollDirectionIntoEvent(CGEventRef event) {
-    uint64_t payload = CGEventGetIntegerValueField(event, kSignumField);
+uint64_t STZStashScrollDirectionIntoEvent(STZScrollRecord *record) {
+    uint64_t payload = record->stash;
     if (payload != 0) {return payload;}
 
-    double delta = primaryScrollDelta(event) * (isScrollFlipped(event) ? -1 : 1);
+    double delta = primaryScrollDelta(record) * (record->isDirectionInverted ? -1 : 1);
     payload = (delta > 0) ? kPositiveSignum : (delta < 0) ? kNegativeSignum : kZeroSignum;
-    CGEventSetIntegerValueField(event, kSignumField, payload);
+    setStash(record, payload);
     return payload;
 }
 
 
-double STZReadScrollDeltaFromEvent(CGEventRef event, uint64_t fallback, bool unstash) {
-    switch (CGEventGetIntegerValueField(event, kSignumField)) {
+static double scrollDeltaOf(STZScrollRecord const *record, uint64_t fallback) {
+    switch (record->stash) {
     case kPositiveSignum:
-        if (unstash) {
-            CGEventSetIntegerValueField(event, kSignumField, 0);
-        }
-        return fabs(primaryScrollDelta(event));
     case kNegativeSignum:
-        if (unstash) {
-            CGEventSetIntegerValueField(event, kSignumField, 0);
-        }
-        return -fabs(primaryScrollDelta(event));
     case kZeroSignum:
-        if (unstash) {
-            CGEventSetIntegerValueField(event, kSignumField, 0);
-        }
-        return 0;
+        fallback = record->stash;
+        break;
     default:
         break;
     }
 
     switch (fallback) {
     case kPositiveSignum:
-        return fabs(primaryScrollDelta(event));
+        return fabs(primaryScrollDelta(record));
     case kNegativeSignum:
-        return -fabs(primaryScrollDelta(event));
+        return -fabs(primaryScrollDelta(record));
     case kZeroSignum:
         return 0;
     default:
-        return primaryScrollDelta(event) * (isScrollFlipped(event) ? -1 : 1);
+        return primaryScrollDelta(record) * (record->isDirectionInverted ? -1 : 1);
+    }
+}
+
+
+double STZReadScrollDeltaFromEvent(STZScrollRecord *record, uint64_t fallback, bool unstash) {
+    double delta = scrollDeltaOf(record, fallback);
+    if (unstash && (record->stash == kPositiveSignum || record->stash == kNegativeSignum || record->stash == kZeroSignum)) {
+        setStash(record, 0);
     }
+    return delta;
 }
 
 
@@ -129,9 +171,12 @@ typedef enum {
 } ScrollType;
 
 
-static ScrollType scrollOf(CGEventRef event);
-static void setScrollOf(CGEventRef event, ScrollType scroll);
-static CGEventRef createZoomEvent(CGEventRef event, CGGesturePhase phase, CGPoint center, double value);
+static ScrollType scrollOf(STZScrollRecord const *record);
+static void setScrollOf(STZScrollRecord *record, ScrollType scroll);
+static CGEventRef createZoomEvent(STZStateRef state, CGEventRef event, CGGesturePhase phase, double value);
+static CGEventRef createRefZoomEvent(STZStateRef state, CGGesturePhase phase, CGEventTimestamp now, double value);
+static CGEventRef dequeueZoomEvent(STZStateRef state, CGEventFlags flags, CGEventTimestamp timestamp,
+                                   CGGesturePhase phase, double value);
 
 
 typedef enum {
@@ -147,6 +192,16 @@ typedef enum {
 
 } StateType;
 
+
+/// The attenuation `k ^ (∆t / k)` equals `exp(-a∆t)` with `a = -ln(k) / k`, so one table of
+/// `exp(-u)` serves any setting. Captured when the momentum phase begins.
+typedef struct {
+    CGEventTimestamp    start;
+    CGEventTimestamp    cutoff;     ///< The zoom stops here; see `beginMomentumCurve`.
+    double              rate;       ///< Table steps per nanosecond; infinite if `k` is 0.
+    double              minValue;
+} MomentumCurve;
+
 static int stateCategory(StateType type) {
     if (type == kStateNotInSession) {return 0;}
     if (type <= kStateMomentumScrollInProgress) {return 1;}
@@ -159,18 +214,43 @@ struct _STZState {
     StateType           type;
     bool                needsFixScroll;
 
-    //  If `refEvent` as well as `delayedZoom` is set, a zoom event of this value will be emitted
+    //  If `hasRefEvent` as well as `delayedZoom` is set, a zoom event of this value will be emitted
     //  before the delayed zoom is emitted; otherwise this value serves only as a memo.
     double              chromiumZoomShim;
 
+    //  Of the scroll event that began `ZoomToEndAfterWaiting`, zoom events emitted periodically
+    //  only need the flags; the event source is kept by `zoomEvents`.
     double              delayedZoom;
-    CGEventRef          refEvent;
+    bool                hasRefEvent;
+    CGEventFlags        refFlags;
     CGEventTimestamp    refTime;
     CGEventTimestamp    endTimeout;
-    CGEventTimestamp    momentumStart;
+    MomentumCurve       momentum;
     CGPoint             zoomCenter;
+
+    //  Delayed zoom events are paced to frames of the display, chosen once per zoom session so
+    //  that a session moving across displays keeps a steady rhythm.
+    CGEventTimestamp    frameInterval;
     uint64_t            sessionData;
 
+    //  While zooming, changes within `coalescingWindow` after an emitted change are summed here
+    //  and emitted together with the first change after `coalesceUntil`. Only if no change comes
+    //  within another window, i.e. the input has stopped, does the periodic update emit them, so
+    //  a steady stream of scroll events never wakes the timer.
+    double              coalescedZoom;
+    CGEventFlags        coalescedFlags;
+    CGEventTimestamp    coalesceUntil;
+    CGEventTimestamp    coalescingWindow;
+
+    //  Zoom events are handed out round this ring; see the header for how long the caller may
+    //  keep one. Reuse relies on that contract rather than on retain counts, which the system
+    //  may raise while posting. Entries are created on first use and recreated, all of them, only
+    //  if the source of scroll events changes.
+#define kZoomEventRingSize 4
+    CGEventRef          zoomEvents[kZoomEventRingSize];
+    uint8_t             zoomEventNext;
+    int64_t             zoomEventSourceStateID;
+
     //  The speedometer is for measuring discrete scroll intervals and requires no high accuracy.
     //  When a bunch of discrete scroll events occur in a short period of time, the timeout for
     // `ZoomToEndAfterWaiting` will shorten.
@@ -181,7 +261,8 @@ struct _STZState {
 };
 
 typedef struct {
-    CGEventRef event;
+    STZSettingsSnapshot const *settings;
+    STZScrollRecord *record;
     ScrollType scroll;
     STZGestureType gesture;
     bool fixChromiumZoomStall;
@@ -189,7 +270,7 @@ typedef struct {
 } _StateTransitionContext;
 
 
-static const CGEventTimestamp kEventDelayDuration = (int64_t)(0.01667 * NSEC_PER_SEC);
+static const CGEventTimestamp kDefaultFrameInterval = NSEC_PER_SEC / 60;
 static const CGEventTimestamp kMomentumScrollTimeout = (int64_t)(0.05 * NSEC_PER_SEC);
 static const CGEventTimestamp kMaxDiscreteScrollTimeout = (int64_t)(0.35 * NSEC_PER_SEC);
 static const CGEventTimestamp kAutoDiscreteScrollTimeout = kCGEventDistantFuture;
@@ -202,6 +283,43 @@ static EventResult updateStateMomentumScrollInProgress(STZStateRef state, _State
 static EventResult updateStateZoomInProgress(STZStateRef state, _StateTransitionContext *c);
 
 
+static void releaseZoomEvents(STZStateRef state) {
+    for (int i = 0; i < kZoomEventRingSize; ++i) {
+        if (state->zoomEvents[i]) {CFRelease(state->zoomEvents[i]);}
+        state->zoomEvents[i] = NULL;
+    }
+}
+
+
+static void prepareZoomEvent(STZStateRef state, CGEventRef event) {
+    int64_t sourceStateID = CGEventGetIntegerValueField(event, kCGEventSourceStateID);
+
+    if (state->zoomEvents[0] != NULL) {
+        if (state->zoomEventSourceStateID == sourceStateID) {return;}
+        releaseZoomEvents(state);
+    }
+
+    CGEventSourceRef source = CGEventCreateSourceFromEvent(event);
+    CGEventRef zoom = CGEventCreate(source);
+    if (source) {CFRelease(source);}
+
+    CGEventSetType(zoom, kCGEventGesture);
+    CGEventSetIntegerValueField(zoom, kCGGestureEventHIDType, kIOHIDEventTypeZoom);
+
+    state->zoomEvents[0] = zoom;
+    state->zoomEventNext = 0;
+    state->zoomEventSourceStateID = sourceStateID;
+}
+
+
+/// The flags of the zoom event handed out last.
+static CGEventFlags getLastZoomFlags(STZStateRef state) {
+    int last = (state->zoomEventNext + kZoomEventRingSize - 1) % kZoomEventRingSize;
+    CGEventRef zoom = state->zoomEvents[last] ?: state->zoomEvents[0];
+    return CGEventGetFlags(zoom);
+}
+
+
 static void setZoomToEndAfterWaiting(STZStateRef state, CGEventRef event, CGEventTimestamp timeout) {
     CGEventTimestamp now = CGEventTimestampNow();
 
@@ -211,7 +329,7 @@ static void setZoomToEndAfterWaiting(STZStateRef state, CGEventRef event, CGEven
         state->speedometerNextIndex = (index + 1) % kSpeedometerCapacity;
         state->speedometerLastTime = now;
 
-        timeout = kEventDelayDuration;
+        timeout = state->frameInterval;
         for (int i = 0; i < kSpeedometerCapacity; ++i) {
             if (timeout < state->speedometerIntervals[i]) {
                 timeout = state->speedometerIntervals[i];
@@ -224,7 +342,9 @@ static void setZoomToEndAfterWaiting(STZStateRef state, CGEventRef event, CGEven
     }
 
     state->type = kStateZoomToEndAfterWaiting;
-    state->refEvent = CGEventCreateCopy(event);
+    state->hasRefEvent = true;
+    state->refFlags = CGEventGetFlags(event);
+    prepareZoomEvent(state, event);
     //  This value is not read from the event because Mos may not report it accurately.
     state->refTime = now;
     state->endTimeout = timeout;
@@ -232,17 +352,91 @@ static void setZoomToEndAfterWaiting(STZStateRef state, CGEventRef event, CGEven
 
 
 static void discardRefEvent(STZStateRef state) {
-    if (state->refEvent == NULL) {return;}
-    CFRelease(state->refEvent);
-    state->refEvent = NULL;
+    state->hasRefEvent = false;
 }
 
 
-static void checkMomentumStart(STZStateRef state, CGEventRef event, ScrollType scroll) {
+/// Returns true if the change is held back, in which case `value`, including what was held back
+/// before, becomes the coalesced zoom and the scroll event should be discarded.
+static bool coalesceZoomChange(STZStateRef state, _StateTransitionContext *c, double value) {
+    CGEventTimestamp window = c->settings->zoomCoalescingWindow;
+    if (window == 0) {return false;}
+
+    //  Not the event timestamp, for the same reason as `refTime`.
+    CGEventTimestamp now = CGEventTimestampNow();
+    state->coalescingWindow = window;
+
+    if (now < state->coalesceUntil) {
+        state->coalescedZoom = value;
+        state->coalescedFlags = CGEventGetFlags(c->record->event);
+        return true;
+    }
+
+    state->coalesceUntil = now + window;
+    return false;
+}
+
+
+//  `exp(-u)` for `u` in [0, 16] with 64 steps per unit. With linear interpolation the relative
+//  error is below (1/64)² / 8 ≈ 3.1e-5; past the end the factor is taken as 0 instead of a value
+//  below 1.2e-7.
+#define kAttenuationStepsPerUnit 64
+#define kAttenuationTableLength (16 * kAttenuationStepsPerUnit + 1)
+static float attenuationTable[kAttenuationTableLength];
+static pthread_once_t attenuationTableOnce = PTHREAD_ONCE_INIT;
+
+
+static void fillAttenuationTable(void) {
+    for (int i = 0; i < kAttenuationTableLength; ++i) {
+        attenuationTable[i] = (float)exp(-(double)i / kAttenuationStepsPerUnit);
+    }
+}
+
+
+static void beginMomentumCurve(MomentumCurve *curve, STZSettingsSnapshot const *settings, CGEventTimestamp start) {
+    //  Momentum may begin on the tap threads and in the replay at once.
+    pthread_once(&attenuationTableOnce, fillAttenuationTable);
+
+    double k = 1 - settings->momentumZoomAttenuation;
+    curve->start = start;
+    curve->minValue = settings->momentumZoomMinValue;
+
+    if (k == 0) {
+        curve->rate = INFINITY;
+        curve->cutoff = start;
+        return;
+    }
+
+    double a = -log(k) / k;
+    curve->rate = a * kAttenuationStepsPerUnit / NSEC_PER_SEC;
+
+    //  The factor alone falls below the minimum at `-ln(minValue) / a` seconds. Magnifications
+    //  before attenuation are scroll deltas times the scalar, well below 1, so none can zoom past
+    //  this; the periodic update ends the zoom here rather than waiting for the momentum to end.
+    double cutoff = curve->minValue == 0 ? INFINITY : -log(curve->minValue) / a;
+    if (cutoff < 86400) {
+        curve->cutoff = start + (CGEventTimestamp)(cutoff * NSEC_PER_SEC);
+    } else {
+        curve->cutoff = kCGEventDistantFuture;
+    }
+}
+
+
+static double momentumAttenuation(MomentumCurve const *curve, CGEventTimestamp now) {
+    double u = (double)(now - curve->start) * curve->rate;
+    if (!(u < kAttenuationTableLength - 1)) {return 0;}  //  Also for NaN from 0 × ∞.
+
+    int i = (int)u;
+    double frac = u - i;
+    return attenuationTable[i] + (attenuationTable[i + 1] - attenuationTable[i]) * frac;
+}
+
+
+static void checkMomentumStart(STZStateRef state, STZSettingsSnapshot const *settings, STZScrollRecord const *record, ScrollType scroll) {
     if (scroll == kMomentumScrollBegan) {
-        state->momentumStart = CGEventGetTimestamp(event);
+        beginMomentumCurve(&state->momentum, settings, record->timestamp);
     } else if (scroll < kMomentumScrollBegan) {
-        state->momentumStart = kCGEventDistantFuture;
+        state->momentum.start = kCGEventDistantFuture;
     }
 }
 
@@ -253,9 +447,17 @@ STZStateRef STZStateCreate(void){
     state->needsFixScroll = false;
     state->chromiumZoomShim = 0;
     state->delayedZoom = 0;
-    state->refEvent = NULL;
-    state->momentumStart = kCGEventDistantFuture;
+    state->coalescedZoom = 0;
+    state->coalesceUntil = 0;
+    state->hasRefEvent = false;
+    state->momentum.start = kCGEventDistantFuture;
+    state->frameInterval = kDefaultFrameInterval;
     state->sessionData = 0;
+    for (int i = 0; i < kZoomEventRingSize; ++i) {
+        state->zoomEvents[i] = NULL;
+    }
+    state->zoomEventNext = 0;
+    state->zoomEventSourceStateID = 0;
 
     state->speedometerNextIndex = 0;
     state->speedometerLastTime = 0;
@@ -268,7 +470,7 @@ STZStateRef STZStateCreate(void){
 
 
 void STZStateRelease(STZStateRef state) {
-    discardRefEvent(state);
+    releaseZoomEvents(state);
     free(state);
 }
 
@@ -279,6 +481,12 @@ bool STZStateIsZooming(STZStateRef state) {
 }
 
 
+bool STZStateIsActive(STZStateRef state) {
+    //  A reference event and coalesced zoom only exist in a session.
+    return state->type != kStateNotInSession || state->needsFixScroll;
+}
+
+
 bool STZStateGetSessionData(STZStateRef state, uint64_t *outData) {
     if (state->type == kStateNotInSession) {
         if (outData) {*outData = 0;}
@@ -290,14 +498,15 @@ bool STZStateGetSessionData(STZStateRef state, uint64_t *outData) {
 }
 
 
-void STZStateReadScrollEvent(STZStateRef state, CGEventRef event) {
+void STZStateReadScrollEvent(STZStateRef state, STZSettingsSnapshot const *settings, STZScrollRecord const *record) {
     discardRefEvent(state);
     state->needsFixScroll = false;
+    state->coalescedZoom = 0;
 
     StateType oldType = state->type;
 
-    ScrollType scroll = scrollOf(event);
-    checkMomentumStart(state, event, scroll);
+    ScrollType scroll = scrollOf(record);
+    checkMomentumStart(state, settings, record, scroll);
 
     switch (scroll) {
     case kDiscretelyScrolled:
@@ -330,12 +539,13 @@ void STZStateReadScrollEvent(STZStateRef state, CGEventRef event) {
 }
 
 
-CGEventRef STZStateTransformScrollEvent(STZStateRef state, CGEventRef event, STZGestureType gesture,
+CGEventRef STZStateTransformScrollEvent(STZStateRef state, STZSettingsSnapshot const *settings,
+                                        STZScrollRecord *record, STZGestureType gesture,
                                         bool fixChromiumZoomStall,
                                         uint64_t fallbackScrollDir, uint64_t const *sessionData,
                                         STZEventPlacement *returnEventPlacement) {
-    ScrollType scroll = scrollOf(event);
-    if (gesture == kSTZZoom && scroll == kDiscretelyScrolled && STZIsScrollEventNoOp(event)) {
+    ScrollType scroll = scrollOf(record);
+    if (gesture == kSTZZoom && scroll == kDiscretelyScrolled && STZIsScrollEventNoOp(record)) {
         //  Some versions of Mos emit endless trailing scroll events with zero deltas until the
         //  left mouse button is down. In any case, such discrete scrolls are bizarre.
         //  Discard the event so that the session will terminate due to timeout.
@@ -348,13 +558,15 @@ CGEventRef STZStateTransformScrollEvent(STZStateRef state, CGEventRef event, STZ
 
     StateType oldType = state->type;
     if (gesture == kSTZZoom && oldType < kStateZoomInProgress) {
-        state->zoomCenter = CGEventGetLocation(event);
+        state->zoomCenter = record->location;
+        state->frameInterval = settings->frameInterval ?: STZGetDisplayFrameIntervalAtPoint(record->location);
     }
 
-    checkMomentumStart(state, event, scroll);
+    checkMomentumStart(state, settings, record, scroll);
 
     _StateTransitionContext c = {
-        .event = event,
+        .settings = settings,
+        .record = record,
         .scroll = scroll,
         .gesture = gesture,
         .fixChromiumZoomStall = fixChromiumZoomStall,
@@ -401,8 +613,9 @@ CGEventRef STZStateTransformScrollEvent(STZStateRef state, CGEventRef event, STZ
         state->sessionData = 0;
     }
 
-    assert((state->refEvent != NULL) == (state->type == kStateZoomToEndAfterWaiting));
-    assert((state->refEvent != NULL) || (state->delayedZoom == 0));
+    assert(state->hasRefEvent == (state->type == kStateZoomToEndAfterWaiting));
+    assert(state->hasRefEvent || (state->delayedZoom == 0));
+    assert(state->type == kStateZoomInProgress || (state->coalescedZoom == 0));
 
     *returnEventPlacement = result.otherPlacement;
     return result.otherEvent;
@@ -418,14 +631,17 @@ CGEventRef STZStateRevertToScrollByEvent(STZStateRef state, CGEventRef event) {
         return NULL;
 
     case kStateZoomInProgress:
-    case kStateZoomToEndAfterWaiting:
+    case kStateZoomToEndAfterWaiting: {
+        double pending = state->delayedZoom + state->coalescedZoom;
         discardRefEvent(state);
         state->needsFixScroll = true;
         state->type = kStateNotInSession;
         state->delayedZoom = 0;
+        state->coalescedZoom = 0;
         state->chromiumZoomShim = 0;
         state->sessionData = 0;
-        return createZoomEvent(event, kCGGesturePhaseEnded, state->zoomCenter, 0);
+        return createZoomEvent(state, event, kCGGesturePhaseEnded, pending);
+    }
 
     case kStateZoomStoppedByAttenuation:
         state->needsFixScroll = true;
@@ -436,27 +652,47 @@ CGEventRef STZStateRevertToScrollByEvent(STZStateRef state, CGEventRef event) {
 }
 
 
+/// Whether the momentum of the current zoom has run past its cutoff. A pending chromium shim is
+/// emitted first, as when a momentum scroll attenuates to zero.
+static bool momentumDidStop(STZStateRef state, CGEventTimestamp now) {
+    return state->momentum.start != kCGEventDistantFuture && now >= state->momentum.cutoff
+        && state->chromiumZoomShim == 0;
+}
+
+
 CGEventRef STZStatePeriodicallyUpdate(STZStateRef state, CGEventTimestamp now) {
+    if (state->type == kStateZoomInProgress && momentumDidStop(state, now)) {
+        CGEventRef event = dequeueZoomEvent(state, getLastZoomFlags(state), now, kCGGesturePhaseEnded, state->coalescedZoom);
+        state->coalescedZoom = 0;
+        state->type = kStateZoomStoppedByAttenuation;
+        return event;
+    }
+
+    if (state->type == kStateZoomInProgress) {
+        if (state->coalescedZoom == 0 || now < state->coalesceUntil) {return NULL;}
+        CGEventRef event = dequeueZoomEvent(state, state->coalescedFlags, now, kCGGesturePhaseChanged, state->coalescedZoom);
+        state->coalescedZoom = 0;
+        state->coalesceUntil = now + state->coalescingWindow;
+        return event;
+    }
+
     if (state->type != kStateZoomToEndAfterWaiting) {return NULL;}
 
     CGEventTimestamp elapsed = now - state->refTime;
-    if (state->refEvent && state->chromiumZoomShim != 0 && elapsed >= kEventDelayDuration / 2) {
-        CGEventRef event = createZoomEvent(state->refEvent, kCGGesturePhaseChanged, state->zoomCenter, state->chromiumZoomShim);
-        CGEventSetTimestamp(event, now);
+    if (state->hasRefEvent && state->chromiumZoomShim != 0 && elapsed >= state->frameInterval / 2) {
+        CGEventRef event = createRefZoomEvent(state, kCGGesturePhaseChanged, now, state->chromiumZoomShim);
         state->chromiumZoomShim = 0;
         return event;
     }
 
-    if (state->delayedZoom != 0 && elapsed >= kEventDelayDuration) {
-        CGEventRef event = createZoomEvent(state->refEvent, kCGGesturePhaseChanged, state->zoomCenter, state->delayedZoom);
-        CGEventSetTimestamp(event, now);
+    if (state->delayedZoom != 0 && elapsed >= state->frameInterval) {
+        CGEventRef event = createRefZoomEvent(state, kCGGesturePhaseChanged, now, state->delayedZoom);
         state->delayedZoom = 0;
         return event;
     }
 
     if (elapsed >= state->endTimeout) {
-        CGEventRef event = createZoomEvent(state->refEvent, kCGGesturePhaseEnded, state->zoomCenter, 0);
-        CGEventSetTimestamp(event, now);
+        CGEventRef event = createRefZoomEvent(state, kCGGesturePhaseEnded, now, 0);
         discardRefEvent(state);
         state->sessionData = 0;
         state->type = kStateNotInSession;
@@ -468,13 +704,26 @@ CGEventRef STZStatePeriodicallyUpdate(STZStateRef state, CGEventTimestamp now) {
 
 
 CGEventTimestamp STZStateGetNextUpdatePeriod(STZStateRef state, CGEventTimestamp now) {
+    CGEventTimestamp fireAt;
+    if (state->type == kStateZoomInProgress) {
+        fireAt = kCGEventDistantFuture;
+        if (state->coalescedZoom != 0) {
+            fireAt = state->coalesceUntil + state->coalescingWindow;
+        }
+        if (state->momentum.start != kCGEventDistantFuture && state->momentum.cutoff < fireAt) {
+            fireAt = state->momentum.cutoff;
+        }
+        if (fireAt == kCGEventDistantFuture) {return 0;}
+        return fireAt <= now ? 1 : fireAt - now;
+    }
+
     if (state->type != kStateZoomToEndAfterWaiting) {return 0;}
 
-    CGEventTimestamp fireAt = state->refTime;
-    if (state->refEvent && state->chromiumZoomShim != 0) {
-        fireAt += kEventDelayDuration / 2;
+    fireAt = state->refTime;
+    if (state->hasRefEvent && state->chromiumZoomShim != 0) {
+        fireAt += state->frameInterval / 2;
     } else if (state->delayedZoom != 0) {
-        fireAt += kEventDelayDuration;
+        fireAt += state->frameInterval;
     } else {
         fireAt += state->endTimeout;
     }
@@ -502,16 +751,15 @@ bool STZStateCanStopTransformingEvents(STZStateRef state) {
 //  MARK: - State Transition Routes
 
 
-static double magnificationFromScroll(CGEventRef event, uint64_t fallbackScrollDir, CGEventTimestamp momentumStart) {
-    double value = STZReadScrollDeltaFromEvent(event, fallbackScrollDir, false) * STZGetMagnificationScalar();
+static double magnificationFromScroll(STZSettingsSnapshot const *settings, STZScrollRecord const *record, uint64_t fallbackScrollDir, MomentumCurve const *momentum) {
+    double value = scrollDeltaOf(record, fallbackScrollDir) * settings->magnificationScalar;
 
-    CGEventTimestamp now = CGEventGetTimestamp(event);
-    if (now >= momentumStart) {
-        double k = 1 - STZGetMomentumZoomAttenuation();
-        double dt = (double)(now - momentumStart) / NSEC_PER_SEC;
-        value *= k != 0 ? pow(k, dt / k) : 0;
+    CGEventTimestamp now = record->timestamp;
+    if (momentum && now >= momentum->start) {
+        if (now >= momentum->cutoff) {return 0;}
 
-        if (fabs(value) < STZGetMomentumZoomMinValue()) {
+        value *= momentumAttenuation(momentum, now);
+        if (fabs(value) < momentum->minValue) {
             value = 0;
         }
     }
@@ -528,23 +776,23 @@ static double magnificationToFixChromiumZoom(double magnification) {
 
 
 static EventResult beginZoomingByDiscreteScroll(STZStateRef state, _StateTransitionContext *c, int terminatingScroll) {
-    double value = magnificationFromScroll(c->event, c->fallbackScrollDir, kCGEventDistantFuture);
+    double value = magnificationFromScroll(c->settings, c->record, c->fallbackScrollDir, NULL);
     if (c->fixChromiumZoomStall) {
         state->chromiumZoomShim = magnificationToFixChromiumZoom(value);
     }
-    setZoomToEndAfterWaiting(state, c->event, kAutoDiscreteScrollTimeout);
+    setZoomToEndAfterWaiting(state, c->record->event, kAutoDiscreteScrollTimeout);
     state->delayedZoom += value;
 
     if (terminatingScroll >= 0) {
-        setScrollOf(c->event, (ScrollType)terminatingScroll);
-        return appendEvent(createZoomEvent(c->event, kCGGesturePhaseBegan, state->zoomCenter, 0));
+        setScrollOf(c->record, (ScrollType)terminatingScroll);
+        return appendEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseBegan, 0));
     } else {
-        return replaceEvent(createZoomEvent(c->event, kCGGesturePhaseBegan, state->zoomCenter, 0));
+        return replaceEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseBegan, 0));
     }
 }
 
-static EventResult beginZoomingByNonDiscreteScroll(STZStateRef state, _StateTransitionContext *c, int terminatingScroll, CGEventTimestamp momentumStart) {
-    double value = magnificationFromScroll(c->event, c->fallbackScrollDir, momentumStart);
+static EventResult beginZoomingByNonDiscreteScroll(STZStateRef state, _StateTransitionContext *c, int terminatingScroll, MomentumCurve const *momentum) {
+    double value = magnificationFromScroll(c->settings, c->record, c->fallbackScrollDir, momentum);
     if (c->fixChromiumZoomStall) {
         state->chromiumZoomShim = magnificationToFixChromiumZoom(value);
         value = 0;  //  Dropping one or two continuous scrolls is OK because they are
@@ -553,10 +801,10 @@ static EventResult beginZoomingByNonDiscreteScroll(STZStateRef state, _StateTran
 
     state->type = kStateZoomInProgress;
     if (terminatingScroll != -1) {
-        setScrollOf(c->event, (ScrollType)terminatingScroll);
-        return appendEvent(createZoomEvent(c->event, kCGGesturePhaseBegan, state->zoomCenter, value));
+        setScrollOf(c->record, (ScrollType)terminatingScroll);
+        return appendEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseBegan, value));
     } else {
-        return replaceEvent(createZoomEvent(c->event, kCGGesturePhaseBegan, state->zoomCenter, value));
+        return replaceEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseBegan, value));
     }
 }
 
@@ -586,12 +834,12 @@ static EventResult updateStateNotInSession(STZStateRef state, _StateTransitionCo
     case kContinuousScrollChanged:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kContinuousScrollBegan);
+            setScrollOf(c->record, kContinuousScrollBegan);
             state->type = kStateScrollInProgress;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, -1, kCGEventDistantFuture);
+            return beginZoomingByNonDiscreteScroll(state, c, -1, NULL);
         }
 
     case kContinuousScrollEnded:
@@ -602,12 +850,12 @@ static EventResult updateStateNotInSession(STZStateRef state, _StateTransitionCo
     case kMomentumScrollChanged:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kMomentumScrollBegan);
+            setScrollOf(c->record, kMomentumScrollBegan);
             state->type = kStateMomentumScrollInProgress;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, -1, state->momentumStart);
+            return beginZoomingByNonDiscreteScroll(state, c, -1, &state->momentum);
         }
 
     case kMomentumScrollEnded:
@@ -621,7 +869,7 @@ static EventResult updateStateScrollMayBegin(STZStateRef state, _StateTransition
     case kDiscretelyScrolled:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kContinuousScrollCancelled);
+            setScrollOf(c->record, kContinuousScrollCancelled);
             state->type = kStateNotInSession;
             return keepEvent();
 
@@ -636,12 +884,12 @@ static EventResult updateStateScrollMayBegin(STZStateRef state, _StateTransition
     case kContinuousScrollChanged:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kContinuousScrollBegan);
+            setScrollOf(c->record, kContinuousScrollBegan);
             state->type = kStateScrollInProgress;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollCancelled, kCGEventDistantFuture);
+            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollCancelled, NULL);
         }
 
     case kContinuousScrollEnded:
@@ -655,16 +903,16 @@ static EventResult updateStateScrollMayBegin(STZStateRef state, _StateTransition
         case kSTZScroll:
             //  Begin momentum scroll on the next event.
             state->needsFixScroll = true;
-            setScrollOf(c->event, kContinuousScrollCancelled);
+            setScrollOf(c->record, kContinuousScrollCancelled);
             state->type = kStateNotInSession;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollCancelled, state->momentumStart);
+            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollCancelled, &state->momentum);
         }
 
     case kMomentumScrollEnded:
-        setScrollOf(c->event, kContinuousScrollCancelled);
+        setScrollOf(c->record, kContinuousScrollCancelled);
         state->type = kStateNotInSession;
         return keepEvent();
     }
@@ -676,7 +924,7 @@ static EventResult updateStateScrollInProgress(STZStateRef state, _StateTransiti
     case kDiscretelyScrolled:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kContinuousScrollEnded);
+            setScrollOf(c->record, kContinuousScrollEnded);
             state->type = kStateNotInSession;
             return keepEvent();
 
@@ -691,12 +939,12 @@ static EventResult updateStateScrollInProgress(STZStateRef state, _StateTransiti
     case kContinuousScrollChanged:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kContinuousScrollChanged);
+            setScrollOf(c->record, kContinuousScrollChanged);
             state->type = kStateScrollInProgress;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollEnded, kCGEventDistantFuture);
+            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollEnded, NULL);
         }
 
     case kContinuousScrollEnded:
@@ -710,16 +958,16 @@ static EventResult updateStateScrollInProgress(STZStateRef state, _StateTransiti
         case kSTZScroll:
             //  Begin momentum scroll on the next event.
             state->needsFixScroll = true;
-            setScrollOf(c->event, kContinuousScrollEnded);
+            setScrollOf(c->record, kContinuousScrollEnded);
             state->type = kStateNotInSession;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollEnded, state->momentumStart);
+            return beginZoomingByNonDiscreteScroll(state, c, kContinuousScrollEnded, &state->momentum);
         }
 
     case kMomentumScrollEnded:
-        setScrollOf(c->event, kContinuousScrollEnded);
+        setScrollOf(c->record, kContinuousScrollEnded);
         state->type = kStateNotInSession;
         return keepEvent();
     }
@@ -731,7 +979,7 @@ static EventResult updateStateMomentumScrollInProgress(STZStateRef state, _State
     case kDiscretelyScrolled:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kMomentumScrollEnded);
+            setScrollOf(c->record, kMomentumScrollEnded);
             state->type = kStateNotInSession;
             return keepEvent();
 
@@ -748,17 +996,17 @@ static EventResult updateStateMomentumScrollInProgress(STZStateRef state, _State
         case kSTZScroll:
             //  Begin continuous scroll on the next event.
             state->needsFixScroll = true;
-            setScrollOf(c->event, kMomentumScrollEnded);
+            setScrollOf(c->record, kMomentumScrollEnded);
             state->type = kStateNotInSession;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, kMomentumScrollEnded, kCGEventDistantFuture);
+            return beginZoomingByNonDiscreteScroll(state, c, kMomentumScrollEnded, NULL);
         }
 
     case kContinuousScrollEnded:
     case kContinuousScrollCancelled:
-        setScrollOf(c->event, kMomentumScrollEnded);
+        setScrollOf(c->record, kMomentumScrollEnded);
         state->type = kStateNotInSession;
         return keepEvent();
 
@@ -766,12 +1014,12 @@ static EventResult updateStateMomentumScrollInProgress(STZStateRef state, _State
     case kMomentumScrollChanged:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kMomentumScrollChanged);
+            setScrollOf(c->record, kMomentumScrollChanged);
             state->type = kStateMomentumScrollInProgress;
             return keepEvent();
 
         case kSTZZoom:
-            return beginZoomingByNonDiscreteScroll(state, c, kMomentumScrollEnded, state->momentumStart);
+            return beginZoomingByNonDiscreteScroll(state, c, kMomentumScrollEnded, &state->momentum);
         }
 
     case kMomentumScrollEnded:
@@ -784,81 +1032,97 @@ static EventResult updateStateMomentumScrollInProgress(STZStateRef state, _State
 static EventResult updateStateZoomInProgress(STZStateRef state, _StateTransitionContext *c) {
     double value;
     double chromiumShim = state->chromiumZoomShim;
-    double pending = state->delayedZoom;
+    double coalesced = state->coalescedZoom;
+    //  What was held back goes out with whatever event comes next, even one that ends the zoom.
+    double pending = state->delayedZoom + coalesced;
     state->chromiumZoomShim = 0;
     state->delayedZoom = 0;
+    state->coalescedZoom = 0;
 
     switch (c->scroll) {
     case kDiscretelyScrolled:
         switch (c->gesture) {
         case kSTZScroll:
             state->type = kStateNotInSession;
-            return prependEvent(createZoomEvent(c->event, kCGGesturePhaseEnded, state->zoomCenter, 0));
+            return prependEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseEnded, pending));
 
         case kSTZZoom:
-            value = magnificationFromScroll(c->event, c->fallbackScrollDir, kCGEventDistantFuture) + pending;
+            value = magnificationFromScroll(c->settings, c->record, c->fallbackScrollDir, NULL) + pending;
             if (c->fixChromiumZoomStall && chromiumShim != 0) {
                 state->delayedZoom = value;
                 value = chromiumShim;
             }
-            setZoomToEndAfterWaiting(state, c->event, kAutoDiscreteScrollTimeout);
-            return replaceEvent(createZoomEvent(c->event, kCGGesturePhaseChanged, state->zoomCenter, value));
+            setZoomToEndAfterWaiting(state, c->record->event, kAutoDiscreteScrollTimeout);
+            return replaceEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseChanged, value));
         }
 
     case kContinuousScrollMayBegin:
         state->type = kStateZoomInProgress;
+        state->coalescedZoom = coalesced;
         return discardEvent();
 
     case kContinuousScrollBegan:
     case kContinuousScrollChanged:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kContinuousScrollBegan);
+            setScrollOf(c->record, kContinuousScrollBegan);
             state->type = kStateScrollInProgress;
-            return prependEvent(createZoomEvent(c->event, kCGGesturePhaseEnded, state->zoomCenter, 0));
+            return prependEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseEnded, pending));
 
         case kSTZZoom:
-            value = magnificationFromScroll(c->event, c->fallbackScrollDir, kCGEventDistantFuture) + pending;
+            value = magnificationFromScroll(c->settings, c->record, c->fallbackScrollDir, NULL) + pending;
+            state->type = kStateZoomInProgress;
+            if (coalesceZoomChange(state, c, value)) {
+                state->chromiumZoomShim = chromiumShim;
+                return discardEvent();
+            }
             if (c->fixChromiumZoomStall && chromiumShim != 0) {
                 state->chromiumZoomShim = value;
                 value = chromiumShim;
             }
-            state->type = kStateZoomInProgress;
-            return replaceEvent(createZoomEvent(c->event, kCGGesturePhaseChanged, state->zoomCenter, value));
+            return replaceEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseChanged, value));
         }
 
     case kContinuousScrollEnded:
     case kContinuousScrollCancelled:
-        //  Waiting for `kMomentumScrollBegan` to avoid interrupting the zoom session.
-        setZoomToEndAfterWaiting(state, c->event, kMomentumScrollTimeout);
+        //  Waiting for `kMomentumScrollBegan` to avoid interrupting the zoom session. What was
+        //  coalesced is emitted by the periodic update meanwhile.
+        setZoomToEndAfterWaiting(state, c->record->event, kMomentumScrollTimeout);
+        state->delayedZoom = coalesced;
         return discardEvent();
 
     case kMomentumScrollBegan:
     case kMomentumScrollChanged:
         switch (c->gesture) {
         case kSTZScroll:
-            setScrollOf(c->event, kMomentumScrollBegan);
+            setScrollOf(c->record, kMomentumScrollBegan);
             state->type = kStateMomentumScrollInProgress;
-            return prependEvent(createZoomEvent(c->event, kCGGesturePhaseEnded, state->zoomCenter, 0));
+            return prependEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseEnded, pending));
 
         case kSTZZoom:
-            value = magnificationFromScroll(c->event, c->fallbackScrollDir, state->momentumStart) + pending;
+            value = magnificationFromScroll(c->settings, c->record, c->fallbackScrollDir, &state->momentum);
+            //  A zero value ends the zoom, which is never held back.
+            if (value == 0 && !(c->fixChromiumZoomStall && chromiumShim != 0)) {
+                state->type = kStateZoomStoppedByAttenuation;
+                return replaceEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseEnded, pending));
+            }
+            if (value != 0 && coalesceZoomChange(state, c, value + pending)) {
+                state->chromiumZoomShim = chromiumShim;
+                state->type = kStateZoomInProgress;
+                return discardEvent();
+            }
+            value += pending;
             if (c->fixChromiumZoomStall && chromiumShim != 0) {
                 state->chromiumZoomShim = value;
                 value = chromiumShim;
             }
-            if (value == 0) {
-                state->type = kStateZoomStoppedByAttenuation;
-                return replaceEvent(createZoomEvent(c->event, kCGGesturePhaseEnded, state->zoomCenter, value));
-            } else {
-                state->type = kStateZoomInProgress;
-                return replaceEvent(createZoomEvent(c->event, kCGGesturePhaseChanged, state->zoomCenter, value));
-            }
+            state->type = kStateZoomInProgress;
+            return replaceEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseChanged, value));
         }
 
     case kMomentumScrollEnded:
         state->type = kStateNotInSession;
-        return replaceEvent(createZoomEvent(c->event, kCGGesturePhaseEnded, state->zoomCenter, 0));
+        return replaceEvent(createZoomEvent(state, c->record->event, kCGGesturePhaseEnded, pending));
     }
 }
 
@@ -866,33 +1130,28 @@ static EventResult updateStateZoomInProgress(STZStateRef state, _StateTransition
 //  MARK: - Event Adaptation
 
 
-bool STZIsScrollEventNoOp(CGEventRef event) {
-    if (CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1) != 0) {return false;}
-    if (CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1) != 0) {return false;}
-    if (CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis2) != 0) {return false;}
-    if (CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis2) != 0) {return false;}
-    return true;
+bool STZIsScrollEventNoOp(STZScrollRecord const *record) {
+    return record->pointDelta[0] == 0 && record->fixedPtDelta[0] == 0
+        && record->pointDelta[1] == 0 && record->fixedPtDelta[1] == 0;
 }
 
 
-bool STZIsScrollEventDiscrete(CGEventRef event) {
-    ScrollType scroll = scrollOf(event);
+bool STZIsScrollEventDiscrete(STZScrollRecord const *record) {
+    ScrollType scroll = scrollOf(record);
     return scroll == kDiscretelyScrolled;
 }
 
 
-bool STZScrollEventMayFallIntoMomentum(CGEventRef event) {
-    ScrollType scroll = scrollOf(event);
+bool STZScrollEventMayFallIntoMomentum(STZScrollRecord const *record) {
+    ScrollType scroll = scrollOf(record);
     return (scroll >= kMomentumScrollBegan && scroll <= kMomentumScrollEnded)
         || scroll == kContinuousScrollEnded;
 }
 
 
-static ScrollType scrollOf(CGEventRef event) {
-    assert(CGEventGetType(event) == kCGEventScrollWheel);
-
-    CGScrollPhase sPhase = (CGScrollPhase)CGEventGetIntegerValueField(event, kCGScrollWheelEventScrollPhase);
-    CGMomentumScrollPhase pPhase = (CGMomentumScrollPhase)CGEventGetIntegerValueField(event, kCGScrollWheelEventMomentumPhase);
+static ScrollType scrollOf(STZScrollRecord const *record) {
+    CGScrollPhase sPhase = record->scrollPhase;
+    CGMomentumScrollPhase pPhase = record->momentumPhase;
 
     if (pPhase == kCGMomentumScrollPhaseNone) {
         switch (sPhase) {
@@ -920,58 +1179,71 @@ static ScrollType scrollOf(CGEventRef event) {
 }
 
 
-static void setScrollOf(CGEventRef event, ScrollType scroll) {
+static void setScrollOf(STZScrollRecord *record, ScrollType scroll) {
+    CGScrollPhase sPhase;
+    CGMomentumScrollPhase pPhase;
+
     switch (scroll) {
     case kDiscretelyScrolled:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, 0);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, 0);
+        sPhase = 0;
+        pPhase = 0;
         break;
     case kContinuousScrollMayBegin:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, kCGScrollPhaseMayBegin);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, 0);
+        sPhase = kCGScrollPhaseMayBegin;
+        pPhase = 0;
         break;
     case kContinuousScrollBegan:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, kCGScrollPhaseBegan);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, 0);
+        sPhase = kCGScrollPhaseBegan;
+        pPhase = 0;
         break;
     case kContinuousScrollChanged:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, kCGScrollPhaseChanged);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, 0);
+        sPhase = kCGScrollPhaseChanged;
+        pPhase = 0;
         break;
     case kContinuousScrollEnded:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, kCGScrollPhaseEnded);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, 0);
+        sPhase = kCGScrollPhaseEnded;
+        pPhase = 0;
         break;
     case kContinuousScrollCancelled:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, kCGScrollPhaseCancelled);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, 0);
+        sPhase = kCGScrollPhaseCancelled;
+        pPhase = 0;
         break;
     case kMomentumScrollBegan:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, 0);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, kCGMomentumScrollPhaseBegin);
+        sPhase = 0;
+        pPhase = kCGMomentumScrollPhaseBegin;
         break;
     case kMomentumScrollChanged:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, 0);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, kCGMomentumScrollPhaseContinue);
+        sPhase = 0;
+        pPhase = kCGMomentumScrollPhaseContinue;
         break;
     case kMomentumScrollEnded:
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, 0);
-        CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, kCGMomentumScrollPhaseEnd);
+        sPhase = 0;
+        pPhase = kCGMomentumScrollPhaseEnd;
         break;
     }
+
+    if (record->scrollPhase == sPhase && record->momentumPhase == pPhase) {return;}
+    record->scrollPhase = sPhase;
+    record->momentumPhase = pPhase;
+    record->dirtyFields |= kScrollPhaseDirty;
 }
 
 
-static CGEventRef createZoomEvent(CGEventRef event, CGGesturePhase phase, CGPoint center, double value) {
-    CGEventSourceRef source = CGEventCreateSourceFromEvent(event);
-    CGEventRef zoom = CGEventCreate(source);
-    if (source) {CFRelease(source);}
+static CGEventRef dequeueZoomEvent(STZStateRef state, CGEventFlags flags, CGEventTimestamp timestamp,
+                                   CGGesturePhase phase, double value) {
+    int index = state->zoomEventNext;
+    state->zoomEventNext = (index + 1) % kZoomEventRingSize;
 
-    CGEventSetType(zoom, kCGEventGesture);
-    CGEventSetFlags(zoom, CGEventGetFlags(event));
-    CGEventSetLocation(zoom, center);
-    CGEventSetTimestamp(zoom, CGEventGetTimestamp(event));
-    CGEventSetIntegerValueField(zoom, kCGGestureEventHIDType, kIOHIDEventTypeZoom);
+    //  Every field that differs between zoom events is set below, so a copy of any entry will do.
+    if (state->zoomEvents[index] == NULL) {
+        state->zoomEvents[index] = CGEventCreateCopy(state->zoomEvents[0]);
+    }
+
+    CGEventRef zoom = (CGEventRef)CFRetain(state->zoomEvents[index]);
+
+    CGEventSetFlags(zoom, flags);
+    CGEventSetLocation(zoom, state->zoomCenter);
+    CGEventSetTimestamp(zoom, timestamp);
     CGEventSetIntegerValueField(zoom, kCGGestureEventPhase, phase);
     CGEventSetDoubleValueField(zoom, kCGGestureEventZoomValue, value);
 
@@ -979,18 +1251,30 @@ static CGEventRef createZoomEvent(CGEventRef event, CGGesturePhase phase, CGPoin
 }
 
 
-bool STZCreateCommandBasedZoomKeyEventPair(CGEventRef event, CGEventRef *outEvents) {
-    double value = magnificationFromScroll(event, 0, kCGEventDistantFuture);
+static CGEventRef createZoomEvent(STZStateRef state, CGEventRef event, CGGesturePhase phase, double value) {
+    prepareZoomEvent(state, event);
+    return dequeueZoomEvent(state, CGEventGetFlags(event), CGEventGetTimestamp(event), phase, value);
+}
+
+
+static CGEventRef createRefZoomEvent(STZStateRef state, CGGesturePhase phase, CGEventTimestamp now, double value) {
+    assert(state->hasRefEvent);
+    return dequeueZoomEvent(state, state->refFlags, now, phase, value);
+}
+
+
+bool STZCreateCommandBasedZoomKeyEventPair(STZSettingsSnapshot const *settings, STZScrollRecord const *record, CGEventRef *outEvents) {
+    double value = magnificationFromScroll(settings, record, 0, NULL);
     if (value == 0) {return false;}
 
-    CGEventSourceRef source = CGEventCreateSourceFromEvent(event);
+    CGEventSourceRef source = CGEventCreateSourceFromEvent(record->event);
 
     for (int i = 0; i < 2; ++i) {
         CGEventRef key = CGEventCreate(source);
         CGEventSetType(key, i == 0 ? kCGEventKeyDown : kCGEventKeyUp);
         CGEventSetFlags(key, kCGEventFlagMaskCommand | (value > 0 ? kCGEventFlagMaskShift : 0));
-        CGEventSetLocation(key, CGEventGetLocation(event));
-        CGEventSetTimestamp(key, CGEventGetTimestamp(event));
+        CGEventSetLocation(key, record->location);
+        CGEventSetTimestamp(key, record->timestamp);
         CGEventSetIntegerValueField(key, kCGKeyboardEventKeycode, value > 0 ? 24 : 27);
         CGEventSetIntegerValueField(key, kCGKeyboardEventKeyboardType, 43);  //  ANSI
         outEvents[i] = key;
@@ -7,7 +7,7 @@
  */
 
 #pragma once
-#include "STZCommon.h"
+#include "STZSettings.h"
 
 CF_IMPLICIT_BRIDGING_ENABLED
 CF_ASSUME_NONNULL_BEGIN
@@ -26,18 +26,39 @@ typedef enum {
 } STZGestureType;
 
 
+/// Fields of a scroll event read by the state machine, decoded once per tap callback. Functions
+/// taking a record modify the record only; changes are written back to the event by
+/// `STZScrollRecordWriteBack`, which must be called before the event is posted or returned.
+typedef struct {
+    CGEventRef              event;
+    uint64_t                registryID;
+    CGEventTimestamp        timestamp;
+    CGPoint                 location;
+    CGScrollPhase           scrollPhase;
+    CGMomentumScrollPhase   momentumPhase;
+    int64_t                 pointDelta[2];
+    double                  fixedPtDelta[2];
+    int64_t                 stash;
+    bool                    isDirectionInverted;
+    uint8_t                 dirtyFields;
+} STZScrollRecord;
+
+void STZScrollRecordRead(STZScrollRecord *record, CGEventRef event);
+void STZScrollRecordWriteBack(STZScrollRecord *record);
+
+
 /// Returns a non-zero value stashed into the event, which can be passed as `fallback` to
 /// `STZReadScrollDeltaFromEvent` if the stash is lost unexpectedly.
-uint64_t STZStashScrollDirectionIntoEvent(CGEventRef);
-double STZReadScrollDeltaFromEvent(CGEventRef event, uint64_t fallback, bool unstash);
+uint64_t STZStashScrollDirectionIntoEvent(STZScrollRecord *record);
+double STZReadScrollDeltaFromEvent(STZScrollRecord *record, uint64_t fallback, bool unstash);
 
 
-bool STZIsScrollEventNoOp(CGEventRef event);
-bool STZIsScrollEventDiscrete(CGEventRef event);
-bool STZScrollEventMayFallIntoMomentum(CGEventRef event);
+bool STZIsScrollEventNoOp(STZScrollRecord const *record);
+bool STZIsScrollEventDiscrete(STZScrollRecord const *record);
+bool STZScrollEventMayFallIntoMomentum(STZScrollRecord const *record);
 
 
-bool STZCreateCommandBasedZoomKeyEventPair(CGEventRef event, CGEventRef __nullable outEvents[__nonnull 2]);
+bool STZCreateCommandBasedZoomKeyEventPair(STZSettingsSnapshot const *settings, STZScrollRecord const *record, CGEventRef __nullable outEvents[_Nonnull 2]);
 
 
 typedef struct _STZState *STZStateRef;
@@ -47,17 +68,27 @@ void STZStateRelease(STZStateRef);
 
 bool STZStateIsZooming(STZStateRef);
 
+/// Returns false if the state is out of a session and has nothing left to fix, in which case
+/// none of the functions below would do anything until another scroll event is read.
+bool STZStateIsActive(STZStateRef);
+
 /// Session data are an arbitrary 64-bit value that is preserved during a wheel session and
 /// automatically reset to zero when the session ends. Returns whether the state is in a session.
 bool STZStateGetSessionData(STZStateRef, uint64_t *outData);
 
 /// Forces the state to be synchronized with the scroll event. The caller should inspect
 /// `STZStateCanStopTransformingEvents` to determine whether forced synchronization is safe.
-void STZStateReadScrollEvent(STZStateRef, CGEventRef event);
+void STZStateReadScrollEvent(STZStateRef, STZSettingsSnapshot const *settings, STZScrollRecord const *record);
+
+//  Zoom events returned below are owned by the state, which hands them out round a ring of four
+//  and overwrites one when its turn comes again. Callers post them synchronously, which copies
+//  them, and release them before asking for another; holding one across the next three calls
+//  that return an event is the most allowed. Copy an event to keep it longer.
 
 /// Optionally takes a session data value that will be associated with the session after the call.
 /// However, if the session will end after the call, this value will be ignored.
-CGEventRef __nullable STZStateTransformScrollEvent(STZStateRef, CGEventRef event, STZGestureType gesture,
+CGEventRef __nullable STZStateTransformScrollEvent(STZStateRef, STZSettingsSnapshot const *settings,
+                                                   STZScrollRecord *record, STZGestureType gesture,
                                                    bool fixChromiumZoomStall,
                                                    uint64_t fallbackScrollDir, uint64_t const *sessionData,
                                                    STZEventPlacement *returnEventPlacement) CF_RETURNS_RETAINED;
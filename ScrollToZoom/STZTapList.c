@@ -0,0 +1,175 @@
+/*
+ *  STZTapList.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTapList.h"
+
+
+typedef struct {
+    int32_t             pid;
+    STZTapProcessKind   kind;
+} ProcessKind;
+
+
+struct _STZTapList {
+    int32_t             selfPID;
+    STZTapListSource    source;
+    STZTapProcessClassifier classifier;
+    void               *refcon;
+
+    STZTapInfo         *infos;
+    STZTapProcessKind  *kinds;      ///< Parallel to `infos`; only meaningful for foreign wheel taps.
+    uint32_t            count;
+    uint32_t            capacity;
+    uint64_t            fingerprint;
+    bool                hasUnresolved;
+
+    //  Processes with a foreign wheel tap in the snapshot. There are rarely more than a handful.
+    ProcessKind        *processes;
+    uint32_t            processCount;
+};
+
+
+static uint32_t const kInitialCapacity = 32;
+
+
+STZTapListRef STZTapListCreate(int32_t selfPID, STZTapListSource source, STZTapProcessClassifier classifier, void *refcon) {
+    STZTapListRef list = malloc(sizeof(struct _STZTapList));
+    list->selfPID = selfPID;
+    list->source = source;
+    list->classifier = classifier;
+    list->refcon = refcon;
+    list->infos = malloc(sizeof(STZTapInfo) * kInitialCapacity);
+    list->kinds = malloc(sizeof(STZTapProcessKind) * kInitialCapacity);
+    list->count = 0;
+    list->capacity = kInitialCapacity;
+    list->fingerprint = 0;
+    list->hasUnresolved = false;
+    list->processes = NULL;
+    list->processCount = 0;
+    return list;
+}
+
+
+void STZTapListRelease(STZTapListRef list) {
+    free(list->infos);
+    free(list->kinds);
+    free(list->processes);
+    free(list);
+}
+
+
+static bool isForeignWheelTap(STZTapListRef list, STZTapInfo const *info) {
+    return info->tapsScrollWheel && !info->listensOnly && info->tappingProcess != list->selfPID;
+}
+
+
+static uint64_t fingerprintOf(STZTapInfo const *infos, uint32_t count) {
+    //  FNV-1a over the fields, not the bytes, which include padding.
+    uint64_t hash = 0xcbf29ce484222325;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t fields[] = {
+            infos[i].tapID,
+            infos[i].tapPoint,
+            (uint32_t)infos[i].tappingProcess,
+            (uint64_t)infos[i].listensOnly << 1 | infos[i].tapsScrollWheel,
+        };
+        for (size_t j = 0; j < sizeof(fields) / sizeof(*fields); ++j) {
+            hash = (hash ^ fields[j]) * 0x100000001b3;
+        }
+    }
+    return (hash ^ count) * 0x100000001b3;
+}
+
+
+static ProcessKind *findProcess(ProcessKind *processes, uint32_t count, int32_t pid) {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (processes[i].pid == pid) {return &processes[i];}
+    }
+    return NULL;
+}
+
+
+/// Rebuilds the kinds and the process cache from the snapshot, keeping what is known of processes
+/// still in it and dropping the rest, whose PIDs may be reused.
+static void classifyProcesses(STZTapListRef list) {
+    ProcessKind *known = list->processes;
+    uint32_t knownCount = list->processCount;
+
+    list->processes = malloc(sizeof(ProcessKind) * (list->count ?: 1));
+    list->processCount = 0;
+    list->hasUnresolved = false;
+
+    for (uint32_t i = 0; i < list->count; ++i) {
+        STZTapInfo const *info = &list->infos[i];
+        if (!isForeignWheelTap(list, info)) {continue;}
+
+        ProcessKind *process = findProcess(list->processes, list->processCount, info->tappingProcess);
+        if (!process) {
+            process = &list->processes[list->processCount++];
+            process->pid = info->tappingProcess;
+
+            ProcessKind const *old = findProcess(known, knownCount, info->tappingProcess);
+            if (old && old->kind != kSTZTapProcessUnresolved) {
+                process->kind = old->kind;
+            } else {
+                process->kind = list->classifier(info->tappingProcess, list->refcon);
+            }
+        }
+
+        list->kinds[i] = process->kind;
+        list->hasUnresolved |= process->kind == kSTZTapProcessUnresolved;
+    }
+
+    free(known);
+}
+
+
+bool STZTapListRefresh(STZTapListRef list) {
+    uint32_t count = list->source(list->infos, list->capacity, list->refcon);
+    while (count > list->capacity) {
+        //  Leave room so that a few more taps don’t need another round.
+        list->capacity = count * 2;
+        list->infos = realloc(list->infos, sizeof(STZTapInfo) * list->capacity);
+        list->kinds = realloc(list->kinds, sizeof(STZTapProcessKind) * list->capacity);
+        count = list->source(list->infos, list->capacity, list->refcon);
+    }
+
+    uint64_t fingerprint = fingerprintOf(list->infos, count);
+    bool changed = fingerprint != list->fingerprint;
+    list->count = count;
+    list->fingerprint = fingerprint;
+
+    if (changed || list->hasUnresolved) {
+        classifyProcesses(list);
+    }
+    return changed;
+}
+
+
+STZTapInfo const *STZTapListGetInfos(STZTapListRef list, uint32_t *outCount) {
+    *outCount = list->count;
+    return list->infos;
+}
+
+
+bool STZTapListIsWheelUnderDictatorship(STZTapListRef list, bool newTapsPrependToList) {
+    for (uint32_t i = 0; i < list->count; ++i) {
+        STZTapInfo const *info = &list->infos[i];
+        if (!info->tapsScrollWheel || info->listensOnly) {continue;}
+
+        if (info->tappingProcess == list->selfPID) {
+            //  Only a prepended list tells that taps after ours were created earlier.
+            if (newTapsPrependToList) {return true;}
+            continue;
+        }
+
+        if (list->kinds[i] != kSTZTapProcessSystem) {return false;}
+    }
+
+    return false;
+}
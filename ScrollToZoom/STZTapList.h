@@ -0,0 +1,64 @@
+/*
+ *  STZTapList.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Keeps a snapshot of the system event tap list, so that checking whether our scroll wheel taps
+//  still come first costs one call into the window server and a hash when nothing has changed.
+//
+//  The snapshot is fingerprinted instead of kept twice; a 64-bit collision between two tap lists
+//  is not a practical concern. Tapping processes are classified only when first seen, and the
+//  results are kept while the process has a tap in the list.
+
+
+typedef struct {
+    uint32_t            tapID;
+    uint32_t            tapPoint;       ///< A `CGEventTapLocation`.
+    int32_t             tappingProcess;
+    bool                listensOnly;
+    bool                tapsScrollWheel;
+} STZTapInfo;
+
+
+/// Fills at most `capacity` taps in the order of the system list, and returns how many there are
+/// in total, which may be more.
+typedef uint32_t (*STZTapListSource)(STZTapInfo *infos, uint32_t capacity, void *__nullable refcon);
+
+
+typedef CLOSED_ENUM(uint8_t) {
+    kSTZTapProcessUnresolved,   ///< Treated as a foreign process, but asked again on each refresh.
+    kSTZTapProcessSystem,
+    kSTZTapProcessForeign,
+} STZTapProcessKind;
+
+typedef STZTapProcessKind (*STZTapProcessClassifier)(int32_t pid, void *__nullable refcon);
+
+
+typedef struct _STZTapList *STZTapListRef;
+
+/// Taps of `selfPID` are never classified.
+STZTapListRef STZTapListCreate(int32_t selfPID, STZTapListSource source, STZTapProcessClassifier classifier, void *__nullable refcon);
+void STZTapListRelease(STZTapListRef);
+
+/// Reads the list again from the source. Returns false if it is the same as before.
+bool STZTapListRefresh(STZTapListRef);
+
+STZTapInfo const *STZTapListGetInfos(STZTapListRef, uint32_t *outCount);
+
+/// Whether no foreign, non-system process can see scroll wheel events before us, judging from
+/// the snapshot. A process not classified yet may be foreign, so it counts as one. If new taps
+/// are known to be prepended to the system list, a foreign tap listed after ours was created
+/// before and doesn’t count.
+bool STZTapListIsWheelUnderDictatorship(STZTapListRef, bool newTapsPrependToList);
+
+
+CF_ASSUME_NONNULL_END
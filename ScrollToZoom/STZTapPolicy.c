@@ -0,0 +1,144 @@
+/*
+ *  STZTapPolicy.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTapPolicy.h"
+
+
+#define kMaxTrackedSwitches 64
+
+
+struct _STZTapPolicy {
+    CGEventTimestamp    lingerTime;
+    uint32_t            maxSwitchesPerSecond;
+
+    bool                isMutable;
+    CGEventTimestamp    mutableSince;
+    CGEventTimestamp    endableSince;  ///< 0 while mutation is needed.
+    CGEventTimestamp    deferredUntil;
+
+    //  Times of the latest switches, oldest first from `nextSwitch`.
+    CGEventTimestamp    switchTimes[kMaxTrackedSwitches];
+    uint32_t            nextSwitch;
+
+    uint64_t            switches;
+    uint64_t            deferredByLimit;
+    CGEventTimestamp    mutableTime;
+};
+
+
+STZTapPolicyRef STZTapPolicyCreate(void) {
+    //  Zero switch times read as long ago.
+    return calloc(1, sizeof(struct _STZTapPolicy));
+}
+
+
+void STZTapPolicyRelease(STZTapPolicyRef policy) {
+    free(policy);
+}
+
+
+void STZTapPolicyConfigure(STZTapPolicyRef policy, CGEventTimestamp lingerTime, uint32_t maxSwitchesPerSecond) {
+    policy->lingerTime = lingerTime;
+    policy->maxSwitchesPerSecond = maxSwitchesPerSecond < kMaxTrackedSwitches ? maxSwitchesPerSecond : kMaxTrackedSwitches;
+}
+
+
+bool STZTapPolicyIsMutable(STZTapPolicyRef policy) {
+    return policy->isMutable;
+}
+
+
+void STZTapPolicyReset(STZTapPolicyRef policy, CGEventTimestamp now) {
+    if (policy->isMutable) {
+        policy->isMutable = false;
+        policy->mutableTime += now - policy->mutableSince;
+    }
+    policy->endableSince = 0;
+}
+
+
+static void recordSwitch(STZTapPolicyRef policy, CGEventTimestamp now) {
+    policy->switchTimes[policy->nextSwitch] = now;
+    policy->nextSwitch = (policy->nextSwitch + 1) % kMaxTrackedSwitches;
+    policy->switches += 1;
+}
+
+
+/// Returns 0 if the limit allows another switch, or else when it will.
+static CGEventTimestamp nextAllowedSwitchTime(STZTapPolicyRef policy, CGEventTimestamp now) {
+    uint32_t limit = policy->maxSwitchesPerSecond;
+    if (limit == 0) {return 0;}
+
+    //  The switch that would be pushed out of the last second.
+    uint32_t index = (policy->nextSwitch + kMaxTrackedSwitches - limit) % kMaxTrackedSwitches;
+    CGEventTimestamp oldest = policy->switchTimes[index];
+    if (oldest == 0 || now >= oldest + NSEC_PER_SEC) {return 0;}
+    return oldest + NSEC_PER_SEC;
+}
+
+
+bool STZTapPolicyRequireMutable(STZTapPolicyRef policy, CGEventTimestamp now) {
+    policy->endableSince = 0;
+    if (policy->isMutable) {return false;}
+
+    policy->isMutable = true;
+    policy->mutableSince = now;
+    recordSwitch(policy, now);
+    return true;
+}
+
+
+bool STZTapPolicyMayEndMutable(STZTapPolicyRef policy, CGEventTimestamp now, bool canEnd, CGEventTimestamp *outRetryTime) {
+    *outRetryTime = 0;
+    if (!policy->isMutable) {return false;}
+
+    if (!canEnd) {
+        policy->endableSince = 0;
+        return false;
+    }
+
+    if (policy->endableSince == 0) {
+        policy->endableSince = now;
+    }
+
+    CGEventTimestamp lingerEnd = policy->endableSince + policy->lingerTime;
+    if (now < lingerEnd) {
+        *outRetryTime = lingerEnd;
+        return false;
+    }
+
+    CGEventTimestamp allowed = nextAllowedSwitchTime(policy, now);
+    if (allowed != 0) {
+        if (policy->deferredUntil != allowed) {
+            policy->deferredUntil = allowed;
+            policy->deferredByLimit += 1;
+        }
+        *outRetryTime = allowed;
+        return false;
+    }
+
+    policy->isMutable = false;
+    policy->endableSince = 0;
+    policy->mutableTime += now - policy->mutableSince;
+    recordSwitch(policy, now);
+    return true;
+}
+
+
+STZTapPolicyStatistics STZTapPolicyGetStatistics(STZTapPolicyRef policy, CGEventTimestamp now) {
+    CGEventTimestamp mutableTime = policy->mutableTime;
+    if (policy->isMutable && now > policy->mutableSince) {
+        mutableTime += now - policy->mutableSince;
+    }
+
+    return (STZTapPolicyStatistics){
+        .switches = policy->switches,
+        .deferredByLimit = policy->deferredByLimit,
+        .mutableTime = mutableTime,
+    };
+}
@@ -0,0 +1,56 @@
+/*
+ *  STZTapPolicy.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Decides when scroll wheel taps switch between passive and mutable. Passive taps add no
+//  latency, but every switch reconfigures up to four taps, so a jittery trigger key or short
+//  flicks would flip them many times a second.
+//
+//  Switching to mutable is never refused, since events would be missed otherwise. Switching
+//  back waits until mutation hasn’t been needed for the linger time, and, if the taps have
+//  switched too often in the last second, until they may switch again. Both delays are bounded,
+//  so the mutable path is never kept on indefinitely.
+
+
+typedef struct _STZTapPolicy *STZTapPolicyRef;
+
+STZTapPolicyRef STZTapPolicyCreate(void);
+void STZTapPolicyRelease(STZTapPolicyRef);
+
+/// `maxSwitchesPerSecond` of 0 means no limit.
+void STZTapPolicyConfigure(STZTapPolicyRef, CGEventTimestamp lingerTime, uint32_t maxSwitchesPerSecond);
+
+bool STZTapPolicyIsMutable(STZTapPolicyRef);
+
+/// Takes the taps as passive without counting a switch, e.g. after they are released.
+void STZTapPolicyReset(STZTapPolicyRef, CGEventTimestamp now);
+
+/// Returns true if the taps should switch to mutable now.
+bool STZTapPolicyRequireMutable(STZTapPolicyRef, CGEventTimestamp now);
+
+/// Reports whether the taps could stop mutating. Returns true if they should switch to passive
+/// now. Otherwise, if switching is only put off, `outRetryTime` is when to ask again; it is 0 if
+/// mutation is still needed or the taps are already passive.
+bool STZTapPolicyMayEndMutable(STZTapPolicyRef, CGEventTimestamp now, bool canEnd, CGEventTimestamp *outRetryTime);
+
+
+typedef struct {
+    uint64_t            switches;
+    uint64_t            deferredByLimit;    ///< Times switching back was put off by the limit.
+    CGEventTimestamp    mutableTime;        ///< In nanoseconds, up to `now`.
+} STZTapPolicyStatistics;
+
+STZTapPolicyStatistics STZTapPolicyGetStatistics(STZTapPolicyRef, CGEventTimestamp now);
+
+
+CF_ASSUME_NONNULL_END
@@ -0,0 +1,211 @@
+/*
+ *  STZTapSlots.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTapSlots.h"
+#include <stdatomic.h>
+#include <sched.h>
+
+
+typedef struct {
+    _Atomic(uint64_t)   registryID;  ///< 0 means free.
+
+    //  Non-zero while the owner is writing. A slot is only taken over if it is zero, and the
+    //  owner only writes if the slot is still its own after making it non-zero; with both
+    //  sequentially consistent, one of them always sees the other.
+    _Atomic(uint32_t)   writing;
+    _Atomic(CGEventTimestamp) lastWriteTime;
+
+    _Atomic(uint32_t)   sequence;
+    _Atomic(bool)       recognized;
+    _Atomic(CGEventTimestamp) tapTimestamp;
+} TapSlot;
+
+//  Set while a slot is being reset for a new owner. Readers never match it.
+static uint64_t const kClaimingRegistryID = UINT64_MAX;
+
+static TapSlot tapSlots[kSTZTapSlotCount];
+
+//  Logs once each time the table fills up, not on every frame of the mouse left out.
+static _Atomic(bool) loggedFullTable = false;
+
+
+void STZTapSlotPublish(int slot, STZTapState state) {
+    TapSlot *tapSlot = &tapSlots[slot];
+    uint32_t sequence = atomic_load_explicit(&tapSlot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&tapSlot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&tapSlot->recognized, state.recognized, memory_order_relaxed);
+    atomic_store_explicit(&tapSlot->tapTimestamp, state.tapTimestamp, memory_order_relaxed);
+    atomic_store_explicit(&tapSlot->sequence, sequence + 2, memory_order_release);
+}
+
+
+STZTapState STZTapSlotGetState(int slot) {
+    TapSlot *tapSlot = &tapSlots[slot];
+    return (STZTapState){
+        .recognized = atomic_load_explicit(&tapSlot->recognized, memory_order_relaxed),
+        .tapTimestamp = atomic_load_explicit(&tapSlot->tapTimestamp, memory_order_relaxed),
+    };
+}
+
+
+static int findSlot(uint64_t registryID) {
+    if (registryID == 0 || registryID == kClaimingRegistryID) {return -1;}
+    for (int i = 0; i < kSTZTapSlotCount; ++i) {
+        if (atomic_load_explicit(&tapSlots[i].registryID, memory_order_acquire) == registryID) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/// Returns false if the slot has been taken over.
+static bool enterSlot(int slot, uint64_t registryID) {
+    TapSlot *tapSlot = &tapSlots[slot];
+    while (true) {
+        atomic_fetch_add(&tapSlot->writing, 1);
+        uint64_t owner = atomic_load(&tapSlot->registryID);
+        if (owner == registryID) {return true;}
+        atomic_fetch_sub(&tapSlot->writing, 1);
+
+        //  A taker that sees us writing gives the slot back at once.
+        if (owner != kClaimingRegistryID) {return false;}
+        sched_yield();
+    }
+}
+
+
+/// The slot must be marked as claiming. Leaves it marked as being written by the new owner.
+static void resetSlot(int slot, uint64_t registryID, CGEventTimestamp now) {
+    TapSlot *tapSlot = &tapSlots[slot];
+    atomic_fetch_add(&tapSlot->writing, 1);
+    STZTapSlotPublish(slot, (STZTapState){false, 0});
+    atomic_store_explicit(&tapSlot->lastWriteTime, now, memory_order_relaxed);
+    atomic_store_explicit(&tapSlot->registryID, registryID, memory_order_release);
+}
+
+
+static bool takeOverSlot(int slot, uint64_t owner) {
+    TapSlot *tapSlot = &tapSlots[slot];
+    if (!atomic_compare_exchange_strong(&tapSlot->registryID, &owner, kClaimingRegistryID)) {return false;}
+    if (atomic_load(&tapSlot->writing) == 0) {return true;}
+    atomic_store(&tapSlot->registryID, owner);
+    return false;
+}
+
+
+static int claimSlot(uint64_t registryID, CGEventTimestamp now) {
+    for (int i = 0; i < kSTZTapSlotCount; ++i) {
+        uint64_t expected = 0;
+        if (atomic_compare_exchange_strong(&tapSlots[i].registryID, &expected, kClaimingRegistryID)) {
+            resetSlot(i, registryID, now);
+            return i;
+        }
+    }
+
+    //  Take over the slot that has been idle for the longest, if long enough. If its owner
+    //  writes meanwhile, it is no longer idle; the next frame looks again.
+    int oldest = -1;
+    uint64_t oldestOwner = 0;
+    CGEventTimestamp oldestTime = now;
+
+    for (int i = 0; i < kSTZTapSlotCount; ++i) {
+        uint64_t owner = atomic_load_explicit(&tapSlots[i].registryID, memory_order_relaxed);
+        CGEventTimestamp time = atomic_load_explicit(&tapSlots[i].lastWriteTime, memory_order_relaxed);
+        if (owner == 0 || owner == kClaimingRegistryID) {continue;}
+        if (time < oldestTime && now - time > kSTZTapSlotLifetime) {
+            oldest = i;
+            oldestOwner = owner;
+            oldestTime = time;
+        }
+    }
+
+    if (oldest >= 0 && takeOverSlot(oldest, oldestOwner)) {
+        resetSlot(oldest, registryID, now);
+        return oldest;
+    }
+
+    if (!atomic_exchange(&loggedFullTable, true)) {
+        STZDebugLog("No tap slot left for Magic Mouse %llx; at most %d mice can zoom at a time",
+                    (unsigned long long)registryID, kSTZTapSlotCount);
+    }
+    return -1;
+}
+
+
+int STZTapSlotBeginWriting(uint64_t registryID, CGEventTimestamp now, bool *outClaimed) {
+    *outClaimed = false;
+    if (registryID == 0 || registryID == kClaimingRegistryID) {return -1;}
+
+    int slot = findSlot(registryID);
+    if (slot >= 0 && !enterSlot(slot, registryID)) {
+        slot = -1;
+    }
+
+    if (slot < 0) {
+        slot = claimSlot(registryID, now);
+        if (slot < 0) {return -1;}
+        *outClaimed = true;
+    }
+
+    atomic_store_explicit(&tapSlots[slot].lastWriteTime, now, memory_order_relaxed);
+    return slot;
+}
+
+
+void STZTapSlotEndWriting(int slot) {
+    atomic_fetch_sub(&tapSlots[slot].writing, 1);
+}
+
+
+bool STZTapSlotRead(uint64_t registryID, STZTapState *outState) {
+    int slot = findSlot(registryID);
+    if (slot < 0) {return false;}
+
+    TapSlot *tapSlot = &tapSlots[slot];
+    uint32_t before, after;
+    do {
+        before = atomic_load_explicit(&tapSlot->sequence, memory_order_acquire);
+        outState->recognized = atomic_load_explicit(&tapSlot->recognized, memory_order_relaxed);
+        outState->tapTimestamp = atomic_load_explicit(&tapSlot->tapTimestamp, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&tapSlot->sequence, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    //  The state read belongs to another device if the slot was taken over meanwhile.
+    return atomic_load_explicit(&tapSlot->registryID, memory_order_acquire) == registryID;
+}
+
+
+void STZTapSlotRelease(uint64_t registryID) {
+    if (registryID == 0 || registryID == kClaimingRegistryID) {return;}
+
+    for (int i = 0; i < kSTZTapSlotCount; ++i) {
+        uint64_t expected = registryID;
+        while (!atomic_compare_exchange_strong(&tapSlots[i].registryID, &expected, 0)) {
+            //  A taker is checking the slot; it either gives it back or resets it.
+            if (expected != kClaimingRegistryID) {break;}
+            expected = registryID;
+            sched_yield();
+        }
+    }
+
+    atomic_store(&loggedFullTable, false);
+}
+
+
+bool STZShouldBeginMagicZoom(uint64_t registryID) {
+    const CGEventTimestamp timeout = 0.5 * NSEC_PER_SEC;
+
+    STZTapState state;
+    if (!STZTapSlotRead(registryID, &state) || !state.recognized) {return false;}
+
+    CGEventTimestamp now = CGEventTimestampNow();
+    return (now - state.tapTimestamp) < timeout;
+}
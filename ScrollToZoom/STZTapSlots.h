@@ -0,0 +1,56 @@
+/*
+ *  STZTapSlots.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  The tap state of each Magic Mouse lives in a slot of a fixed table, written only by the frame
+//  callback of the device, so frames of different devices never contend. The state is published
+//  by a sequence lock: the writer makes the sequence odd while updating it, and readers retry
+//  until they see the same even sequence before and after reading, so the event tap never waits
+//  for a frame being processed.
+//
+//  A slot is claimed by the first frame of a device and released when the device is stopped.
+//  When the table is full, the slot of a device that has sent no frames for `kSTZTapSlotLifetime`
+//  is taken over, so a mouse that was put away without being detached doesn’t hold it forever.
+
+#define kSTZTapSlotCount 8
+#define kSTZTapSlotLifetime (300 * NSEC_PER_SEC)
+
+
+typedef struct {
+    bool                recognized;
+    CGEventTimestamp    tapTimestamp;
+} STZTapState;
+
+
+/// Returns the index of the slot of the device, claiming one if it has none, or -1 if the table
+/// is full. `outClaimed` tells whether the slot was just claimed, in which case its state is
+/// reset and the caller should reset its own per-slot data. Must be paired with
+/// `STZTapSlotEndWriting` if a slot is returned; until then, the slot is not taken over.
+int STZTapSlotBeginWriting(uint64_t registryID, CGEventTimestamp now, bool *outClaimed);
+void STZTapSlotEndWriting(int slot);
+
+/// The writer reads its own published state directly.
+STZTapState STZTapSlotGetState(int slot);
+void STZTapSlotPublish(int slot, STZTapState state);
+
+/// Returns false if the device has no slot. Never blocks.
+bool STZTapSlotRead(uint64_t registryID, STZTapState *outState);
+
+/// Should be called after the device is stopped, so that no frame is being written.
+void STZTapSlotRelease(uint64_t registryID);
+
+/// Whether the device was recognized to zoom by a tap recent enough for its scroll to begin one.
+bool STZShouldBeginMagicZoom(uint64_t registryID);
+
+
+CF_ASSUME_NONNULL_END
@@ -0,0 +1,968 @@
+/*
+ *  STZTrace.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTrace.h"
+#include "CGEventSPI.h"
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+static char const traceMagic[4] = {'S', 'T', 'Z', 'T'};
+#define HEADER_SIZE 8
+
+#define LOCATION_SCALE 4
+#define FIXED_PT_SCALE 65536
+#define TOUCH_SCALE 1024
+
+typedef OPTION_FLAGS(uint8_t) {
+    kScrollHasFlags             = 1 << 0,
+    kScrollHasPID               = 1 << 1,
+    kScrollIsDirectionInverted  = 1 << 2,
+} ScrollBits;
+
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+
+static int64_t quantize(double value, double scale) {
+    return (int64_t)llround(value * scale);
+}
+
+
+//  MARK: - Recording
+
+
+typedef struct {
+    uint8_t     bytes[1024];
+    size_t      length;
+} Encoder;
+
+static void encodeByte(Encoder *encoder, uint8_t byte) {
+    encoder->bytes[encoder->length++] = byte;
+}
+
+static void encodeVarint(Encoder *encoder, uint64_t value) {
+    while (value >= 0x80) {
+        encodeByte(encoder, (uint8_t)value | 0x80);
+        value >>= 7;
+    }
+    encodeByte(encoder, (uint8_t)value);
+}
+
+static void encodeSignedVarint(Encoder *encoder, int64_t value) {
+    encodeVarint(encoder, zigzag(value));
+}
+
+
+//  Dictionaries only grow during a trace; there are a handful of devices and apps at most, so
+//  linear search is fine.
+
+typedef struct {
+    void       *items;
+    size_t      count;
+    size_t      capacity;
+} Array;
+
+static void *arrayAppend(Array *array, size_t itemSize) {
+    if (array->count == array->capacity) {
+        array->capacity = array->capacity ? array->capacity * 2 : 16;
+        array->items = realloc(array->items, array->capacity * itemSize);
+    }
+    return (char *)array->items + itemSize * array->count++;
+}
+
+static void arrayRemoveAll(Array *array) {
+    free(array->items);
+    *array = (Array){NULL, 0, 0};
+}
+
+
+typedef struct {
+    int32_t     pid;
+    uint32_t    bundleIndex;
+} ProcessEntry;
+
+
+//  Records come from the event taps and the MultitouchSupport thread, which must never wait for
+//  the disk or for each other. They are pushed unencoded into a bounded lock-free queue, and a
+//  writer thread that wakes every few milliseconds encodes them in queue order and writes them
+//  out. A record that finds the queue full is dropped and counted; the trace stays decodable,
+//  since all the state of the encoding lives with the writer.
+//
+//  Pushers announce themselves in `activePushers` before checking `recording`, so once stopping
+//  has cleared it and seen no pushers, nothing more can be pushed and the writer can drain the
+//  queue for the last time.
+
+#define kQueueCapacity 1024  //  A power of two; far more than arrives between two wakes.
+#define kWriterInterval (NSEC_PER_SEC / 100)
+#define kMaxBundleIDLength 255
+#define kKnownPIDCapacity 256
+
+
+typedef struct {
+    STZTraceKind        kind;
+    CGEventTimestamp    timestamp;
+    uint64_t            registryID;
+
+    union {
+        struct {
+            int32_t     pid;
+            uint8_t     length;  ///< 0 if the bundle ID is unknown.
+            char        bundleID[kMaxBundleIDLength];
+        } process;
+
+        struct {
+            CGScrollPhase           scrollPhase;
+            CGMomentumScrollPhase   momentumPhase;
+            CGEventFlags            flags;
+            int32_t                 pid;
+            bool                    isDirectionInverted;
+            CGPoint                 location;
+            int64_t                 pointDelta[2];
+            double                  fixedPtDelta[2];
+        } scroll;
+
+        struct {
+            CGEventFlags            flags;
+            bool                    down;
+        } trigger;
+
+        bool                        magicZoomActive;
+
+        struct {
+            uint8_t                 count;
+            STZTraceTouch           touches[STZ_TRACE_MAX_TOUCHES];
+        } touches;
+    };
+} PendingRecord;
+
+
+/// A cell is free for the push at position `p` when its sequence is `p`, and holds the record of
+/// that push when it is `p + 1`.
+typedef struct {
+    _Atomic(size_t)     sequence;
+    PendingRecord       record;
+} QueueCell;
+
+static QueueCell queueCells[kQueueCapacity];
+static _Atomic(size_t) queuePushPosition = 0;
+static size_t queuePopPosition = 0;  //  Only the writer pops.
+
+static atomic_bool recording = false;
+static _Atomic(int) activePushers = 0;
+static _Atomic(uint64_t) droppedRecords = 0;
+
+//  Processes pushed in the current trace, so that the taps needn’t ask the writer.
+static _Atomic(int32_t) knownPIDs[kKnownPIDCapacity];
+static _Atomic(int) knownPIDCount = 0;
+
+//  Starting and stopping are serialized by this lock; recording never takes it.
+static pthread_mutex_t controlLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t writerThread;
+static atomic_bool writerShouldExit = false;
+
+//  Owned by the writer thread while recording.
+static FILE *traceFile = NULL;
+static CGEventTimestamp recentTimestamp = 0;
+static Array recordedDevices = {NULL, 0, 0};
+static Array recordedBundles = {NULL, 0, 0};
+static Array recordedProcesses = {NULL, 0, 0};
+static CGEventFlags recentScrollFlags = 0;
+static int32_t recentScrollPID = 0;
+static int64_t recentScrollLocation[2] = {0, 0};
+
+
+bool STZTraceIsRecording(void) {
+    return atomic_load_explicit(&recording, memory_order_relaxed);
+}
+
+
+/// Returns a cell to fill and pass to `endPush`, or NULL if no trace is being recorded or the
+/// queue is full. The caller must call `endPush` either way.
+static QueueCell *beginPush(size_t *outPosition) {
+    atomic_fetch_add_explicit(&activePushers, 1, memory_order_seq_cst);
+    if (!atomic_load_explicit(&recording, memory_order_seq_cst)) {return NULL;}
+
+    size_t position = atomic_load_explicit(&queuePushPosition, memory_order_relaxed);
+    while (true) {
+        QueueCell *cell = &queueCells[position & (kQueueCapacity - 1)];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queuePushPosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *outPosition = position;
+                return cell;
+            }
+        } else if (difference < 0) {
+            atomic_fetch_add_explicit(&droppedRecords, 1, memory_order_relaxed);
+            return NULL;
+        } else {
+            position = atomic_load_explicit(&queuePushPosition, memory_order_relaxed);
+        }
+    }
+}
+
+
+static void endPush(QueueCell *cell, size_t position) {
+    if (cell) {
+        atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    }
+    atomic_fetch_sub_explicit(&activePushers, 1, memory_order_release);
+}
+
+
+static bool popRecord(PendingRecord *record) {
+    QueueCell *cell = &queueCells[queuePopPosition & (kQueueCapacity - 1)];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if (sequence != queuePopPosition + 1) {return false;}
+
+    *record = cell->record;
+    atomic_store_explicit(&cell->sequence, queuePopPosition + kQueueCapacity, memory_order_release);
+    queuePopPosition += 1;
+    return true;
+}
+
+
+static void resetQueue(void) {
+    for (size_t i = 0; i < kQueueCapacity; ++i) {
+        atomic_store_explicit(&queueCells[i].sequence, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&queuePushPosition, 0, memory_order_relaxed);
+    queuePopPosition = 0;
+    atomic_store_explicit(&droppedRecords, 0, memory_order_relaxed);
+    atomic_store_explicit(&knownPIDCount, 0, memory_order_relaxed);
+
+    //  A slot counted but not yet stored reads 0, which no process being scrolled has.
+    for (size_t i = 0; i < kKnownPIDCapacity; ++i) {
+        atomic_store_explicit(&knownPIDs[i], 0, memory_order_relaxed);
+    }
+}
+
+
+static void resetRecorder(void) {
+    recentTimestamp = 0;
+    recentScrollFlags = 0;
+    recentScrollPID = 0;
+    recentScrollLocation[0] = 0;
+    recentScrollLocation[1] = 0;
+
+    for (size_t i = 0; i < recordedBundles.count; ++i) {
+        free(((char **)recordedBundles.items)[i]);
+    }
+
+    arrayRemoveAll(&recordedDevices);
+    arrayRemoveAll(&recordedBundles);
+    arrayRemoveAll(&recordedProcesses);
+}
+
+
+//  MARK: Encoding
+
+
+static void beginRecord(Encoder *encoder, STZTraceKind kind, CGEventTimestamp timestamp) {
+    encodeByte(encoder, kind);
+    encodeSignedVarint(encoder, (int64_t)(timestamp - recentTimestamp));
+    recentTimestamp = timestamp;
+}
+
+
+static void endRecord(Encoder *encoder) {
+    fwrite(encoder->bytes, 1, encoder->length, traceFile);
+    encoder->length = 0;
+}
+
+
+static uint64_t deviceIndex(uint64_t registryID, CGEventTimestamp timestamp) {
+    uint64_t const *devices = recordedDevices.items;
+    for (size_t i = 0; i < recordedDevices.count; ++i) {
+        if (devices[i] == registryID) {return i + 1;}
+    }
+
+    *(uint64_t *)arrayAppend(&recordedDevices, sizeof(uint64_t)) = registryID;
+
+    Encoder encoder = {.length = 0};
+    beginRecord(&encoder, kSTZTraceDevice, timestamp);
+    encodeVarint(&encoder, registryID);
+    endRecord(&encoder);
+
+    return recordedDevices.count;
+}
+
+
+static ProcessEntry *findProcess(int32_t pid) {
+    ProcessEntry *processes = recordedProcesses.items;
+    for (size_t i = 0; i < recordedProcesses.count; ++i) {
+        if (processes[i].pid == pid) {return processes + i;}
+    }
+    return NULL;
+}
+
+
+static void writeProcess(PendingRecord const *record) {
+    char const *bundleID = record->process.bundleID;
+    size_t bundleIDLength = record->process.length;
+    uint32_t bundleIndex = 0;
+    bool newBundle = false;
+
+    if (bundleIDLength) {
+        char **bundles = recordedBundles.items;
+        for (size_t i = 0; i < recordedBundles.count; ++i) {
+            if (strlen(bundles[i]) == bundleIDLength && memcmp(bundles[i], bundleID, bundleIDLength) == 0) {
+                bundleIndex = (uint32_t)i + 1;
+                break;
+            }
+        }
+
+        if (!bundleIndex) {
+            *(char **)arrayAppend(&recordedBundles, sizeof(char *)) = strndup(bundleID, bundleIDLength);
+            bundleIndex = (uint32_t)recordedBundles.count;
+            newBundle = true;
+        }
+    }
+
+    ProcessEntry *entry = findProcess(record->process.pid);
+    if (!entry) {
+        entry = arrayAppend(&recordedProcesses, sizeof(ProcessEntry));
+        entry->pid = record->process.pid;
+    }
+    entry->bundleIndex = bundleIndex;
+
+    Encoder encoder = {.length = 0};
+    beginRecord(&encoder, kSTZTraceProcess, recentTimestamp);
+    encodeVarint(&encoder, (uint32_t)record->process.pid);
+    encodeVarint(&encoder, bundleIndex);
+    if (newBundle) {
+        encodeVarint(&encoder, bundleIDLength);
+        memcpy(encoder.bytes + encoder.length, bundleID, bundleIDLength);
+        encoder.length += bundleIDLength;
+    }
+    endRecord(&encoder);
+}
+
+
+static void writeScroll(PendingRecord const *record) {
+    uint64_t device = deviceIndex(record->registryID, record->timestamp);
+
+    ScrollBits bits = 0;
+    if (record->scroll.flags != recentScrollFlags) {bits |= kScrollHasFlags;}
+    if (record->scroll.pid != recentScrollPID) {bits |= kScrollHasPID;}
+    if (record->scroll.isDirectionInverted) {bits |= kScrollIsDirectionInverted;}
+
+    int64_t location[2] = {
+        quantize(record->scroll.location.x, LOCATION_SCALE),
+        quantize(record->scroll.location.y, LOCATION_SCALE),
+    };
+
+    Encoder encoder = {.length = 0};
+    beginRecord(&encoder, kSTZTraceScroll, record->timestamp);
+    encodeByte(&encoder, bits);
+    encodeVarint(&encoder, device);
+    encodeVarint(&encoder, record->scroll.scrollPhase);
+    encodeVarint(&encoder, record->scroll.momentumPhase);
+    if (bits & kScrollHasFlags) {encodeVarint(&encoder, record->scroll.flags);}
+    if (bits & kScrollHasPID) {encodeVarint(&encoder, (uint32_t)record->scroll.pid);}
+    encodeSignedVarint(&encoder, location[0] - recentScrollLocation[0]);
+    encodeSignedVarint(&encoder, location[1] - recentScrollLocation[1]);
+    encodeSignedVarint(&encoder, record->scroll.pointDelta[0]);
+    encodeSignedVarint(&encoder, record->scroll.pointDelta[1]);
+    encodeSignedVarint(&encoder, quantize(record->scroll.fixedPtDelta[0], FIXED_PT_SCALE));
+    encodeSignedVarint(&encoder, quantize(record->scroll.fixedPtDelta[1], FIXED_PT_SCALE));
+    endRecord(&encoder);
+
+    recentScrollFlags = record->scroll.flags;
+    recentScrollPID = record->scroll.pid;
+    recentScrollLocation[0] = location[0];
+    recentScrollLocation[1] = location[1];
+}
+
+
+static void writeTrigger(PendingRecord const *record) {
+    Encoder encoder = {.length = 0};
+    beginRecord(&encoder, kSTZTraceTrigger, record->timestamp);
+    encodeVarint(&encoder, record->trigger.flags);
+    encodeByte(&encoder, record->trigger.down);
+    endRecord(&encoder);
+}
+
+
+static void writeMagicZoom(PendingRecord const *record) {
+    uint64_t device = deviceIndex(record->registryID, record->timestamp);
+
+    Encoder encoder = {.length = 0};
+    beginRecord(&encoder, kSTZTraceMagicZoom, record->timestamp);
+    encodeVarint(&encoder, device);
+    encodeByte(&encoder, record->magicZoomActive);
+    endRecord(&encoder);
+}
+
+
+static void writeTouches(PendingRecord const *record) {
+    uint64_t device = deviceIndex(record->registryID, record->timestamp);
+    STZTraceTouch const *touches = record->touches.touches;
+
+    Encoder encoder = {.length = 0};
+    beginRecord(&encoder, kSTZTraceTouches, record->timestamp);
+    encodeVarint(&encoder, device);
+    encodeByte(&encoder, record->touches.count);
+
+    for (int i = 0; i < record->touches.count; ++i) {
+        encodeByte(&encoder, touches[i].fingerID);
+        encodeByte(&encoder, touches[i].phase);
+        encodeSignedVarint(&encoder, quantize(touches[i].location[0], TOUCH_SCALE));
+        encodeSignedVarint(&encoder, quantize(touches[i].location[1], TOUCH_SCALE));
+        encodeSignedVarint(&encoder, quantize(touches[i].velocity[0], TOUCH_SCALE));
+        encodeSignedVarint(&encoder, quantize(touches[i].velocity[1], TOUCH_SCALE));
+        encodeSignedVarint(&encoder, quantize(touches[i].zTotal, TOUCH_SCALE));
+        encodeSignedVarint(&encoder, quantize(touches[i].zDensity, TOUCH_SCALE));
+    }
+
+    endRecord(&encoder);
+}
+
+
+static void writePendingRecords(void) {
+    PendingRecord record;
+    while (popRecord(&record)) {
+        switch (record.kind) {
+        case kSTZTraceProcess:      writeProcess(&record); break;
+        case kSTZTraceScroll:       writeScroll(&record); break;
+        case kSTZTraceTrigger:      writeTrigger(&record); break;
+        case kSTZTraceMagicZoom:    writeMagicZoom(&record); break;
+        case kSTZTraceTouches:      writeTouches(&record); break;
+        case kSTZTraceDevice:       break;  //  Written by the writer itself.
+        }
+    }
+}
+
+
+static void *runWriter(void *info) {
+    struct timespec interval = {0, kWriterInterval};
+    while (!atomic_load_explicit(&writerShouldExit, memory_order_acquire)) {
+        writePendingRecords();
+        nanosleep(&interval, NULL);
+    }
+
+    writePendingRecords();
+    return NULL;
+}
+
+
+//  MARK: Control
+
+
+bool STZTraceStartRecording(char const *path) {
+    pthread_mutex_lock(&controlLock);
+
+    if (traceFile) {
+        pthread_mutex_unlock(&controlLock);
+        return false;
+    }
+
+    traceFile = fopen(path, "wb");
+    if (!traceFile) {
+        pthread_mutex_unlock(&controlLock);
+        STZDebugLog("Failed to create trace at %s", path);
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE] = {0};
+    memcpy(header, traceMagic, sizeof(traceMagic));
+    header[4] = STZ_TRACE_VERSION;
+    fwrite(header, 1, sizeof(header), traceFile);
+
+    resetRecorder();
+    resetQueue();
+    atomic_store_explicit(&writerShouldExit, false, memory_order_relaxed);
+    pthread_create(&writerThread, NULL, runWriter, NULL);
+
+    atomic_store_explicit(&recording, true, memory_order_seq_cst);
+    pthread_mutex_unlock(&controlLock);
+
+    STZDebugLog("Started recording trace at %s", path);
+    return true;
+}
+
+
+void STZTraceStopRecording(void) {
+    pthread_mutex_lock(&controlLock);
+
+    if (traceFile) {
+        atomic_store_explicit(&recording, false, memory_order_seq_cst);
+
+        //  Pushes that saw `recording` set are finished once no pusher is left.
+        while (atomic_load_explicit(&activePushers, memory_order_acquire) != 0) {
+            sched_yield();
+        }
+
+        atomic_store_explicit(&writerShouldExit, true, memory_order_release);
+        pthread_join(writerThread, NULL);
+
+        fclose(traceFile);
+        traceFile = NULL;
+        resetRecorder();
+
+        uint64_t dropped = atomic_load_explicit(&droppedRecords, memory_order_relaxed);
+        if (dropped) {
+            STZDebugLog("Stopped recording trace; %llu records dropped", dropped);
+        } else {
+            STZDebugLog("Stopped recording trace");
+        }
+    }
+
+    pthread_mutex_unlock(&controlLock);
+}
+
+
+//  MARK: Pushing
+
+
+bool STZTraceKnowsProcess(int32_t pid) {
+    if (!STZTraceIsRecording()) {return true;}
+
+    int count = atomic_load_explicit(&knownPIDCount, memory_order_acquire);
+    if (count > kKnownPIDCapacity) {count = kKnownPIDCapacity;}
+    for (int i = 0; i < count; ++i) {
+        if (atomic_load_explicit(&knownPIDs[i], memory_order_relaxed) == pid) {return true;}
+    }
+    return false;
+}
+
+
+void STZTraceRecordProcess(int32_t pid, char const *bundleID) {
+    if (!STZTraceIsRecording()) {return;}
+
+    size_t position;
+    QueueCell *cell = beginPush(&position);
+    if (cell) {
+        size_t bundleIDLength = bundleID ? strlen(bundleID) : 0;
+
+        //  No real bundle ID comes close; a longer one is recorded as unknown.
+        if (bundleIDLength > kMaxBundleIDLength) {
+            bundleIDLength = 0;
+        }
+
+        PendingRecord *record = &cell->record;
+        record->kind = kSTZTraceProcess;
+        record->timestamp = 0;  //  Written at the time of the previous record.
+        record->process.pid = pid;
+        record->process.length = (uint8_t)bundleIDLength;
+        memcpy(record->process.bundleID, bundleID ?: "", bundleIDLength);
+
+        //  Past the capacity, processes are recorded again each time, which is only wasteful.
+        int index = atomic_fetch_add_explicit(&knownPIDCount, 1, memory_order_relaxed);
+        if (index < kKnownPIDCapacity) {
+            atomic_store_explicit(&knownPIDs[index], pid, memory_order_release);
+        }
+    }
+    endPush(cell, position);
+}
+
+
+void STZTraceRecordScroll(STZScrollRecord const *record) {
+    if (!STZTraceIsRecording()) {return;}
+
+    size_t position;
+    QueueCell *cell = beginPush(&position);
+    if (cell) {
+        PendingRecord *pending = &cell->record;
+        pending->kind = kSTZTraceScroll;
+        pending->timestamp = record->timestamp;
+        pending->registryID = record->registryID;
+        pending->scroll.scrollPhase = record->scrollPhase;
+        pending->scroll.momentumPhase = record->momentumPhase;
+        pending->scroll.flags = CGEventGetFlags(record->event);
+        pending->scroll.pid = (int32_t)CGEventGetIntegerValueField(record->event, kCGEventTargetUnixProcessID);
+        pending->scroll.isDirectionInverted = record->isDirectionInverted;
+        pending->scroll.location = record->location;
+        pending->scroll.pointDelta[0] = record->pointDelta[0];
+        pending->scroll.pointDelta[1] = record->pointDelta[1];
+        pending->scroll.fixedPtDelta[0] = record->fixedPtDelta[0];
+        pending->scroll.fixedPtDelta[1] = record->fixedPtDelta[1];
+    }
+    endPush(cell, position);
+}
+
+
+void STZTraceRecordTrigger(CGEventTimestamp timestamp, CGEventFlags flags, bool down) {
+    if (!STZTraceIsRecording()) {return;}
+
+    size_t position;
+    QueueCell *cell = beginPush(&position);
+    if (cell) {
+        cell->record.kind = kSTZTraceTrigger;
+        cell->record.timestamp = timestamp;
+        cell->record.trigger.flags = flags;
+        cell->record.trigger.down = down;
+    }
+    endPush(cell, position);
+}
+
+
+void STZTraceRecordMagicZoom(CGEventTimestamp timestamp, uint64_t registryID, bool active) {
+    if (!STZTraceIsRecording()) {return;}
+
+    size_t position;
+    QueueCell *cell = beginPush(&position);
+    if (cell) {
+        cell->record.kind = kSTZTraceMagicZoom;
+        cell->record.timestamp = timestamp;
+        cell->record.registryID = registryID;
+        cell->record.magicZoomActive = active;
+    }
+    endPush(cell, position);
+}
+
+
+void STZTraceRecordTouches(CGEventTimestamp timestamp, uint64_t registryID, STZTraceTouch const *touches, int touchCount) {
+    if (!STZTraceIsRecording()) {return;}
+    if (touchCount > STZ_TRACE_MAX_TOUCHES) {
+        touchCount = STZ_TRACE_MAX_TOUCHES;
+    }
+
+    size_t position;
+    QueueCell *cell = beginPush(&position);
+    if (cell) {
+        cell->record.kind = kSTZTraceTouches;
+        cell->record.timestamp = timestamp;
+        cell->record.registryID = registryID;
+        cell->record.touches.count = (uint8_t)touchCount;
+        memcpy(cell->record.touches.touches, touches, sizeof(STZTraceTouch) * (size_t)touchCount);
+    }
+    endPush(cell, position);
+}
+
+
+//  MARK: - Reading
+
+
+typedef struct {
+    char const     *bytes;
+    size_t          length;
+} BundleEntry;
+
+
+struct _STZTraceReader {
+    uint8_t const      *bytes;
+    size_t              length;
+    size_t              offset;
+    CGEventTimestamp    timestamp;
+    Array               devices;
+    Array               bundles;
+    Array               processes;
+    CGEventFlags        scrollFlags;
+    int32_t             scrollPID;
+    int64_t             scrollLocation[2];
+    STZTraceTouch       touches[STZ_TRACE_MAX_TOUCHES];
+};
+
+
+STZTraceReaderRef STZTraceReaderOpen(char const *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {return NULL;}
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < HEADER_SIZE) {
+        close(fd);
+        return NULL;
+    }
+
+    //  The mapping stays valid after the descriptor is closed.
+    void *bytes = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (bytes == MAP_FAILED) {return NULL;}
+
+    uint8_t const *header = bytes;
+    if (memcmp(header, traceMagic, sizeof(traceMagic)) != 0 || header[4] != STZ_TRACE_VERSION) {
+        munmap(bytes, (size_t)info.st_size);
+        return NULL;
+    }
+
+    madvise(bytes, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+    STZTraceReaderRef reader = calloc(1, sizeof(struct _STZTraceReader));
+    reader->bytes = bytes;
+    reader->length = (size_t)info.st_size;
+    reader->offset = HEADER_SIZE;
+    return reader;
+}
+
+
+void STZTraceReaderClose(STZTraceReaderRef reader) {
+    munmap((void *)reader->bytes, reader->length);
+    arrayRemoveAll(&reader->devices);
+    arrayRemoveAll(&reader->bundles);
+    arrayRemoveAll(&reader->processes);
+    free(reader);
+}
+
+
+static bool decodeByte(STZTraceReaderRef reader, uint8_t *value) {
+    if (reader->offset >= reader->length) {return false;}
+    *value = reader->bytes[reader->offset++];
+    return true;
+}
+
+
+static bool decodeVarint(STZTraceReaderRef reader, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (reader->offset >= reader->length) {return false;}
+        uint8_t byte = reader->bytes[reader->offset++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static bool decodeSignedVarint(STZTraceReaderRef reader, int64_t *value) {
+    uint64_t raw;
+    if (!decodeVarint(reader, &raw)) {return false;}
+    *value = unzigzag(raw);
+    return true;
+}
+
+
+static bool decodeDevice(STZTraceReaderRef reader, uint64_t *registryID) {
+    uint64_t index;
+    if (!decodeVarint(reader, &index)) {return false;}
+    if (index == 0 || index > reader->devices.count) {return false;}
+    *registryID = ((uint64_t *)reader->devices.items)[index - 1];
+    return true;
+}
+
+
+static void lookUpProcess(STZTraceReaderRef reader, STZTraceItem *item) {
+    item->bundleID = NULL;
+    item->bundleIDLength = 0;
+
+    ProcessEntry const *processes = reader->processes.items;
+    for (size_t i = 0; i < reader->processes.count; ++i) {
+        if (processes[i].pid != item->pid) {continue;}
+        if (processes[i].bundleIndex) {
+            BundleEntry const *bundle = (BundleEntry *)reader->bundles.items + processes[i].bundleIndex - 1;
+            item->bundleID = bundle->bytes;
+            item->bundleIDLength = bundle->length;
+        }
+        return;
+    }
+}
+
+
+static bool decodeProcess(STZTraceReaderRef reader, STZTraceItem *item) {
+    uint64_t pid, bundleIndex;
+    if (!decodeVarint(reader, &pid)) {return false;}
+    if (!decodeVarint(reader, &bundleIndex)) {return false;}
+
+    if (bundleIndex == reader->bundles.count + 1) {
+        uint64_t length;
+        if (!decodeVarint(reader, &length)) {return false;}
+        if (length > reader->length - reader->offset) {return false;}
+
+        BundleEntry *bundle = arrayAppend(&reader->bundles, sizeof(BundleEntry));
+        bundle->bytes = (char const *)reader->bytes + reader->offset;
+        bundle->length = (size_t)length;
+        reader->offset += (size_t)length;
+
+    } else if (bundleIndex > reader->bundles.count) {
+        return false;
+    }
+
+    item->pid = (int32_t)pid;
+
+    ProcessEntry *entry = NULL;
+    ProcessEntry *processes = reader->processes.items;
+    for (size_t i = 0; i < reader->processes.count; ++i) {
+        if (processes[i].pid == item->pid) {
+            entry = processes + i;
+            break;
+        }
+    }
+
+    if (!entry) {
+        entry = arrayAppend(&reader->processes, sizeof(ProcessEntry));
+        entry->pid = item->pid;
+    }
+
+    entry->bundleIndex = (uint32_t)bundleIndex;
+    lookUpProcess(reader, item);
+    return true;
+}
+
+
+static bool decodeScroll(STZTraceReaderRef reader, STZTraceItem *item) {
+    uint8_t bits;
+    uint64_t scrollPhase, momentumPhase;
+    if (!decodeByte(reader, &bits)) {return false;}
+    if (!decodeDevice(reader, &item->registryID)) {return false;}
+    if (!decodeVarint(reader, &scrollPhase)) {return false;}
+    if (!decodeVarint(reader, &momentumPhase)) {return false;}
+
+    if (bits & kScrollHasFlags) {
+        uint64_t flags;
+        if (!decodeVarint(reader, &flags)) {return false;}
+        reader->scrollFlags = (CGEventFlags)flags;
+    }
+
+    if (bits & kScrollHasPID) {
+        uint64_t pid;
+        if (!decodeVarint(reader, &pid)) {return false;}
+        reader->scrollPID = (int32_t)pid;
+    }
+
+    int64_t values[6];
+    for (int i = 0; i < 6; ++i) {
+        if (!decodeSignedVarint(reader, &values[i])) {return false;}
+    }
+
+    reader->scrollLocation[0] += values[0];
+    reader->scrollLocation[1] += values[1];
+
+    item->pid = reader->scrollPID;
+    lookUpProcess(reader, item);
+
+    item->scroll.scrollPhase = (CGScrollPhase)scrollPhase;
+    item->scroll.momentumPhase = (CGMomentumScrollPhase)momentumPhase;
+    item->scroll.flags = reader->scrollFlags;
+    item->scroll.location.x = (double)reader->scrollLocation[0] / LOCATION_SCALE;
+    item->scroll.location.y = (double)reader->scrollLocation[1] / LOCATION_SCALE;
+    item->scroll.pointDelta[0] = values[2];
+    item->scroll.pointDelta[1] = values[3];
+    item->scroll.fixedPtDelta[0] = (double)values[4] / FIXED_PT_SCALE;
+    item->scroll.fixedPtDelta[1] = (double)values[5] / FIXED_PT_SCALE;
+    item->scroll.isDirectionInverted = (bits & kScrollIsDirectionInverted) != 0;
+    return true;
+}
+
+
+static bool decodeTouches(STZTraceReaderRef reader, STZTraceItem *item) {
+    uint8_t count;
+    if (!decodeDevice(reader, &item->registryID)) {return false;}
+    if (!decodeByte(reader, &count)) {return false;}
+    if (count > STZ_TRACE_MAX_TOUCHES) {return false;}
+
+    for (int i = 0; i < count; ++i) {
+        STZTraceTouch *touch = &reader->touches[i];
+        int64_t values[6];
+        if (!decodeByte(reader, &touch->fingerID)) {return false;}
+        if (!decodeByte(reader, &touch->phase)) {return false;}
+        for (int j = 0; j < 6; ++j) {
+            if (!decodeSignedVarint(reader, &values[j])) {return false;}
+        }
+
+        touch->location[0] = (float)values[0] / TOUCH_SCALE;
+        touch->location[1] = (float)values[1] / TOUCH_SCALE;
+        touch->velocity[0] = (float)values[2] / TOUCH_SCALE;
+        touch->velocity[1] = (float)values[3] / TOUCH_SCALE;
+        touch->zTotal = (float)values[4] / TOUCH_SCALE;
+        touch->zDensity = (float)values[5] / TOUCH_SCALE;
+    }
+
+    item->touches.touches = reader->touches;
+    item->touches.count = count;
+    return true;
+}
+
+
+bool STZTraceReaderNext(STZTraceReaderRef reader, STZTraceItem *item) {
+    while (true) {
+        uint8_t kind;
+        int64_t timeDelta;
+        if (!decodeByte(reader, &kind)) {return false;}
+        if (!decodeSignedVarint(reader, &timeDelta)) {return false;}
+
+        reader->timestamp += (uint64_t)timeDelta;
+
+        *item = (STZTraceItem){
+            .kind = kind,
+            .timestamp = reader->timestamp,
+        };
+
+        switch ((STZTraceKind)kind) {
+        case kSTZTraceDevice: {
+            uint64_t registryID;
+            if (!decodeVarint(reader, &registryID)) {return false;}
+            *(uint64_t *)arrayAppend(&reader->devices, sizeof(uint64_t)) = registryID;
+            continue;  //  Not reported as an item.
+        }
+
+        case kSTZTraceProcess:
+            return decodeProcess(reader, item);
+
+        case kSTZTraceScroll:
+            return decodeScroll(reader, item);
+
+        case kSTZTraceTrigger: {
+            uint64_t flags;
+            uint8_t down;
+            if (!decodeVarint(reader, &flags)) {return false;}
+            if (!decodeByte(reader, &down)) {return false;}
+            item->trigger.flags = (CGEventFlags)flags;
+            item->trigger.down = down != 0;
+            return true;
+        }
+
+        case kSTZTraceMagicZoom: {
+            uint8_t active;
+            if (!decodeDevice(reader, &item->registryID)) {return false;}
+            if (!decodeByte(reader, &active)) {return false;}
+            item->magicZoomActive = active != 0;
+            return true;
+        }
+
+        case kSTZTraceTouches:
+            return decodeTouches(reader, item);
+
+        default:
+            //  Records of unknown kinds can’t be skipped without knowing their length.
+            STZUnknownEnumCase("STZTraceKind", kind);
+            return false;
+        }
+    }
+}
+
+
+CGEventRef STZTraceCreateScrollEvent(STZTraceItem const *item) {
+    assert(item->kind == kSTZTraceScroll);
+
+    CGEventRef event = CGEventCreate(NULL);
+    CGEventSetType(event, kCGEventScrollWheel);
+    CGEventSetTimestamp(event, item->timestamp);
+    CGEventSetLocation(event, item->scroll.location);
+    CGEventSetFlags(event, item->scroll.flags);
+    CGEventSetIntegerValueField(event, kCGEventRegistryID, (int64_t)item->registryID);
+    CGEventSetIntegerValueField(event, kCGEventTargetUnixProcessID, item->pid);
+    CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, item->scroll.scrollPhase);
+    CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, item->scroll.momentumPhase);
+    CGEventSetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1, item->scroll.pointDelta[0]);
+    CGEventSetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis2, item->scroll.pointDelta[1]);
+    CGEventSetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1, item->scroll.fixedPtDelta[0]);
+    CGEventSetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis2, item->scroll.fixedPtDelta[1]);
+    CGEventSetIntegerValueField(event, kCGScrollEventIsDirectionInverted, item->scroll.isDirectionInverted);
+    return event;
+}
@@ -0,0 +1,145 @@
+/*
+ *  STZTrace.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZStateManager.h"
+
+CF_IMPLICIT_BRIDGING_ENABLED
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  A trace is the input seen by the app, recorded in a compact binary form for replay and
+//  analysis. The file starts with the 4-byte magic `STZT`, a version byte and three reserved
+//  bytes, followed by records until the end of the file. Each record is:
+//
+//      kind            u8
+//      time delta      signed varint, nanoseconds since the previous record
+//      payload         depends on the kind
+//
+//  Varints are LEB128; signed varints are zigzag-encoded first. Registry IDs and bundle IDs are
+//  defined once per trace by `kSTZTraceDevice` and `kSTZTraceProcess` records and referenced
+//  by 1-based index afterwards. Scroll records only repeat the flags and the target PID when
+//  they change, and store the location relative to the previous scroll record.
+
+#define STZ_TRACE_VERSION 1
+
+
+typedef CLOSED_ENUM(uint8_t) {
+
+    /// Payload: registry ID. The device takes the next device index.
+    kSTZTraceDevice = 1,
+
+    /// Payload: PID and bundle index, 0 if the bundle ID is unknown. If the index is the next
+    /// bundle index, the bundle ID is defined by its length and bytes that follow.
+    kSTZTraceProcess,
+
+    /// Payload: bits, device index, phases, [flags], [PID], location in 1/4 points, integral
+    /// point deltas and fixed point deltas in 1/65536 points. The bits tell whether the flags and
+    /// the PID are present, and whether the direction is inverted.
+    kSTZTraceScroll,
+
+    /// Payload: event flags, and whether the trigger is down after the event.
+    kSTZTraceTrigger,
+
+    /// Payload: device index, and whether magic zoom is active.
+    kSTZTraceMagicZoom,
+
+    /// Payload: device index, touch count, and for each touch the finger ID, the phase and
+    /// `STZTraceTouch` values in 1/1024 units.
+    kSTZTraceTouches,
+} STZTraceKind;
+
+
+#define STZ_TRACE_MAX_TOUCHES 16
+
+/// Values are those of `MTTouch`; only the fields read by the magic zoom recognizer are kept.
+typedef struct {
+    uint8_t     fingerID;
+    uint8_t     phase;
+    float       location[2];
+    float       velocity[2];
+    float       zTotal;
+    float       zDensity;
+} STZTraceTouch;
+
+
+//  MARK: - Recording
+
+//  Recording functions are thread-safe, never block and return immediately if no trace is being
+//  recorded. Records are written by a background thread; the file is complete once
+//  `STZTraceStopRecording` returns.
+
+bool STZTraceIsRecording(void);
+bool STZTraceStartRecording(char const *path);
+void STZTraceStopRecording(void);
+
+/// Whether the process has been recorded by `STZTraceRecordProcess` in the current trace.
+bool STZTraceKnowsProcess(int32_t pid);
+void STZTraceRecordProcess(int32_t pid, char const *__nullable bundleID);
+
+void STZTraceRecordScroll(STZScrollRecord const *record);
+void STZTraceRecordTrigger(CGEventTimestamp timestamp, CGEventFlags flags, bool down);
+void STZTraceRecordMagicZoom(CGEventTimestamp timestamp, uint64_t registryID, bool active);
+void STZTraceRecordTouches(CGEventTimestamp timestamp, uint64_t registryID, STZTraceTouch const *touches, int touchCount);
+
+
+//  MARK: - Reading
+
+/// Records are decoded in place from the mapped file, one at a time. Pointers in an item are
+/// valid until the next call to `STZTraceReaderNext` or until the reader is closed.
+typedef struct {
+    STZTraceKind                kind;
+    CGEventTimestamp            timestamp;
+    uint64_t                    registryID;
+    int32_t                     pid;
+
+    /// Not NUL-terminated; points into the mapped file.
+    char const *__nullable      bundleID;
+    size_t                      bundleIDLength;
+
+    union {
+        struct {
+            CGScrollPhase           scrollPhase;
+            CGMomentumScrollPhase   momentumPhase;
+            CGEventFlags            flags;
+            CGPoint                 location;
+            int64_t                 pointDelta[2];
+            double                  fixedPtDelta[2];
+            bool                    isDirectionInverted;
+        } scroll;
+
+        struct {
+            CGEventFlags            flags;
+            bool                    down;
+        } trigger;
+
+        bool                        magicZoomActive;
+
+        struct {
+            STZTraceTouch const    *touches;
+            int                     count;
+        } touches;
+    };
+} STZTraceItem;
+
+
+typedef struct _STZTraceReader *STZTraceReaderRef;
+
+STZTraceReaderRef __nullable STZTraceReaderOpen(char const *path);
+void STZTraceReaderClose(STZTraceReaderRef);
+
+/// Returns false at the end of the trace or if the rest is malformed, for example when the
+/// recording was cut off.
+bool STZTraceReaderNext(STZTraceReaderRef, STZTraceItem *item);
+
+/// Creates a scroll event with the fields of a scroll item.
+CGEventRef STZTraceCreateScrollEvent(STZTraceItem const *item) CF_RETURNS_RETAINED;
+
+
+CF_ASSUME_NONNULL_END
+CF_IMPLICIT_BRIDGING_DISABLED
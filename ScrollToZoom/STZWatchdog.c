@@ -0,0 +1,173 @@
+/*
+ *  STZWatchdog.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZWatchdog.h"
+
+
+typedef struct {
+    STZDeferredWork     work;
+    void               *info;
+    void               *object;
+} DeferredWork;
+
+
+struct _STZWatchdog {
+    CGEventTimestamp    budget;
+    uint32_t            callbackCount;
+    STZWatchdogHistogram *histograms;
+    STZWatchdogHistogram *queueDelays;
+
+    bool                inCallback;
+    bool                overBudget;
+    uint32_t            callback;
+    CGEventTimestamp    enteredAt;
+    CGEventTimestamp    deadline;
+
+    DeferredWork       *queue;
+    uint32_t            queueCount;
+    uint32_t            queueCapacity;
+    uint64_t            deferredWorkCount;
+};
+
+
+STZWatchdogRef STZWatchdogCreate(CGEventTimestamp budget, uint32_t callbackCount) {
+    STZWatchdogRef watchdog = malloc(sizeof(struct _STZWatchdog));
+    watchdog->budget = budget;
+    watchdog->callbackCount = callbackCount;
+    watchdog->histograms = calloc(callbackCount, sizeof(STZWatchdogHistogram));
+    watchdog->queueDelays = calloc(callbackCount, sizeof(STZWatchdogHistogram));
+    watchdog->inCallback = false;
+    watchdog->overBudget = false;
+    watchdog->callback = 0;
+    watchdog->enteredAt = 0;
+    watchdog->deadline = 0;
+    watchdog->queue = NULL;
+    watchdog->queueCount = 0;
+    watchdog->queueCapacity = 0;
+    watchdog->deferredWorkCount = 0;
+    return watchdog;
+}
+
+
+void STZWatchdogRelease(STZWatchdogRef watchdog) {
+    free(watchdog->histograms);
+    free(watchdog->queueDelays);
+    free(watchdog->queue);
+    free(watchdog);
+}
+
+
+static uint32_t bucketOf(CGEventTimestamp duration) {
+    uint64_t micros = duration / 1000;
+    if (micros == 0) {return 0;}
+    uint32_t bucket = 64 - (uint32_t)__builtin_clzll(micros);
+    return bucket < kSTZWatchdogBucketCount ? bucket : kSTZWatchdogBucketCount - 1;
+}
+
+
+static void addToHistogram(STZWatchdogHistogram *histogram, CGEventTimestamp duration, bool overBudget) {
+    histogram->counts[bucketOf(duration)] += 1;
+    histogram->callbacks += 1;
+    if (overBudget) {
+        histogram->overBudget += 1;
+    }
+    if (histogram->maxDuration < duration) {
+        histogram->maxDuration = duration;
+    }
+}
+
+
+void STZWatchdogBeginCallback(STZWatchdogRef watchdog, uint32_t callback, CGEventTimestamp eventTime, CGEventTimestamp now) {
+    assert(!watchdog->inCallback && callback < watchdog->callbackCount);
+    watchdog->inCallback = true;
+    watchdog->overBudget = false;
+    watchdog->callback = callback;
+    watchdog->enteredAt = now;
+    watchdog->deadline = now + watchdog->budget;
+
+    //  Posted events may carry any timestamp, so the delay is only recorded, never budgeted.
+    if (eventTime != 0 && eventTime <= now) {
+        CGEventTimestamp delay = now - eventTime;
+        addToHistogram(&watchdog->queueDelays[callback], delay, delay >= watchdog->budget);
+    }
+}
+
+
+void STZWatchdogEndCallback(STZWatchdogRef watchdog, CGEventTimestamp now) {
+    assert(watchdog->inCallback);
+    watchdog->inCallback = false;
+
+    CGEventTimestamp duration = now > watchdog->enteredAt ? now - watchdog->enteredAt : 0;
+    addToHistogram(&watchdog->histograms[watchdog->callback], duration,
+                   watchdog->overBudget || now >= watchdog->deadline);
+}
+
+
+bool STZWatchdogShouldDefer(STZWatchdogRef watchdog, CGEventTimestamp now) {
+    if (!watchdog->inCallback) {return false;}
+    if (now >= watchdog->deadline) {
+        watchdog->overBudget = true;
+    }
+    return watchdog->overBudget;
+}
+
+
+bool STZWatchdogDefer(STZWatchdogRef watchdog, STZDeferredWork work, void *info, void *object) {
+    if (watchdog->queueCount == watchdog->queueCapacity) {
+        watchdog->queueCapacity = watchdog->queueCapacity ? watchdog->queueCapacity * 2 : 16;
+        watchdog->queue = realloc(watchdog->queue, sizeof(DeferredWork) * watchdog->queueCapacity);
+    }
+
+    watchdog->queue[watchdog->queueCount] = (DeferredWork){work, info, object};
+    watchdog->queueCount += 1;
+    watchdog->deferredWorkCount += 1;
+    return watchdog->queueCount == 1;
+}
+
+
+void STZWatchdogRunDeferredWork(STZWatchdogRef watchdog) {
+    assert(!watchdog->inCallback);
+
+    //  Nothing defers outside callbacks, so the queue doesn’t grow while it runs.
+    for (uint32_t i = 0; i < watchdog->queueCount; ++i) {
+        DeferredWork const *item = &watchdog->queue[i];
+        item->work(item->info, item->object);
+    }
+    watchdog->queueCount = 0;
+}
+
+
+CGEventTimestamp STZWatchdogHistogramGetPercentile(STZWatchdogHistogram const *histogram, double fraction) {
+    uint64_t rank = (uint64_t)(histogram->callbacks * fraction + 0.5);
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < kSTZWatchdogBucketCount - 1; ++i) {
+        count += histogram->counts[i];
+        if (count >= rank && count > 0) {
+            CGEventTimestamp upperBound = ((CGEventTimestamp)1 << i) * 1000;
+            return upperBound < histogram->maxDuration ? upperBound : histogram->maxDuration;
+        }
+    }
+    return histogram->maxDuration;
+}
+
+
+STZWatchdogHistogram STZWatchdogGetHistogram(STZWatchdogRef watchdog, uint32_t callback) {
+    assert(callback < watchdog->callbackCount);
+    return watchdog->histograms[callback];
+}
+
+
+STZWatchdogHistogram STZWatchdogGetQueueDelayHistogram(STZWatchdogRef watchdog, uint32_t callback) {
+    assert(callback < watchdog->callbackCount);
+    return watchdog->queueDelays[callback];
+}
+
+
+uint64_t STZWatchdogGetDeferredWorkCount(STZWatchdogRef watchdog) {
+    return watchdog->deferredWorkCount;
+}
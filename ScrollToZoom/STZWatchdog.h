@@ -0,0 +1,76 @@
+/*
+ *  STZWatchdog.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Times event tap callbacks against a budget. The system disables a tap whose callbacks keep
+//  events waiting too long, so once a callback has used up its budget, work that can wait is
+//  queued instead of done, and the owner runs the queue after the callback returns.
+//
+//  A callback is timed from when it is entered. Events also wait in the run loop before that, and
+//  the system counts that time as well, but event timestamps can’t be trusted for it: tools like
+//  Mos post events with timestamps of their own. How long events seem to have waited is recorded
+//  in separate histograms instead, only to tell whether callbacks or the run loop are slow.
+
+
+#define kSTZWatchdogBucketCount 20
+
+/// Bucket 0 counts durations under 1 µs; bucket `i` counts those from 2^(i-1) up to 2^i µs, and
+/// the last bucket the rest, i.e. 0.26 s and longer.
+typedef struct {
+    uint64_t            counts[kSTZWatchdogBucketCount];
+    uint64_t            callbacks;
+
+    /// Callbacks that deferred work or ran past the budget; for queue delays, those that alone
+    /// were as long as the budget.
+    uint64_t            overBudget;
+    CGEventTimestamp    maxDuration;
+} STZWatchdogHistogram;
+
+/// The upper bound of the bucket that the fraction of callbacks falls in, or the longest
+/// duration if that is less; in nanoseconds.
+CGEventTimestamp STZWatchdogHistogramGetPercentile(STZWatchdogHistogram const *histogram, double fraction);
+
+
+typedef void (*STZDeferredWork)(void *__nullable info, void *__nullable object);
+
+
+typedef struct _STZWatchdog *STZWatchdogRef;
+
+/// Callbacks are identified by indices below `callbackCount`.
+STZWatchdogRef STZWatchdogCreate(CGEventTimestamp budget, uint32_t callbackCount);
+void STZWatchdogRelease(STZWatchdogRef);
+
+/// Callbacks must not nest. `eventTime` is only used for the queue delay, and may be 0 if the
+/// callback has no event.
+void STZWatchdogBeginCallback(STZWatchdogRef, uint32_t callback, CGEventTimestamp eventTime, CGEventTimestamp now);
+void STZWatchdogEndCallback(STZWatchdogRef, CGEventTimestamp now);
+
+/// Whether the current callback should defer optional work. Always false outside callbacks.
+bool STZWatchdogShouldDefer(STZWatchdogRef, CGEventTimestamp now);
+
+/// Queues the work. Returns true if the queue was empty, in which case the owner should arrange
+/// for `STZWatchdogRunDeferredWork` to be called once the callback returns.
+bool STZWatchdogDefer(STZWatchdogRef, STZDeferredWork work, void *__nullable info, void *__nullable object);
+
+/// Runs the queued work in the order it was deferred. Must not be called in a callback.
+void STZWatchdogRunDeferredWork(STZWatchdogRef);
+
+STZWatchdogHistogram STZWatchdogGetHistogram(STZWatchdogRef, uint32_t callback);
+
+/// From the timestamps of events to when their callbacks are entered; events timestamped in the
+/// future are not counted.
+STZWatchdogHistogram STZWatchdogGetQueueDelayHistogram(STZWatchdogRef, uint32_t callback);
+uint64_t STZWatchdogGetDeferredWorkCount(STZWatchdogRef);
+
+
+CF_ASSUME_NONNULL_END
@@ -0,0 +1,597 @@
+/*
+ *  STZWheelTaps.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZWheelTaps.h"
+#include "CGEventSPI.h"
+#include "STZTapSlots.h"
+
+
+typedef OPTION_FLAGS(uint64_t) {
+    //  The following two flags are exclusive
+    kStateSessionIsMagicZoom        = 1 << 0,
+    kStateSessionIsTriggeredZoom    = 1 << 1,
+} StateSessionData;
+
+
+typedef struct _WheelContext {
+    STZStateRef     state;
+    uint64_t        registryID;
+    STZAppOptions   appOptions;
+    uint64_t        hardScrollDir;
+    bool            magicZoomPending;
+    STZSchedulerEntry periodicUpdate;
+    STZWheelTapsRef taps;  ///< For the dispose callback.
+
+    //  Links in `activeContexts`; `isActive` tells whether it is in the list.
+    bool            isActive;
+    struct _WheelContext *prevActive;
+    struct _WheelContext *nextActive;
+} WheelContext;
+
+
+struct _STZWheelTaps {
+    STZWheelTapsHooks   hooks;
+    void               *refcon;
+    STZWheelModes       modes;
+    bool                triggerFlagsDown;
+    bool                tapsMutable;
+    STZTapPolicyRef     tapPolicy;
+    STZSchedulerEntry   tapPolicyRetry;
+    STZCacheRef         contexts;
+    STZSchedulerRef     periodicUpdates;
+
+    //  Contexts that may have work left, so that `forEachStateDo` doesn’t visit every device seen
+    //  in the lifetime of the cache. Values in the cache are never moved, so they can be linked
+    //  directly.
+    WheelContext       *activeContexts;
+
+    //  Consecutive events mostly come from the same device. The context of the latest device is
+    //  resolved by its handle without hashing.
+    uint64_t            recentRegistryID;
+    STZCacheHandle      recentContext;
+};
+
+
+static void activateWheelContext(WheelContext *context) {
+    if (context->isActive) {return;}
+    STZWheelTapsRef taps = context->taps;
+    context->isActive = true;
+    context->prevActive = NULL;
+    context->nextActive = taps->activeContexts;
+    if (taps->activeContexts) {
+        taps->activeContexts->prevActive = context;
+    }
+    taps->activeContexts = context;
+}
+
+static void deactivateWheelContext(WheelContext *context) {
+    if (!context->isActive) {return;}
+    context->isActive = false;
+    if (context->prevActive) {
+        context->prevActive->nextActive = context->nextActive;
+    } else {
+        context->taps->activeContexts = context->nextActive;
+    }
+    if (context->nextActive) {
+        context->nextActive->prevActive = context->prevActive;
+    }
+}
+
+static void wheelContextDispose(void *context) {
+    WheelContext *ctx = context;
+    deactivateWheelContext(ctx);
+    STZSchedulerSetDeadline(ctx->taps->periodicUpdates, &ctx->periodicUpdate, 0);
+    STZStateRelease(ctx->state);
+}
+
+
+STZWheelTapsRef STZWheelTapsCreate(STZWheelTapsHooks const *hooks, void *refcon) {
+    STZWheelTapsRef taps = malloc(sizeof(struct _STZWheelTaps));
+    taps->hooks = *hooks;
+    taps->refcon = refcon;
+    taps->modes = 0;
+    taps->triggerFlagsDown = false;
+    taps->tapsMutable = false;
+    taps->tapPolicy = STZTapPolicyCreate();
+    taps->tapPolicyRetry = (STZSchedulerEntry){0};
+    taps->contexts = STZCacheCreate(sizeof(WheelContext), 300 * NSEC_PER_SEC, wheelContextDispose);
+    taps->periodicUpdates = STZSchedulerCreate();
+    taps->activeContexts = NULL;
+    taps->recentRegistryID = 0;
+    taps->recentContext = 0;
+    STZTapPolicyReset(taps->tapPolicy, CGEventTimestampNow());
+    return taps;
+}
+
+
+void STZWheelTapsRelease(STZWheelTapsRef taps) {
+    //  Contexts unschedule themselves, so the scheduler goes last.
+    STZCacheRelease(taps->contexts);
+    STZSchedulerRelease(taps->periodicUpdates);
+    STZTapPolicyRelease(taps->tapPolicy);
+    free(taps);
+}
+
+
+STZWheelModes STZWheelTapsGetModes(STZWheelTapsRef taps) {return taps->modes;}
+void STZWheelTapsSetModes(STZWheelTapsRef taps, STZWheelModes modes) {taps->modes = modes;}
+bool STZWheelTapsAreMutable(STZWheelTapsRef taps) {return taps->tapsMutable;}
+bool STZWheelTapsAreTriggerFlagsDown(STZWheelTapsRef taps) {return taps->triggerFlagsDown;}
+
+
+static void moveTimerIfNeeded(STZWheelTapsRef taps, CGEventTimestamp now) {
+    CGEventTimestamp deadline;
+    if (STZSchedulerUpdateTimer(taps->periodicUpdates, &deadline)) {
+        taps->hooks.moveTimer(deadline, now, taps->refcon);
+    }
+}
+
+
+void STZWheelTapsReset(STZWheelTapsRef taps) {
+    CGEventTimestamp now = CGEventTimestampNow();
+    STZCacheRemoveAll(taps->contexts);
+    taps->recentRegistryID = 0;
+    taps->recentContext = 0;
+    taps->triggerFlagsDown = false;
+    taps->tapsMutable = false;
+    STZTapPolicyReset(taps->tapPolicy, now);
+    STZSchedulerSetDeadline(taps->periodicUpdates, &taps->tapPolicyRetry, 0);
+    STZSchedulerForgetTimer(taps->periodicUpdates);
+    taps->hooks.moveTimer(0, now, taps->refcon);
+}
+
+
+void STZWheelTapsForgetTriggerFlags(STZWheelTapsRef taps) {
+    taps->triggerFlagsDown = false;
+}
+
+
+static WheelContext *wheelContextWithFallback(STZWheelTapsRef taps, uint64_t registryID) {
+    WheelContext *context;
+    if (registryID == 0 || registryID == taps->recentRegistryID) {
+        context = STZCacheGetValueForHandle(taps->contexts, taps->recentContext);
+        if (context != NULL) {return context;}
+    }
+
+    context = STZCacheGetValue(taps->contexts, registryID);
+
+    if (context == NULL) {
+        WheelContext ctx_ = {
+            .state = STZStateCreate(),
+            .registryID = registryID,
+            .appOptions = 0,
+            .hardScrollDir = 0,
+            .magicZoomPending = false,
+            .periodicUpdate = {0},
+            .taps = taps,
+            .isActive = false,
+            .prevActive = NULL,
+            .nextActive = NULL,
+        };
+        context = STZCacheSetValue(taps->contexts, registryID, &ctx_);
+    }
+
+    taps->recentRegistryID = registryID;
+    taps->recentContext = STZCacheGetHandle(taps->contexts, context);
+    return context;
+}
+
+
+static void emit(STZWheelTapsRef taps, WheelContext *context, STZWheelEmission emission, STZWheelDelivery delivery, CGEventRef event) {
+    taps->hooks.emit(emission, delivery, event, context->registryID, taps->refcon);
+}
+
+
+/// Zoom events made while a soft tap handles an event go out at the tap unless the hard taps are
+/// inserted. The soft taps are then at the annotated session location, where an event type must
+/// not change, so they post to the session instead.
+static STZWheelDelivery auxDelivery(STZWheelTapsRef taps) {
+    return (taps->modes & kSTZWheelUnderDictatorship) ? kSTZWheelPostedToSession : kSTZWheelPostedAtTap;
+}
+
+
+static void clearTriggerFlagsForEvent(STZSettingsSnapshot const *settings, CGEventRef event) {
+    CGEventFlags mask = ~(settings->triggerFlags & kSTZModifiersMask);
+    CGEventSetFlags(event, CGEventGetFlags(event) & mask);
+}
+
+
+static void beginTapMutations(STZWheelTapsRef taps) {
+    if (!STZTapPolicyRequireMutable(taps->tapPolicy, CGEventTimestampNow())) {return;}
+    taps->tapsMutable = true;
+    taps->hooks.setTapsMutable(true, taps->refcon);
+}
+
+
+//  MARK: - Visiting states
+
+
+typedef OPTION_FLAGS(uint8_t) {
+    kTryToEndWheelTapMutations  = 1 << 0,
+    kRescheduleTimer            = 1 << 1,
+    kEmitPeriodicEvents         = 1 << 2,
+    kDiscardTriggerFlags        = 1 << 3,
+} WheelContextActions;
+
+
+typedef struct {
+    STZWheelTapsRef         const taps;
+    WheelContextActions     const actions;
+    STZSettingsSnapshot     const *const settings;
+    CGEventTimestamp        const now;
+    CGEventRef              const event;
+    bool                    canEndMutations;
+} WheelContextDoEnv;
+
+
+static void wheelContextDo(WheelContext *context, WheelContextDoEnv *env) {
+    if (env->actions & kEmitPeriodicEvents) {
+        CGEventRef event = STZStatePeriodicallyUpdate(context->state, env->now);
+        if (event != NULL) {
+            if (context->appOptions & kSTZFlagsExcludedForApp) {
+                clearTriggerFlagsForEvent(env->settings, event);
+            }
+            emit(env->taps, context, kSTZWheelPeriodic, kSTZWheelPostedToSession, event);
+            CFRelease(event);
+        }
+    }
+
+    if (env->actions & kDiscardTriggerFlags) {
+        uint64_t data;
+        if (STZStateGetSessionData(context->state, &data) && !(data & kStateSessionIsMagicZoom)) {
+            CGEventRef event = STZStateRevertToScrollByEvent(context->state, env->event);
+            if (event != NULL) {
+                emit(env->taps, context, kSTZWheelReverting, kSTZWheelPostedToSession, event);
+                CFRelease(event);
+            }
+        }
+    }
+
+    if (env->actions & kTryToEndWheelTapMutations) {
+        uint64_t data;
+        if (context->magicZoomPending
+         || (STZStateGetSessionData(context->state, &data) && (data & kStateSessionIsMagicZoom))
+         || !STZStateCanStopTransformingEvents(context->state)) {
+            env->canEndMutations = false;
+        }
+    }
+
+    if (env->actions & kRescheduleTimer) {
+        CGEventTimestamp updatePeriod = STZStateGetNextUpdatePeriod(context->state, env->now);
+        STZSchedulerSetDeadline(env->taps->periodicUpdates, &context->periodicUpdate, updatePeriod ? env->now + updatePeriod : 0);
+    }
+}
+
+
+static void forEachStateDo(STZWheelTapsRef taps, WheelContextActions actions, CGEventRef __nullable event) {
+    assert(!(actions & kDiscardTriggerFlags) || event);
+
+    if (!taps->tapsMutable || taps->triggerFlagsDown) {
+        actions = actions & ~kTryToEndWheelTapMutations;
+    }
+
+    WheelContextDoEnv env = {
+        .taps = taps,
+        .actions = actions,
+        .settings = STZGetSettingsSnapshot(),
+        .now = CGEventTimestampNow(),
+        .event = event,
+        .canEndMutations = (actions & kTryToEndWheelTapMutations) != 0,
+    };
+
+    STZCacheExpireValues(taps->contexts, env.now);
+    WheelContext *context = taps->activeContexts;
+    while (context) {
+        WheelContext *next = context->nextActive;
+        wheelContextDo(context, &env);
+        if (!context->magicZoomPending && !context->periodicUpdate.deadline && !STZStateIsActive(context->state)) {
+            deactivateWheelContext(context);
+        }
+        context = next;
+    }
+
+    //  Not asked while mutation is surely needed or the taps are passive; no retry is due then.
+    CGEventTimestamp retryTime = 0;
+    if (actions & kTryToEndWheelTapMutations) {
+        STZTapPolicyConfigure(taps->tapPolicy, env.settings->mutableTapsLingerTime, env.settings->maxTapSwitchesPerSecond);
+        if (STZTapPolicyMayEndMutable(taps->tapPolicy, env.now, env.canEndMutations, &retryTime)) {
+            taps->tapsMutable = false;
+            taps->hooks.setTapsMutable(false, taps->refcon);
+
+            STZTapPolicyStatistics statistics = STZTapPolicyGetStatistics(taps->tapPolicy, env.now);
+            STZDebugLog("\tswitched to passive scroll wheel taps (%llu switches, %.1f s mutable in total)",
+                        (unsigned long long)statistics.switches, (double)statistics.mutableTime / NSEC_PER_SEC);
+        }
+    }
+    STZSchedulerSetDeadline(taps->periodicUpdates, &taps->tapPolicyRetry, retryTime);
+
+    //  The retry may have moved the earliest deadline even if no state was rescheduled.
+    moveTimerIfNeeded(taps, env.now);
+}
+
+
+//  MARK: - Callbacks
+
+
+void STZWheelTapsSetTriggerFlagsDown(STZWheelTapsRef taps, bool down, CGEventRef event) {
+    if (taps->triggerFlagsDown == down) {return;}
+    taps->triggerFlagsDown = down;
+
+    if (down) {
+        beginTapMutations(taps);
+        return;
+    }
+
+    WheelContextActions actions = kTryToEndWheelTapMutations;
+    if (!(taps->modes & kSTZWheelContinuesTriggeredZoom)) {
+        actions |= kDiscardTriggerFlags;
+    }
+    forEachStateDo(taps, actions, event);
+}
+
+
+void STZWheelTapsSetMagicZoomPending(STZWheelTapsRef taps, uint64_t registryID, bool pending) {
+    WheelContext *context = wheelContextWithFallback(taps, registryID);
+    context->magicZoomPending = pending;
+    activateWheelContext(context);
+
+    if (pending) {
+        beginTapMutations(taps);
+    } else {
+        forEachStateDo(taps, kTryToEndWheelTapMutations, NULL);
+    }
+}
+
+
+CGEventRef STZWheelTapsHardScrollEvent(STZWheelTapsRef taps, CGEventRef event) {
+    bool continuesTriggeredZoom = (taps->modes & kSTZWheelContinuesTriggeredZoom) != 0;
+
+    //  Stashing when not mutable is a no-op, but we can store the fallback scroll direction.
+    //  When using Mos, etc., a hard event may be followed by a sequence of periodic soft events.
+    //  If the user presses the trigger flags during that sequence, the zoom direction may
+    //  be out-of-date without this fallback value.
+    STZScrollRecord record;
+    STZScrollRecordRead(&record, event);
+
+    WheelContext *context = wheelContextWithFallback(taps, record.registryID);
+    context->hardScrollDir = STZStashScrollDirectionIntoEvent(&record);
+
+    //  A passive tap only listens; what it writes would never reach the soft taps.
+    if (taps->tapsMutable) {
+        STZScrollRecordWriteBack(&record);
+    }
+
+    //  For example with Mos, the event sequence may look like this:
+    //
+    //    trigger down -> hard scroll [1] -> soft scroll × n [1] ->
+    //    trigger up -> soft scroll × n [1] ->
+    //    hard scroll [2] -> soft scroll × n [2]
+    //
+    //  All these scroll events are discrete; Mos doesn’t simulate scroll gestures.
+    //  When `hard scroll [2]` arrives and the session has not yet timed out, terminate it.
+
+    uint64_t data;
+    if (continuesTriggeredZoom && !taps->triggerFlagsDown
+     && STZStateGetSessionData(context->state, &data) && (data & kStateSessionIsTriggeredZoom)
+     && STZIsScrollEventDiscrete(&record)) {
+        CGEventRef revertEvent = STZStateRevertToScrollByEvent(context->state, event);
+        if (revertEvent != NULL) {
+            emit(taps, context, kSTZWheelReverting, kSTZWheelPostedToSession, revertEvent);
+            CFRelease(revertEvent);
+
+            //  The subsequent mutation ending may invalidate the current mutation,
+            //  so we manually emit the modified event.
+            if (taps->tapsMutable) {
+                emit(taps, context, kSTZWheelUpdated, kSTZWheelPostedAtTap, event);
+            }
+            forEachStateDo(taps, kTryToEndWheelTapMutations, NULL);
+            return NULL;
+        }
+    }
+
+    if (taps->tapsMutable && taps->triggerFlagsDown && STZIsScrollEventDiscrete(&record)) {
+        int32_t pid = (int32_t)CGEventGetIntegerValueField(event, kCGEventTargetUnixProcessID);
+        STZSettingsSnapshot const *settings = STZGetSettingsSnapshot();
+        STZAppOptions appOptions = taps->hooks.getAppOptions(settings, pid, taps->refcon);
+
+        if (!(appOptions & kSTZDisabledForApp) && (appOptions & kSTZUsesCommandBasedZoom)) {
+            CGEventRef pair[2];
+            if (STZCreateCommandBasedZoomKeyEventPair(settings, &record, pair)) {
+                for (int i = 0; i < 2; ++i) {
+                    emit(taps, context, kSTZWheelCommandKey, kSTZWheelPostedToSession, pair[i]);
+                    CFRelease(pair[i]);
+                }
+            }
+            return NULL;
+        }
+    }
+
+    return event;
+}
+
+
+void STZWheelTapsPassiveScrollEvent(STZWheelTapsRef taps, CGEventRef event) {
+    STZScrollRecord record;
+    STZScrollRecordRead(&record, event);
+
+    WheelContext *context = wheelContextWithFallback(taps, record.registryID);
+    STZStateReadScrollEvent(context->state, STZGetSettingsSnapshot(), &record);
+    activateWheelContext(context);
+}
+
+
+CGEventRef STZWheelTapsMutableScrollEvent(STZWheelTapsRef taps, CGEventRef event) {
+    STZSettingsSnapshot const *settings = STZGetSettingsSnapshot();
+    bool continuesTriggeredZoom = (taps->modes & kSTZWheelContinuesTriggeredZoom) != 0;
+    bool underDictatorship = (taps->modes & kSTZWheelUnderDictatorship) != 0;
+
+    STZScrollRecord record;
+    STZScrollRecordRead(&record, event);
+
+    WheelContext *context = wheelContextWithFallback(taps, record.registryID);
+    context->magicZoomPending = false;
+    activateWheelContext(context);
+
+    uint64_t data = 0;
+    STZGestureType gesture = kSTZScroll;
+    bool inSession = STZStateGetSessionData(context->state, &data);
+
+    //  Magic Zoom is currently not affected by any per-app option.
+    //  Though we have no idea why Chromium set a zoom threshold, Magic Zoom behaves like
+    //  touchpad zoom, so we don’t fix Chromium zoom stall for it.
+
+    if (inSession && (data & kStateSessionIsMagicZoom)) {
+        gesture = kSTZZoom;
+        context->appOptions = 0;
+
+    } else if (STZShouldBeginMagicZoom(record.registryID)) {
+        data = kStateSessionIsMagicZoom;
+        gesture = kSTZZoom;
+        context->appOptions = 0;
+
+    } else if (continuesTriggeredZoom && inSession && (data & kStateSessionIsTriggeredZoom)
+            && (STZScrollEventMayFallIntoMomentum(&record) || (underDictatorship && STZIsScrollEventDiscrete(&record)))) {
+        //  What if the event is a `kContinuousScrollEnded`?
+        //  It doesn’t matter because the session will soon time out or enter a momentum state.
+        gesture = kSTZZoom;
+
+    } else if (taps->triggerFlagsDown && (!continuesTriggeredZoom || !STZScrollEventMayFallIntoMomentum(&record))) {
+        //  With `continuesTriggeredZoom`, momentum scrolls in zoom session are handled in the
+        //  previous, and we don’t transform momentum scrolls eagerly.
+
+        //  Scroll events in the same session are always posted to the same process,
+        //  so we need to check the app options only once per session.
+        if (!STZStateIsZooming(context->state)) {
+            int32_t pid = (int32_t)CGEventGetIntegerValueField(event, kCGEventTargetUnixProcessID);
+            context->appOptions = taps->hooks.getAppOptions(settings, pid, taps->refcon);
+        }
+
+        if (!(context->appOptions & kSTZDisabledForApp)) {
+            if (!underDictatorship && STZIsScrollEventDiscrete(&record) && (context->appOptions & kSTZUsesCommandBasedZoom)) {
+                STZStashScrollDirectionIntoEvent(&record);
+                CGEventRef pair[2];
+                if (STZCreateCommandBasedZoomKeyEventPair(settings, &record, pair)) {
+                    for (int i = 0; i < 2; ++i) {
+                        emit(taps, context, kSTZWheelCommandKey, kSTZWheelPostedToSession, pair[i]);
+                        CFRelease(pair[i]);
+                    }
+                }
+                return NULL;
+            }
+
+            gesture = kSTZZoom;
+            if (continuesTriggeredZoom) {
+                data = kStateSessionIsTriggeredZoom;
+            }
+        }
+    }
+
+    if (gesture != kSTZZoom) {
+        //  For example, a event sequence may look like this:
+        //
+        //    trigger down -> continuous scroll × n [1] ->      zoom
+        //    trigger up -> continuous scroll × n [1] ->        revert to scrolls
+        //    momentum scroll × n [1]
+        //
+        //   If the data is kept after reverting to scrolls, the momentum scrolls might
+        //   be misrecognized as a triggered zoom.
+        data = 0;
+    }
+
+    uint64_t fallbackScrollDir = underDictatorship ? context->hardScrollDir : 0;
+
+    STZEventPlacement auxPlacement;
+    CGEventRef auxEvent = STZStateTransformScrollEvent(context->state, settings, &record, gesture,
+                                                       (context->appOptions & kSTZFixesZoomForChromiumApp) != 0,
+                                                       fallbackScrollDir, &data, &auxPlacement);
+    if (underDictatorship) {
+        STZReadScrollDeltaFromEvent(&record, 0, true);
+    }
+    STZScrollRecordWriteBack(&record);
+
+    CGEventRef returnValue;
+#define RETURNS(x) returnValue = x; break
+    if (auxEvent == NULL) {
+        switch (auxPlacement) {
+        case kSTZReplaceEvent:
+            emit(taps, context, kSTZWheelDiscarded, kSTZWheelNotPosted, event);
+            RETURNS(NULL);
+        case kSTZAppendEvent:
+        case kSTZPrependEvent:
+            emit(taps, context, kSTZWheelUpdated, kSTZWheelNotPosted, event);
+            RETURNS(event);
+        }
+
+    } else {
+        if (context->appOptions & kSTZFlagsExcludedForApp) {
+            clearTriggerFlagsForEvent(settings, auxEvent);
+        }
+        switch (auxPlacement) {
+        case kSTZReplaceEvent:
+            emit(taps, context, kSTZWheelReplacing, auxDelivery(taps), auxEvent);
+            CFRelease(auxEvent);
+            RETURNS(NULL);
+        case kSTZAppendEvent:
+            emit(taps, context, kSTZWheelUpdated, kSTZWheelPostedAtTap, event);
+            emit(taps, context, kSTZWheelAppended, auxDelivery(taps), auxEvent);
+            CFRelease(auxEvent);
+            RETURNS(NULL);
+        case kSTZPrependEvent:
+            emit(taps, context, kSTZWheelPrepended, auxDelivery(taps), auxEvent);
+            emit(taps, context, kSTZWheelUpdated, kSTZWheelNotPosted, event);
+            CFRelease(auxEvent);
+            RETURNS(event);
+        }
+    }
+#undef RETURNS
+    forEachStateDo(taps, kTryToEndWheelTapMutations | kRescheduleTimer, NULL);
+    return returnValue;
+}
+
+
+void STZWheelTapsTimerDidFire(STZWheelTapsRef taps) {
+    //  How late the timer is goes to the scheduler statistics; logging each firing would only
+    //  make it later.
+    STZSchedulerTimerDidFire(taps->periodicUpdates, CGEventTimestampNow());
+    forEachStateDo(taps, kTryToEndWheelTapMutations | kRescheduleTimer | kEmitPeriodicEvents, NULL);
+}
+
+
+void STZWheelTapsExpireContexts(STZWheelTapsRef taps) {
+    STZCacheExpireValues(taps->contexts, CGEventTimestampNow());
+}
+
+
+CGEventTimestamp STZWheelTapsGetExpiryInterval(STZWheelTapsRef taps) {
+    return STZCacheGetExpiryInterval(taps->contexts);
+}
+
+
+bool STZWheelTapsRemoveDevice(STZWheelTapsRef taps, uint64_t registryID) {
+    if (!STZCacheRemoveValue(taps->contexts, registryID)) {return false;}
+
+    //  The state may have been the one that kept the taps mutable or the timer scheduled.
+    forEachStateDo(taps, kTryToEndWheelTapMutations | kRescheduleTimer, NULL);
+    return true;
+}
+
+
+bool STZWheelTapsIsZooming(STZWheelTapsRef taps, uint64_t registryID) {
+    WheelContext *context = STZCacheGetValue(taps->contexts, registryID);
+    return context != NULL && STZStateIsZooming(context->state);
+}
+
+
+STZSchedulerStatistics STZWheelTapsGetSchedulerStatistics(STZWheelTapsRef taps) {
+    return STZSchedulerGetStatistics(taps->periodicUpdates);
+}
+
+
+STZTapPolicyStatistics STZWheelTapsGetPolicyStatistics(STZWheelTapsRef taps, CGEventTimestamp now) {
+    return STZTapPolicyGetStatistics(taps->tapPolicy, now);
+}
@@ -0,0 +1,128 @@
+/*
+ *  STZWheelTaps.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZStateManager.h"
+#include "STZScheduler.h"
+#include "STZTapPolicy.h"
+
+CF_IMPLICIT_BRIDGING_ENABLED
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  What the scroll wheel taps, the flags tap and the periodic update timer decide: which device
+//  context an event belongs to, whether it becomes part of a zoom, when each state wants its next
+//  update, and when the taps may stop mutating. STZEventHandling.c drives it from the event taps
+//  and a run loop timer, and STZReplay.c from traces under the backend clock, so both run the
+//  same decisions. Only posting events, switching taps and moving the timer are left to the owner
+//  through `STZWheelTapsHooks`.
+//
+//  Not thread-safe; the app uses it on the main thread, where the taps run.
+
+
+typedef CLOSED_ENUM(uint8_t) {
+    kSTZWheelUpdated,       ///< The input event goes on, after the state machine updated it.
+    kSTZWheelDiscarded,     ///< The input event is discarded.
+    kSTZWheelPrepended,     ///< Posted before the input event.
+    kSTZWheelAppended,      ///< Posted after the input event.
+    kSTZWheelReplacing,     ///< Posted instead of the input event.
+    kSTZWheelPeriodic,      ///< Posted by the periodic update.
+    kSTZWheelReverting,     ///< Posted when a triggered zoom reverts to scrolling.
+    kSTZWheelCommandKey,    ///< Posted for an app that zooms by key commands.
+} STZWheelEmission;
+
+typedef CLOSED_ENUM(uint8_t) {
+    kSTZWheelNotPosted,         ///< The tap returns the event or drops it; only reported.
+    kSTZWheelPostedAtTap,       ///< Posted into the stream where the tap is, as by `CGEventTapPostEvent`.
+    kSTZWheelPostedToSession,   ///< Posted to the session anew, passing every session tap again.
+} STZWheelDelivery;
+
+
+typedef struct {
+    /// Must post the event as `delivery` tells before returning. The event is not retained.
+    /// `registryID` is that of the device context the event comes from.
+    void (*emit)(STZWheelEmission emission, STZWheelDelivery delivery, CGEventRef event,
+                 uint64_t registryID, void *__nullable refcon);
+
+    /// Enables the mutable scroll wheel taps and disables the passive ones, or the other way.
+    void (*setTapsMutable)(bool tapsMutable, void *__nullable refcon);
+
+    /// Moves the periodic update timer to `deadline`, or stops it if it is 0. `now` is the time
+    /// the deadline was computed at, for converting it to the clock of the timer.
+    void (*moveTimer)(CGEventTimestamp deadline, CGEventTimestamp now, void *__nullable refcon);
+
+    /// Options of the app of the process that scroll events are posted to.
+    STZAppOptions (*getAppOptions)(STZSettingsSnapshot const *settings, int32_t pid, void *__nullable refcon);
+} STZWheelTapsHooks;
+
+
+typedef OPTION_FLAGS(uint8_t) {
+    /// The hard taps are inserted; see `kSTZWantsDictatorship`. Zoom events are then posted to
+    /// the session instead of at the soft taps.
+    kSTZWheelUnderDictatorship      = 1 << 0,
+
+    /// The opposite of `kSTZRevertsToScrollImmediately`.
+    kSTZWheelContinuesTriggeredZoom = 1 << 1,
+} STZWheelModes;
+
+
+typedef struct _STZWheelTaps *STZWheelTapsRef;
+
+/// The hooks are copied. The taps start passive with no mode.
+STZWheelTapsRef STZWheelTapsCreate(STZWheelTapsHooks const *hooks, void *__nullable refcon);
+void STZWheelTapsRelease(STZWheelTapsRef);
+
+STZWheelModes STZWheelTapsGetModes(STZWheelTapsRef);
+void STZWheelTapsSetModes(STZWheelTapsRef, STZWheelModes modes);
+
+bool STZWheelTapsAreMutable(STZWheelTapsRef);
+bool STZWheelTapsAreTriggerFlagsDown(STZWheelTapsRef);
+
+/// Forgets every device, takes the trigger flags as up and the taps as passive, and stops the
+/// timer, without reverting anything or calling `setTapsMutable`. For when the taps are released.
+void STZWheelTapsReset(STZWheelTapsRef);
+
+/// Takes the trigger flags as up without reverting anything, e.g. after the flags tap is released.
+void STZWheelTapsForgetTriggerFlags(STZWheelTapsRef);
+
+/// Called from the flags tap when the trigger flags are pressed or released by `event`.
+void STZWheelTapsSetTriggerFlagsDown(STZWheelTapsRef, bool down, CGEventRef event);
+
+/// Called when a Magic Mouse is recognized to be about to zoom, or no longer. The recognition
+/// itself is read by `STZShouldBeginMagicZoom` when the mouse scrolls.
+void STZWheelTapsSetMagicZoomPending(STZWheelTapsRef, uint64_t registryID, bool pending);
+
+/// Called from the hard taps at the HID location, passive or mutable. Returns the event to pass
+/// on, or NULL to drop it; a passive tap passes it on regardless.
+CGEventRef __nullable STZWheelTapsHardScrollEvent(STZWheelTapsRef, CGEventRef event);
+
+/// Called from the passive soft tap; only keeps the state in sync.
+void STZWheelTapsPassiveScrollEvent(STZWheelTapsRef, CGEventRef event);
+
+/// Called from the mutable soft tap. Returns the event to pass on, or NULL to drop it.
+CGEventRef __nullable STZWheelTapsMutableScrollEvent(STZWheelTapsRef, CGEventRef event);
+
+/// Called when the periodic update timer fires.
+void STZWheelTapsTimerDidFire(STZWheelTapsRef);
+
+/// Lookups only expire device contexts while events come; call this about every expiry interval
+/// so that idle ones are released.
+void STZWheelTapsExpireContexts(STZWheelTapsRef);
+CGEventTimestamp STZWheelTapsGetExpiryInterval(STZWheelTapsRef);
+
+/// Releases the context of a detached device. Returns false if it had none.
+bool STZWheelTapsRemoveDevice(STZWheelTapsRef, uint64_t registryID);
+
+bool STZWheelTapsIsZooming(STZWheelTapsRef, uint64_t registryID);
+
+STZSchedulerStatistics STZWheelTapsGetSchedulerStatistics(STZWheelTapsRef);
+STZTapPolicyStatistics STZWheelTapsGetPolicyStatistics(STZWheelTapsRef, CGEventTimestamp now);
+
+
+CF_ASSUME_NONNULL_END
+CF_IMPLICIT_BRIDGING_DISABLED
@@ -10,6 +10,7 @@
 #import "STZPermissionView.h"
 #import "STZEventHandling.h"
 #import "STZSettings.h"
+#import "STZProfile.h"
 #import "STZLaunchAtLogin.h"
 #import "STZControls.h"
 #import "STZOptionsPanel.h"
@@ -90,6 +91,9 @@ static NSString *trim(NSString *string) {
     NSSlider           *_inertiaSlider;
     NSButton           *_revertImmediatelyCheckbox;
     NSButton           *_launchCheckbox;
+    NSTextField        *_profileLabel;
+    NSPopUpButton      *_profilePopUp;
+    NSTextField        *_profileMessageLabel;
     NSButton           *_dictatorshipCheckbox;
     NSTextField        *_dictatorshipMessageLabel;
     NSButton           *_optionsButton;
@@ -169,6 +173,32 @@ static double const STZMomentumZoomAttenuationRange[] = {0, 1};
         [_launchCheckbox setTag:0];
     }
 
+    _profileLabel = [NSTextField labelWithString:NSLocalizedString(@"performance:", nil)];
+    _profilePopUp = [[NSPopUpButton alloc] initWithFrame:NSZeroRect pullsDown:NO];
+    [_profilePopUp setTarget:self];
+    [_profilePopUp setAction:@selector(selectProfile:)];
+    [_profilePopUp setAutoenablesItems:NO];
+
+    struct {STZProfile profile; NSString *title;} const profileItems[] = {
+        {kSTZProfileBalanced, NSLocalizedString(@"profile-balanced", nil)},
+        {kSTZProfileLowLatency, NSLocalizedString(@"profile-low-latency", nil)},
+        {kSTZProfileLowPower, NSLocalizedString(@"profile-low-power", nil)},
+        {kSTZProfileCustom, NSLocalizedString(@"profile-custom", nil)},
+    };
+
+    for (size_t i = 0; i < sizeof(profileItems) / sizeof(*profileItems); ++i) {
+        if (profileItems[i].profile == kSTZProfileCustom) {
+            [[_profilePopUp menu] addItem:[NSMenuItem separatorItem]];
+        }
+        [_profilePopUp addItemWithTitle:profileItems[i].title];
+        [[_profilePopUp lastItem] setTag:profileItems[i].profile];
+    }
+
+    //  Custom is only shown for settings changed by hand, and can’t be chosen.
+    [[_profilePopUp itemAtIndex:[_profilePopUp indexOfItemWithTag:kSTZProfileCustom]] setEnabled:NO];
+
+    _profileMessageLabel = STZMessageLabel(NSLocalizedString(@"performance-message", nil));
+
     _dictatorshipCheckbox = [NSButton checkboxWithTitle:NSLocalizedString(@"wants-dictatorship", nil)
                                                  target:self action:@selector(toggleDictatorship:)];
 
@@ -185,6 +215,7 @@ static double const STZMomentumZoomAttenuationRange[] = {0, 1};
     [view setSubviews:@[_triggerFlagsCheckbox, _triggerFlagsField,
                         _magicZoomCheckbox, magicZoomMessageLabel,
                         box, _launchCheckbox,
+                        _profileLabel, _profilePopUp, _profileMessageLabel,
                         _dictatorshipCheckbox, _dictatorshipMessageLabel,
                         _revertImmediatelyCheckbox,
                         _optionsButton, _consoleButton]];
@@ -266,7 +297,18 @@ static double const STZMomentumZoomAttenuationRange[] = {0, 1};
         [[_launchCheckbox topAnchor] constraintEqualToAnchor:[box bottomAnchor] constant:kSTZUISmallSpacing],
         [[_launchCheckbox leadingAnchor] constraintEqualToAnchor:[view leadingAnchor] constant:kSTZUINormalSpacing],
 
-        [[_dictatorshipCheckbox topAnchor] constraintEqualToAnchor:[(launchMessageLabel ?: _launchCheckbox) bottomAnchor] constant:kSTZUINormalSpacing - kSTZUIInlineSpacing],
+        [[_profileLabel topAnchor] constraintEqualToAnchor:[(launchMessageLabel ?: _launchCheckbox) bottomAnchor] constant:kSTZUINormalSpacing],
+        [[_profileLabel leadingAnchor] constraintEqualToAnchor:[view leadingAnchor] constant:kSTZUINormalSpacing],
+
+        [[_profilePopUp firstBaselineAnchor] constraintEqualToAnchor:[_profileLabel firstBaselineAnchor]],
+        [[_profilePopUp leadingAnchor] constraintEqualToAnchor:[_profileLabel trailingAnchor] constant:kSTZUIInlineSpacing],
+        [[_profilePopUp trailingAnchor] constraintLessThanOrEqualToAnchor:[view trailingAnchor] constant:-kSTZUINormalSpacing],
+
+        [[_profileMessageLabel topAnchor] constraintEqualToAnchor:[_profilePopUp bottomAnchor] constant:kSTZUIInlineSpacing],
+        [[_profileMessageLabel leadingAnchor] constraintEqualToAnchor:[_profileLabel leadingAnchor] constant:kSTZUICheckboxWidth],
+        [[_profileMessageLabel trailingAnchor] constraintEqualToAnchor:[_inertiaSlider trailingAnchor]],
+
+        [[_dictatorshipCheckbox topAnchor] constraintEqualToAnchor:[_profileMessageLabel bottomAnchor] constant:kSTZUINormalSpacing - kSTZUIInlineSpacing],
         [[_dictatorshipCheckbox leadingAnchor] constraintEqualToAnchor:[view leadingAnchor] constant:kSTZUINormalSpacing],
 
         [[_dictatorshipMessageLabel topAnchor] constraintEqualToAnchor:[_dictatorshipCheckbox bottomAnchor] constant:kSTZUIInlineSpacing],
@@ -308,6 +350,9 @@ static double const STZMomentumZoomAttenuationRange[] = {0, 1};
 
 - (void)updateAdvancedSettingsVisibility {
     [_consoleButton setHidden:!_showsAdvancedSettings];
+    [_profileLabel setHidden:!_showsAdvancedSettings];
+    [_profilePopUp setHidden:!_showsAdvancedSettings];
+    [_profileMessageLabel setHidden:!_showsAdvancedSettings];
     [_dictatorshipCheckbox setHidden:!_showsAdvancedSettings];
     [_dictatorshipMessageLabel setHidden:!_showsAdvancedSettings];
 
@@ -337,6 +382,7 @@ static double const STZMomentumZoomAttenuationRange[] = {0, 1};
     [_inertiaSlider setDoubleValue:1 - STZGetMomentumZoomAttenuation()];
     [_magicZoomCheckbox setState:(modes & kSTZMagicZoomEnabled) != 0];
     [_dictatorshipCheckbox setState:(modes & kSTZWantsDictatorship) != 0];
+    [_profilePopUp selectItemWithTag:STZGetCurrentProfile()];
     [_revertImmediatelyCheckbox setState:(modes & kSTZRevertsToScrollImmediately) != 0];
     [_launchCheckbox setState:STZGetLaunchAtLoginEnabled()];
 }
@@ -353,6 +399,7 @@ static double const STZMomentumZoomAttenuationRange[] = {0, 1};
     [_inertiaSlider setEnabled:zoomSettingsEnabled];
     [_optionsButton setEnabled:triggerFlagsEnabled];
     [_launchCheckbox setEnabled:[_launchCheckbox tag] != -1];
+    [_profilePopUp setEnabled:zoomSettingsEnabled];
     [_dictatorshipCheckbox setEnabled:zoomSettingsEnabled];
     [_revertImmediatelyCheckbox setEnabled:triggerFlagsEnabled];
 }
@@ -386,6 +433,14 @@ static double const STZMomentumZoomAttenuationRange[] = {0, 1};
     [self toggleMode:kSTZRevertsToScrollImmediately byCheckbox:_revertImmediatelyCheckbox];
 }
 
+- (void)selectProfile:(id)sender {
+    STZApplyProfile((STZProfile)[[_profilePopUp selectedItem] tag]);
+    if ([self commitModes:STZGetPreferredModes() presentingFromView:_profilePopUp]) {
+        [_enableRetryTimer invalidate];
+        _enableRetryTimer = nil;
+    }
+}
+
 - (void)toggleMode:(STZModes)mode byCheckbox:(NSButton *)checkbox {
     STZModes modes = STZGetPreferredModes();
     if ([checkbox state]) {
@@ -0,0 +1,150 @@
+/*
+ *  STZAppEngineTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#define _XOPEN_SOURCE 700
+#include "STZTestSupport.h"
+#include "STZAppEngine.h"
+#include <ftw.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+//  Builds a tree of fake bundles in a temporary directory, with only the parts detection looks
+//  at, and checks the engines found and when the cache scans a bundle again.
+
+static char root[PATH_MAX];
+
+
+static void makePath(char const *relativePath, bool isFile) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", root, relativePath);
+
+    //  Create each directory along the way.
+    for (char *slash = strchr(path + strlen(root) + 1, '/'); slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(path, 0755);
+        *slash = '/';
+    }
+
+    if (isFile) {
+        FILE *file = fopen(path, "w");
+        if (file) {fclose(file);}
+    } else {
+        mkdir(path, 0755);
+    }
+}
+
+
+static void makeBundle(char const *name, char const *const frameworks[], char const *const markers[]) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/Contents/Info.plist", name);
+    makePath(path, true);
+
+    for (int i = 0; frameworks && frameworks[i]; ++i) {
+        snprintf(path, sizeof(path), "%s/Contents/Frameworks/%s", name, frameworks[i]);
+        makePath(path, false);
+    }
+
+    //  As in real bundles, `Resources` links to the current version.
+    for (int i = 0; markers && markers[i]; ++i) {
+        snprintf(path, sizeof(path), "%s/Contents/Frameworks/%s/Versions/A/Resources/chrome_100_percent.pak", name, markers[i]);
+        makePath(path, true);
+
+        char link[PATH_MAX];
+        snprintf(link, sizeof(link), "%s/%s/Contents/Frameworks/%s/Resources", root, name, markers[i]);
+        symlink("Versions/A/Resources", link);
+    }
+}
+
+
+static void pathOf(char *path, char const *relativePath) {
+    snprintf(path, PATH_MAX, "%s/%s", root, relativePath);
+}
+
+
+static STZAppEngine detect(char const *name) {
+    char path[PATH_MAX];
+    pathOf(path, name);
+    return STZDetectAppEngine(path);
+}
+
+
+static STZAppEngine engineFromCache(STZAppEngineCacheRef cache, char const *name) {
+    char path[PATH_MAX];
+    pathOf(path, name);
+    return STZAppEngineCacheGetEngine(cache, path);
+}
+
+
+static int removeEntry(char const *path, struct stat const *st, int flag, struct FTW *ftw) {
+    return remove(path);
+}
+
+
+int main(void) {
+    snprintf(root, sizeof(root), "%s/STZAppEngineTests.XXXXXX", getenv("TMPDIR") ?: "/tmp");
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    makeBundle("Native.app", NULL, NULL);
+    makeBundle("Chromium.app", (char const *[]){"Chromium Framework.framework", "Sparkle.framework", NULL}, NULL);
+    makeBundle("Edge.app", NULL, (char const *[]){"Microsoft Edge Framework.framework", NULL});
+    makeBundle("Code.app", (char const *[]){"Squirrel.framework", "Electron Framework.framework", NULL}, NULL);
+    makeBundle("Other.app", (char const *[]){"Sparkle.framework/Resources", NULL}, NULL);
+
+    STZ_CHECK(detect("Native.app") == kSTZAppEngineNative);
+    STZ_CHECK(detect("Chromium.app") == kSTZAppEngineChromium);
+    STZ_CHECK(detect("Edge.app") == kSTZAppEngineChromium);
+    STZ_CHECK(detect("Code.app") == kSTZAppEngineElectron);
+    STZ_CHECK(detect("Other.app") == kSTZAppEngineNative);
+    STZ_CHECK(detect("Missing.app") == kSTZAppEngineNative);
+
+    char cachePath[PATH_MAX];
+    pathOf(cachePath, "AppEngines.cache");
+
+    STZAppEngineCacheRef cache = STZAppEngineCacheCreate(cachePath);
+    STZ_CHECK(engineFromCache(cache, "Chromium.app") == kSTZAppEngineChromium);
+    STZ_CHECK(engineFromCache(cache, "Code.app") == kSTZAppEngineElectron);
+    STZ_CHECK(engineFromCache(cache, "Native.app") == kSTZAppEngineNative);
+    STZ_CHECK(STZAppEngineCacheSave(cache));
+    STZAppEngineCacheRelease(cache);
+
+    //  Loaded from the file, an unmodified bundle isn’t scanned again, even if its frameworks
+    //  have changed.
+    char path[PATH_MAX];
+    pathOf(path, "Code.app/Contents/Frameworks/Electron Framework.framework");
+    rmdir(path);
+
+    cache = STZAppEngineCacheCreate(cachePath);
+    STZ_CHECK(engineFromCache(cache, "Code.app") == kSTZAppEngineElectron);
+
+    //  An update rewrites `Info.plist`.
+    pathOf(path, "Code.app/Contents/Info.plist");
+    struct timeval times[2];
+    gettimeofday(&times[0], NULL);
+    times[0].tv_sec += 10;
+    times[1] = times[0];
+    utimes(path, times);
+
+    STZ_CHECK(engineFromCache(cache, "Code.app") == kSTZAppEngineNative);
+    STZ_CHECK(STZAppEngineCacheSave(cache));
+    STZAppEngineCacheRelease(cache);
+
+    cache = STZAppEngineCacheCreate(cachePath);
+    STZ_CHECK(engineFromCache(cache, "Code.app") == kSTZAppEngineNative);
+    STZ_CHECK(engineFromCache(cache, "Chromium.app") == kSTZAppEngineChromium);
+    STZAppEngineCacheRelease(cache);
+
+    nftw(root, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+    return STZTestFinish();
+}
@@ -0,0 +1,153 @@
+/*
+ *  STZAppRegistryBenchmarks.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZAppRegistry.h"
+#include "STZProcessTable.h"
+#include "STZSettings.h"
+#include <string.h>
+
+
+//  Interns the bundle IDs of a fake system, fills a process table for its processes as launches
+//  would, and then times per-event lookups of app options: through the process table and the
+//  app ID, as the event taps do, against hashing the bundle ID of each event as before interning.
+
+#define kAppCount 3000
+#define kProcessCount 20000
+#define kMaxPID 70000
+
+static char bundleIDs[kAppCount][64];
+
+
+static void testRegistry(void) {
+    int mismatches = 0;
+    for (int i = 0; i < kAppCount; ++i) {
+        snprintf(bundleIDs[i], sizeof(bundleIDs[i]), i % 7 ? "com.vendor%d.product.helper" : "com.apple.service%d", i);
+        mismatches += STZAppRegistryIntern(bundleIDs[i], strlen(bundleIDs[i])) != (STZAppID)i + 1;
+    }
+
+    for (int i = 0; i < kAppCount; ++i) {
+        STZAppID appID = (STZAppID)i + 1;
+        mismatches += STZAppRegistryIntern(bundleIDs[i], strlen(bundleIDs[i])) != appID;
+
+        size_t length;
+        char const *bundleID = STZAppRegistryGetBundleIdentifier(appID, &length);
+        mismatches += length != strlen(bundleIDs[i]) || strcmp(bundleID, bundleIDs[i]) != 0;
+        mismatches += STZAppRegistryIsSystemApp(appID) != (i % 7 == 0);
+    }
+
+    STZ_CHECK(mismatches == 0);
+    STZ_CHECK(STZAppRegistryLookup("com.vendor", 10) == kSTZNoAppID);
+    STZ_CHECK(STZAppRegistryGetLastAppID() == kAppCount);
+}
+
+
+/// Launches, terminations and lookups at random against a plain array. An entry without an app
+/// is only valid at the version it was written at.
+static void testProcessTable(int steps) {
+    static STZAppID appIDs[kMaxPID];
+    static uint64_t versions[kMaxPID];
+    static bool present[kMaxPID];
+
+    STZProcessTableRef table = STZProcessTableCreate();
+    unsigned seed = 1;
+    int mismatches = 0;
+
+    for (int step = 0; step < steps; ++step) {
+        seed = seed * 1103515245 + 12345;
+        int32_t pid = 1 + (int32_t)((seed >> 8) % (kMaxPID - 1));
+        uint64_t version = (uint64_t)step / 1000;
+
+        switch ((seed >> 4) & 3) {
+        case 0:
+            STZProcessTableRemove(table, pid);
+            present[pid] = false;
+            break;
+        case 1:
+            appIDs[pid] = (seed >> 20) % 5;
+            versions[pid] = version;
+            present[pid] = true;
+            STZProcessTableSetAppID(table, pid, appIDs[pid], version);
+            break;
+        default: {
+            STZAppID appID;
+            bool found = STZProcessTableGetAppID(table, pid, version, &appID);
+            bool valid = present[pid] && (appIDs[pid] != kSTZNoAppID || versions[pid] == version);
+            mismatches += found != valid || (found && appID != appIDs[pid]);
+            break;
+        }
+        }
+    }
+
+    uint32_t count = 0;
+    for (int pid = 0; pid < kMaxPID; ++pid) {
+        count += present[pid];
+    }
+
+    STZ_CHECK(mismatches == 0);
+    STZ_CHECK(STZProcessTableGetCount(table) == count);
+    STZProcessTableRelease(table);
+}
+
+
+static int32_t pidAt(int event) {
+    return 100 + (int32_t)((unsigned)event * 40503u % kProcessCount);
+}
+
+
+static int appIndexOf(int32_t pid) {
+    return (int)((unsigned)pid * 2654435761u % kAppCount);
+}
+
+
+int main(int argc, char *argv[]) {
+    int events = STZTestIsFullRun(argc, argv) ? 100000000 : 2000000;
+    testRegistry();
+    testProcessTable(STZTestIsFullRun(argc, argv) ? 20000000 : 500000);
+
+    //  Each process is resolved once, when its launch is observed.
+    STZProcessTableRef processes = STZProcessTableCreate();
+    uint64_t start = STZTestGetWallTime();
+    for (int i = 0; i < kProcessCount; ++i) {
+        int32_t pid = 100 + i;
+        char const *bundleID = bundleIDs[appIndexOf(pid)];
+        STZProcessTableSetAppID(processes, pid, STZAppRegistryIntern(bundleID, strlen(bundleID)), 0);
+    }
+    uint64_t resolveTime = STZTestGetWallTime() - start;
+
+    static STZAppOptions appOptions[kAppCount + 1];
+    for (int i = 1; i <= kAppCount; ++i) {
+        appOptions[i] = i & 15;
+    }
+    STZSettingsSnapshot snapshot = {.appOptions = appOptions, .lastAppID = kAppCount};
+
+    unsigned interned = 0;
+    start = STZTestGetWallTime();
+    for (int e = 0; e < events; ++e) {
+        STZAppID appID = kSTZNoAppID;
+        STZProcessTableGetAppID(processes, pidAt(e), 0, &appID);
+        interned += STZSettingsSnapshotGetAppOptions(&snapshot, appID);
+    }
+    uint64_t internedTime = STZTestGetWallTime() - start;
+
+    unsigned hashed = 0;
+    start = STZTestGetWallTime();
+    for (int e = 0; e < events; ++e) {
+        char const *bundleID = bundleIDs[appIndexOf(pidAt(e))];
+        hashed += appOptions[STZAppRegistryLookup(bundleID, strlen(bundleID))];
+    }
+    uint64_t hashedTime = STZTestGetWallTime() - start;
+
+    printf("resolving %d processes: %.1f ns each\n", kProcessCount, (double)resolveTime / kProcessCount);
+    printf("options per event by process table and app ID: %.2f ns\n", (double)internedTime / events);
+    printf("options per event by bundle ID hash: %.2f ns\n", (double)hashedTime / events);
+
+    STZ_CHECK(interned == hashed);
+    STZProcessTableRelease(processes);
+    return STZTestFinish();
+}
@@ -0,0 +1,175 @@
+/*
+ *  STZAttenuationTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZReplay.h"
+#include <math.h>
+
+
+//  Momentum zooms are attenuated by `k ^ (∆t / k)` looked up in a table of `exp(-u)`. Replays
+//  momentum of a constant delta over several settings and checks every emitted change against
+//  `pow()` within the relative error the table promises, and that the zoom ends where the curve
+//  falls below the minimum, even if no momentum scroll comes to notice.
+
+
+#define kMaxChanges 1024
+
+
+typedef struct {
+    int                 changes;
+    double              values[kMaxChanges];
+    CGEventTimestamp    times[kMaxChanges];
+    int                 ended;
+    int                 changesAfterEnded;
+    CGEventTimestamp    endedTime;
+    STZReplayEmission   endedEmission;
+} Log;
+
+
+static void record(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {
+    Log *log = refcon;
+    if (emission == kSTZReplayUpdated || CGEventGetType(event) != kCGEventGesture) {return;}
+
+    switch (CGEventGetIntegerValueField(event, kCGGestureEventPhase)) {
+    case kCGGesturePhaseChanged:
+        if (log->ended) {
+            log->changesAfterEnded += 1;
+        } else if (log->changes < kMaxChanges) {
+            log->values[log->changes] = CGEventGetDoubleValueField(event, kCGGestureEventZoomValue);
+            log->times[log->changes] = CGEventGetTimestamp(event);
+            log->changes += 1;
+        }
+        break;
+    case kCGGesturePhaseEnded:
+        log->ended += 1;
+        log->endedTime = time;
+        log->endedEmission = emission;
+        break;
+    }
+}
+
+
+static double const kDelta = 10;
+static double const kRelativeTolerance = 3.1e-5;
+
+
+/// A short trackpad zoom, then momentum from `momentumStart` with an event every `interval`
+/// until `momentumEnd`, all of the same delta.
+static void replayMomentum(Log *log, CGEventTimestamp momentumStart, CGEventTimestamp interval,
+                           CGEventTimestamp momentumEnd) {
+    STZMemoryBackendSetDisplayFrameInterval(NSEC_PER_SEC / 60);
+
+    CGEventTimestamp time = momentumStart - NSEC_PER_SEC / 10;
+    STZMemoryBackendSetNow(time);
+
+    *log = (Log){0};
+    STZReplayRef replay = STZReplayCreate(0, record, log);
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+
+    for (int i = 0; i < 10; ++i) {
+        time += NSEC_PER_SEC / 120;
+        CGScrollPhase phase = i == 0 ? kCGScrollPhaseBegan : i == 9 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+        CGEventRef event = STZTestCreateScrollEvent(time, 1, kDelta, phase, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+
+    for (time = momentumStart; time <= momentumEnd; time += interval) {
+        CGMomentumScrollPhase momentumPhase = time == momentumStart ? kCGMomentumScrollPhaseBegin
+                                            : time + interval > momentumEnd ? kCGMomentumScrollPhaseEnd
+                                            : kCGMomentumScrollPhaseContinue;
+        CGEventRef event = STZTestCreateScrollEvent(time, 1, kDelta, 0, momentumPhase);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+
+    STZReplaySetTriggerFlagsDown(replay, false, momentumEnd);
+    STZReplayAdvanceTo(replay, momentumEnd + NSEC_PER_SEC);
+    STZReplayRelease(replay);
+}
+
+
+static void testTableAgainstPow(void) {
+    static double const attenuations[] = {0, 0.2, 0.5, 0.8, 0.95};
+    static double const minValues[] = {0, 1e-4, 1e-3};
+
+    CGEventTimestamp start = 1000 * NSEC_PER_SEC;
+    CGEventTimestamp end = start + 3 * NSEC_PER_SEC;
+    static Log events;
+
+    for (int a = 0; a < 5; ++a) {
+        for (int m = 0; m < 3; ++m) {
+            STZSetMomentumZoomAttenuation(attenuations[a]);
+            STZSetMomentumZoomMinValue(minValues[m]);
+            replayMomentum(&events, start, NSEC_PER_SEC / 120, end);
+
+            STZ_CHECK(events.ended == 1);
+            STZ_CHECK(events.changesAfterEnded == 0);
+
+            //  The momentum begins with an unattenuated change.
+            int first = 0;
+            while (first < events.changes && events.times[first] < start) {first += 1;}
+            STZ_CHECK(first < events.changes && events.times[first] == start);
+            if (first >= events.changes) {continue;}
+
+            double k = 1 - attenuations[a];
+            double initial = events.values[first];
+            double expectedLast = 0;
+
+            for (int i = first; i < events.changes; ++i) {
+                double dt = (double)(events.times[i] - start) / NSEC_PER_SEC;
+                double expected = pow(k, dt / k);
+                STZ_CHECK(fabs(expected - exp(log(k) / k * dt)) <= 1e-12);
+                STZ_CHECK(fabs(events.values[i] / initial - expected) <= kRelativeTolerance * expected);
+                expectedLast = expected;
+            }
+
+            //  Unless the next momentum scroll is the last, which ends the zoom anyway, it is
+            //  expected below the minimum or past the end of the table, and the zoom ends no later.
+            CGEventTimestamp nextTime = events.times[events.changes - 1] + NSEC_PER_SEC / 120;
+            double next = pow(k, (double)(nextTime - start) / NSEC_PER_SEC / k);
+            STZ_CHECK(fabs(initial) * expectedLast >= minValues[m] * (1 - kRelativeTolerance));
+            STZ_CHECK(nextTime + NSEC_PER_SEC / 120 > end
+                   || fabs(initial) * next <= minValues[m] * (1 + kRelativeTolerance)
+                   || next < exp(-16));
+            STZ_CHECK(events.endedTime <= nextTime);
+        }
+    }
+}
+
+
+static void testCutoffEndsZoom(void) {
+    STZSetMomentumZoomAttenuation(0.8);
+    STZSetMomentumZoomMinValue(1e-3);
+
+    //  The factor alone falls below the minimum at `ln(1000) / (ln(5) / 0.2)` seconds.
+    double k = 0.2;
+    double cutoff = log(1000) / (-log(k) / k);
+
+    //  Only two momentum scrolls, well apart; the zoom must end in between.
+    CGEventTimestamp start = 1000 * NSEC_PER_SEC;
+    CGEventTimestamp cutoffTime = start + (CGEventTimestamp)(cutoff * NSEC_PER_SEC);
+    static Log events;
+    replayMomentum(&events, start, 3 * NSEC_PER_SEC, start + 3 * NSEC_PER_SEC);
+
+    STZ_CHECK(events.ended == 1);
+    STZ_CHECK(events.endedEmission == kSTZReplayPeriodic);
+    STZ_CHECK(events.endedTime >= cutoffTime);
+    STZ_CHECK(events.endedTime <= cutoffTime + NSEC_PER_SEC / 60);
+    STZ_CHECK(events.changesAfterEnded == 0);
+}
+
+
+int main(void) {
+    testTableAgainstPow();
+    testCutoffEndsZoom();
+
+    STZSetMomentumZoomAttenuation(0.8);
+    STZSetMomentumZoomMinValue(0.001);
+    return STZTestFinish();
+}
@@ -0,0 +1,171 @@
+/*
+ *  STZCacheBenchmarks.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include <string.h>
+
+
+//  Times lookups in STZCache against the cache it replaced, which scanned all entries and
+//  compared timestamps on every access, for as many devices as usual and far more. Events mostly
+//  come in bursts from one device, so keys are looked up in runs of 8. Event handling resolves
+//  the latest device by its handle, which is timed as well.
+
+#define kValueSize 64
+
+
+//  MARK: - Linear Cache
+
+//  The replaced cache, trimmed to lookups and insertions.
+
+typedef struct {
+    uint64_t            key;
+    CGEventTimestamp    accessedAt;  ///< 0 means not used.
+} LinearEntry;
+
+typedef struct {
+    int                 count;
+    int                 recentIndex;
+    CGEventTimestamp    valueLifetime;
+    int                 entrySize;
+    uint8_t            *entries;
+} LinearCache;
+
+
+static LinearEntry *linearEntryAtIndex(LinearCache *cache, int i) {
+    return (LinearEntry *)(cache->entries + cache->entrySize * i);
+}
+
+
+static void linearCacheInit(LinearCache *cache, CGEventTimestamp valueLifetime) {
+    cache->count = 1;
+    cache->recentIndex = 0;
+    cache->valueLifetime = valueLifetime;
+    cache->entrySize = sizeof(LinearEntry) + kValueSize;
+    cache->entries = calloc(cache->count, cache->entrySize);
+}
+
+
+static void *linearCacheGetValue(LinearCache *cache, uint64_t key, bool createsIfAbsent) {
+    CGEventTimestamp now = CGEventTimestampNow();
+    int spareIndex = -1;
+
+    for (int h = 0; h < cache->count; ++h) {
+        int i = (cache->recentIndex + h) % cache->count;
+        LinearEntry *entry = linearEntryAtIndex(cache, i);
+
+        if (entry->accessedAt == 0) {
+            spareIndex = i;
+        } else if (now - entry->accessedAt >= cache->valueLifetime) {
+            if (spareIndex == -1) {
+                spareIndex = i;
+            }
+        } else if (entry->key == key) {
+            entry->accessedAt = now;
+            cache->recentIndex = i;
+            return &entry[1];
+        }
+    }
+
+    if (!createsIfAbsent) {return NULL;}
+
+    if (spareIndex == -1) {
+        int newCount = (int)(cache->count * 1.5 + 1);
+        cache->entries = realloc(cache->entries, (size_t)newCount * cache->entrySize);
+        memset(cache->entries + cache->count * cache->entrySize, 0, (size_t)(newCount - cache->count) * cache->entrySize);
+        spareIndex = cache->count;
+        cache->count = newCount;
+    }
+
+    LinearEntry *entry = linearEntryAtIndex(cache, spareIndex);
+    entry->key = key;
+    entry->accessedAt = now;
+    cache->recentIndex = spareIndex;
+    return &entry[1];
+}
+
+
+//  MARK: - Benchmark
+
+
+static uint64_t keyAt(int keyCount, int i) {
+    return 0x100000a00 + (uint64_t)((i / 8) * 7 % keyCount);
+}
+
+
+/// Returns nanoseconds per lookup.
+static double timeLinearCache(int keyCount, int lookups, uint64_t *checksum) {
+    LinearCache cache;
+    linearCacheInit(&cache, 300 * NSEC_PER_SEC);
+    uint8_t value[kValueSize] = {0};
+    for (int k = 0; k < keyCount; ++k) {
+        value[0] = (uint8_t)k;
+        memcpy(linearCacheGetValue(&cache, 0x100000a00 + (uint64_t)k, true), value, kValueSize);
+    }
+
+    uint64_t start = STZTestGetWallTime();
+    for (int i = 0; i < lookups; ++i) {
+        uint8_t const *found = linearCacheGetValue(&cache, keyAt(keyCount, i), false);
+        *checksum += found ? found[0] : 1000;
+    }
+    uint64_t elapsed = STZTestGetWallTime() - start;
+
+    free(cache.entries);
+    return (double)elapsed / lookups;
+}
+
+
+static double timeCache(int keyCount, int lookups, bool byHandle, uint64_t *checksum) {
+    STZCacheRef cache = STZCacheCreate(kValueSize, 300 * NSEC_PER_SEC, NULL);
+    STZCacheHandle handles[64];
+    uint8_t value[kValueSize] = {0};
+    for (int k = 0; k < keyCount; ++k) {
+        value[0] = (uint8_t)k;
+        handles[k] = STZCacheGetHandle(cache, STZCacheSetValue(cache, 0x100000a00 + (uint64_t)k, value));
+    }
+
+    uint64_t start = STZTestGetWallTime();
+    for (int i = 0; i < lookups; ++i) {
+        uint64_t key = keyAt(keyCount, i);
+        uint8_t const *found = byHandle ? STZCacheGetValueForHandle(cache, handles[key - 0x100000a00])
+                                        : STZCacheGetValue(cache, key);
+        *checksum += found ? found[0] : 1000;
+    }
+    uint64_t elapsed = STZTestGetWallTime() - start;
+
+    STZCacheRelease(cache);
+    return (double)elapsed / lookups;
+}
+
+
+int main(int argc, char *argv[]) {
+    int lookups = STZTestIsFullRun(argc, argv) ? 50000000 : 1000000;
+    STZMemoryBackendSetNow(1000 * NSEC_PER_SEC);
+
+    printf("| keys | linear ns | indexed ns | handle ns |\n");
+    printf("|------|-----------|------------|-----------|\n");
+
+    static int const keyCounts[] = {1, 8, 64};
+    for (int k = 0; k < 3; ++k) {
+        uint64_t linearChecksum = 0, checksum = 0, handleChecksum = 0;
+        double linear = timeLinearCache(keyCounts[k], lookups, &linearChecksum);
+        double indexed = timeCache(keyCounts[k], lookups, false, &checksum);
+        double handle = timeCache(keyCounts[k], lookups, true, &handleChecksum);
+        printf("| %4d | %9.2f | %10.2f | %9.2f |\n", keyCounts[k], linear, indexed, handle);
+
+        //  All find every key with the same value.
+        STZ_CHECK(checksum == linearChecksum && handleChecksum == linearChecksum);
+        STZ_CHECK(checksum < (uint64_t)lookups * 1000);
+
+        //  The scan grows with the keys; the index must win once there are many.
+        if (keyCounts[k] == 64) {
+            STZ_CHECK(indexed < linear);
+        }
+    }
+
+    return STZTestFinish();
+}
@@ -0,0 +1,86 @@
+/*
+ *  STZCacheTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+
+
+static CGEventTimestamp const kLifetime = 300 * NSEC_PER_SEC;
+static int disposedCount = 0;
+
+static void countDisposed(void *valueAddr) {
+    disposedCount += 1;
+}
+
+
+/// A value is kept for its lifetime after the latest access, and disposed within one expiry
+/// interval after that.
+static void testLifetime(CGEventTimestamp base) {
+    STZMemoryBackendSetNow(base);
+    STZCacheRef cache = STZCacheCreate(sizeof(int), kLifetime, countDisposed);
+    CGEventTimestamp interval = STZCacheGetExpiryInterval(cache);
+    disposedCount = 0;
+
+    int value = 1;
+    STZCacheSetValue(cache, 7, &value);
+
+    STZMemoryBackendSetNow(base + kLifetime / 2);
+    STZ_CHECK(STZCacheGetValue(cache, 7) != NULL);
+
+    CGEventTimestamp accessed = base + kLifetime / 2;
+    STZCacheExpireValues(cache, accessed + kLifetime - 1);
+    STZ_CHECK(disposedCount == 0);
+
+    STZCacheExpireValues(cache, accessed + kLifetime + interval);
+    STZ_CHECK(disposedCount == 1);
+
+    STZCacheRelease(cache);
+}
+
+
+/// Accesses after a gap longer than a whole round of the wheel must not be stamped with the tick
+/// of the access before the gap, or the next expiry would dispose them at once.
+static void testAccessAfterGap(CGEventTimestamp base) {
+    STZMemoryBackendSetNow(base);
+    STZCacheRef cache = STZCacheCreate(sizeof(int), kLifetime, countDisposed);
+    disposedCount = 0;
+
+    int value = 1;
+    STZCacheSetValue(cache, 7, &value);
+    STZCacheSetValue(cache, 8, &value);
+
+    //  As after the working modes are turned off and on again.
+    STZCacheRemoveAll(cache);
+    STZ_CHECK(disposedCount == 2);
+
+    CGEventTimestamp later = base + 2 * kLifetime + NSEC_PER_SEC;
+    STZMemoryBackendSetNow(later);
+    int *created = STZCacheSetValue(cache, 9, &value);
+    STZCacheHandle handle = STZCacheGetHandle(cache, created);
+
+    STZCacheExpireValues(cache, later + NSEC_PER_SEC);
+    STZ_CHECK(disposedCount == 2);
+    STZ_CHECK(STZCacheGetValue(cache, 9) == created);
+    STZ_CHECK(STZCacheGetValueForHandle(cache, handle) == created);
+
+    //  A value kept across the gap without accesses is expired by the first access after it.
+    STZMemoryBackendSetNow(later + 2 * kLifetime);
+    STZ_CHECK(STZCacheGetValueForHandle(cache, handle) == NULL);
+    STZ_CHECK(disposedCount == 3);
+
+    STZCacheRelease(cache);
+}
+
+
+int main(void) {
+    CGEventTimestamp bases[] = {0, 1000 * NSEC_PER_SEC, 86400 * NSEC_PER_SEC};
+    for (int i = 0; i < 3; ++i) {
+        testLifetime(bases[i]);
+        testAccessAfterGap(bases[i]);
+    }
+    return STZTestFinish();
+}
@@ -0,0 +1,90 @@
+/*
+ *  STZCoalescingBenchmarks.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZReplay.h"
+
+
+//  Replays trackpad zooms with momentum at the common trackpad rates, with zoom coalescing off
+//  and at each window, and prints how many zoom events the app being zoomed receives per second
+//  and how long changes are held back for it. Latency with coalescing off is the baseline; what
+//  a window adds is the difference.
+
+
+static void ignoreEmission(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {}
+
+
+static STZReplayStatistics replayZooms(double window, int rate, int sessions) {
+    STZSetZoomCoalescingWindow(window);
+    STZMemoryBackendSetDisplayFrameInterval(NSEC_PER_SEC / 60);
+
+    CGEventTimestamp time = 1000 * NSEC_PER_SEC;
+    STZMemoryBackendSetNow(time);
+    STZReplayRef replay = STZReplayCreate(0, ignoreEmission, NULL);
+
+    //  Each session is a second of fingers moving and a second of momentum, then a short rest.
+    for (int session = 0; session < sessions; ++session) {
+        STZReplaySetTriggerFlagsDown(replay, true, time);
+        for (int i = 0; i < rate * 2; ++i) {
+            time += NSEC_PER_SEC / rate;
+            CGScrollPhase phase = 0;
+            CGMomentumScrollPhase momentumPhase = kCGMomentumScrollPhaseNone;
+            if (i < rate) {
+                phase = i == 0 ? kCGScrollPhaseBegan : i == rate - 1 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+            } else {
+                momentumPhase = i == rate ? kCGMomentumScrollPhaseBegin
+                              : i == rate * 2 - 1 ? kCGMomentumScrollPhaseEnd
+                              : kCGMomentumScrollPhaseContinue;
+            }
+            CGEventRef event = STZTestCreateScrollEvent(time, 1, 1 + i % 5, phase, momentumPhase);
+            STZReplayScrollEvent(replay, event);
+            CFRelease(event);
+        }
+        STZReplaySetTriggerFlagsDown(replay, false, time);
+        time += NSEC_PER_SEC / 4;
+        STZReplayAdvanceTo(replay, time);
+    }
+
+    STZReplayStatistics statistics = STZReplayGetStatistics(replay);
+    STZReplayRelease(replay);
+    return statistics;
+}
+
+
+int main(int argc, char *argv[]) {
+    int sessions = STZTestIsFullRun(argc, argv) ? 200 : 10;
+
+    static int const rates[] = {120, 240};
+    static double const windows[] = {0, 1.0 / 120, 1.0 / 60, 1.0 / 30};
+
+    printf("| trackpad | window ms | zooms/s | mean ms | p99 ms | max ms | wake/min |\n");
+    printf("|----------|-----------|---------|---------|--------|--------|----------|\n");
+
+    for (int r = 0; r < 2; ++r) {
+        STZReplayStatistics off = {0};
+        for (int w = 0; w < 4; ++w) {
+            STZReplayStatistics s = replayZooms(windows[w], rates[r], sessions);
+            printf("| %5d Hz | %9.1f | %7.1f | %7.2f | %6.2f | %6.2f | %8.1f |\n",
+                   rates[r], windows[w] * 1000, s.zoomEventsPerSecond,
+                   s.meanLatency * 1000, s.p99Latency * 1000, s.maxLatency * 1000, s.timerFiringsPerMinute);
+
+            //  Without coalescing, changes are only held back by momentum too weak to zoom.
+            if (w == 0) {
+                off = s;
+                continue;
+            }
+
+            //  No more events, each held back no longer than its window and a frame of the timer.
+            STZ_CHECK(s.zoomEventsPerSecond <= off.zoomEventsPerSecond);
+            STZ_CHECK(s.maxLatency <= windows[w] * 2 + 1.0 / 60);
+        }
+    }
+
+    STZSetZoomCoalescingWindow(0);
+    return STZTestFinish();
+}
@@ -0,0 +1,134 @@
+/*
+ *  STZCoalescingTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZReplay.h"
+#include <math.h>
+
+
+//  Replays the same input with zoom coalescing off and on. Coalescing may only merge changes:
+//  the zoom must begin and end at the same times, and what was held back must not be lost when
+//  the trigger is released or momentum ends before the next change would have carried it.
+
+
+typedef struct {
+    int                 events;
+    double              total;
+    CGEventTimestamp    beganTime;
+    CGEventTimestamp    endedTime;
+    int                 began;
+    int                 ended;
+} Log;
+
+
+static void record(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {
+    Log *log = refcon;
+    if (CGEventGetType(event) != kCGEventGesture) {return;}
+
+    log->events += 1;
+    log->total += CGEventGetDoubleValueField(event, kCGGestureEventZoomValue);
+
+    switch (CGEventGetIntegerValueField(event, kCGGestureEventPhase)) {
+    case kCGGesturePhaseBegan:
+        log->began += 1;
+        log->beganTime = time;
+        break;
+    case kCGGesturePhaseEnded:
+        log->ended += 1;
+        log->endedTime = time;
+        break;
+    }
+}
+
+
+typedef CLOSED_ENUM(uint8_t) {
+    kReleaseDuringGesture,  ///< The trigger is released while fingers still move.
+    kEndByMomentum,         ///< The gesture ends and its momentum runs out.
+    kScrollAfterGesture,    ///< A new scroll gesture begins right after the zoom.
+} Ending;
+
+
+static Log replay(double window, Ending ending) {
+    STZSetZoomCoalescingWindow(window);
+    STZMemoryBackendSetDisplayFrameInterval(NSEC_PER_SEC / 60);
+
+    CGEventTimestamp time = 1000 * NSEC_PER_SEC;
+    STZMemoryBackendSetNow(time);
+
+    Log log = {0};
+    STZReplayRef replay = STZReplayCreate(0, record, &log);
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+
+    //  Deltas vary so that a lost change shows in the total.
+    int count = 60;
+    for (int i = 0; i < count; ++i) {
+        time += NSEC_PER_SEC / 240;
+        CGScrollPhase phase = i == 0 ? kCGScrollPhaseBegan : kCGScrollPhaseChanged;
+        if (i == count - 1 && ending != kReleaseDuringGesture) {
+            phase = kCGScrollPhaseEnded;
+        }
+        CGEventRef event = STZTestCreateScrollEvent(time, 1, 1 + i % 7, phase, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+
+    switch (ending) {
+    case kReleaseDuringGesture:
+        time += NSEC_PER_SEC / 240;
+        STZReplaySetTriggerFlagsDown(replay, false, time);
+        break;
+
+    case kEndByMomentum:
+        for (int i = 0; i < count; ++i) {
+            time += NSEC_PER_SEC / 240;
+            CGMomentumScrollPhase momentumPhase = i == 0 ? kCGMomentumScrollPhaseBegin
+                                                : i == count - 1 ? kCGMomentumScrollPhaseEnd
+                                                : kCGMomentumScrollPhaseContinue;
+            CGEventRef event = STZTestCreateScrollEvent(time, 1, 8 - i / 8, 0, momentumPhase);
+            STZReplayScrollEvent(replay, event);
+            CFRelease(event);
+        }
+        STZReplaySetTriggerFlagsDown(replay, false, time);
+        break;
+
+    case kScrollAfterGesture:
+        STZReplaySetTriggerFlagsDown(replay, false, time);
+        time += NSEC_PER_SEC / 240;
+        CGEventRef event = STZTestCreateScrollEvent(time, 1, 3, kCGScrollPhaseBegan, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+        break;
+    }
+
+    time += NSEC_PER_SEC;
+    STZReplayAdvanceTo(replay, time);
+    STZReplayRelease(replay);
+    return log;
+}
+
+
+int main(void) {
+    static double const windows[] = {1.0 / 120, 1.0 / 60, 1.0 / 30};
+
+    for (Ending ending = kReleaseDuringGesture; ending <= kScrollAfterGesture; ++ending) {
+        Log off = replay(0, ending);
+        STZ_CHECK(off.began == 1 && off.ended == 1);
+
+        for (int w = 0; w < 3; ++w) {
+            Log on = replay(windows[w], ending);
+            STZ_CHECK(on.began == 1 && on.ended == 1);
+            STZ_CHECK(on.beganTime == off.beganTime);
+            STZ_CHECK(on.endedTime == off.endedTime);
+            STZ_CHECK(on.events < off.events);
+            STZ_CHECK(fabs(on.total - off.total) <= 1e-9 * fabs(off.total));
+        }
+    }
+
+    STZSetZoomCoalescingWindow(0);
+    return STZTestFinish();
+}
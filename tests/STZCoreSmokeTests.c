@@ -0,0 +1,69 @@
+/*
+ *  STZCoreSmokeTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZStateManager.h"
+#include "STZSettings.h"
+
+
+//  Drives one state directly through the headless backend, the way the mutating soft scroll
+//  wheel tap does, to check that the core links and transforms a trackpad gesture into a zoom.
+
+
+static int postedCount = 0;
+
+static void countPosted(CGEventTapLocation location, CGEventRef event, void *refcon) {
+    postedCount += 1;
+}
+
+
+int main(void) {
+    STZMemoryBackendSetPostCallback(countPosted, NULL);
+    STZStateRef state = STZStateCreate();
+    STZSettingsSnapshot const *settings = STZGetSettingsSnapshot();
+
+    int gestureCount = 0;
+    int beganCount = 0;
+    CGEventTimestamp time = 1000 * NSEC_PER_SEC;
+
+    for (int i = 0; i < 12; ++i) {
+        time += NSEC_PER_SEC / 120;
+        STZMemoryBackendSetNow(time);
+
+        CGScrollPhase phase = i == 0 ? kCGScrollPhaseBegan : i == 11 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+        CGEventRef event = STZTestCreateScrollEvent(time, 42, 4, phase, kCGMomentumScrollPhaseNone);
+
+        STZScrollRecord record;
+        STZScrollRecordRead(&record, event);
+        STZEventPlacement placement;
+        uint64_t data = 1;
+        CGEventRef auxEvent = STZStateTransformScrollEvent(state, settings, &record, kSTZZoom, false, 0, &data, &placement);
+        STZScrollRecordWriteBack(&record);
+
+        if (auxEvent) {
+            STZ_CHECK(CGEventGetType(auxEvent) == kCGEventGesture);
+            gestureCount += 1;
+            if (CGEventGetIntegerValueField(auxEvent, kCGGestureEventPhase) == kCGGesturePhaseBegan) {
+                beganCount += 1;
+            }
+            CFRelease(auxEvent);
+        }
+        CFRelease(event);
+
+        if (i == 5) {
+            STZ_CHECK(STZStateIsZooming(state));
+        }
+    }
+
+    STZ_CHECK(gestureCount > 0);
+    STZ_CHECK(beganCount == 1);
+    STZ_CHECK(postedCount == 0);
+
+    STZStateRelease(state);
+    return STZTestFinish();
+}
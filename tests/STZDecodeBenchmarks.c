@@ -0,0 +1,203 @@
+/*
+ *  STZDecodeBenchmarks.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZStateManager.h"
+#include <math.h>
+
+
+//  Counts the event field accesses and times what the hard and soft wheel taps ask of each
+//  scroll event: decoded once into a record per callback, against reading the event again for
+//  each question as before records. A field access is a call into the window server’s event on
+//  macOS and an array lookup here, so the counts matter more than the times.
+
+#define kSignumField kCGScrollWheelEventFixedPtDeltaAxis3
+#define kPositiveSignum 5722
+#define kNegativeSignum 5721
+#define kZeroSignum 5720
+
+
+typedef struct {
+    uint64_t            registryID;
+    CGEventTimestamp    timestamp;
+    bool                discrete;
+    bool                mayFallIntoMomentum;
+    bool                noOp;
+    double              delta;
+} Answers;
+
+
+//  MARK: - Direct
+
+
+static double primaryDeltaOf(CGEventRef event) {
+    double delta = CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1);
+    if (delta == 0) {
+        delta = CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1);
+    }
+    return delta;
+}
+
+
+static void stashDirectionDirectly(CGEventRef event) {
+    if (CGEventGetIntegerValueField(event, kSignumField) != 0) {return;}
+    bool inverted = CGEventGetIntegerValueField(event, kCGScrollEventIsDirectionInverted) != 0;
+    double delta = primaryDeltaOf(event) * (inverted ? -1 : 1);
+    CGEventSetIntegerValueField(event, kSignumField, delta > 0 ? kPositiveSignum : delta < 0 ? kNegativeSignum : kZeroSignum);
+}
+
+
+static bool isDiscreteDirectly(CGEventRef event) {
+    return CGEventGetIntegerValueField(event, kCGScrollWheelEventMomentumPhase) == kCGMomentumScrollPhaseNone
+        && CGEventGetIntegerValueField(event, kCGScrollWheelEventScrollPhase) == 0;
+}
+
+
+static bool mayFallIntoMomentumDirectly(CGEventRef event) {
+    if (CGEventGetIntegerValueField(event, kCGScrollWheelEventMomentumPhase) != kCGMomentumScrollPhaseNone) {return true;}
+    return CGEventGetIntegerValueField(event, kCGScrollWheelEventScrollPhase) == kCGScrollPhaseEnded;
+}
+
+
+static bool isNoOpDirectly(CGEventRef event) {
+    if (CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1) != 0) {return false;}
+    if (CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1) != 0) {return false;}
+    if (CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis2) != 0) {return false;}
+    if (CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis2) != 0) {return false;}
+    return true;
+}
+
+
+static double readDeltaDirectly(CGEventRef event) {
+    int64_t stash = CGEventGetIntegerValueField(event, kSignumField);
+    if (stash == kPositiveSignum || stash == kNegativeSignum || stash == kZeroSignum) {
+        CGEventSetIntegerValueField(event, kSignumField, 0);
+    }
+    switch (stash) {
+    case kPositiveSignum:   return fabs(primaryDeltaOf(event));
+    case kNegativeSignum:   return -fabs(primaryDeltaOf(event));
+    case kZeroSignum:       return 0;
+    default:                break;
+    }
+    bool inverted = CGEventGetIntegerValueField(event, kCGScrollEventIsDirectionInverted) != 0;
+    return primaryDeltaOf(event) * (inverted ? -1 : 1);
+}
+
+
+static Answers answerDirectly(CGEventRef event) {
+    stashDirectionDirectly(event);
+
+    Answers answers;
+    answers.registryID = CGEventGetRegistryID(event);
+    answers.timestamp = CGEventGetTimestamp(event);
+    answers.discrete = isDiscreteDirectly(event);
+    answers.mayFallIntoMomentum = mayFallIntoMomentumDirectly(event);
+    answers.noOp = isNoOpDirectly(event);
+    answers.delta = readDeltaDirectly(event);
+    return answers;
+}
+
+
+//  MARK: - Decoded
+
+
+static Answers answerFromRecords(CGEventRef event) {
+    STZScrollRecord record;
+    STZScrollRecordRead(&record, event);
+    STZStashScrollDirectionIntoEvent(&record);
+    STZScrollRecordWriteBack(&record);
+
+    STZScrollRecordRead(&record, event);
+    Answers answers;
+    answers.registryID = record.registryID;
+    answers.timestamp = record.timestamp;
+    answers.discrete = STZIsScrollEventDiscrete(&record);
+    answers.mayFallIntoMomentum = STZScrollEventMayFallIntoMomentum(&record);
+    answers.noOp = STZIsScrollEventNoOp(&record);
+    answers.delta = STZReadScrollDeltaFromEvent(&record, 0, true);
+    STZScrollRecordWriteBack(&record);
+    return answers;
+}
+
+
+//  MARK: - Benchmark
+
+#define kEventCount 64
+
+
+static void createEvents(CGEventRef events[kEventCount]) {
+    for (int i = 0; i < kEventCount; ++i) {
+        CGScrollPhase phase = 0;
+        CGMomentumScrollPhase momentumPhase = kCGMomentumScrollPhaseNone;
+        switch (i % 4) {
+        case 0:     break;
+        case 1:     phase = kCGScrollPhaseChanged; break;
+        case 2:     phase = kCGScrollPhaseEnded; break;
+        default:    momentumPhase = kCGMomentumScrollPhaseContinue; break;
+        }
+        double delta = i % 8 == 5 ? 0 : (i % 3 - 1) * 3.5;
+        events[i] = STZTestCreateScrollEvent(1000 * NSEC_PER_SEC + i, 0x100000a00 + i % 2, delta, phase, momentumPhase);
+        CGEventSetIntegerValueField(events[i], kCGScrollEventIsDirectionInverted, i % 5 == 0);
+    }
+}
+
+
+static bool answersEqual(Answers a, Answers b) {
+    return a.registryID == b.registryID && a.timestamp == b.timestamp && a.discrete == b.discrete
+        && a.mayFallIntoMomentum == b.mayFallIntoMomentum && a.noOp == b.noOp && a.delta == b.delta;
+}
+
+
+int main(int argc, char *argv[]) {
+    int rounds = STZTestIsFullRun(argc, argv) ? 500000 : 20000;
+    CGEventRef events[kEventCount];
+    createEvents(events);
+
+    //  Both ways give the same answers and leave no stash behind.
+    int mismatches = 0;
+    for (int i = 0; i < kEventCount; ++i) {
+        Answers direct = answerDirectly(events[i]);
+        mismatches += CGEventGetIntegerValueField(events[i], kSignumField) != 0;
+        Answers decoded = answerFromRecords(events[i]);
+        mismatches += CGEventGetIntegerValueField(events[i], kSignumField) != 0;
+        mismatches += !answersEqual(direct, decoded);
+    }
+    STZ_CHECK(mismatches == 0);
+
+    volatile double sink = 0;
+    size_t accesses = STZMemoryBackendGetFieldAccessCount();
+    uint64_t start = STZTestGetWallTime();
+    for (int round = 0; round < rounds; ++round) {
+        for (int i = 0; i < kEventCount; ++i) {
+            sink += answerDirectly(events[i]).delta;
+        }
+    }
+    uint64_t directTime = STZTestGetWallTime() - start;
+    size_t directAccesses = STZMemoryBackendGetFieldAccessCount() - accesses;
+
+    accesses = STZMemoryBackendGetFieldAccessCount();
+    start = STZTestGetWallTime();
+    for (int round = 0; round < rounds; ++round) {
+        for (int i = 0; i < kEventCount; ++i) {
+            sink += answerFromRecords(events[i]).delta;
+        }
+    }
+    uint64_t decodedTime = STZTestGetWallTime() - start;
+    size_t decodedAccesses = STZMemoryBackendGetFieldAccessCount() - accesses;
+
+    double eventCount = (double)rounds * kEventCount;
+    printf("| path    | accesses/event | ns/event |\n");
+    printf("|---------|----------------|----------|\n");
+    printf("| direct  | %14.2f | %8.2f |\n", directAccesses / eventCount, directTime / eventCount);
+    printf("| decoded | %14.2f | %8.2f |\n", decodedAccesses / eventCount, decodedTime / eventCount);
+
+    for (int i = 0; i < kEventCount; ++i) {
+        CFRelease(events[i]);
+    }
+    return STZTestFinish();
+}
@@ -0,0 +1,143 @@
+/*
+ *  STZEpochTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZEpoch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+
+//  Readers load a shared object and check it over and over while a writer keeps replacing it as
+//  the settings do their snapshot. Released objects are poisoned and kept until the end rather
+//  than freed, so that their memory isn’t reused and a reader still holding one sees it.
+
+
+#define kAlive 0x53545A4C
+#define kReaders 4
+#define kPublishes 20000
+
+
+typedef struct {
+    _Atomic(uint64_t)   magic;
+    uint64_t            version;
+} Object;
+
+
+static _Atomic(Object *) current = NULL;
+static _Atomic(bool) stopReading = false;
+static _Atomic(int) releasedCount = 0;
+
+static Object *createdObjects[kPublishes + 16];
+static int createdCount = 0;
+
+
+static void releaseObject(void *object) {
+    atomic_store(&((Object *)object)->magic, 0);
+    atomic_fetch_add(&releasedCount, 1);
+}
+
+
+static Object *createObject(uint64_t version) {
+    Object *object = malloc(sizeof(Object));
+    atomic_init(&object->magic, kAlive);
+    object->version = version;
+    createdObjects[createdCount++] = object;
+    return object;
+}
+
+
+static void *readContinually(void *info) {
+    int *poisoned = info;
+
+    while (!atomic_load(&stopReading)) {
+        STZEpochBeginReading();
+        STZEpochPin();
+        Object *first = atomic_load_explicit(&current, memory_order_acquire);
+
+        //  Nested stretches keep the outer pin, and so does what is loaded later.
+        for (int i = 0; i < 16; ++i) {
+            STZEpochBeginReading();
+            STZEpochPin();
+            Object *later = atomic_load_explicit(&current, memory_order_acquire);
+            *poisoned += atomic_load(&later->magic) != kAlive;
+            STZEpochEndReading();
+            *poisoned += atomic_load(&first->magic) != kAlive;
+        }
+
+        STZEpochEndReading();
+    }
+
+    return NULL;
+}
+
+
+static void testConcurrentReaders(void) {
+    atomic_store(&current, createObject(0));
+
+    pthread_t threads[kReaders];
+    int poisoned[kReaders] = {0};
+    for (int t = 0; t < kReaders; ++t) {
+        pthread_create(&threads[t], NULL, readContinually, &poisoned[t]);
+    }
+
+    for (int i = 1; i <= kPublishes; ++i) {
+        Object *old = atomic_exchange_explicit(&current, createObject((uint64_t)i), memory_order_acq_rel);
+        STZEpochRetire(old, releaseObject);
+    }
+
+    atomic_store(&stopReading, true);
+    for (int t = 0; t < kReaders; ++t) {
+        pthread_join(threads[t], NULL);
+        STZ_CHECK(poisoned[t] == 0);
+    }
+
+    //  With every reader out of its stretch, everything retired can go.
+    STZ_CHECK(STZEpochReclaim() == 0);
+    STZ_CHECK(atomic_load(&releasedCount) == kPublishes);
+    releaseObject(atomic_exchange(&current, NULL));
+}
+
+
+static void testPinnedReaderHoldsBack(void) {
+    atomic_store(&releasedCount, 0);
+    atomic_store(&current, createObject(0));
+
+    //  Pinned outside of any stretch: held until the thread leaves the next one.
+    STZEpochPin();
+    Object *held = atomic_load(&current);
+
+    STZEpochRetire(atomic_exchange(&current, createObject(1)), releaseObject);
+    STZEpochRetire(atomic_exchange(&current, createObject(2)), releaseObject);
+    STZ_CHECK(atomic_load(&held->magic) == kAlive);
+    STZ_CHECK(STZEpochReclaim() == 2);
+
+    STZEpochBeginReading();
+    STZEpochPin();
+    STZ_CHECK(STZEpochReclaim() == 2);
+    STZEpochEndReading();
+
+    STZ_CHECK(STZEpochReclaim() == 0);
+    STZ_CHECK(atomic_load(&releasedCount) == 2);
+
+    //  Objects retired while nobody is pinned are released at once.
+    STZEpochRetire(atomic_exchange(&current, createObject(3)), releaseObject);
+    STZ_CHECK(atomic_load(&releasedCount) == 3);
+    releaseObject(atomic_exchange(&current, NULL));
+}
+
+
+int main(void) {
+    testConcurrentReaders();
+    testPinnedReaderHoldsBack();
+
+    for (int i = 0; i < createdCount; ++i) {
+        free(createdObjects[i]);
+    }
+    return STZTestFinish();
+}
@@ -0,0 +1,83 @@
+/*
+ *  STZFrameIntervalTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZReplay.h"
+#include "STZSettings.h"
+
+
+//  Zooms with a wheel click on displays of common refresh rates and checks that the follow-up
+//  zoom events are spaced by the frame interval of the display, or of the target frame rate if
+//  one is set. With the Chromium fix, the first follow-up comes half a frame early.
+
+
+static CGEventTimestamp inputTime;
+static CGEventTimestamp spacings[8];
+static int spacingCount;
+
+
+static void recordPeriodic(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {
+    if (emission != kSTZReplayPeriodic || spacingCount == 8) {return;}
+    if (CGEventGetIntegerValueField(event, kCGGestureEventPhase) != kCGGesturePhaseChanged) {return;}
+    spacings[spacingCount++] = time - inputTime;
+}
+
+
+static void checkSpacing(double refreshRate, double targetFrameRate, STZReplayOptions options) {
+    CGEventTimestamp expected = (CGEventTimestamp)(NSEC_PER_SEC / (targetFrameRate > 0 ? targetFrameRate : refreshRate));
+    STZMemoryBackendSetDisplayFrameInterval((CGEventTimestamp)(NSEC_PER_SEC / refreshRate));
+    STZSetTargetFrameRate(targetFrameRate);
+
+    CGEventTimestamp time = 5 * NSEC_PER_SEC;
+    STZMemoryBackendSetNow(time);
+    STZReplayRef replay = STZReplayCreate(options, recordPeriodic, NULL);
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+
+    int mismatches = 0;
+    for (int i = 0; i < 3; ++i) {
+        time += NSEC_PER_SEC * 4 / 10;
+        inputTime = time;
+        spacingCount = 0;
+
+        CGEventRef event = STZTestCreateScrollEvent(time, 1, 10, 0, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+        STZReplayAdvanceTo(replay, time + NSEC_PER_SEC * 3 / 10);
+
+        if (options & kSTZReplayFixesChromiumZoomStall) {
+            mismatches += !(spacingCount >= 2 && spacings[0] == expected / 2 && spacings[1] == expected);
+        } else {
+            mismatches += !(spacingCount >= 1 && spacings[0] == expected);
+        }
+    }
+
+    printf("%5.1f Hz display, %5.1f Hz target%s: first follow-up after %.3f ms, frames of %.3f ms\n",
+           refreshRate, targetFrameRate, options ? ", Chromium" : "",
+           spacingCount ? (double)spacings[0] / 1e6 : 0.0, (double)expected / 1e6);
+    STZ_CHECK(mismatches == 0);
+
+    STZReplaySetTriggerFlagsDown(replay, false, time);
+    STZReplayRelease(replay);
+}
+
+
+int main(void) {
+    static double const refreshRates[] = {60, 120, 144};
+
+    for (int i = 0; i < 3; ++i) {
+        checkSpacing(refreshRates[i], 0, 0);
+        checkSpacing(refreshRates[i], 0, kSTZReplayFixesChromiumZoomStall);
+    }
+
+    //  A target frame rate overrides the display.
+    checkSpacing(60, 144, 0);
+    checkSpacing(144, 60, kSTZReplayFixesChromiumZoomStall);
+
+    STZSetTargetFrameRate(0);
+    return STZTestFinish();
+}
@@ -0,0 +1,77 @@
+/*
+ *  STZPoolBenchmarks.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZReplay.h"
+
+
+//  Zooms with the trigger held, on a trackpad and with a wheel, and counts the events created
+//  besides the input. Each state reuses the zoom event it emitted last once it is released, so
+//  after warming up no event is created however many zoom events are posted. Before pooling,
+//  every zoom event was created, and so was a copy of each wheel click waiting to end.
+
+
+static uint64_t zoomEvents = 0;
+
+
+static void countZoomEvents(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {
+    if (CGEventGetType(event) != kCGEventScrollWheel) {
+        zoomEvents += 1;
+    }
+}
+
+
+static CGEventTimestamp replayScrolls(STZReplayRef replay, CGEventTimestamp time, int count, bool discrete) {
+    for (int i = 0; i < count; ++i) {
+        time += NSEC_PER_SEC * 8 / 1000;
+        CGScrollPhase phase = 0;
+        if (!discrete) {
+            phase = i % 50 == 0 ? kCGScrollPhaseBegan : i % 50 == 49 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+        }
+        CGEventRef event = STZTestCreateScrollEvent(time, 7, 5, phase, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+    return time;
+}
+
+
+int main(int argc, char *argv[]) {
+    int count = STZTestIsFullRun(argc, argv) ? 1000000 : 10000;
+    CGEventTimestamp time = 1000 * NSEC_PER_SEC;
+    STZMemoryBackendSetNow(time);
+
+    STZReplayRef replay = STZReplayCreate(0, countZoomEvents, NULL);
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+
+    printf("| input      | scrolls | zoom events | created | ns/scroll |\n");
+    printf("|------------|---------|-------------|---------|-----------|\n");
+
+    for (int discrete = 0; discrete < 2; ++discrete) {
+        time = replayScrolls(replay, time, 100, discrete);
+
+        size_t created = STZMemoryBackendGetCreatedEventCount();
+        uint64_t zoomEventsBefore = zoomEvents;
+        uint64_t start = STZTestGetWallTime();
+        time = replayScrolls(replay, time, count, discrete);
+        uint64_t elapsed = STZTestGetWallTime() - start;
+
+        //  The input events are created here as well.
+        size_t extra = STZMemoryBackendGetCreatedEventCount() - created - (size_t)count;
+        uint64_t posted = zoomEvents - zoomEventsBefore;
+        printf("| %-10s | %7d | %11llu | %7zu | %9.1f |\n", discrete ? "wheel" : "trackpad", count,
+               (unsigned long long)posted, extra, (double)elapsed / count);
+
+        STZ_CHECK(posted >= (uint64_t)count / 2);
+        STZ_CHECK(extra == 0);
+    }
+
+    STZReplaySetTriggerFlagsDown(replay, false, time);
+    STZReplayRelease(replay);
+    return STZTestFinish();
+}
@@ -0,0 +1,145 @@
+/*
+ *  STZPrefixTrieTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZPrefixTrie.h"
+#include <string.h>
+
+
+static void addRule(STZPrefixTrieRef trie, char const *rule, uint32_t value) {
+    STZPrefixTrieAddRule(trie, rule, strlen(rule), value);
+}
+
+
+/// Returns the matched value, or `UINT32_MAX` if nothing matches.
+static uint32_t match(STZPrefixTrieRef trie, char const *string) {
+    uint32_t value = UINT32_MAX;
+    bool found = STZPrefixTrieMatch(trie, string, strlen(string), &value);
+    STZ_CHECK(found == (value != UINT32_MAX));
+    return found ? value : UINT32_MAX;
+}
+
+
+static void testExactOverPrefix(void) {
+    STZPrefixTrieRef trie = STZPrefixTrieCreate();
+    addRule(trie, "com.microsoft.edgemac*", 1);
+    addRule(trie, "com.microsoft.edgemac", 2);
+    addRule(trie, "com.microsoft.edgemac.Beta", 3);
+
+    STZ_CHECK(match(trie, "com.microsoft.edgemac") == 2);
+    STZ_CHECK(match(trie, "com.microsoft.edgemac.Beta") == 3);
+    STZ_CHECK(match(trie, "com.microsoft.edgemac.Dev") == 1);
+
+    //  An exact rule covers only itself, not what starts with it.
+    STZ_CHECK(match(trie, "com.microsoft.edgemac.Beta.helper") == 1);
+    STZPrefixTrieRelease(trie);
+}
+
+
+static void testLongestPrefixWins(void) {
+    STZPrefixTrieRef trie = STZPrefixTrieCreate();
+    addRule(trie, "com.google.Chrome.canary*", 3);
+    addRule(trie, "com.*", 1);
+    addRule(trie, "com.google.*", 2);
+
+    STZ_CHECK(match(trie, "com.google.Chrome.canary") == 3);
+    STZ_CHECK(match(trie, "com.google.Chrome.beta") == 2);
+    STZ_CHECK(match(trie, "com.apple.Safari") == 1);
+    STZ_CHECK(match(trie, "org.mozilla.firefox") == UINT32_MAX);
+
+    //  A prefix rule matches the rest of it on its own.
+    STZ_CHECK(match(trie, "com.google.") == 2);
+    STZ_CHECK(match(trie, "com.") == 1);
+    STZPrefixTrieRelease(trie);
+}
+
+
+static void testBareStar(void) {
+    STZPrefixTrieRef trie = STZPrefixTrieCreate();
+    addRule(trie, "*", 7);
+    addRule(trie, "com.apple.*", 8);
+
+    STZ_CHECK(match(trie, "org.mozilla.firefox") == 7);
+    STZ_CHECK(match(trie, "") == 7);
+    STZ_CHECK(match(trie, "com.apple.Safari") == 8);
+    STZ_CHECK(match(trie, "com.apple") == 7);
+
+    //  Only a trailing `*` is special.
+    addRule(trie, "a*b", 9);
+    STZ_CHECK(match(trie, "a*b") == 9);
+    STZ_CHECK(match(trie, "axb") == 7);
+    STZPrefixTrieRelease(trie);
+}
+
+
+static void testReaddingRule(void) {
+    STZPrefixTrieRef trie = STZPrefixTrieCreate();
+    addRule(trie, "com.example.app", 1);
+    addRule(trie, "com.example.*", 2);
+    addRule(trie, "com.example.app", 3);
+    addRule(trie, "com.example.*", 4);
+
+    STZ_CHECK(match(trie, "com.example.app") == 3);
+    STZ_CHECK(match(trie, "com.example.other") == 4);
+
+    //  Rules needn’t be NUL-terminated; only `length` bytes are read.
+    STZPrefixTrieAddRule(trie, "com.example.tool and garbage", 16, 5);
+    STZ_CHECK(match(trie, "com.example.tool") == 5);
+    STZ_CHECK(match(trie, "com.example.tool and garbage") == 4);
+    STZPrefixTrieRelease(trie);
+}
+
+
+static void testStringEndingMidPath(void) {
+    STZPrefixTrieRef trie = STZPrefixTrieCreate();
+    addRule(trie, "com.jetbrains.intellij", 1);
+    addRule(trie, "com.jetbrains.pycharm*", 2);
+
+    //  These end at nodes that exist but carry no rule of their own.
+    STZ_CHECK(match(trie, "com.jetbrains.") == UINT32_MAX);
+    STZ_CHECK(match(trie, "com.jetbrains.intelli") == UINT32_MAX);
+    STZ_CHECK(match(trie, "com.jetbrains.pychar") == UINT32_MAX);
+    STZ_CHECK(match(trie, "") == UINT32_MAX);
+
+    //  And these leave the trie partway.
+    STZ_CHECK(match(trie, "com.jetbrains.intellij.ce") == UINT32_MAX);
+    STZ_CHECK(match(trie, "com.jetbrains.goland") == UINT32_MAX);
+    STZ_CHECK(match(trie, "com.jetbrains.pycharm.ce") == 2);
+    STZPrefixTrieRelease(trie);
+}
+
+
+static void testManyRules(void) {
+    STZPrefixTrieRef trie = STZPrefixTrieCreate();
+    char rule[32];
+
+    //  Enough nodes to grow the array several times while siblings are being linked.
+    for (uint32_t i = 0; i < 1000; ++i) {
+        snprintf(rule, sizeof(rule), "org.example.app%u", (i * 7919) % 1000);
+        addRule(trie, rule, (i * 7919) % 1000);
+    }
+
+    int mismatched = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        snprintf(rule, sizeof(rule), "org.example.app%u", i);
+        mismatched += match(trie, rule) != i;
+    }
+    STZ_CHECK(mismatched == 0);
+    STZPrefixTrieRelease(trie);
+}
+
+
+int main(void) {
+    testExactOverPrefix();
+    testLongestPrefixWins();
+    testBareStar();
+    testReaddingRule();
+    testStringEndingMidPath();
+    testManyRules();
+    return STZTestFinish();
+}
@@ -0,0 +1,146 @@
+/*
+ *  STZProfileBenchmarks.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZProfile.h"
+#include "STZReplay.h"
+
+
+//  Replays the same minute of input under each profile and prints what the profile trades: how
+//  long zoom changes are held back, how often the app wakes up, how many events are posted to
+//  the session to pass every tap again, and how often and how long the wheel taps are mutable. Each round is a trackpad zoom with momentum, a few wheel clicks, and
+//  quick presses of the trigger key, and some scrolling, then idles until the next 10 seconds.
+
+
+static void ignoreEmission(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {}
+
+
+static CGEventTimestamp replayRound(STZReplayRef replay, CGEventTimestamp time) {
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+
+    //  0.5 s on a 240 Hz trackpad, then 0.5 s of momentum.
+    int count = 120;
+    for (int i = 0; i < count * 2; ++i) {
+        time += NSEC_PER_SEC / 240;
+        CGScrollPhase phase = 0;
+        CGMomentumScrollPhase momentumPhase = kCGMomentumScrollPhaseNone;
+        if (i < count) {
+            phase = i == 0 ? kCGScrollPhaseBegan : i == count - 1 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+        } else {
+            momentumPhase = i == count ? kCGMomentumScrollPhaseBegin
+                          : i == count * 2 - 1 ? kCGMomentumScrollPhaseEnd
+                          : kCGMomentumScrollPhaseContinue;
+        }
+        CGEventRef event = STZTestCreateScrollEvent(time, 1, 3, phase, momentumPhase);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+
+    time += NSEC_PER_SEC * 3 / 10;
+    for (int i = 0; i < 10; ++i) {
+        time += NSEC_PER_SEC * 8 / 100;
+        CGEventRef event = STZTestCreateScrollEvent(time, 2, 10, 0, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+
+    time += NSEC_PER_SEC / 2;
+    STZReplaySetTriggerFlagsDown(replay, false, time);
+
+    //  A wheel click with each quick press, as when zooming a step at a time.
+    for (int i = 0; i < 6; ++i) {
+        time += NSEC_PER_SEC / 10;
+        STZReplaySetTriggerFlagsDown(replay, true, time);
+        CGEventRef event = STZTestCreateScrollEvent(time + NSEC_PER_SEC / 50, 2, 10, 0, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+        STZReplaySetTriggerFlagsDown(replay, false, time + NSEC_PER_SEC / 25);
+    }
+
+    //  Then scrolling as usual, after which the taps need not mutate anymore.
+    time += NSEC_PER_SEC / 2;
+    for (int i = 0; i < 5; ++i) {
+        time += NSEC_PER_SEC / 10;
+        CGEventRef event = STZTestCreateScrollEvent(time, 2, -10, 0, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+
+    return time;
+}
+
+
+static STZReplayStatistics replayProfile(STZProfile profile, STZReplayOptions options, int rounds) {
+    STZApplyProfile(profile);
+    STZ_CHECK(STZGetCurrentProfile() == profile);
+    STZMemoryBackendSetDisplayFrameInterval(NSEC_PER_SEC / 120);
+
+    CGEventTimestamp time = 1000 * NSEC_PER_SEC;
+    STZMemoryBackendSetNow(time);
+    if (STZGetProfileSettings(profile).wantsDictatorship) {
+        options |= kSTZReplayWantsDictatorship;
+    }
+    STZReplayRef replay = STZReplayCreate(options, ignoreEmission, NULL);
+
+    for (int round = 0; round < rounds; ++round) {
+        CGEventTimestamp start = time;
+        replayRound(replay, time);
+        time = start + 10 * NSEC_PER_SEC;
+        STZReplayAdvanceTo(replay, time);
+    }
+
+    STZReplayStatistics statistics = STZReplayGetStatistics(replay);
+    STZReplayRelease(replay);
+    return statistics;
+}
+
+
+int main(int argc, char *argv[]) {
+    int rounds = STZTestIsFullRun(argc, argv) ? 60 : 6;
+
+    static char const *const names[] = {
+        [kSTZProfileBalanced] = "balanced",
+        [kSTZProfileLowLatency] = "low-latency",
+        [kSTZProfileLowPower] = "low-power",
+    };
+
+    printf("| profile     | app      | p50 ms | p99 ms | wake/min | zooms | reposts | switches | mutable s |\n");
+    printf("|-------------|----------|--------|--------|----------|-------|---------|----------|-----------|\n");
+
+    for (int chromium = 0; chromium < 2; ++chromium) {
+        STZReplayOptions options = chromium ? kSTZReplayFixesChromiumZoomStall : 0;
+        STZReplayStatistics results[kSTZProfileLowPower + 1];
+
+        for (STZProfile profile = kSTZProfileBalanced; profile <= kSTZProfileLowPower; ++profile) {
+            STZReplayStatistics s = replayProfile(profile, options, rounds);
+            results[profile] = s;
+            printf("| %-11s | %-8s | %6.2f | %6.2f | %8.1f | %5llu | %7llu | %8llu | %9.2f |\n",
+                   names[profile], chromium ? "chromium" : "native",
+                   s.p50Latency * 1000, s.p99Latency * 1000, s.timerFiringsPerMinute,
+                   (unsigned long long)s.zoomEvents, (unsigned long long)s.sessionPosts,
+                   (unsigned long long)s.tapSwitches, s.mutableTime);
+        }
+
+        STZReplayStatistics balanced = results[kSTZProfileBalanced];
+        STZReplayStatistics lowLatency = results[kSTZProfileLowLatency];
+        STZReplayStatistics lowPower = results[kSTZProfileLowPower];
+
+        //  What each profile is named after must hold against the balanced one.
+        //  Low latency comes from not waiting for other taps, which the replay has no clock for;
+        //  what it shows is that only periodic events make the round trip through the session.
+        STZ_CHECK(lowLatency.sessionPosts < balanced.sessionPosts);
+        STZ_CHECK(lowLatency.mutableTime < balanced.mutableTime);
+        //  The timer of the coalescing window fires early while the input keeps coming; each zoom
+        //  event posted wakes the app being zoomed, which costs far more.
+        STZ_CHECK(lowPower.timerFirings + lowPower.zoomEvents < balanced.timerFirings + balanced.zoomEvents);
+        STZ_CHECK(lowPower.zoomEvents < balanced.zoomEvents);
+        STZ_CHECK(lowPower.tapSwitches <= balanced.tapSwitches);
+    }
+
+    return STZTestFinish();
+}
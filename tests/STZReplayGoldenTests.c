@@ -0,0 +1,383 @@
+/*
+ *  STZReplayGoldenTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZReplay.h"
+#include <string.h>
+
+
+//  Replays the traces in the fixture directory and compares what the state machine emits with
+//  the expected logs beside them, one line per emission. A change in behavior shows up as a diff
+//  of the logs; when it is intended, run with `--update` to rewrite them and review the diff.
+//
+//      STZReplayGoldenTests <fixture directory> [--update | --generate]
+//
+//  The traces are synthetic so that they can be regenerated with `--generate` after the trace
+//  format changes; the expected logs are not touched by it. Traces recorded from the app can be
+//  added to the list as they are, with `generate` left NULL.
+
+
+typedef struct {
+    char const         *name;
+    STZReplayOptions    options;
+    void              (*generate)(CGEventTimestamp base);
+} Fixture;
+
+
+#define kMaxLogLength (1 << 20)
+
+typedef struct {
+    CGEventTimestamp    base;
+    char               *text;
+    size_t              length;
+} Log;
+
+
+static CGEventTimestamp const kFixtureBase = 1000 * NSEC_PER_SEC;
+static CGEventTimestamp const kFrame = NSEC_PER_SEC / 120;
+static CGEventFlags const kTriggerFlags = kCGEventFlagMaskCommand;
+
+static uint64_t const kTrackpad = 0x100000a01;
+static uint64_t const kWheelMouse = 0x100000b02;
+static uint64_t const kMagicMouse = 0x100000c03;
+
+
+//  MARK: - Synthetic traces
+
+
+static void recordScroll(CGEventTimestamp time, uint64_t registryID, double delta,
+                         CGScrollPhase phase, CGMomentumScrollPhase momentumPhase, CGEventFlags flags) {
+    CGEventRef event = STZTestCreateScrollEvent(time, registryID, delta, phase, momentumPhase);
+    CGEventSetFlags(event, flags);
+    CGEventSetLocation(event, (CGPoint){640, 400});
+    CGEventSetIntegerValueField(event, kCGEventTargetUnixProcessID, 501);
+
+    STZScrollRecord record;
+    STZScrollRecordRead(&record, event);
+    STZTraceRecordScroll(&record);
+    CFRelease(event);
+}
+
+
+/// Records a phased gesture of `count` events, followed by `momentumCount` momentum events
+/// decaying from the last delta. Returns the time of the last event.
+static CGEventTimestamp recordGesture(CGEventTimestamp time, uint64_t registryID, double delta, int count,
+                                      int momentumCount, CGEventFlags flags) {
+    for (int i = 0; i < count; ++i) {
+        time += kFrame;
+        CGScrollPhase phase = i == 0 ? kCGScrollPhaseBegan : kCGScrollPhaseChanged;
+        recordScroll(time, registryID, delta, phase, kCGMomentumScrollPhaseNone, flags);
+    }
+    time += kFrame;
+    recordScroll(time, registryID, 0, kCGScrollPhaseEnded, kCGMomentumScrollPhaseNone, flags);
+
+    for (int i = 0; i < momentumCount; ++i) {
+        time += kFrame;
+        CGMomentumScrollPhase phase = i == 0 ? kCGMomentumScrollPhaseBegin
+                                    : i == momentumCount - 1 ? kCGMomentumScrollPhaseEnd
+                                    : kCGMomentumScrollPhaseContinue;
+        double momentumDelta = i == momentumCount - 1 ? 0 : delta * (momentumCount - i) / momentumCount;
+        recordScroll(time, registryID, momentumDelta, 0, phase, flags);
+    }
+    return time;
+}
+
+
+static void generateTrackpadZoom(CGEventTimestamp time) {
+    STZTraceRecordTrigger(time, kTriggerFlags, true);
+    time = recordGesture(time, kTrackpad, 6, 24, 0, kTriggerFlags);
+    time += NSEC_PER_SEC / 2;
+    STZTraceRecordTrigger(time, 0, false);
+}
+
+
+static void generateTrackpadMomentum(CGEventTimestamp time) {
+    STZTraceRecordTrigger(time, kTriggerFlags, true);
+    time = recordGesture(time, kTrackpad, -8, 12, 30, kTriggerFlags);
+    time += NSEC_PER_SEC / 2;
+    STZTraceRecordTrigger(time, 0, false);
+}
+
+
+/// The trigger is released when the fingers lift, before the momentum phase.
+static void generateMomentumAfterRelease(CGEventTimestamp time) {
+    STZTraceRecordTrigger(time, kTriggerFlags, true);
+    time = recordGesture(time, kTrackpad, 8, 12, 0, kTriggerFlags);
+    STZTraceRecordTrigger(time + kFrame / 2, 0, false);
+    for (int i = 0; i < 20; ++i) {
+        time += kFrame;
+        CGMomentumScrollPhase phase = i == 0 ? kCGMomentumScrollPhaseBegin
+                                    : i == 19 ? kCGMomentumScrollPhaseEnd
+                                    : kCGMomentumScrollPhaseContinue;
+        recordScroll(time, kTrackpad, i == 19 ? 0 : 8 - i * 0.4, 0, phase, 0);
+    }
+}
+
+
+static void generateReleaseDuringGesture(CGEventTimestamp time) {
+    STZTraceRecordTrigger(time, kTriggerFlags, true);
+    for (int i = 0; i < 10; ++i) {
+        time += kFrame;
+        recordScroll(time, kTrackpad, 5, i == 0 ? kCGScrollPhaseBegan : kCGScrollPhaseChanged, kCGMomentumScrollPhaseNone, kTriggerFlags);
+    }
+    time += kFrame;
+    STZTraceRecordTrigger(time, 0, false);
+    for (int i = 0; i < 10; ++i) {
+        time += kFrame;
+        recordScroll(time, kTrackpad, 5, kCGScrollPhaseChanged, kCGMomentumScrollPhaseNone, 0);
+    }
+    time += kFrame;
+    recordScroll(time, kTrackpad, 0, kCGScrollPhaseEnded, kCGMomentumScrollPhaseNone, 0);
+}
+
+
+static void generateWheelZoom(CGEventTimestamp time) {
+    STZTraceRecordTrigger(time, kTriggerFlags, true);
+    for (int burst = 0; burst < 3; ++burst) {
+        for (int i = 0; i < 6; ++i) {
+            time += NSEC_PER_SEC / 30;
+            recordScroll(time, kWheelMouse, burst == 1 ? -10 : 10, 0, kCGMomentumScrollPhaseNone, kTriggerFlags);
+        }
+        time += NSEC_PER_SEC / 2;
+    }
+    STZTraceRecordTrigger(time, 0, false);
+    time += NSEC_PER_SEC;
+    recordScroll(time, kWheelMouse, 10, 0, kCGMomentumScrollPhaseNone, 0);
+}
+
+
+static void generateMagicZoom(CGEventTimestamp time) {
+    STZTraceRecordMagicZoom(time, kMagicMouse, true);
+    time = recordGesture(time, kMagicMouse, 4, 16, 12, 0);
+    time += NSEC_PER_SEC / 4;
+    STZTraceRecordMagicZoom(time, kMagicMouse, false);
+    time = recordGesture(time, kMagicMouse, 4, 4, 0, 0);
+}
+
+
+static void generateTwoDevices(CGEventTimestamp time) {
+    STZTraceRecordTrigger(time, kTriggerFlags, true);
+    for (int i = 0; i < 16; ++i) {
+        time += kFrame;
+        recordScroll(time, kTrackpad, 3, i == 0 ? kCGScrollPhaseBegan : kCGScrollPhaseChanged, kCGMomentumScrollPhaseNone, kTriggerFlags);
+        if (i % 4 == 1) {
+            recordScroll(time + kFrame / 2, kWheelMouse, -10, 0, kCGMomentumScrollPhaseNone, kTriggerFlags);
+        }
+    }
+    time += kFrame;
+    recordScroll(time, kTrackpad, 0, kCGScrollPhaseEnded, kCGMomentumScrollPhaseNone, kTriggerFlags);
+    time += NSEC_PER_SEC / 2;
+    STZTraceRecordTrigger(time, 0, false);
+}
+
+
+static Fixture const fixtures[] = {
+    {"trackpad-zoom", 0, generateTrackpadZoom},
+    {"trackpad-momentum", 0, generateTrackpadMomentum},
+    {"momentum-after-release", 0, generateMomentumAfterRelease},
+    {"momentum-after-release-continued", kSTZReplayContinuesTriggeredZoom, generateMomentumAfterRelease},
+    {"release-during-gesture", 0, generateReleaseDuringGesture},
+    {"wheel-zoom", 0, generateWheelZoom},
+    {"wheel-zoom-chromium", kSTZReplayFixesChromiumZoomStall, generateWheelZoom},
+    {"wheel-zoom-dictatorship", kSTZReplayWantsDictatorship, generateWheelZoom},
+    {"momentum-after-release-dictatorship", kSTZReplayContinuesTriggeredZoom | kSTZReplayWantsDictatorship,
+     generateMomentumAfterRelease},
+    {"magic-zoom", 0, generateMagicZoom},
+    {"two-devices", 0, generateTwoDevices},
+};
+
+#define kFixtureCount (sizeof(fixtures) / sizeof(fixtures[0]))
+
+
+//  MARK: - Emission logs
+
+
+static char const *emissionName(STZReplayEmission emission) {
+    switch (emission) {
+    case kSTZReplayUpdated:     return "updated";
+    case kSTZReplayPrepended:   return "prepended";
+    case kSTZReplayAppended:    return "appended";
+    case kSTZReplayReplacing:   return "replacing";
+    case kSTZReplayDiscarding:  return "discarding";
+    case kSTZReplayPeriodic:    return "periodic";
+    case kSTZReplayReverting:   return "reverting";
+    case kSTZReplayCommandKey:  return "command-key";
+    }
+    return "unknown";
+}
+
+
+static void appendLine(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {
+    Log *log = refcon;
+    char line[256];
+    int length = snprintf(line, sizeof(line), "%10.3f ms  %-10s  ",
+                          (double)(time - log->base) * 1000 / NSEC_PER_SEC, emissionName(emission));
+
+    CGEventType type = CGEventGetType(event);
+    if (type == kCGEventGesture) {
+        length += snprintf(line + length, sizeof(line) - length, "zoom    phase %lld  value %.6g\n",
+                           CGEventGetIntegerValueField(event, kCGGestureEventPhase),
+                           CGEventGetDoubleValueField(event, kCGGestureEventZoomValue));
+    } else if (type == kCGEventScrollWheel) {
+        length += snprintf(line + length, sizeof(line) - length, "scroll  phase %lld/%lld  delta %lld/%.6g\n",
+                           CGEventGetIntegerValueField(event, kCGScrollWheelEventScrollPhase),
+                           CGEventGetIntegerValueField(event, kCGScrollWheelEventMomentumPhase),
+                           CGEventGetIntegerValueField(event, kCGScrollWheelEventPointDeltaAxis1),
+                           CGEventGetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1));
+    } else {
+        length += snprintf(line + length, sizeof(line) - length, "type %d\n", (int)type);
+    }
+
+    if (length > 0 && log->length + (size_t)length < kMaxLogLength) {
+        memcpy(log->text + log->length, line, (size_t)length);
+        log->length += (size_t)length;
+        log->text[log->length] = '\0';
+    }
+}
+
+
+static void fixturePath(char *path, size_t size, char const *directory, char const *name, char const *extension) {
+    snprintf(path, size, "%s/%s.%s", directory, name, extension);
+}
+
+
+static bool replayFixture(char const *directory, Fixture const *fixture, Log *log) {
+    char path[1024];
+    fixturePath(path, sizeof(path), directory, fixture->name, "stztrace");
+
+    //  Times are logged from the first input record so that the logs read the same for any base.
+    STZTraceReaderRef reader = STZTraceReaderOpen(path);
+    if (reader == NULL) {
+        fprintf(stderr, "%s: cannot read trace\n", path);
+        return false;
+    }
+    STZTraceItem item = {.timestamp = 0};
+    while (STZTraceReaderNext(reader, &item) && item.kind == kSTZTraceProcess) {}
+    STZTraceReaderClose(reader);
+
+    log->base = item.timestamp;
+    log->length = 0;
+    log->text[0] = '\0';
+
+    STZMemoryBackendSetNow(0);
+    STZReplayRef replay = STZReplayCreate(fixture->options, appendLine, log);
+    reader = STZTraceReaderOpen(path);
+    STZReplayTrace(replay, reader);
+    STZTraceReaderClose(reader);
+    STZReplayRelease(replay);
+    return true;
+}
+
+
+static char *readFile(char const *path, size_t *outLength) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {return NULL;}
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc((size_t)length + 1);
+    *outLength = fread(text, 1, (size_t)length, file);
+    text[*outLength] = '\0';
+    fclose(file);
+    return text;
+}
+
+
+static bool writeFile(char const *path, char const *text, size_t length) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "%s: cannot write\n", path);
+        return false;
+    }
+    fwrite(text, 1, length, file);
+    fclose(file);
+    return true;
+}
+
+
+/// Prints the first line that differs, with its line number, so that a failure in the test log
+/// tells where to look. The whole actual log is written beside the build for a real diff.
+static void reportDifference(char const *name, char const *expected, char const *actual) {
+    int line = 1;
+    while (true) {
+        char const *expectedEnd = strchr(expected, '\n');
+        char const *actualEnd = strchr(actual, '\n');
+        size_t expectedLength = expectedEnd ? (size_t)(expectedEnd - expected) : strlen(expected);
+        size_t actualLength = actualEnd ? (size_t)(actualEnd - actual) : strlen(actual);
+
+        if (expectedLength != actualLength || memcmp(expected, actual, expectedLength) != 0) {
+            fprintf(stderr, "%s.expected:%d differs\n  expected: %.*s\n  actual:   %.*s\n", name, line,
+                    (int)expectedLength, expectedLength ? expected : "<end of log>",
+                    (int)actualLength, actualLength ? actual : "<end of log>");
+            return;
+        }
+
+        if (!expectedEnd || !actualEnd) {return;}
+        expected = expectedEnd + 1;
+        actual = actualEnd + 1;
+        line += 1;
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <fixture directory> [--update | --generate]\n", argv[0]);
+        return 2;
+    }
+
+    char const *directory = argv[1];
+    bool update = argc > 2 && strcmp(argv[2], "--update") == 0;
+    bool generate = argc > 2 && strcmp(argv[2], "--generate") == 0;
+    char path[1024];
+
+    if (generate) {
+        for (size_t i = 0; i < kFixtureCount; ++i) {
+            if (fixtures[i].generate == NULL) {continue;}
+            fixturePath(path, sizeof(path), directory, fixtures[i].name, "stztrace");
+            if (!STZ_CHECK(STZTraceStartRecording(path))) {continue;}
+            STZTraceRecordProcess(501, "com.example.Fixture");
+            fixtures[i].generate(kFixtureBase);
+            STZTraceStopRecording();
+        }
+        return STZTestFinish();
+    }
+
+    Log log = {.text = malloc(kMaxLogLength)};
+
+    for (size_t i = 0; i < kFixtureCount; ++i) {
+        Fixture const *fixture = &fixtures[i];
+        if (!STZ_CHECK(replayFixture(directory, fixture, &log))) {continue;}
+
+        fixturePath(path, sizeof(path), directory, fixture->name, "expected");
+        if (update) {
+            STZ_CHECK(writeFile(path, log.text, log.length));
+            continue;
+        }
+
+        size_t expectedLength;
+        char *expected = readFile(path, &expectedLength);
+        if (!STZ_CHECK(expected != NULL)) {
+            fprintf(stderr, "%s: missing; run with --update to create it\n", path);
+            continue;
+        }
+
+        bool same = expectedLength == log.length && memcmp(expected, log.text, log.length) == 0;
+        if (!STZ_CHECK(same)) {
+            reportDifference(fixture->name, expected, log.text);
+            snprintf(path, sizeof(path), "%s.actual", fixture->name);
+            writeFile(path, log.text, log.length);
+        }
+        free(expected);
+    }
+
+    free(log.text);
+    return STZTestFinish();
+}
@@ -0,0 +1,171 @@
+/*
+ *  STZReplayTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZReplay.h"
+
+
+//  The replay must not depend on where its clock starts. The app sees uptime timestamps, often
+//  days after the clock the caches were created with was read.
+
+
+typedef struct {
+    CGEventTimestamp    base;
+    int                 count;
+    int                 began;
+    int                 ended;
+    CGEventTimestamp    times[256];
+    uint8_t             emissions[256];
+    uint8_t             phases[256];
+} Log;
+
+
+static void record(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {
+    Log *log = refcon;
+    if (emission == kSTZReplayUpdated || CGEventGetType(event) != kCGEventGesture) {return;}
+
+    CGGesturePhase phase = (CGGesturePhase)CGEventGetIntegerValueField(event, kCGGestureEventPhase);
+    log->began += phase == kCGGesturePhaseBegan;
+    log->ended += phase == kCGGesturePhaseEnded;
+
+    if (log->count < 256) {
+        log->times[log->count] = time - log->base;
+        log->emissions[log->count] = emission;
+        log->phases[log->count] = (uint8_t)phase;
+        log->count += 1;
+    }
+}
+
+
+/// Two trackpad zooms one second apart, then a wheel zoom after the trigger is released and
+/// pressed again. The replay is created before the clock is moved to `base`.
+static void replayAt(CGEventTimestamp base, Log *log) {
+    *log = (Log){.base = base};
+    STZMemoryBackendSetNow(0);
+    STZReplayRef replay = STZReplayCreate(0, record, log);
+
+    CGEventTimestamp time = base;
+    for (int session = 0; session < 2; ++session) {
+        STZReplaySetTriggerFlagsDown(replay, true, time);
+        for (int i = 0; i < 20; ++i) {
+            time += NSEC_PER_SEC / 120;
+            CGScrollPhase phase = i == 0 ? kCGScrollPhaseBegan : i == 19 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+            CGEventRef event = STZTestCreateScrollEvent(time, 42, 5, phase, kCGMomentumScrollPhaseNone);
+            STZReplayScrollEvent(replay, event);
+            CFRelease(event);
+        }
+        time += NSEC_PER_SEC;
+        STZReplayAdvanceTo(replay, time);
+        STZReplaySetTriggerFlagsDown(replay, false, time);
+    }
+
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+    for (int i = 0; i < 3; ++i) {
+        time += NSEC_PER_SEC / 10;
+        CGEventRef event = STZTestCreateScrollEvent(time, 43, 10, 0, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+    time += NSEC_PER_SEC;
+    STZReplayAdvanceTo(replay, time);
+    STZReplaySetTriggerFlagsDown(replay, false, time);
+
+    STZReplayRelease(replay);
+}
+
+
+//  MARK: - Held Zoom Events
+
+
+//  Zoom events are reused round a ring, so a caller may hold one across the next three without
+//  it changing under them.
+
+#define kHeldEventCount 3
+
+typedef struct {
+    CGEventRef          events[kHeldEventCount];
+    double              values[kHeldEventCount];
+    CGEventTimestamp    times[kHeldEventCount];
+    int                 next;
+    int                 zooms;
+    int                 changed;
+} HeldEvents;
+
+
+static void holdZoomEvents(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {
+    HeldEvents *held = refcon;
+    if (CGEventGetType(event) != kCGEventGesture) {return;}
+
+    for (int i = 0; i < kHeldEventCount; ++i) {
+        if (!held->events[i]) {continue;}
+        held->changed += CGEventGetDoubleValueField(held->events[i], kCGGestureEventZoomValue) != held->values[i]
+                      || CGEventGetTimestamp(held->events[i]) != held->times[i];
+    }
+
+    int i = held->next;
+    if (held->events[i]) {CFRelease(held->events[i]);}
+    held->events[i] = (CGEventRef)CFRetain(event);
+    held->values[i] = CGEventGetDoubleValueField(event, kCGGestureEventZoomValue);
+    held->times[i] = CGEventGetTimestamp(event);
+    held->next = (i + 1) % kHeldEventCount;
+    held->zooms += 1;
+}
+
+
+static void testHeldZoomEvents(void) {
+    HeldEvents held = {0};
+    CGEventTimestamp time = 1000 * NSEC_PER_SEC;
+    STZMemoryBackendSetNow(time);
+    STZReplayRef replay = STZReplayCreate(0, holdZoomEvents, &held);
+
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+    for (int i = 0; i < 40; ++i) {
+        time += NSEC_PER_SEC / 120;
+        CGScrollPhase phase = i == 0 ? kCGScrollPhaseBegan : i == 39 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+        CGEventRef event = STZTestCreateScrollEvent(time, 42, 1 + i % 3, phase, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+    time += NSEC_PER_SEC;
+    STZReplayAdvanceTo(replay, time);
+    STZReplaySetTriggerFlagsDown(replay, false, time);
+    STZReplayRelease(replay);
+
+    STZ_CHECK(held.zooms > kHeldEventCount);
+    STZ_CHECK(held.changed == 0);
+
+    for (int i = 0; i < kHeldEventCount; ++i) {
+        if (held.events[i]) {CFRelease(held.events[i]);}
+    }
+}
+
+
+int main(void) {
+    static Log reference, log;
+    replayAt(0, &reference);
+    STZ_CHECK(reference.began == 3);
+    STZ_CHECK(reference.ended == 3);
+
+    CGEventTimestamp bases[] = {1000 * NSEC_PER_SEC, 86400 * NSEC_PER_SEC, 30 * 86400 * NSEC_PER_SEC};
+    for (int b = 0; b < 3; ++b) {
+        replayAt(bases[b], &log);
+        STZ_CHECK(log.began == reference.began);
+        STZ_CHECK(log.ended == reference.ended);
+        STZ_CHECK(log.count == reference.count);
+        bool same = log.count == reference.count;
+        for (int i = 0; same && i < log.count; ++i) {
+            same = log.times[i] == reference.times[i]
+                && log.emissions[i] == reference.emissions[i]
+                && log.phases[i] == reference.phases[i];
+        }
+        STZ_CHECK(same);
+    }
+
+    testHeldZoomEvents();
+    return STZTestFinish();
+}
@@ -0,0 +1,152 @@
+/*
+ *  STZSchedulerTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZScheduler.h"
+#include "STZReplay.h"
+
+
+#define kEntryCount 200
+
+
+//  Moves random entries and checks the earliest deadline against a linear scan.
+static void testHeap(int iterations) {
+    STZSchedulerEntry entries[kEntryCount] = {{0}};
+    CGEventTimestamp deadlines[kEntryCount] = {0};
+    STZSchedulerRef scheduler = STZSchedulerCreate();
+
+    srand(1);
+    int mismatches = 0;
+    for (int i = 0; i < iterations; ++i) {
+        int index = rand() % kEntryCount;
+        CGEventTimestamp deadline = rand() % 4 == 0 ? 0 : 1 + rand() % 1000;
+        STZSchedulerSetDeadline(scheduler, &entries[index], deadline);
+        deadlines[index] = deadline;
+
+        if (i % 97 != 0) {continue;}
+        CGEventTimestamp earliest = 0;
+        for (int k = 0; k < kEntryCount; ++k) {
+            if (deadlines[k] && (!earliest || deadlines[k] < earliest)) {
+                earliest = deadlines[k];
+            }
+            mismatches += entries[k].deadline != deadlines[k];
+        }
+        mismatches += STZSchedulerGetEarliestDeadline(scheduler) != earliest;
+    }
+    STZ_CHECK(mismatches == 0);
+
+    //  The timer is armed once for the earliest deadline, and not again until that gets earlier.
+    CGEventTimestamp deadline;
+    STZ_CHECK(STZSchedulerUpdateTimer(scheduler, &deadline) && deadline == STZSchedulerGetEarliestDeadline(scheduler));
+    STZ_CHECK(!STZSchedulerUpdateTimer(scheduler, &deadline));
+    STZ_CHECK(STZSchedulerTimerDidFire(scheduler, deadline + 5) == 5);
+
+    STZSchedulerStatistics statistics = STZSchedulerGetStatistics(scheduler);
+    STZ_CHECK(statistics.timerArms == 1 && statistics.timerMoves == 0);
+    STZ_CHECK(statistics.firings == 1 && statistics.maxJitter == 5);
+    STZSchedulerRelease(scheduler);
+}
+
+
+//  Only an earlier deadline moves an armed timer. A later one lets it fire early, after which it
+//  is armed again for the real deadline.
+static void testLazyTimer(void) {
+    STZSchedulerRef scheduler = STZSchedulerCreate();
+    STZSchedulerEntry first = {0};
+    STZSchedulerEntry second = {0};
+    CGEventTimestamp deadline;
+
+    STZSchedulerSetDeadline(scheduler, &first, 100);
+    STZ_CHECK(STZSchedulerUpdateTimer(scheduler, &deadline) && deadline == 100);
+    STZSchedulerSetDeadline(scheduler, &first, 200);
+    STZ_CHECK(!STZSchedulerUpdateTimer(scheduler, &deadline));
+    STZSchedulerSetDeadline(scheduler, &second, 50);
+    STZ_CHECK(STZSchedulerUpdateTimer(scheduler, &deadline) && deadline == 50);
+    STZSchedulerSetDeadline(scheduler, &second, 0);
+    STZ_CHECK(!STZSchedulerUpdateTimer(scheduler, &deadline));
+
+    STZ_CHECK(STZSchedulerTimerDidFire(scheduler, 52) == 0);
+    STZ_CHECK(STZSchedulerUpdateTimer(scheduler, &deadline) && deadline == 200);
+    STZ_CHECK(STZSchedulerTimerDidFire(scheduler, 203) == 3);
+    STZSchedulerSetDeadline(scheduler, &first, 0);
+    STZ_CHECK(!STZSchedulerUpdateTimer(scheduler, &deadline));
+
+    STZSchedulerStatistics statistics = STZSchedulerGetStatistics(scheduler);
+    STZ_CHECK(statistics.timerArms == 2 && statistics.timerMoves == 1);
+    STZ_CHECK(statistics.firings == 2 && statistics.earlyFirings == 1 && statistics.maxJitter == 3);
+    STZSchedulerRelease(scheduler);
+}
+
+//  MARK: - Timer Churn
+
+
+static void ignoreEmission(CGEventTimestamp time, STZReplayEmission emission, CGEventRef event, void *refcon) {}
+
+
+//  Before the scheduler, the periodic timer was created again at the end of every scroll event.
+//  Every click of a wheel pushes the deadline of its state back; the armed timer is left alone
+//  then, so a steady wheel zoom never moves it, only fires it early now and then to arm it again.
+static void testTimerChurn(int count) {
+    STZMemoryBackendSetDisplayFrameInterval(NSEC_PER_SEC / 60);
+    CGEventTimestamp time = 5 * NSEC_PER_SEC;
+    STZMemoryBackendSetNow(time);
+
+    static int const wheelIntervals[] = {8, 25, 50};
+    for (int k = 0; k < 3; ++k) {
+        STZReplayRef replay = STZReplayCreate(kSTZReplayFixesChromiumZoomStall, ignoreEmission, NULL);
+        STZReplaySetTriggerFlagsDown(replay, true, time);
+
+        for (int i = 0; i < count; ++i) {
+            time += wheelIntervals[k] * (NSEC_PER_SEC / 1000);
+            CGEventRef event = STZTestCreateScrollEvent(time, 2, 10, 0, kCGMomentumScrollPhaseNone);
+            STZReplayScrollEvent(replay, event);
+            CFRelease(event);
+        }
+
+        STZReplayStatistics statistics = STZReplayGetStatistics(replay);
+        printf("wheel every %2d ms: %d events, %llu timer moves, %llu arms, %llu firings\n", wheelIntervals[k], count,
+               (unsigned long long)statistics.timerMoves, (unsigned long long)statistics.timerArms,
+               (unsigned long long)statistics.timerFirings);
+        STZ_CHECK(statistics.timerMoves <= 2);
+        STZ_CHECK(statistics.timerArms <= statistics.timerFirings + 1);
+
+        STZReplaySetTriggerFlagsDown(replay, false, time);
+        time += NSEC_PER_SEC;
+        STZReplayAdvanceTo(replay, time);
+        STZReplayRelease(replay);
+    }
+
+    STZReplayRef replay = STZReplayCreate(0, ignoreEmission, NULL);
+    STZReplaySetTriggerFlagsDown(replay, true, time);
+
+    for (int i = 0; i < count; ++i) {
+        time += NSEC_PER_SEC / 240;
+        CGScrollPhase phase = i == 0 ? kCGScrollPhaseBegan : i == count - 1 ? kCGScrollPhaseEnded : kCGScrollPhaseChanged;
+        CGEventRef event = STZTestCreateScrollEvent(time, 1, 3, phase, kCGMomentumScrollPhaseNone);
+        STZReplayScrollEvent(replay, event);
+        CFRelease(event);
+    }
+
+    STZReplayStatistics statistics = STZReplayGetStatistics(replay);
+    printf("trackpad at 240 Hz: %d events, %llu timer moves, %llu arms, %llu firings\n", count,
+           (unsigned long long)statistics.timerMoves, (unsigned long long)statistics.timerArms,
+           (unsigned long long)statistics.timerFirings);
+    STZ_CHECK(statistics.timerMoves + statistics.timerArms <= (uint64_t)count / 2);
+
+    STZReplaySetTriggerFlagsDown(replay, false, time);
+    STZReplayRelease(replay);
+}
+
+
+int main(int argc, char *argv[]) {
+    bool full = STZTestIsFullRun(argc, argv);
+    testHeap(full ? 2000000 : 200000);
+    testLazyTimer();
+    testTimerChurn(full ? 10000 : 1000);
+    return STZTestFinish();
+}
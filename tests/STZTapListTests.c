@@ -0,0 +1,145 @@
+/*
+ *  STZTapListTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZTapList.h"
+#include <string.h>
+
+
+//  Drives the tap list with a synthetic system list, where new taps are prepended, and counts how
+//  often each process is classified.
+
+#define kSelfPID 500
+#define kMaxPID 1000
+
+static STZTapInfo systemTaps[64];
+static uint32_t systemTapCount = 0;
+static int sourceCalls = 0;
+static int classifications[kMaxPID];
+static STZTapProcessKind processKinds[kMaxPID];
+
+
+static uint32_t copySystemTaps(STZTapInfo *infos, uint32_t capacity, void *refcon) {
+    sourceCalls += 1;
+    for (uint32_t i = 0; i < systemTapCount && i < capacity; ++i) {
+        infos[i] = systemTaps[i];
+    }
+    return systemTapCount;
+}
+
+
+static STZTapProcessKind classifyProcess(int32_t pid, void *refcon) {
+    classifications[pid] += 1;
+    return processKinds[pid];
+}
+
+
+static void addTap(uint32_t tapID, int32_t pid, bool tapsScrollWheel, bool listensOnly) {
+    memmove(&systemTaps[1], &systemTaps[0], sizeof(STZTapInfo) * systemTapCount);
+    systemTaps[0] = (STZTapInfo){tapID, kCGSessionEventTap, pid, listensOnly, tapsScrollWheel};
+    systemTapCount += 1;
+}
+
+
+static void removeTap(uint32_t tapID) {
+    for (uint32_t i = 0; i < systemTapCount; ++i) {
+        if (systemTaps[i].tapID != tapID) {continue;}
+        memmove(&systemTaps[i], &systemTaps[i + 1], sizeof(STZTapInfo) * (systemTapCount - i - 1));
+        systemTapCount -= 1;
+        return;
+    }
+}
+
+
+int main(void) {
+    processKinds[100] = kSTZTapProcessSystem;
+    processKinds[200] = kSTZTapProcessForeign;
+    processKinds[300] = kSTZTapProcessUnresolved;
+    processKinds[400] = kSTZTapProcessForeign;
+
+    STZTapListRef list = STZTapListCreate(kSelfPID, copySystemTaps, classifyProcess, NULL);
+
+    //  Foreign taps that listen only or don’t tap the wheel are never classified.
+    addTap(1, 100, true, false);
+    addTap(2, 200, true, true);
+    addTap(3, 200, false, false);
+    addTap(10, kSelfPID, true, false);
+    addTap(11, kSelfPID, true, false);
+    STZ_CHECK(STZTapListRefresh(list));
+    STZ_CHECK(classifications[100] == 1 && classifications[200] == 0);
+    STZ_CHECK(STZTapListIsWheelUnderDictatorship(list, true));
+    STZ_CHECK(!STZTapListIsWheelUnderDictatorship(list, false));
+
+    STZ_CHECK(!STZTapListRefresh(list));
+    STZ_CHECK(classifications[100] == 1);
+
+    //  A burst of taps from one process classifies it once.
+    addTap(20, 200, true, false);
+    addTap(21, 200, true, false);
+    addTap(22, 200, true, false);
+    STZ_CHECK(STZTapListRefresh(list));
+    STZ_CHECK(classifications[200] == 1 && classifications[100] == 1);
+    STZ_CHECK(!STZTapListIsWheelUnderDictatorship(list, true));
+
+    //  Our taps reinserted at the front.
+    removeTap(10);
+    removeTap(11);
+    addTap(12, kSelfPID, true, false);
+    addTap(13, kSelfPID, true, false);
+    STZ_CHECK(STZTapListRefresh(list));
+    STZ_CHECK(classifications[200] == 1 && classifications[100] == 1);
+    STZ_CHECK(STZTapListIsWheelUnderDictatorship(list, true));
+
+    //  A process still being looked up may be foreign, and is asked again on each refresh until
+    //  it is resolved, here as a system process.
+    addTap(30, 300, true, false);
+    STZ_CHECK(STZTapListRefresh(list));
+    STZ_CHECK(classifications[300] == 1);
+    STZ_CHECK(!STZTapListIsWheelUnderDictatorship(list, true));
+
+    processKinds[300] = kSTZTapProcessSystem;
+    STZ_CHECK(!STZTapListRefresh(list));
+    STZ_CHECK(classifications[300] == 2);
+    STZ_CHECK(STZTapListIsWheelUnderDictatorship(list, true));
+
+    STZ_CHECK(!STZTapListRefresh(list));
+    STZ_CHECK(classifications[300] == 2);
+
+    //  A process that leaves is forgotten, since its PID may be reused.
+    removeTap(30);
+    for (uint32_t tapID = 20; tapID <= 22; ++tapID) {
+        removeTap(tapID);
+    }
+    STZ_CHECK(STZTapListRefresh(list));
+
+    processKinds[200] = kSTZTapProcessSystem;
+    addTap(40, 200, true, false);
+    STZ_CHECK(STZTapListRefresh(list));
+    STZ_CHECK(classifications[200] == 2);
+    STZ_CHECK(STZTapListIsWheelUnderDictatorship(list, true));
+
+    //  Growing past the initial capacity reads the source once more.
+    for (uint32_t i = 0; i < 50; ++i) {
+        addTap(100 + i, 400, i % 2, false);
+    }
+    sourceCalls = 0;
+    STZ_CHECK(STZTapListRefresh(list));
+    STZ_CHECK(sourceCalls == 2);
+    STZ_CHECK(!STZTapListIsWheelUnderDictatorship(list, false));
+
+    uint32_t count;
+    STZTapListGetInfos(list, &count);
+    STZ_CHECK(count == systemTapCount);
+
+    sourceCalls = 0;
+    STZ_CHECK(!STZTapListRefresh(list));
+    STZ_CHECK(sourceCalls == 1 && classifications[400] == 1);
+
+    STZTapListRelease(list);
+    return STZTestFinish();
+}
@@ -0,0 +1,130 @@
+/*
+ *  STZTapPolicyBenchmarks.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZTapPolicy.h"
+
+
+//  Drives the policy as the event taps do, every quarter of a millisecond over 5 seconds: taps
+//  are required to mutate while zooming, and asked to end mutation when zooming stops and again
+//  whenever a retry is due. Prints what each setting trades between switches and mutable time
+//  for a bouncing trigger key and for short flicks.
+
+#define kMillisecond (NSEC_PER_SEC / 1000)
+#define kDuration (5000 * kMillisecond)
+
+
+typedef struct {
+    STZTapPolicyStatistics statistics;
+    bool                mutableWhenNeeded;
+    bool                passiveAtEnd;
+} Outcome;
+
+
+/// `edges` are the times zooming starts and stops, in pairs.
+static Outcome simulate(CGEventTimestamp lingerTime, uint32_t maxSwitchesPerSecond,
+                        CGEventTimestamp const *edges, int edgeCount) {
+    STZTapPolicyRef policy = STZTapPolicyCreate();
+    STZTapPolicyConfigure(policy, lingerTime, maxSwitchesPerSecond);
+
+    Outcome outcome = {.mutableWhenNeeded = true};
+    CGEventTimestamp retryTime = 0;
+    int nextEdge = 0;
+
+    for (CGEventTimestamp now = kMillisecond; now <= kDuration; now += kMillisecond / 4) {
+        bool needed = false;
+        for (int i = 0; i + 1 < edgeCount; i += 2) {
+            needed |= now >= edges[i] && now < edges[i + 1];
+        }
+
+        bool atEdge = nextEdge < edgeCount && now >= edges[nextEdge];
+        if (atEdge) {
+            nextEdge += 1;
+        }
+
+        if (needed) {
+            STZTapPolicyRequireMutable(policy, now);
+            outcome.mutableWhenNeeded &= STZTapPolicyIsMutable(policy);
+            retryTime = 0;
+        } else if (atEdge || (retryTime && now >= retryTime)) {
+            if (STZTapPolicyMayEndMutable(policy, now, true, &retryTime)) {
+                retryTime = 0;
+            }
+        }
+    }
+
+    outcome.statistics = STZTapPolicyGetStatistics(policy, kDuration);
+    outcome.passiveAtEnd = !STZTapPolicyIsMutable(policy);
+    STZTapPolicyRelease(policy);
+    return outcome;
+}
+
+
+static Outcome simulateAndPrint(char const *name, CGEventTimestamp lingerTime, uint32_t maxSwitchesPerSecond,
+                                CGEventTimestamp const *edges, int edgeCount) {
+    Outcome outcome = simulate(lingerTime, maxSwitchesPerSecond, edges, edgeCount);
+    printf("| %-15s | %6llu | %7u | %8llu | %8llu | %10.1f |\n", name,
+           (unsigned long long)(lingerTime / kMillisecond), maxSwitchesPerSecond,
+           (unsigned long long)outcome.statistics.switches, (unsigned long long)outcome.statistics.deferredByLimit,
+           (double)outcome.statistics.mutableTime / kMillisecond);
+
+    //  Mutation is never refused, and never kept on once zooming has stopped for good.
+    STZ_CHECK(outcome.mutableWhenNeeded);
+    STZ_CHECK(outcome.passiveAtEnd);
+    return outcome;
+}
+
+
+int main(void) {
+    //  A trigger key bouncing: 40 presses of 10 ms, 50 ms apart.
+    CGEventTimestamp bounces[80];
+    for (int i = 0; i < 40; ++i) {
+        bounces[i * 2] = 100 * kMillisecond + (CGEventTimestamp)i * 50 * kMillisecond;
+        bounces[i * 2 + 1] = bounces[i * 2] + 10 * kMillisecond;
+    }
+
+    //  Short flicks: 20 zoom sessions of 60 ms, 150 ms apart.
+    CGEventTimestamp flicks[40];
+    for (int i = 0; i < 20; ++i) {
+        flicks[i * 2] = 100 * kMillisecond + (CGEventTimestamp)i * 150 * kMillisecond;
+        flicks[i * 2 + 1] = flicks[i * 2] + 60 * kMillisecond;
+    }
+
+    printf("| input           | linger | limit/s | switches | deferred | mutable ms |\n");
+    printf("|-----------------|--------|---------|----------|----------|------------|\n");
+
+    struct {
+        char const *name;
+        CGEventTimestamp const *edges;
+        int edgeCount;
+        CGEventTimestamp lingerTime;
+    } const inputs[] = {
+        {"bouncing key", bounces, 80, 200 * kMillisecond},
+        {"short flicks", flicks, 40, 100 * kMillisecond},
+    };
+
+    for (int i = 0; i < 2; ++i) {
+        Outcome eager = simulateAndPrint(inputs[i].name, 0, 0, inputs[i].edges, inputs[i].edgeCount);
+        Outcome lingering = simulateAndPrint(inputs[i].name, inputs[i].lingerTime, 0, inputs[i].edges, inputs[i].edgeCount);
+        Outcome limited = simulateAndPrint(inputs[i].name, 0, 8, inputs[i].edges, inputs[i].edgeCount);
+        simulateAndPrint(inputs[i].name, inputs[i].lingerTime, 8, inputs[i].edges, inputs[i].edgeCount);
+
+        //  Without either, the taps switch at every edge.
+        STZ_CHECK(eager.statistics.switches == (uint64_t)inputs[i].edgeCount);
+
+        //  Lingering over the gaps switches once each way; the limit caps switches per second
+        //  at the cost of some mutable time.
+        STZ_CHECK(lingering.statistics.switches == 2);
+        STZ_CHECK(limited.statistics.switches < eager.statistics.switches);
+        STZ_CHECK(limited.statistics.switches <= 8 * (kDuration / NSEC_PER_SEC));
+        STZ_CHECK(limited.statistics.deferredByLimit > 0);
+        STZ_CHECK(limited.statistics.mutableTime > eager.statistics.mutableTime);
+    }
+
+    return STZTestFinish();
+}
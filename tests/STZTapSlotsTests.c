@@ -0,0 +1,295 @@
+/*
+ *  STZTapSlotsTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZTapSlots.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <math.h>
+
+
+#define kWriterCount 12
+#define kRegistryIDBase 0x100000d00
+
+
+static void testClaimAndTakeOver(void) {
+    CGEventTimestamp now = 1000 * NSEC_PER_SEC;
+    bool claimed;
+
+    for (int i = 0; i < kSTZTapSlotCount; ++i) {
+        int slot = STZTapSlotBeginWriting(kRegistryIDBase + i, now, &claimed);
+        STZ_CHECK(slot >= 0 && claimed);
+        if (slot < 0) {continue;}
+        STZTapSlotPublish(slot, (STZTapState){true, now});
+        STZTapSlotEndWriting(slot);
+    }
+
+    STZTapState state;
+    STZ_CHECK(STZTapSlotRead(kRegistryIDBase + 3, &state) && state.recognized && state.tapTimestamp == now);
+    STZ_CHECK(!STZTapSlotRead(kRegistryIDBase + kSTZTapSlotCount, &state));
+
+    //  The table is full and no device has been idle for long.
+    now += kSTZTapSlotLifetime;
+    STZ_CHECK(STZTapSlotBeginWriting(kRegistryIDBase + kSTZTapSlotCount, now, &claimed) < 0);
+
+    //  Keep the first device busy; the idle one with the oldest frame is taken over instead.
+    int slot = STZTapSlotBeginWriting(kRegistryIDBase, now, &claimed);
+    STZ_CHECK(slot >= 0 && !claimed);
+    if (slot >= 0) {STZTapSlotEndWriting(slot);}
+
+    now += NSEC_PER_SEC;
+    slot = STZTapSlotBeginWriting(kRegistryIDBase + kSTZTapSlotCount, now, &claimed);
+    STZ_CHECK(slot >= 0 && claimed);
+    if (slot >= 0) {STZTapSlotEndWriting(slot);}
+
+    STZ_CHECK(STZTapSlotRead(kRegistryIDBase, &state) && state.recognized);
+    STZ_CHECK(STZTapSlotRead(kRegistryIDBase + kSTZTapSlotCount, &state) && !state.recognized && state.tapTimestamp == 0);
+
+    int lost = 0;
+    for (int i = 1; i < kSTZTapSlotCount; ++i) {
+        lost += !STZTapSlotRead(kRegistryIDBase + i, &state);
+    }
+    STZ_CHECK(lost == 1);
+
+    for (int i = 0; i <= kSTZTapSlotCount; ++i) {
+        STZTapSlotRelease(kRegistryIDBase + i);
+        STZ_CHECK(!STZTapSlotRead(kRegistryIDBase + i, &state));
+    }
+}
+
+
+//  MARK: - Stress
+
+
+//  More writers than slots, each with a clock far ahead of the others at times, so that slots
+//  are claimed, taken over and released all the time while one reader checks every published
+//  state. A state holds its device in the high bits of the timestamp and is recognized exactly
+//  when the counter in the low bits is odd, so a torn read or a state of another device shows.
+//
+//  The same writers then run against what the states were published through before: a cache of
+//  all devices under one lock, held by each frame while it is processed. Every read is timed in
+//  both runs, clock reads included, since what the event tap cares about is how long it may wait.
+
+typedef CLOSED_ENUM(uint8_t) {
+    kStoreTapSlots,
+    kStoreLockedCache,
+} Store;
+
+typedef struct {
+    int                 index;
+    uint64_t            iterations;
+    Store               store;
+} Writer;
+
+static _Atomic(uint64_t) slotWriters[kSTZTapSlotCount];
+static _Atomic(int) finishedWriters = 0;
+static _Atomic(uint64_t) doubleWrites = 0;
+static _Atomic(uint64_t) writesWithoutSlot = 0;
+
+static pthread_mutex_t lockedCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static STZCacheRef lockedCache = NULL;
+
+
+static STZTapState stateOfWrite(uint64_t registryID, uint64_t i) {
+    return (STZTapState){i & 1, (registryID << 24) | (i & 0xFFFFFF)};
+}
+
+
+static void writeTapSlot(uint64_t registryID, CGEventTimestamp now, uint64_t i) {
+    bool claimed;
+    int slot = STZTapSlotBeginWriting(registryID, now, &claimed);
+    if (slot < 0) {
+        atomic_fetch_add(&writesWithoutSlot, 1);
+        return;
+    }
+
+    uint64_t expected = 0;
+    if (!atomic_compare_exchange_strong(&slotWriters[slot], &expected, registryID)) {
+        atomic_fetch_add(&doubleWrites, 1);
+    }
+
+    //  Give others a chance to run while the slot is being written, even on a single core.
+    if (i % 8 == 0) {
+        sched_yield();
+    }
+    STZTapSlotPublish(slot, stateOfWrite(registryID, i));
+
+    atomic_store(&slotWriters[slot], 0);
+    STZTapSlotEndWriting(slot);
+}
+
+
+static void writeLockedCache(uint64_t registryID, uint64_t i) {
+    pthread_mutex_lock(&lockedCacheMutex);
+    STZTapState *state = STZCacheGetValue(lockedCache, registryID);
+    if (!state) {
+        STZTapState newState = {false, 0};
+        state = STZCacheSetValue(lockedCache, registryID, &newState);
+    }
+
+    if (i % 8 == 0) {
+        sched_yield();
+    }
+    *state = stateOfWrite(registryID, i);
+    pthread_mutex_unlock(&lockedCacheMutex);
+}
+
+
+static bool readLockedCache(uint64_t registryID, STZTapState *outState) {
+    pthread_mutex_lock(&lockedCacheMutex);
+    STZTapState *state = STZCacheGetValue(lockedCache, registryID);
+    if (state) {*outState = *state;}
+    pthread_mutex_unlock(&lockedCacheMutex);
+    return state != NULL;
+}
+
+
+static void *writeStates(void *info) {
+    Writer *writer = info;
+    uint64_t registryID = kRegistryIDBase + (uint64_t)writer->index;
+    CGEventTimestamp now = NSEC_PER_SEC;
+
+    for (uint64_t i = 1; i <= writer->iterations; ++i) {
+        now += i % 64 == (uint64_t)writer->index ? kSTZTapSlotLifetime + 1 : 1;
+
+        bool release = i % 1000 == (uint64_t)writer->index;
+        switch (writer->store) {
+        case kStoreTapSlots:
+            writeTapSlot(registryID, now, i);
+            //  As if the device were stopped and detached.
+            if (release) {STZTapSlotRelease(registryID);}
+            break;
+
+        case kStoreLockedCache:
+            writeLockedCache(registryID, i);
+            if (release) {
+                pthread_mutex_lock(&lockedCacheMutex);
+                STZCacheRemoveValue(lockedCache, registryID);
+                pthread_mutex_unlock(&lockedCacheMutex);
+            }
+            break;
+        }
+    }
+
+    atomic_fetch_add(&finishedWriters, 1);
+    return NULL;
+}
+
+
+//  Read durations in buckets 1/32 of a power of two wide, so percentiles are within about 2%
+//  from nanoseconds to seconds.
+#define kReadBucketsPerOctave 32
+#define kReadBucketCount (32 * kReadBucketsPerOctave)
+
+typedef struct {
+    uint64_t            counts[kReadBucketCount];
+    uint64_t            reads;
+    uint64_t            found;
+    uint64_t            inconsistent;
+    uint64_t            foreign;
+    uint64_t            maxDuration;
+} Reads;
+
+
+static uint64_t readPercentile(Reads const *reads, double fraction) {
+    uint64_t target = (uint64_t)ceil((double)reads->reads * fraction);
+    uint64_t count = 0;
+    for (int i = 0; i < kReadBucketCount; ++i) {
+        count += reads->counts[i];
+        if (count >= target) {
+            uint64_t bound = (uint64_t)exp2((double)(i + 1) / kReadBucketsPerOctave);
+            return bound < reads->maxDuration ? bound : reads->maxDuration;
+        }
+    }
+    return reads->maxDuration;
+}
+
+
+static void stress(Store store, uint64_t iterations, Reads *reads) {
+    pthread_t threads[kWriterCount];
+    Writer writers[kWriterCount];
+
+    atomic_store(&finishedWriters, 0);
+    for (int i = 0; i < kWriterCount; ++i) {
+        writers[i] = (Writer){i, iterations, store};
+        pthread_create(&threads[i], NULL, writeStates, &writers[i]);
+    }
+
+    while (atomic_load(&finishedWriters) < kWriterCount) {
+        for (int i = 0; i < kWriterCount; ++i) {
+            uint64_t registryID = kRegistryIDBase + (uint64_t)i;
+            STZTapState state;
+
+            uint64_t begin = STZTestGetWallTime();
+            bool found = store == kStoreTapSlots ? STZTapSlotRead(registryID, &state)
+                                                 : readLockedCache(registryID, &state);
+            uint64_t duration = STZTestGetWallTime() - begin;
+
+            int bucket = duration == 0 ? 0 : (int)(log2((double)duration) * kReadBucketsPerOctave);
+            reads->counts[bucket < kReadBucketCount ? bucket : kReadBucketCount - 1] += 1;
+            if (reads->maxDuration < duration) {reads->maxDuration = duration;}
+            reads->reads += 1;
+
+            if (!found) {continue;}
+            reads->found += 1;
+
+            if (state.tapTimestamp == 0) {
+                reads->inconsistent += state.recognized;
+                continue;
+            }
+
+            reads->foreign += (state.tapTimestamp >> 24) != registryID;
+            reads->inconsistent += state.recognized != (state.tapTimestamp & 1);
+        }
+        sched_yield();
+    }
+
+    for (int i = 0; i < kWriterCount; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    testClaimAndTakeOver();
+
+    uint64_t iterations = STZTestIsFullRun(argc, argv) ? 20000000 : 200000;
+    static Reads slotReads, lockedReads;
+
+    stress(kStoreTapSlots, iterations, &slotReads);
+
+    lockedCache = STZCacheCreate(sizeof(STZTapState), kSTZTapSlotLifetime, NULL);
+    stress(kStoreLockedCache, iterations, &lockedReads);
+    STZCacheRelease(lockedCache);
+
+    printf("%llu writes without a slot\n\n", (unsigned long long)atomic_load(&writesWithoutSlot));
+    printf("| store        | reads     | found     | p50 ns | p99 ns   | p99.9 ns | max ns    |\n");
+    printf("|--------------|-----------|-----------|--------|----------|----------|-----------|\n");
+
+    Reads const *runs[] = {&slotReads, &lockedReads};
+    char const *names[] = {"tap slots", "locked cache"};
+    for (int i = 0; i < 2; ++i) {
+        Reads const *reads = runs[i];
+        printf("| %-12s | %9llu | %9llu | %6llu | %8llu | %8llu | %9llu |\n", names[i],
+               (unsigned long long)reads->reads, (unsigned long long)reads->found,
+               (unsigned long long)readPercentile(reads, 0.5),
+               (unsigned long long)readPercentile(reads, 0.99),
+               (unsigned long long)readPercentile(reads, 0.999),
+               (unsigned long long)reads->maxDuration);
+    }
+
+    STZ_CHECK(atomic_load(&doubleWrites) == 0);
+    for (int i = 0; i < 2; ++i) {
+        STZ_CHECK(runs[i]->inconsistent == 0);
+        STZ_CHECK(runs[i]->foreign == 0);
+        STZ_CHECK(runs[i]->found > 0);
+    }
+
+    return STZTestFinish();
+}
@@ -0,0 +1,61 @@
+/*
+ *  STZTestSupport.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include <time.h>
+
+
+static int failureCount = 0;
+
+
+bool STZTestCheck(bool passed, char const *expression, char const *file, int line) {
+    if (!passed) {
+        failureCount += 1;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    }
+    return passed;
+}
+
+
+int STZTestFinish(void) {
+    if (failureCount) {
+        printf("%d check(s) failed\n", failureCount);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
+
+
+bool STZTestIsFullRun(int argc, char *const argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--full") == 0) {return true;}
+    }
+    return false;
+}
+
+
+uint64_t STZTestGetWallTime(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * NSEC_PER_SEC + (uint64_t)time.tv_nsec;
+}
+
+
+CGEventRef STZTestCreateScrollEvent(CGEventTimestamp time, uint64_t registryID, double delta,
+                                    CGScrollPhase phase, CGMomentumScrollPhase momentumPhase) {
+    CGEventRef event = CGEventCreate(NULL);
+    CGEventSetType(event, kCGEventScrollWheel);
+    CGEventSetTimestamp(event, time);
+    CGEventSetIntegerValueField(event, kCGEventRegistryID, (int64_t)registryID);
+    CGEventSetDoubleValueField(event, kCGScrollWheelEventPointDeltaAxis1, delta);
+    CGEventSetDoubleValueField(event, kCGScrollWheelEventFixedPtDeltaAxis1, delta);
+    CGEventSetIntegerValueField(event, kCGScrollWheelEventScrollPhase, phase);
+    CGEventSetIntegerValueField(event, kCGScrollWheelEventMomentumPhase, momentumPhase);
+    return event;
+}
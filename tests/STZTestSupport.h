@@ -0,0 +1,41 @@
+/*
+ *  STZTestSupport.h
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#pragma once
+#include "STZCommon.h"
+#include "CGEventSPI.h"
+#include <stdio.h>
+
+CF_ASSUME_NONNULL_BEGIN
+
+
+//  Shared by the tests and benchmarks of the portable core. Checks don’t stop the program; the
+//  exit status of `STZTestFinish` tells whether any failed.
+
+
+#define STZ_CHECK(condition) STZTestCheck((condition), #condition, __FILE__, __LINE__)
+
+bool STZTestCheck(bool passed, char const *expression, char const *file, int line);
+
+/// Prints the number of failed checks and returns the exit status for `main`.
+int STZTestFinish(void);
+
+/// Whether `--full` is among the arguments, which asks benchmarks for their long workload.
+bool STZTestIsFullRun(int argc, char *const argv[__nullable]);
+
+/// Monotonic wall time in nanoseconds, for benchmarks. The backend clock is virtual.
+uint64_t STZTestGetWallTime(void);
+
+
+/// A scroll event at the given time, with the delta in points and lines on the vertical axis.
+/// Events with no phase read as discrete, as from a mouse wheel.
+CGEventRef STZTestCreateScrollEvent(CGEventTimestamp time, uint64_t registryID, double delta,
+                                    CGScrollPhase phase, CGMomentumScrollPhase momentumPhase) CF_RETURNS_RETAINED;
+
+
+CF_ASSUME_NONNULL_END
@@ -0,0 +1,155 @@
+/*
+ *  STZTraceTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZTrace.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+//  Several threads record at once, as the event taps and the MultitouchSupport thread do. Fewer
+//  records are pushed than the queue holds, so none may be dropped however late the writer
+//  wakes: the trace must hold every record of every thread, in the order each thread pushed them.
+
+
+#define kThreads 4
+#define kRecordsPerThread 200
+
+
+static void *recordFromThread(void *info) {
+    int thread = (int)(intptr_t)info;
+    uint64_t registryID = (uint64_t)thread + 1;
+    int32_t pid = 100 + thread;
+
+    char bundleID[32];
+    snprintf(bundleID, sizeof(bundleID), "com.example.thread%d", thread);
+    if (!STZTraceKnowsProcess(pid)) {
+        STZTraceRecordProcess(pid, bundleID);
+    }
+    STZ_CHECK(STZTraceKnowsProcess(pid));
+
+    for (int i = 0; i < kRecordsPerThread; ++i) {
+        CGEventTimestamp timestamp = (CGEventTimestamp)(i + 1) * 1000 + (CGEventTimestamp)thread;
+        if (i % 2) {
+            STZTraceTouch touch = {.fingerID = (uint8_t)thread, .phase = 1, .location = {i / 256.f, 0.5f}};
+            STZTraceRecordTouches(timestamp, registryID, &touch, 1);
+        } else {
+            STZTraceRecordMagicZoom(timestamp, registryID, i % 4 == 0);
+        }
+    }
+
+    return NULL;
+}
+
+
+static void testConcurrentRecording(char const *path) {
+    STZ_CHECK(STZTraceStartRecording(path));
+    STZ_CHECK(!STZTraceStartRecording(path));
+
+    pthread_t threads[kThreads];
+    for (int t = 0; t < kThreads; ++t) {
+        pthread_create(&threads[t], NULL, recordFromThread, (void *)(intptr_t)t);
+    }
+    for (int t = 0; t < kThreads; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    STZTraceStopRecording();
+    STZ_CHECK(!STZTraceIsRecording());
+
+    STZTraceReaderRef reader = STZTraceReaderOpen(path);
+    if (!STZ_CHECK(reader != NULL)) {return;}
+
+    int records[kThreads] = {0};
+    int processes[kThreads] = {0};
+    int misordered = 0;
+    int malformed = 0;
+
+    STZTraceItem item;
+    while (STZTraceReaderNext(reader, &item)) {
+        if (item.kind == kSTZTraceProcess) {
+            int thread = item.pid - 100;
+            char expected[32];
+            snprintf(expected, sizeof(expected), "com.example.thread%d", thread);
+            if (thread < 0 || thread >= kThreads || item.bundleIDLength != strlen(expected)
+             || memcmp(item.bundleID, expected, item.bundleIDLength) != 0) {
+                malformed += 1;
+            } else {
+                processes[thread] += 1;
+            }
+            continue;
+        }
+
+        int thread = (int)item.registryID - 1;
+        if (thread < 0 || thread >= kThreads) {
+            malformed += 1;
+            continue;
+        }
+
+        int i = records[thread]++;
+        misordered += item.timestamp != (CGEventTimestamp)(i + 1) * 1000 + (CGEventTimestamp)thread;
+
+        if (item.kind == kSTZTraceTouches) {
+            malformed += i % 2 == 0 || item.touches.count != 1 || item.touches.touches[0].fingerID != thread;
+        } else {
+            malformed += i % 2 == 1 || item.kind != kSTZTraceMagicZoom || item.magicZoomActive != (i % 4 == 0);
+        }
+    }
+
+    STZTraceReaderClose(reader);
+
+    for (int t = 0; t < kThreads; ++t) {
+        STZ_CHECK(records[t] == kRecordsPerThread);
+        STZ_CHECK(processes[t] == 1);
+    }
+    STZ_CHECK(misordered == 0);
+    STZ_CHECK(malformed == 0);
+}
+
+
+static void testNothingAfterStop(char const *path) {
+    STZ_CHECK(STZTraceStartRecording(path));
+    STZTraceRecordMagicZoom(1000, 1, true);
+    STZTraceStopRecording();
+
+    STZTraceRecordMagicZoom(2000, 1, false);
+    STZ_CHECK(STZTraceKnowsProcess(42));
+
+    STZTraceReaderRef reader = STZTraceReaderOpen(path);
+    if (!STZ_CHECK(reader != NULL)) {return;}
+
+    int magicZooms = 0;
+    STZTraceItem item;
+    while (STZTraceReaderNext(reader, &item)) {
+        magicZooms += item.kind == kSTZTraceMagicZoom;
+    }
+    STZ_CHECK(magicZooms == 1);
+    STZTraceReaderClose(reader);
+}
+
+
+int main(void) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/STZTraceTests.XXXXXX", getenv("TMPDIR") ?: "/tmp");
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    //  Twice, so that the second trace starts from a clean queue and dictionaries.
+    testConcurrentRecording(path);
+    testConcurrentRecording(path);
+    testNothingAfterStop(path);
+
+    unlink(path);
+    return STZTestFinish();
+}
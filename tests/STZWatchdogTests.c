@@ -0,0 +1,79 @@
+/*
+ *  STZWatchdogTests.c
+ *  ScrollToZoom
+ *
+ *  Created by alpha on 2026/10/17.
+ *  Copyright © 2026 alphaArgon.
+ */
+
+#include "STZTestSupport.h"
+#include "STZWatchdog.h"
+
+
+static CGEventTimestamp const kBudget = NSEC_PER_SEC / 4;
+static CGEventTimestamp const kMillisecond = NSEC_PER_SEC / 1000;
+
+static int workOrder[4];
+static int workCount = 0;
+
+
+static void recordWork(void *info, void *object) {
+    workOrder[workCount++] = (int)(intptr_t)info;
+}
+
+
+int main(void) {
+    STZWatchdogRef watchdog = STZWatchdogCreate(kBudget, 2);
+    CGEventTimestamp now = 10 * NSEC_PER_SEC;
+
+    //  A fast callback for a fresh event.
+    STZWatchdogBeginCallback(watchdog, 0, now - 1000, now);
+    STZ_CHECK(!STZWatchdogShouldDefer(watchdog, now + 5000));
+    STZWatchdogEndCallback(watchdog, now + 5000);
+
+    //  The event seems to have waited 200 ms, which may be its own timestamp; the callback still
+    //  has its whole budget.
+    STZWatchdogBeginCallback(watchdog, 1, now - 200 * kMillisecond, now);
+    STZ_CHECK(!STZWatchdogShouldDefer(watchdog, now + 60 * kMillisecond));
+    STZWatchdogEndCallback(watchdog, now + 70 * kMillisecond);
+
+    //  An event posted with a timestamp from long ago, or from the future.
+    STZWatchdogBeginCallback(watchdog, 1, 1, now);
+    STZ_CHECK(!STZWatchdogShouldDefer(watchdog, now));
+    STZWatchdogEndCallback(watchdog, now + 100);
+
+    STZWatchdogBeginCallback(watchdog, 1, now + NSEC_PER_SEC, now);
+    STZWatchdogEndCallback(watchdog, now + 100);
+
+    //  Past the budget since entry, work is deferred and run in order afterwards.
+    STZWatchdogBeginCallback(watchdog, 0, now, now);
+    STZ_CHECK(!STZWatchdogShouldDefer(watchdog, now + kBudget - 1));
+    STZ_CHECK(STZWatchdogShouldDefer(watchdog, now + kBudget));
+    STZ_CHECK(STZWatchdogDefer(watchdog, recordWork, (void *)1, NULL));
+    STZ_CHECK(!STZWatchdogDefer(watchdog, recordWork, (void *)2, NULL));
+    STZWatchdogEndCallback(watchdog, now + kBudget + kMillisecond);
+
+    STZ_CHECK(!STZWatchdogShouldDefer(watchdog, now + NSEC_PER_SEC));
+    STZWatchdogRunDeferredWork(watchdog);
+    STZ_CHECK(workCount == 2 && workOrder[0] == 1 && workOrder[1] == 2);
+    STZ_CHECK(STZWatchdogGetDeferredWorkCount(watchdog) == 2);
+
+    STZWatchdogHistogram timings = STZWatchdogGetHistogram(watchdog, 0);
+    STZ_CHECK(timings.callbacks == 2 && timings.overBudget == 1 && timings.counts[3] == 1);
+
+    timings = STZWatchdogGetHistogram(watchdog, 1);
+    STZ_CHECK(timings.callbacks == 3 && timings.overBudget == 0);
+    STZ_CHECK(timings.maxDuration == 70 * kMillisecond);
+
+    //  Delays are recorded apart; the one from the future is left out.
+    STZWatchdogHistogram delays = STZWatchdogGetQueueDelayHistogram(watchdog, 1);
+    STZ_CHECK(delays.callbacks == 2 && delays.overBudget == 1);
+    STZ_CHECK(delays.maxDuration == now - 1);
+    STZ_CHECK(STZWatchdogHistogramGetPercentile(&delays, 0.5) == 262144 * 1000);
+
+    delays = STZWatchdogGetQueueDelayHistogram(watchdog, 0);
+    STZ_CHECK(delays.callbacks == 2 && delays.overBudget == 0 && delays.maxDuration == 1000);
+
+    STZWatchdogRelease(watchdog);
+    return STZTestFinish();
+}